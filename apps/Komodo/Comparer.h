@@ -122,7 +122,7 @@ public:
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 
-        engine.add_mutating_callback([&]{ this->update(engine); });
+        engine.add_mutating_callback("Comparer", [&]{ this->update(engine); });
     }
 
     void update(Bifrost::Core::Engine& engine) {
@@ -11,6 +11,7 @@
 #include <Bifrost/Assets/Material.h>
 #include <Bifrost/Scene/Camera.h>
 #include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/ScreenshotWriter.h>
 
 #include <DX11Renderer/Compositor.h>
 #include <DX11Renderer/Renderer.h>
@@ -49,6 +50,10 @@ struct RenderingGUI::State {
         bool use_path_regularization = true;
         OptiXRenderer::PathRegularizationSettings path_regularization_settings;
     } optix;
+
+    ScreenshotWriter screenshot_writer = ScreenshotWriter([](const Screenshot& screenshot, const std::string& path) {
+        return StbImageWriter::write(screenshot, path);
+    });
 };
 
 RenderingGUI::RenderingGUI(DX11Renderer::Compositor* compositor, DX11Renderer::Renderer* dx_renderer, OptiXRenderer::Renderer* optix_renderer)
@@ -74,13 +79,11 @@ void RenderingGUI::layout_frame() {
         { // Resolve existing screenshots
             for (auto cam_ID : Cameras::get_iterable()) {
                 auto output_screenshot = [&](Screenshot::Content content, char* file_extension) {
-                    auto image_ID = Cameras::resolve_screenshot(cam_ID, content, "ss");
-                    if (Images::has(image_ID)) {
-                        std::string path = std::string(m_screenshot.path) + file_extension;
-                        if (!StbImageWriter::write(image_ID, path))
+                    std::string path = std::string(m_screenshot.path) + file_extension;
+                    m_state->screenshot_writer.write(cam_ID, content, path, [](const std::string& path, bool succeeded) {
+                        if (!succeeded)
                             printf("Failed to output screenshot to '%s'\n", path.c_str());
-                        Images::destroy(image_ID);
-                    }
+                    });
                 };
                 output_screenshot(Screenshot::Content::ColorLDR, ".png");
                 output_screenshot(Screenshot::Content::ColorHDR, ".hdr");
@@ -204,7 +204,7 @@ void create_sphere_scene(Engine& engine, Cameras::UID camera_ID, SceneRoots::UID
             }
         };
 
-        engine.add_mutating_callback([=, &engine]() { swap_material(engine); });
+        engine.add_mutating_callback("Swap material", [=, &engine]() { swap_material(engine); });
     }
 
     { // Setup GUI.
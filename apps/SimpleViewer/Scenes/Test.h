@@ -206,7 +206,7 @@ void create_test_scene(Core::Engine& engine, Scene::Cameras::UID camera_ID, Scen
             parent_node = ring_node;
 
             LocalRotator* simple_rotator = new LocalRotator(ring_node.get_ID(), i * 0.31415f * 0.5f + 0.2f);
-            engine.add_mutating_callback([=, &engine] { simple_rotator->rotate(engine); });
+            engine.add_mutating_callback("Rotate ring", [=, &engine] { simple_rotator->rotate(engine); }, Core::Engine::Manager::None, Core::Engine::Manager::SceneNodes);
         }
     }
 
@@ -278,7 +278,7 @@ void create_test_scene(Core::Engine& engine, Scene::Cameras::UID camera_ID, Scen
         sphere_node.set_parent(root_node);
 
         LocalRotator* simple_rotator = new LocalRotator(sphere_node.get_ID(), 0.2f, Vector3f::up());
-        engine.add_mutating_callback([=, &engine] { simple_rotator->rotate(engine); });
+        engine.add_mutating_callback("Rotate sphere", [=, &engine] { simple_rotator->rotate(engine); }, Core::Engine::Manager::None, Core::Engine::Manager::SceneNodes);
     }
 
     { // Partial coverage plastic torus.
@@ -308,7 +308,7 @@ void create_test_scene(Core::Engine& engine, Scene::Cameras::UID camera_ID, Scen
     { // GUN!
         Cameras::UID cam_ID = *Cameras::begin();
         BoxGun* boxgun = new BoxGun(cam_ID);
-        engine.add_mutating_callback([=, &engine] { boxgun->update(engine); });
+        engine.add_mutating_callback("Box gun", [=, &engine] { boxgun->update(engine); });
     }
 
     Vector3f light_position = Vector3f(100.0f, 20.0f, 100.0f);
@@ -318,7 +318,7 @@ void create_test_scene(Core::Engine& engine, Scene::Cameras::UID camera_ID, Scen
     SceneNodes::set_parent(light_node_ID, root_node.get_ID());
 
     BlinkingLight* blinking_light = new BlinkingLight();
-    engine.add_mutating_callback([=, &engine] { blinking_light->blink(engine); });
+    engine.add_mutating_callback("Blinking light", [=, &engine] { blinking_light->blink(engine); });
 }
 
 } // NS Scenes
@@ -18,6 +18,7 @@
 
 #include <Bifrost/Assets/Mesh.h>
 #include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/MeshSimplification.h>
 #include <Bifrost/Core/Engine.h>
 #include <Bifrost/Input/Keyboard.h>
 #include <Bifrost/Input/Mouse.h>
@@ -52,6 +53,11 @@ using namespace Bifrost::Scene;
 
 static std::string g_scene;
 static std::string g_environment;
+static bool g_optimize_meshes = false;
+static bool g_weld_vertices = false;
+static bool g_print_vertex_cache_report = false;
+static bool g_compress_meshes = false;
+static bool g_build_LODs = false;
 static RGB g_environment_color = RGB(0.68f, 0.92f, 1.0f);
 static float g_scene_size;
 static DX11Renderer::Compositor* compositor = nullptr;
@@ -266,8 +272,7 @@ Images::UID load_image(const std::string& path) {
 //   It also avoids combining leafs on a tree acros the entire scene.
 void mesh_combine_whole_scene(SceneNodes::UID scene_root) {
 
-    // Asserts of properties used when combining UIDs and mesh flags in one uint key.
-    assert(MeshModels::UID::MAX_IDS <= 0xFFFFFF);
+    // Asserts of properties used when combining UIDs and mesh flags in one 64 bit key.
     assert((int)MeshFlag::Position <= 0xFF);
     assert((int)MeshFlag::Normal <= 0xFF);
     assert((int)MeshFlag::Texcoord <= 0xFF);
@@ -277,7 +282,7 @@ void mesh_combine_whole_scene(SceneNodes::UID scene_root) {
         used_meshes[mesh_ID] = false;
 
     struct OrderedModel {
-        unsigned int key;
+        unsigned long long key;
         MeshModels::UID model_ID;
 
         inline bool operator<(OrderedModel lhs) const { return key < lhs.key; }
@@ -287,13 +292,14 @@ void mesh_combine_whole_scene(SceneNodes::UID scene_root) {
     std::vector<OrderedModel> ordered_models = std::vector<OrderedModel>();
     ordered_models.reserve(MeshModels::capacity());
     for (MeshModels::UID model_ID : MeshModels::get_iterable()) {
-        unsigned int key = MeshModels::get_material_ID(model_ID).get_index() << 8u;
+        unsigned long long key = (unsigned long long)MeshModels::get_material_ID(model_ID).get_index() << 8u;
 
         // Least significant bits in key consist of mesh flags.
         Mesh mesh = MeshModels::get_mesh_ID(model_ID);
-        key |= int(mesh.get_positions() ? MeshFlag::Position : MeshFlag::None);
-        key |= int(mesh.get_normals() ? MeshFlag::Normal : MeshFlag::None);
-        key |= int(mesh.get_texcoords() ? MeshFlag::Texcoord : MeshFlag::None);
+        MeshFlags mesh_flags = mesh.get_flags();
+        key |= int(mesh_flags.is_set(MeshFlag::Position) ? MeshFlag::Position : MeshFlag::None);
+        key |= int(mesh_flags.is_set(MeshFlag::Normal) ? MeshFlag::Normal : MeshFlag::None);
+        key |= int(mesh_flags.is_set(MeshFlag::Texcoord) ? MeshFlag::Texcoord : MeshFlag::None);
 
         OrderedModel model = { key, model_ID };
         ordered_models.push_back(model);
@@ -335,7 +341,7 @@ void mesh_combine_whole_scene(SceneNodes::UID scene_root) {
                     }
 
                     std::string mesh_name = material.get_name() + "_combined_mesh";
-                    unsigned int mesh_flags = segment_begin->key; // The mesh flags are contained in the key.
+                    unsigned int mesh_flags = (unsigned int)segment_begin->key; // The mesh flags are contained in the key.
                     Meshes::UID merged_mesh_ID = MeshUtils::combine(mesh_name, transformed_meshes.data(), transformed_meshes.data() + transformed_meshes.size(), mesh_flags);
 
                     // Create new model.
@@ -440,7 +446,12 @@ int initializer(Engine& engine) {
     SceneRoots::allocate(1u);
     Textures::allocate(8u);
 
-    engine.add_tick_cleanup_callback(miniheaps_cleanup_callback);
+    SceneNodes::add_transform_propagation_callbacks(engine);
+
+    typedef Engine::Manager Manager;
+    engine.add_tick_cleanup_callback("Reset change notifications", miniheaps_cleanup_callback, Manager::None,
+        { Manager::Cameras, Manager::Images, Manager::LightSources, Manager::Materials, Manager::Meshes,
+          Manager::MeshModels, Manager::SceneNodes, Manager::SceneRoots, Manager::Textures });
 
     return 0;
 }
@@ -464,7 +475,8 @@ int initialize_scene(Engine& engine) {
     // Create camera
     Cameras::UID cam_ID = Cameras::create("Camera", scene_ID, Matrix4x4f::identity(), Matrix4x4f::identity()); // Matrices will be set up by the CameraHandler.
     CameraHandler* camera_handler = new CameraHandler(cam_ID, engine.get_window().get_aspect_ratio(), 0.1f, 100.0f);
-    engine.add_mutating_callback([=, &engine] { camera_handler->handle(engine); });
+    typedef Engine::Manager Manager;
+    engine.add_mutating_callback("Camera projection", [=, &engine] { camera_handler->handle(engine); }, { Manager::Input, Manager::Window }, Manager::Cameras);
 
     // Load model
     bool load_model_from_file = false;
@@ -486,13 +498,52 @@ int initialize_scene(Engine& engine) {
         printf("Loading scene: '%s'\n", g_scene.c_str());
         SceneNodes::UID obj_root_ID = SceneNodes::UID::invalid_UID();
         if (ObjLoader::file_supported(g_scene))
-            obj_root_ID = ObjLoader::load(g_scene, load_image);
+            obj_root_ID = ObjLoader::load(g_scene, load_image, g_optimize_meshes);
         else if (glTFLoader::file_supported(g_scene))
-            obj_root_ID = glTFLoader::load(g_scene);
+            obj_root_ID = glTFLoader::load(g_scene, g_optimize_meshes);
         SceneNodes::set_parent(obj_root_ID, root_node_ID);
         // mesh_combine_whole_scene(root_node_ID);
         detect_and_flag_cutout_materials();
         load_model_from_file = true;
+
+        if (g_weld_vertices) {
+            unsigned int vertex_count = 0, removed_vertex_count = 0;
+            for (Meshes::UID mesh_ID : Meshes::get_iterable()) {
+                vertex_count += Meshes::get_vertex_count(mesh_ID);
+                removed_vertex_count += MeshUtils::weld_vertices(mesh_ID);
+            }
+            printf("Welded %u of %u vertices\n", removed_vertex_count, vertex_count);
+        }
+
+        if (g_print_vertex_cache_report) {
+            unsigned int primitive_count = 0, vertex_count = 0, transformed_vertex_count = 0;
+            for (Meshes::UID mesh_ID : Meshes::get_iterable()) {
+                primitive_count += Meshes::get_primitive_count(mesh_ID);
+                vertex_count += Meshes::get_vertex_count(mesh_ID);
+                transformed_vertex_count += MeshUtils::compute_vertex_cache_statistics(mesh_ID).transformed_vertex_count;
+            }
+            printf("Vertex cache report: %u triangles, %u vertices, ACMR %.3f, ATVR %.3f\n", primitive_count, vertex_count,
+                   transformed_vertex_count / float(primitive_count), transformed_vertex_count / float(vertex_count));
+        }
+
+        if (g_build_LODs) {
+            std::vector<Meshes::UID> mesh_IDs;
+            for (Meshes::UID mesh_ID : Meshes::get_iterable())
+                mesh_IDs.push_back(mesh_ID);
+            MeshUtils::build_LOD_chains(mesh_IDs.data(), mesh_IDs.data() + mesh_IDs.size());
+            unsigned int level_count = 0;
+            for (Meshes::UID mesh_ID : mesh_IDs)
+                level_count += (unsigned int)Meshes::get_LOD_chain(mesh_ID).size();
+            printf("Built %u levels of detail for %u meshes\n", level_count, (unsigned int)mesh_IDs.size());
+        }
+
+        if (g_compress_meshes) {
+            size_t uncompressed_bytes = Meshes::get_memory_usage()[MemoryCategory::Vertices];
+            for (Meshes::UID mesh_ID : Meshes::get_iterable())
+                Meshes::set_compression(mesh_ID, MeshFlag::Compressed);
+            size_t compressed_bytes = Meshes::get_memory_usage()[MemoryCategory::Vertices];
+            printf("Compressed mesh vertices from %.1fMB to %.1fMB\n", uncompressed_bytes / (1024.0 * 1024.0), compressed_bytes / (1024.0 * 1024.0));
+        }
     }
 
     if (SceneNodes::get_children_IDs(root_node_ID).size() == 0u) {
@@ -532,10 +583,11 @@ int initialize_scene(Engine& engine) {
 
     float camera_velocity = g_scene_size * 0.1f;
     Navigation* camera_navigation = new Navigation(cam_ID, camera_velocity, g_camera_translation, g_camera_vertical_rotation, g_camera_horizontal_rotation);
-    engine.add_mutating_callback([=, &engine] { camera_navigation->navigate(engine); });
+    // Navigation can pause the engine time read by the other callbacks, so it keeps the default exclusive access.
+    engine.add_mutating_callback("Camera navigation", [=, &engine] { camera_navigation->navigate(engine); });
     RenderSwapper* render_swapper = new RenderSwapper(cam_ID);
-    engine.add_mutating_callback([=, &engine] { render_swapper->handle(engine); });
-    engine.add_mutating_callback([&engine] { update_FPS(engine); });
+    engine.add_mutating_callback("Renderer swapping", [=, &engine] { render_swapper->handle(engine); }, { Manager::Input, Manager::Renderers }, Manager::Cameras);
+    engine.add_mutating_callback("FPS statistics", [&engine] { update_FPS(engine); }, Manager::None, Manager::Window);
 
     if (false) { // Picture in picture
         auto second_cam_ID = Cameras::create("Second cam", scene_ID, Cameras::get_projection_matrix(cam_ID), Cameras::get_inverse_projection_matrix(cam_ID));
@@ -571,7 +623,7 @@ int initialize_scene(Engine& engine) {
     };
 
     OptiXBackendSwitcher* backend_switcher = new OptiXBackendSwitcher(optix_renderer, cam_ID);
-    engine.add_mutating_callback([=, &engine] { backend_switcher->handle(engine); });
+    engine.add_mutating_callback("OptiX backend switching", [=, &engine] { backend_switcher->handle(engine); });
 #endif
 
     return 0;
@@ -606,7 +658,7 @@ int win32_window_initialized(Engine& engine, Window& window, HWND& hwnd) {
 #else
         imgui->add_frame(std::make_unique<GUI::RenderingGUI>(compositor, dx11_renderer));
 #endif
-        engine.add_mutating_callback([=, &engine] {
+        engine.add_mutating_callback("GUI", [=, &engine] {
             auto* keyboard = engine.get_keyboard();
             auto* imgui_adaptor = static_cast<ImGui::ImGuiAdaptor*>(imgui);
 
@@ -624,7 +676,8 @@ int win32_window_initialized(Engine& engine, Window& window, HWND& hwnd) {
     for (auto camera_ID : Cameras::get_iterable())
         Cameras::set_renderer_ID(camera_ID, default_renderer);
 
-    engine.add_non_mutating_callback([=] { compositor->render(); });
+    // Rendering reads the whole scene and presents to the window, which keeps it on the ticking thread.
+    engine.add_non_mutating_callback("Render", [=] { compositor->render(); }, Engine::Manager::All, Engine::Manager::Window);
 
     return initialize_scene(engine);
 }
@@ -638,6 +691,11 @@ void print_usage() {
         "  -p | --path-tracing-only: Launches with the path tracer as the only avaliable renderer.\n"
         "  -r | --rasterizer-only: Launches with the rasterizer as the only avaliable renderer.\n"
 #endif
+        "      | --optimize-meshes: Reorders the loaded meshes' triangles and vertices for vertex cache and vertex fetch efficiency.\n"
+        "      | --weld-vertices: Merges the duplicate vertices of the loaded meshes.\n"
+        "      | --vertex-cache-report: Prints the average cache miss ratio and transform to vertex ratio of the loaded meshes.\n"
+        "      | --compress-meshes: Stores the loaded meshes with quantized positions, octahedral normals and half precision texcoords.\n"
+        "      | --build-lods: Builds chains of simplified levels of detail for the loaded meshes.\n"
         "  -e  | --environment-map <image>: Loads the specified image for the environment.\n"
         "  -c  | --environment-tint [R,G,B]: Tint the environment by the specified value.\n"
         "      | --window-size [width, height]: Size of the window.\n"
@@ -696,6 +754,16 @@ int main(int argc, char** argv) {
     while (argument < argc) {
         if (strcmp(argv[argument], "--scene") == 0 || strcmp(argv[argument], "-s") == 0)
             g_scene = std::string(argv[++argument]);
+        else if (strcmp(argv[argument], "--optimize-meshes") == 0)
+            g_optimize_meshes = true;
+        else if (strcmp(argv[argument], "--weld-vertices") == 0)
+            g_weld_vertices = true;
+        else if (strcmp(argv[argument], "--vertex-cache-report") == 0)
+            g_print_vertex_cache_report = true;
+        else if (strcmp(argv[argument], "--compress-meshes") == 0)
+            g_compress_meshes = true;
+        else if (strcmp(argv[argument], "--build-lods") == 0)
+            g_build_LODs = true;
         else if (strcmp(argv[argument], "--environment-map") == 0 || strcmp(argv[argument], "-e") == 0)
             g_environment = std::string(argv[++argument]);
         else if (strcmp(argv[argument], "--environment-tint") == 0 || strcmp(argv[argument], "-c") == 0)
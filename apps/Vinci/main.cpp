@@ -19,6 +19,7 @@
 #include <Bifrost/Scene/LightSource.h>
 #include <Bifrost/Scene/SceneNode.h>
 #include <Bifrost/Scene/SceneRoot.h>
+#include <Bifrost/Scene/ScreenshotWriter.h>
 
 #include <DX11OptiXAdaptor/Adaptor.h>
 #include <DX11Renderer/Compositor.h>
@@ -286,7 +287,8 @@ private:
 class DataGeneration final {
 public:
     DataGeneration(SceneRefresher& scene_refresher, Navigation& camera_navigation, const fs::path& output_directory, int max_iterations = 256)
-        : m_scene_refresher(&scene_refresher), m_camera_navigation(camera_navigation), m_output_directory(output_directory), m_iteration(0), m_max_iterations(max_iterations) {
+        : m_scene_refresher(&scene_refresher), m_camera_navigation(camera_navigation), m_output_directory(output_directory), m_iteration(0), m_max_iterations(max_iterations)
+        , m_screenshot_writer([](const Screenshot& screenshot, const std::string& path) { return StbImageWriter::write(screenshot, path); }, 16, 2) {
         queue_screenshot();
     }
 
@@ -297,14 +299,12 @@ public:
             Cameras::cancel_screenshot(camera_ID());
 
         if (Cameras::pending_screenshots(camera_ID())) {
-            // Resolve and save screenshots.
+            // Queue the screenshots for writing in the background.
             auto output_screenshot = [&](Screenshot::Content content, const std::string& path) {
-                auto image_ID = Cameras::resolve_screenshot(camera_ID(), content, "ss");
-                if (Images::has(image_ID)) {
-                    if (!StbImageWriter::write(image_ID, path))
+                m_screenshot_writer.write(camera_ID(), content, path, [](const std::string& path, bool succeeded) {
+                    if (!succeeded)
                         printf("Failed to output screenshot to '%s'\n", path.c_str());
-                    Images::destroy(image_ID);
-                }
+                });
             };
 
             std::string base_path = (m_output_directory / std::to_string(m_iteration)).string();
@@ -319,8 +319,10 @@ public:
             ++m_iteration;
         }
 
-        if (m_iteration == m_max_iterations)
+        if (m_iteration == m_max_iterations) {
+            m_screenshot_writer.wait_until_idle();
             engine.request_quit();
+        }
 
         if (screenshot_resolved) {
             m_scene_refresher->refresh();
@@ -335,6 +337,7 @@ private:
     const fs::path& m_output_directory;
     int m_iteration;
     int m_max_iterations;
+    ScreenshotWriter m_screenshot_writer;
 
     inline Cameras::UID camera_ID() const { return m_camera_navigation.camera_ID(); }
 
@@ -426,7 +429,7 @@ int setup_scene(Engine& engine, Options& options) {
 
         scene_refresher = new SceneRefresher(*g_random_scene, camera_ID);
     }
-    engine.add_mutating_callback([=, &engine] {
+    engine.add_mutating_callback("Scene refresh", [=, &engine] {
         if (engine.get_keyboard()->was_pressed(Keyboard::Key::N))
             scene_refresher->refresh();
         });
@@ -453,14 +456,14 @@ int setup_scene(Engine& engine, Options& options) {
     scene_refresher->set_light_node(light_node, camera_to_light_transform);
 
     Navigation* camera_navigation = new Navigation(camera_ID, camera_velocity);
-    engine.add_mutating_callback([=, &engine] { camera_navigation->navigate(engine); });
+    engine.add_mutating_callback("Camera navigation", [=, &engine] { camera_navigation->navigate(engine); }, Engine::Manager::Input, Engine::Manager::Cameras);
 
     if (!g_options.output_directory.empty()) {
         if (!fs::exists(g_options.output_directory))
             fs::create_directories(g_options.output_directory);
         if (fs::is_directory(g_options.output_directory)) {
             DataGeneration* data_generation = new DataGeneration(*scene_refresher, *camera_navigation, g_options.output_directory);
-            engine.add_mutating_callback([=, &engine] { data_generation->tick(engine); });
+            engine.add_mutating_callback("Data generation", [=, &engine] { data_generation->tick(engine); });
         }
     }
 
@@ -470,7 +473,12 @@ int setup_scene(Engine& engine, Options& options) {
 int initializer(Engine& engine) {
     engine.get_window().set_name("Vinci");
 
-    engine.add_tick_cleanup_callback(miniheaps_cleanup_callback);
+    SceneNodes::add_transform_propagation_callbacks(engine);
+
+    typedef Engine::Manager Manager;
+    engine.add_tick_cleanup_callback("Reset change notifications", miniheaps_cleanup_callback, Manager::None,
+        { Manager::Cameras, Manager::Images, Manager::LightSources, Manager::Materials, Manager::Meshes,
+          Manager::MeshModels, Manager::SceneNodes, Manager::SceneRoots, Manager::Textures });
 
     return 0;
 }
@@ -483,7 +491,7 @@ int win32_window_initialized(Engine& engine, Window& window, HWND& hwnd) {
 
     g_optix_adaptor = (DX11OptiXAdaptor::Adaptor*)g_compositor->add_renderer(DX11OptiXAdaptor::Adaptor::initialize).get();
 
-    engine.add_non_mutating_callback([=] { g_compositor->render(); });
+    engine.add_non_mutating_callback("Render", [=] { g_compositor->render(); }, Engine::Manager::All, Engine::Manager::Window);
 
     return setup_scene(engine, g_options);
 }
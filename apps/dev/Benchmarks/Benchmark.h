@@ -0,0 +1,46 @@
+// Benchmark utilities.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdio>
+
+namespace Benchmark {
+
+// Returns the fastest of the runs in milliseconds, which is the least noisy estimate of the cost.
+template <typename F>
+double time_ms(F function, int run_count = 5) {
+    using namespace std::chrono;
+    double best_time_ms = 1e30;
+    for (int r = 0; r < run_count; ++r) {
+        auto begin = high_resolution_clock::now();
+        function();
+        auto end = high_resolution_clock::now();
+        double time_ms = duration<double, std::milli>(end - begin).count();
+        best_time_ms = time_ms < best_time_ms ? time_ms : best_time_ms;
+    }
+    return best_time_ms;
+}
+
+inline void print_result(const char* name, double time_ms) {
+    printf("  %-48s %10.3fms\n", name, time_ms);
+}
+
+// Prevents the compiler from optimizing away results that are otherwise unused.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+
+} // NS Benchmark
+
+#endif // _BIFROST_BENCHMARKS_BENCHMARK_H_
@@ -0,0 +1,140 @@
+// Change recording and replay benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_CHANGE_LOG_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_CHANGE_LOG_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/ChangeLog.h>
+#include <Bifrost/Scene/MeshModelBVH.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace ChangeLogBenchmark {
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene;
+
+inline void allocate_managers(unsigned int instance_count) {
+    Images::allocate(1);
+    Textures::allocate(1);
+    Materials::allocate(1);
+    Meshes::allocate(3);
+    MeshModels::allocate(instance_count + 1);
+    SceneNodes::allocate(instance_count + 1);
+    SceneRoots::allocate(1);
+    LightSources::allocate(1);
+    Cameras::allocate(1);
+}
+
+inline void deallocate_managers() {
+    Cameras::deallocate();
+    LightSources::deallocate();
+    SceneRoots::deallocate();
+    MeshModels::deallocate();
+    SceneNodes::deallocate();
+    Meshes::deallocate();
+    Materials::deallocate();
+    Textures::deallocate();
+    Images::deallocate();
+}
+
+inline void reset_change_notifications() {
+    Images::reset_change_notifications();
+    Textures::reset_change_notifications();
+    Materials::reset_change_notifications();
+    Meshes::reset_change_notifications();
+    MeshModels::reset_change_notifications();
+    SceneNodes::reset_change_notifications();
+    SceneRoots::reset_change_notifications();
+    LightSources::reset_change_notifications();
+    Cameras::reset_change_notifications();
+}
+
+// Records a session where the first tick creates the instances and every following tick moves a tenth of them,
+// and replays it under a headless engine with a mesh model BVH consuming the changes, as a renderer would.
+inline void record_and_replay(unsigned int instance_count, unsigned int tick_count) {
+    const char* path = "ChangeLogBenchmark.bfchanges";
+    allocate_managers(instance_count);
+
+    printf(" Record and replay %u ticks moving %u of %u instances\n", tick_count, instance_count / 10, instance_count);
+
+    double record_time = 0.0;
+    {
+        ChangeRecorder recorder = ChangeRecorder(path);
+
+        SceneRoots::UID scene_ID = SceneRoots::create("Scene", RGB::black());
+        SceneNodes::UID root_node_ID = SceneRoots::get_root_node(scene_ID);
+        Meshes::UID mesh_IDs[3] = { MeshCreation::revolved_sphere(32, 16), MeshCreation::torus(32, 16, 0.2f), MeshCreation::cube(8) };
+        Materials::UID material_ID = Materials::create("Material", {});
+        Cameras::create("Camera", scene_ID, Matrix4x4f::identity(), Matrix4x4f::identity());
+
+        std::vector<SceneNodes::UID> node_IDs(instance_count);
+        RNG::LinearCongruential rng = RNG::LinearCongruential(instance_count);
+        for (unsigned int i = 0; i < instance_count; ++i) {
+            node_IDs[i] = SceneNodes::create("Instance", Transform((rng.sample3f() - 0.5f) * 100.0f));
+            SceneNodes::set_parent(node_IDs[i], root_node_ID);
+            MeshModels::create(node_IDs[i], mesh_IDs[i % 3], material_ID);
+        }
+
+        for (unsigned int t = 0; t < tick_count; ++t) {
+            if (t > 0)
+                for (unsigned int i = t % 10; i < instance_count; i += 10)
+                    SceneNodes::set_local_transform(node_IDs[i], Transform((rng.sample3f() - 0.5f) * 100.0f));
+            record_time += Benchmark::time_ms([&]() { recorder.record_tick(1.0 / 60.0); }, 1);
+            reset_change_notifications();
+        }
+    }
+    Benchmark::print_result("record", record_time);
+
+    FILE* log_file = fopen(path, "rb");
+    fseek(log_file, 0, SEEK_END);
+    long log_size = ftell(log_file);
+    fclose(log_file);
+
+    double replay_time = 0.0, first_tick_time = 0.0;
+    {
+        deallocate_managers();
+        allocate_managers(instance_count);
+
+        ChangeReplayer replayer = ChangeReplayer(path);
+        MeshModelBVH model_BVH;
+        Bifrost::Core::Engine engine = Bifrost::Core::Engine("");
+        engine.add_mutating_callback("Replay changes", [&] { replayer.replay_tick(); });
+        engine.add_non_mutating_callback("Update model BVH", [&] { model_BVH.update(); });
+        engine.add_tick_cleanup_callback("Reset change notifications", [] { reset_change_notifications(); });
+
+        first_tick_time = Benchmark::time_ms([&]() { engine.do_tick(replayer.get_next_delta_time()); }, 1);
+        replay_time = Benchmark::time_ms([&]() {
+            while (!replayer.is_at_end())
+                engine.do_tick(replayer.get_next_delta_time());
+        }, 1);
+        Benchmark::do_not_optimize(model_BVH.get_node_count());
+    }
+    Benchmark::print_result("replay first tick", first_tick_time);
+    Benchmark::print_result("replay remaining ticks", replay_time);
+    printf("  %.2f MB log, %.3fms pr replayed update tick\n", log_size / (1024.0 * 1024.0), replay_time / (tick_count - 1));
+
+    remove(path);
+    deallocate_managers();
+}
+
+inline void run() {
+    record_and_replay(10000u, 100u);
+    record_and_replay(100000u, 100u);
+}
+
+} // NS ChangeLogBenchmark
+
+#endif // _BIFROST_BENCHMARKS_CHANGE_LOG_BENCHMARK_H_
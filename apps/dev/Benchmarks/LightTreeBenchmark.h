@@ -0,0 +1,129 @@
+// Light tree benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_LIGHT_TREE_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_LIGHT_TREE_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Math/Constants.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/LightTree.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace LightTreeBenchmark {
+
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene;
+
+// The irradiance from a light at a shading point, treating the light as a point light.
+inline float irradiance(LightSources::UID light_ID, Vector3f position, Vector3f normal) {
+    Vector3f light_position = SceneNodes::get_global_transform(LightSources::get_node_ID(light_ID)).translation;
+    Vector3f offset = light_position - position;
+    float distance_squared = std::max(magnitude_squared(offset), 0.0001f);
+    float cos_theta = std::max(dot(normal, offset) / std::sqrt(distance_squared), 0.0f);
+    return luminance(LightSources::get_sphere_light_power(light_ID)) * cos_theta / (4.0f * PI<float>() * distance_squared);
+}
+
+// Scatters lights with varying power in a city block sized volume above a ground plane and estimates the irradiance at
+// points on the ground with a single light sample, selected either uniformly or by the light tree.
+inline void sample_lights(unsigned int light_count) {
+    SceneNodes::allocate(light_count + 1);
+    LightSources::allocate(light_count + 1);
+
+    RNG::LinearCongruential rng = RNG::LinearCongruential(light_count);
+    std::vector<LightSources::UID> light_IDs;
+    light_IDs.reserve(light_count);
+    for (unsigned int l = 0; l < light_count; ++l) {
+        Vector3f position = Vector3f(200.0f * rng.sample1f() - 100.0f, 0.5f + 20.0f * rng.sample1f(), 200.0f * rng.sample1f() - 100.0f);
+        SceneNodes::UID node_ID = SceneNodes::create("Light", Transform(position));
+        float power = 10.0f + 1000.0f * rng.sample1f() * rng.sample1f();
+        light_IDs.push_back(LightSources::create_sphere_light(node_ID, RGB(power), 0.1f));
+    }
+
+    printf(" Sample %u lights\n", light_count);
+
+    LightTree* light_tree = nullptr;
+    double build_time = Benchmark::time_ms([&]() {
+        delete light_tree;
+        light_tree = new LightTree();
+    });
+    Benchmark::print_result("build", build_time);
+
+    // Shading points on the ground and their reference irradiance from all lights.
+    const int point_count = 64;
+    const int sample_count = 4096;
+    Vector3f normal = Vector3f::up();
+    std::vector<Vector3f> positions(point_count);
+    std::vector<float> reference_irradiances(point_count);
+    for (int p = 0; p < point_count; ++p) {
+        positions[p] = Vector3f(200.0f * rng.sample1f() - 100.0f, 0.0f, 200.0f * rng.sample1f() - 100.0f);
+        reference_irradiances[p] = 0.0f;
+        for (LightSources::UID light_ID : light_IDs)
+            reference_irradiances[p] += irradiance(light_ID, positions[p], normal);
+    }
+
+    // The relative variance of the single sample estimators, averaged over the shading points.
+    auto relative_variance = [&](auto sample_light) -> double {
+        double variance_sum = 0.0;
+        for (int p = 0; p < point_count; ++p) {
+            double squared_error_sum = 0.0;
+            for (int s = 0; s < sample_count; ++s) {
+                LightTree::Sample sample = sample_light(positions[p], (s + 0.5f) / sample_count);
+                double estimate = sample.PDF > 0.0f ? irradiance(sample.light_ID, positions[p], normal) / sample.PDF : 0.0;
+                double relative_error = estimate / reference_irradiances[p] - 1.0;
+                squared_error_sum += relative_error * relative_error;
+            }
+            variance_sum += squared_error_sum / sample_count;
+        }
+        return variance_sum / point_count;
+    };
+
+    auto sample_uniform = [&](Vector3f position, float random) -> LightTree::Sample {
+        unsigned int light_index = std::min((unsigned int)(random * light_count), light_count - 1);
+        return { light_IDs[light_index], 1.0f / light_count };
+    };
+    auto sample_tree = [&](Vector3f position, float random) -> LightTree::Sample {
+        return light_tree->sample(position, normal, random);
+    };
+
+    double uniform_variance = relative_variance(sample_uniform);
+    double tree_variance = relative_variance(sample_tree);
+    printf("  relative variance: uniform %.4f, light tree %.4f\n", uniform_variance, tree_variance);
+    printf("  the light tree needs %.1fx fewer samples for the same variance\n", uniform_variance / tree_variance);
+
+    const int timed_sample_count = 100000;
+    LightSources::UID sampled_light_ID;
+    double uniform_time = Benchmark::time_ms([&]() {
+        for (int s = 0; s < timed_sample_count; ++s)
+            sampled_light_ID = sample_uniform(positions[s % point_count], (s + 0.5f) / timed_sample_count).light_ID;
+    });
+    Benchmark::do_not_optimize(sampled_light_ID.get_index());
+    double tree_time = Benchmark::time_ms([&]() {
+        for (int s = 0; s < timed_sample_count; ++s)
+            sampled_light_ID = sample_tree(positions[s % point_count], (s + 0.5f) / timed_sample_count).light_ID;
+    });
+    Benchmark::do_not_optimize(sampled_light_ID.get_index());
+    Benchmark::print_result("100000 uniform samples", uniform_time);
+    Benchmark::print_result("100000 light tree samples", tree_time);
+
+    delete light_tree;
+    LightSources::deallocate();
+    SceneNodes::deallocate();
+}
+
+inline void run() {
+    sample_lights(1000u);
+    sample_lights(10000u);
+}
+
+} // NS LightTreeBenchmark
+
+#endif // _BIFROST_BENCHMARKS_LIGHT_TREE_BENCHMARK_H_
@@ -0,0 +1,130 @@
+// Mesh BVH build and ray query benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_MESH_BVH_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_MESH_BVH_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Assets/MeshBVH.h>
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Math/RNG.h>
+
+#include <vector>
+
+namespace MeshBVHBenchmark {
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+// Builds the hierarchy of a torus with roughly the given number of triangles with the Morton and
+// SAH builders and traces coherent camera rays, one at a time and as packets of four neighbouring
+// rays, and incoherent rays from random points around the torus.
+inline void build_and_intersect(unsigned int triangle_count, unsigned int ray_count) {
+    Meshes::allocate(1);
+    unsigned int circumference_quads = (unsigned int)std::sqrt(triangle_count / 4.0f);
+    Meshes::UID mesh_ID = MeshCreation::torus(2 * circumference_quads, circumference_quads, 0.3f, MeshFlag::Position);
+    triangle_count = Meshes::get_primitive_count(mesh_ID);
+    printf(" Build and intersect %u triangles with %u rays\n", triangle_count, ray_count);
+
+    const Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+    const Vector3f* positions = Meshes::get_positions(mesh_ID);
+    std::vector<AABB> primitive_bounds(triangle_count);
+    for (unsigned int p = 0; p < triangle_count; ++p) {
+        primitive_bounds[p] = AABB(positions[primitives[p].x], positions[primitives[p].x]);
+        primitive_bounds[p].grow_to_contain(positions[primitives[p].y]);
+        primitive_bounds[p].grow_to_contain(positions[primitives[p].z]);
+    }
+
+    std::vector<BVH4Node> nodes;
+    std::vector<unsigned int> primitive_order;
+    double morton_build_time = Benchmark::time_ms([&]() {
+        build_BVH4(primitive_bounds.data(), triangle_count, MeshBVH::MAX_LEAF_SIZE, nodes, primitive_order);
+    }, 3);
+    Benchmark::print_result("build Morton BVH4", morton_build_time);
+
+    double SAH_build_time = Benchmark::time_ms([&]() {
+        build_BVH4_SAH(primitive_bounds.data(), triangle_count, MeshBVH::MAX_LEAF_SIZE, nodes, primitive_order);
+    }, 3);
+    Benchmark::print_result("build SAH BVH4", SAH_build_time);
+
+    double mesh_BVH_build_time = Benchmark::time_ms([&]() {
+        MeshBVH bvh = MeshBVH(mesh_ID);
+        Benchmark::do_not_optimize(bvh.get_node_count());
+    }, 3);
+    Benchmark::print_result("build mesh BVH", mesh_BVH_build_time);
+
+    // Orthographic camera rays looking down at the torus from above in a square grid.
+    MeshBVH bvh = MeshBVH(mesh_ID);
+    AABB bounds = bvh.get_bounds();
+    unsigned int grid_size = (unsigned int)std::sqrt(float(ray_count)) & ~1u;
+    ray_count = grid_size * grid_size;
+    std::vector<Ray> camera_rays(ray_count);
+    for (unsigned int y = 0; y < grid_size; y += 2)
+        for (unsigned int x = 0; x < grid_size; x += 2)
+            for (unsigned int i = 0; i < 4; ++i) {
+                // Store the rays of each 2x2 pixel block consecutively, so they form a packet.
+                float u = (x + (i % 2) + 0.5f) / grid_size, v = (y + (i / 2) + 0.5f) / grid_size;
+                Vector3f origin = Vector3f(bounds.minimum.x + u * bounds.size().x, bounds.maximum.y + 1.0f, bounds.minimum.z + v * bounds.size().z);
+                camera_rays[(y * grid_size + 2 * x) + i] = Ray(origin, Vector3f(0, -1, 0));
+            }
+
+    RNG::LinearCongruential rng = RNG::LinearCongruential(triangle_count);
+    std::vector<Ray> random_rays(ray_count);
+    for (Ray& ray : random_rays) {
+        Vector3f origin = bounds.minimum - bounds.size() + rng.sample3f() * bounds.size() * 3.0f;
+        Vector3f target = bounds.minimum + rng.sample3f() * bounds.size();
+        ray = Ray(origin, normalize(target - origin));
+    }
+
+    unsigned int hit_count = 0;
+    auto trace_single_rays = [&](const std::vector<Ray>& rays) {
+        hit_count = 0;
+        for (Ray ray : rays) {
+            float distance = 1e30f;
+            unsigned int primitive_index;
+            Vector2f barycentric;
+            hit_count += bvh.intersect(ray, distance, primitive_index, barycentric) ? 1 : 0;
+        }
+    };
+    auto trace_packets = [&](const std::vector<Ray>& rays) {
+        hit_count = 0;
+        for (unsigned int r = 0; r < ray_count; r += 4) {
+            RayPacket4 packet = RayPacket4(rays.data() + r);
+            float distances[4] = { 1e30f, 1e30f, 1e30f, 1e30f };
+            unsigned int primitive_indices[4];
+            Vector2f barycentrics[4];
+            int hit_mask = bvh.intersect(packet, 0xF, distances, primitive_indices, barycentrics);
+            hit_count += (hit_mask & 1) + ((hit_mask >> 1) & 1) + ((hit_mask >> 2) & 1) + ((hit_mask >> 3) & 1);
+        }
+    };
+
+    double coherent_time = Benchmark::time_ms([&]() { trace_single_rays(camera_rays); });
+    Benchmark::print_result("coherent closest hit", coherent_time);
+    double coherent_packet_time = Benchmark::time_ms([&]() { trace_packets(camera_rays); });
+    Benchmark::print_result("coherent closest hit packets", coherent_packet_time);
+    double incoherent_time = Benchmark::time_ms([&]() { trace_single_rays(random_rays); });
+    Benchmark::print_result("incoherent closest hit", incoherent_time);
+    double incoherent_packet_time = Benchmark::time_ms([&]() { trace_packets(random_rays); });
+    Benchmark::print_result("incoherent closest hit packets", incoherent_packet_time);
+
+    printf("  %u of %u rays hit, %.2f / %.2f Mrays/s coherent single / packets, %.2f / %.2f Mrays/s incoherent single / packets\n",
+           hit_count, ray_count, ray_count / (coherent_time * 1000.0), ray_count / (coherent_packet_time * 1000.0),
+           ray_count / (incoherent_time * 1000.0), ray_count / (incoherent_packet_time * 1000.0));
+
+    Meshes::deallocate();
+}
+
+inline void run() {
+    build_and_intersect(1000000u, 1000000u);
+    build_and_intersect(4000000u, 1000000u);
+}
+
+} // NS MeshBVHBenchmark
+
+#endif // _BIFROST_BENCHMARKS_MESH_BVH_BENCHMARK_H_
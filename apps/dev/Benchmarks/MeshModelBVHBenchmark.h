@@ -0,0 +1,122 @@
+// Mesh model BVH benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_MESH_MODEL_BVH_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_MESH_MODEL_BVH_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Math/Constants.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/MeshModelBVH.h>
+
+#include <vector>
+
+namespace MeshModelBVHBenchmark {
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene;
+
+// Scatters the instances of a unit cube uniformly in a cube with room for 1000 instances along each axis
+// and culls them against a camera in the center, which sees roughly a tenth of the instances.
+inline void cull_instances(unsigned int instance_count) {
+    SceneNodes::allocate(instance_count + 1);
+    Meshes::allocate(1);
+    Materials::allocate(1);
+    MeshModels::allocate(instance_count + 1);
+
+    Meshes::UID mesh_ID = Meshes::create("Cube", 12u, 8u);
+    Meshes::set_bounds(mesh_ID, AABB(Vector3f(-0.5f), Vector3f(0.5f)));
+    Materials::UID material_ID = Materials::create("Material", {});
+
+    float scene_size = 20.0f * std::cbrt(float(instance_count));
+    RNG::LinearCongruential rng = RNG::LinearCongruential(instance_count);
+    std::vector<SceneNodes::UID> node_IDs;
+    node_IDs.reserve(instance_count);
+    for (unsigned int i = 0; i < instance_count; ++i) {
+        Vector3f position = (rng.sample3f() - 0.5f) * scene_size;
+        node_IDs.push_back(SceneNodes::create("Instance", Transform(position)));
+        MeshModels::create(node_IDs.back(), mesh_ID, material_ID);
+    }
+
+    Matrix4x4f projection_matrix, inverse_projection_matrix;
+    CameraUtils::compute_perspective_projection(1.0f, scene_size * 0.5f, PI<float>() / 3.0f, 16.0f / 9.0f, projection_matrix, inverse_projection_matrix);
+    Frustum frustum = Frustum::from_view_projection_matrix(projection_matrix);
+
+    printf(" Cull %u instances\n", instance_count);
+
+    std::vector<MeshModels::UID> visible_model_IDs;
+    visible_model_IDs.reserve(instance_count);
+    double brute_force_time = Benchmark::time_ms([&]() {
+        visible_model_IDs.clear();
+        for (MeshModels::UID model_ID : MeshModels::get_iterable()) {
+            Transform transform = SceneNodes::get_global_transform(MeshModels::get_scene_node_ID(model_ID));
+            AABB bounds = Meshes::get_bounds(MeshModels::get_mesh_ID(model_ID));
+            Vector3f half_size = bounds.size() * (0.5f * transform.scale);
+            if (frustum.intersects(AABB(transform.translation - half_size, transform.translation + half_size)))
+                visible_model_IDs.push_back(model_ID);
+        }
+    });
+    Benchmark::print_result("brute force frustum culling", brute_force_time);
+    size_t brute_force_visible_count = visible_model_IDs.size();
+
+    MeshModelBVH* bvh = nullptr;
+    double build_time = Benchmark::time_ms([&]() {
+        delete bvh;
+        bvh = new MeshModelBVH();
+    });
+    Benchmark::print_result("build BVH", build_time);
+
+    double cull_time = Benchmark::time_ms([&]() {
+        visible_model_IDs.clear();
+        bvh->find_models_in_frustum(frustum, visible_model_IDs);
+    });
+    Benchmark::print_result("BVH frustum culling", cull_time);
+    printf("  %zu of %u instances visible, %zu with brute force\n", visible_model_IDs.size(), instance_count, brute_force_visible_count);
+
+    // Moves one percent of the instances every tick.
+    unsigned int tick = 0;
+    double partial_refit_time = Benchmark::time_ms([&]() {
+        ++tick;
+        for (unsigned int i = tick; i < instance_count; i += 100) {
+            Transform transform = SceneNodes::get_global_transform(node_IDs[i]);
+            transform.translation.y += 0.1f;
+            SceneNodes::set_global_transform(node_IDs[i], transform);
+        }
+        bvh->update();
+    });
+    Benchmark::print_result("move 1% and refit BVH", partial_refit_time);
+
+    double full_refit_time = Benchmark::time_ms([&]() {
+        for (SceneNodes::UID node_ID : node_IDs) {
+            Transform transform = SceneNodes::get_global_transform(node_ID);
+            transform.translation.y -= 0.01f;
+            SceneNodes::set_global_transform(node_ID, transform);
+        }
+        bvh->update();
+    });
+    Benchmark::print_result("move all and refit BVH", full_refit_time);
+
+    delete bvh;
+    MeshModels::deallocate();
+    Materials::deallocate();
+    Meshes::deallocate();
+    SceneNodes::deallocate();
+}
+
+inline void run() {
+    cull_instances(10000u);
+    cull_instances(100000u);
+    cull_instances(1000000u);
+}
+
+} // NS MeshModelBVHBenchmark
+
+#endif // _BIFROST_BENCHMARKS_MESH_MODEL_BVH_BENCHMARK_H_
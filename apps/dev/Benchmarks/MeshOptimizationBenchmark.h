@@ -0,0 +1,170 @@
+// Mesh optimization, welding, compression and simplification benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_MESH_OPTIMIZATION_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_MESH_OPTIMIZATION_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Assets/MeshSimplification.h>
+#include <Bifrost/Math/RNG.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace MeshOptimizationBenchmark {
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+inline void print_vertex_cache_statistics(const char* name, MeshUtils::VertexCacheStatistics statistics) {
+    printf("  %s: ACMR %.3f, ATVR %.3f\n", name, statistics.ACMR, statistics.ATVR);
+}
+
+// Optimizes the vertex cache and vertex fetch order of a torus with roughly the given number of triangles,
+// both in the generated order and with its triangles shuffled, and reports the vertex cache statistics.
+inline void optimize_vertex_cache(unsigned int triangle_count) {
+    Meshes::allocate(2);
+    unsigned int circumference_quads = (unsigned int)std::sqrt(triangle_count / 4.0f);
+    Meshes::UID generated_mesh_ID = MeshCreation::torus(2 * circumference_quads, circumference_quads, 0.3f);
+    triangle_count = Meshes::get_primitive_count(generated_mesh_ID);
+    printf(" Optimize %u triangles\n", triangle_count);
+
+    Meshes::UID shuffled_mesh_ID = MeshUtils::deep_clone(generated_mesh_ID);
+    Vector3ui* primitives = Meshes::get_primitives(shuffled_mesh_ID);
+    RNG::LinearCongruential rng = RNG::LinearCongruential(triangle_count);
+    for (unsigned int p = triangle_count - 1; p > 0; --p)
+        std::swap(primitives[p], primitives[rng.sample1ui() % (p + 1)]);
+
+    print_vertex_cache_statistics("generated", MeshUtils::compute_vertex_cache_statistics(generated_mesh_ID));
+    print_vertex_cache_statistics("shuffled", MeshUtils::compute_vertex_cache_statistics(shuffled_mesh_ID));
+
+    // Only the first run optimizes the shuffled triangles, the following runs reoptimize the optimized mesh.
+    double vertex_cache_time = Benchmark::time_ms([&]() { MeshUtils::optimize_vertex_cache(shuffled_mesh_ID); }, 3);
+    Benchmark::print_result("optimize vertex cache", vertex_cache_time);
+    double vertex_fetch_time = Benchmark::time_ms([&]() { MeshUtils::optimize_vertex_fetch(shuffled_mesh_ID); }, 3);
+    Benchmark::print_result("optimize vertex fetch", vertex_fetch_time);
+    print_vertex_cache_statistics("optimized", MeshUtils::compute_vertex_cache_statistics(shuffled_mesh_ID));
+
+    Meshes::deallocate();
+}
+
+// Expands a torus with roughly the given number of triangles to three vertices pr triangle, as a
+// triangle soup import would, and welds the duplicated vertices with and without an epsilon.
+inline void weld_vertices(unsigned int triangle_count) {
+    const int run_count = 3;
+    Meshes::allocate(2 + 2 * run_count);
+    unsigned int circumference_quads = (unsigned int)std::sqrt(triangle_count / 4.0f);
+    Mesh torus = MeshCreation::torus(2 * circumference_quads, circumference_quads, 0.3f);
+    triangle_count = torus.get_primitive_count();
+    Mesh expanded_torus = Meshes::create("Expanded torus", triangle_count, torus.get_index_count());
+    MeshUtils::expand_indexed_buffer(torus.get_primitives(), triangle_count, torus.get_positions(), expanded_torus.get_positions());
+    MeshUtils::expand_indexed_buffer(torus.get_primitives(), triangle_count, torus.get_normals(), expanded_torus.get_normals());
+    MeshUtils::expand_indexed_buffer(torus.get_primitives(), triangle_count, torus.get_texcoords(), expanded_torus.get_texcoords());
+    for (unsigned int i = 0; i < expanded_torus.get_index_count(); ++i)
+        expanded_torus.get_indices()[i] = i;
+    printf(" Weld %u vertices of %u triangles\n", expanded_torus.get_vertex_count(), triangle_count);
+
+    // Every run welds its own copy of the expanded torus.
+    auto time_welding = [&](float epsilon) -> double {
+        std::vector<Meshes::UID> mesh_IDs(run_count);
+        for (Meshes::UID& mesh_ID : mesh_IDs)
+            mesh_ID = MeshUtils::deep_clone(expanded_torus.get_ID());
+        int run = 0;
+        double time = Benchmark::time_ms([&]() { MeshUtils::weld_vertices(mesh_IDs[run++ % run_count], epsilon); }, run_count);
+        printf("  %u vertices after welding\n", Meshes::get_vertex_count(mesh_IDs[0]));
+        for (Meshes::UID mesh_ID : mesh_IDs)
+            Meshes::destroy(mesh_ID);
+        return time;
+    };
+    Benchmark::print_result("weld exact duplicates", time_welding(0.0f));
+    Benchmark::print_result("weld with epsilon", time_welding(0.00001f));
+
+    Meshes::deallocate();
+}
+
+// Compresses the vertex buffers of a torus with roughly the given number of triangles and reports the
+// vertex memory and the throughput of decoding the compressed vertices in bulk.
+inline void compress_vertices(unsigned int triangle_count) {
+    Meshes::allocate(1);
+    unsigned int circumference_quads = (unsigned int)std::sqrt(triangle_count / 4.0f);
+    Meshes::UID mesh_ID = MeshCreation::torus(2 * circumference_quads, circumference_quads, 0.3f);
+    unsigned int vertex_count = Meshes::get_vertex_count(mesh_ID);
+    printf(" Compress %u vertices\n", vertex_count);
+
+    size_t uncompressed_bytes = Meshes::get_memory_usage(mesh_ID)[Bifrost::Core::MemoryCategory::Vertices];
+    double compress_time = Benchmark::time_ms([&]() {
+        Meshes::set_compression(mesh_ID, MeshFlag::None);
+        Meshes::set_compression(mesh_ID, MeshFlag::Compressed);
+    }, 3);
+    Benchmark::print_result("decompress and compress", compress_time);
+    size_t compressed_bytes = Meshes::get_memory_usage(mesh_ID)[Bifrost::Core::MemoryCategory::Vertices];
+    printf("  vertex memory %.2fMB -> %.2fMB\n", uncompressed_bytes / (1024.0 * 1024.0), compressed_bytes / (1024.0 * 1024.0));
+
+    std::vector<Vector3f> positions(vertex_count), normals(vertex_count);
+    std::vector<Vector2f> texcoords(vertex_count);
+    double bulk_decode_time = Benchmark::time_ms([&]() {
+        Meshes::decode_positions(mesh_ID, 0, vertex_count, positions.data());
+        Meshes::decode_normals(mesh_ID, 0, vertex_count, normals.data());
+        Meshes::decode_texcoords(mesh_ID, 0, vertex_count, texcoords.data());
+    });
+    Benchmark::print_result("bulk decode", bulk_decode_time);
+    double vertex_decode_time = Benchmark::time_ms([&]() {
+        for (unsigned int v = 0; v < vertex_count; ++v) {
+            positions[v] = Meshes::get_position(mesh_ID, v);
+            normals[v] = Meshes::get_normal(mesh_ID, v);
+            texcoords[v] = Meshes::get_texcoord(mesh_ID, v);
+        }
+    });
+    Benchmark::print_result("decode pr vertex", vertex_decode_time);
+    Benchmark::do_not_optimize(positions.data());
+    printf("  %.2f / %.2f Mvertices/s bulk / pr vertex\n", vertex_count / (bulk_decode_time * 1000.0), vertex_count / (vertex_decode_time * 1000.0));
+
+    Meshes::deallocate();
+}
+
+// Builds level of detail chains for a number of tori with roughly the given number of triangles each,
+// one mesh at a time and in parallel across the meshes.
+inline void build_LOD_chains(unsigned int mesh_count, unsigned int triangle_count) {
+    Meshes::allocate(mesh_count * 8);
+    unsigned int circumference_quads = (unsigned int)std::sqrt(triangle_count / 4.0f);
+    std::vector<Meshes::UID> mesh_IDs(mesh_count);
+    for (unsigned int m = 0; m < mesh_count; ++m)
+        mesh_IDs[m] = MeshCreation::torus(2 * circumference_quads, circumference_quads, 0.3f);
+    triangle_count = Meshes::get_primitive_count(mesh_IDs[0]);
+    printf(" Build LOD chains for %u meshes with %u triangles\n", mesh_count, triangle_count);
+
+    double serial_time = Benchmark::time_ms([&]() {
+        for (Meshes::UID mesh_ID : mesh_IDs)
+            MeshUtils::build_LOD_chain(mesh_ID);
+    }, 3);
+    Benchmark::print_result("build LOD chains serially", serial_time);
+    double parallel_time = Benchmark::time_ms([&]() {
+        MeshUtils::build_LOD_chains(mesh_IDs.data(), mesh_IDs.data() + mesh_count);
+    }, 3);
+    Benchmark::print_result("build LOD chains in parallel", parallel_time);
+
+    for (Meshes::LOD level : Meshes::get_LOD_chain(mesh_IDs[0]))
+        printf("  %u triangles with error %.5f\n", Meshes::get_primitive_count(level.mesh_ID), level.error);
+
+    Meshes::deallocate();
+}
+
+inline void run() {
+    optimize_vertex_cache(100000u);
+    optimize_vertex_cache(1000000u);
+    weld_vertices(1000000u);
+    compress_vertices(1000000u);
+    build_LOD_chains(1, 1000000u);
+    build_LOD_chains(256, 10000u);
+}
+
+} // NS MeshOptimizationBenchmark
+
+#endif // _BIFROST_BENCHMARKS_MESH_OPTIMIZATION_BENCHMARK_H_
@@ -0,0 +1,100 @@
+// Scene BVH and ray query benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_SCENE_BVH_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_SCENE_BVH_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/SceneBVH.h>
+
+#include <vector>
+
+namespace SceneBVHBenchmark {
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene;
+
+// Scatters instances of a sphere, a torus and a cube uniformly in a cube with room for 10 instances along each axis
+// pr 1000 instances and casts random rays from inside the scene.
+inline void intersect_rays(unsigned int instance_count, unsigned int ray_count) {
+    SceneNodes::allocate(instance_count + 1);
+    SceneRoots::allocate(1);
+    Meshes::allocate(3);
+    Materials::allocate(1);
+    MeshModels::allocate(instance_count + 1);
+
+    SceneRoots::UID scene_ID = SceneRoots::create("Scene", RGB::black());
+    SceneNodes::UID root_node_ID = SceneRoots::get_root_node(scene_ID);
+    Meshes::UID mesh_IDs[3] = { MeshCreation::revolved_sphere(64, 32), MeshCreation::torus(64, 32, 0.2f), MeshCreation::cube(16) };
+    Materials::UID material_ID = Materials::create("Material", {});
+
+    float scene_size = 2.0f * std::cbrt(float(instance_count));
+    RNG::LinearCongruential rng = RNG::LinearCongruential(instance_count);
+    for (unsigned int i = 0; i < instance_count; ++i) {
+        Vector3f position = (rng.sample3f() - 0.5f) * scene_size;
+        Quaternionf rotation = Quaternionf::from_angle_axis(rng.sample1f() * 6.0f, normalize(rng.sample3f() - 0.5f));
+        SceneNodes::UID node_ID = SceneNodes::create("Instance", Transform(position, rotation, 0.2f + 0.3f * rng.sample1f()));
+        SceneNodes::set_parent(node_ID, root_node_ID);
+        MeshModels::create(node_ID, mesh_IDs[i % 3], material_ID);
+    }
+
+    std::vector<Ray> rays(ray_count);
+    for (Ray& ray : rays)
+        ray = Ray((rng.sample3f() - 0.5f) * scene_size, normalize(rng.sample3f() - 0.5f));
+    std::vector<RayHit> hits(ray_count);
+
+    printf(" Intersect %u rays with %u instances\n", ray_count, instance_count);
+
+    double build_time = Benchmark::time_ms([&]() {
+        SceneBVH bvh;
+        Benchmark::do_not_optimize(bvh.get_allocated_bytes());
+    }, 3);
+    Benchmark::print_result("build scene BVH", build_time);
+
+    SceneRoots::update_BVH();
+
+    double closest_hit_time = Benchmark::time_ms([&]() {
+        for (unsigned int r = 0; r < ray_count; ++r)
+            hits[r] = SceneRoots::intersect(scene_ID, rays[r]);
+    });
+    Benchmark::print_result("closest hit", closest_hit_time);
+
+    unsigned int hit_count = 0;
+    double any_hit_time = Benchmark::time_ms([&]() {
+        hit_count = 0;
+        for (unsigned int r = 0; r < ray_count; ++r)
+            hit_count += SceneRoots::intersects(scene_ID, rays[r]) ? 1 : 0;
+    });
+    Benchmark::print_result("any hit", any_hit_time);
+
+    double batched_time = Benchmark::time_ms([&]() {
+        SceneRoots::intersect(scene_ID, rays.data(), hits.data(), ray_count);
+    });
+    Benchmark::print_result("batched closest hit", batched_time);
+    printf("  %u of %u rays hit, %.2f Mrays/s closest hit, %.2f Mrays/s batched\n", hit_count, ray_count,
+           ray_count / (closest_hit_time * 1000.0), ray_count / (batched_time * 1000.0));
+
+    SceneRoots::deallocate();
+    MeshModels::deallocate();
+    Materials::deallocate();
+    Meshes::deallocate();
+    SceneNodes::deallocate();
+}
+
+inline void run() {
+    intersect_rays(1000u, 100000u);
+    intersect_rays(100000u, 100000u);
+}
+
+} // NS SceneBVHBenchmark
+
+#endif // _BIFROST_BENCHMARKS_SCENE_BVH_BENCHMARK_H_
@@ -0,0 +1,139 @@
+// Scene node benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_SCENE_NODE_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_SCENE_NODE_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Scene/SceneNode.h>
+
+#include <vector>
+
+namespace SceneNodeBenchmark {
+
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene;
+
+// Creates node_count nodes where every node's parent is the node created branching_factor nodes earlier,
+// fx a branching factor of 1 creates a single deep chain and node_count - 1 creates a single wide level.
+inline std::vector<SceneNodes::UID> create_hierarchy(unsigned int node_count, unsigned int branching_factor) {
+    std::vector<SceneNodes::UID> node_IDs;
+    node_IDs.reserve(node_count);
+    for (unsigned int i = 0; i < node_count; ++i) {
+        node_IDs.push_back(SceneNodes::create("Node"));
+        if (i > 0)
+            SceneNodes::set_parent(node_IDs[i], node_IDs[(i - 1) / branching_factor]);
+    }
+    return node_IDs;
+}
+
+// Sets the local transform of every node once, as when every node in the hierarchy is animated, and
+// then propagates the transforms. Immediate propagation updates the subtree of a node on every set.
+inline void animate_hierarchy(const char* hierarchy_name, unsigned int node_count, unsigned int branching_factor) {
+    SceneNodes::allocate(node_count + 1);
+    std::vector<SceneNodes::UID> node_IDs = create_hierarchy(node_count, branching_factor);
+
+    printf(" Animate %u nodes in a %s hierarchy\n", node_count, hierarchy_name);
+
+    float time = 0.0f;
+    auto animate = [&]() {
+        time += 0.01f;
+        Quaternionf rotation = Quaternionf::from_angle_axis(time, Vector3f::up());
+        for (SceneNodes::UID node_ID : node_IDs)
+            SceneNodes::set_local_transform(node_ID, Transform(Vector3f(0.001f, 0, 0), rotation));
+        SceneNodes::propagate_transforms();
+        SceneNodes::reset_change_notifications();
+    };
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Immediate);
+    Benchmark::print_result("immediate propagation", Benchmark::time_ms(animate));
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    Benchmark::print_result("deferred level ordered propagation", Benchmark::time_ms(animate));
+
+    Benchmark::do_not_optimize(SceneNodes::get_global_transform(node_IDs.back()).translation.x);
+    SceneNodes::deallocate();
+}
+
+// Moves only the root of the hierarchy, which is as cheap in both modes, as every node is updated once.
+inline void move_root(const char* hierarchy_name, unsigned int node_count, unsigned int branching_factor) {
+    SceneNodes::allocate(node_count + 1);
+    std::vector<SceneNodes::UID> node_IDs = create_hierarchy(node_count, branching_factor);
+
+    printf(" Move the root of %u nodes in a %s hierarchy\n", node_count, hierarchy_name);
+
+    float time = 0.0f;
+    auto move = [&]() {
+        time += 0.01f;
+        SceneNodes::set_local_transform(node_IDs[0], Transform(Vector3f(time, 0, 0)));
+        SceneNodes::propagate_transforms();
+        SceneNodes::reset_change_notifications();
+    };
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Immediate);
+    Benchmark::print_result("immediate propagation", Benchmark::time_ms(move));
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    Benchmark::print_result("deferred level ordered propagation", Benchmark::time_ms(move));
+
+    Benchmark::do_not_optimize(SceneNodes::get_global_transform(node_IDs.back()).translation.x);
+    SceneNodes::deallocate();
+}
+
+// Visits the children of every node in a tree, either by copying them to a vector or through the child iterator,
+// and then moves every leaf to another parent.
+inline void children_and_reparenting(unsigned int node_count, unsigned int branching_factor) {
+    SceneNodes::allocate(node_count + 1);
+    std::vector<SceneNodes::UID> node_IDs = create_hierarchy(node_count, branching_factor);
+
+    printf(" Children of %u nodes with branching factor %u\n", node_count, branching_factor);
+
+    double vector_time = Benchmark::time_ms([&]() {
+        unsigned int child_index_sum = 0;
+        for (SceneNodes::UID node_ID : node_IDs)
+            for (SceneNodes::UID child_ID : SceneNodes::get_children_IDs(node_ID))
+                child_index_sum += child_ID.get_index();
+        Benchmark::do_not_optimize(child_index_sum);
+    });
+    Benchmark::print_result("get_children_IDs vector", vector_time);
+
+    double iterator_time = Benchmark::time_ms([&]() {
+        unsigned int child_index_sum = 0;
+        for (SceneNodes::UID node_ID : node_IDs)
+            for (SceneNodes::UID child_ID : SceneNodes::get_children(node_ID))
+                child_index_sum += child_ID.get_index();
+        Benchmark::do_not_optimize(child_index_sum);
+    });
+    Benchmark::print_result("get_children iterator", iterator_time);
+
+    unsigned int first_leaf = (node_count - 1) / branching_factor + 1;
+    unsigned int round = 0;
+    double reparent_time = Benchmark::time_ms([&]() {
+        ++round;
+        for (unsigned int i = first_leaf; i < node_count; ++i)
+            SceneNodes::set_parent(node_IDs[i], node_IDs[(i + round) % first_leaf]);
+    });
+    Benchmark::print_result("reparent leaves", reparent_time);
+
+    SceneNodes::deallocate();
+}
+
+inline void run() {
+    animate_hierarchy("deep", 4096u, 1u);
+    animate_hierarchy("wide", 100000u, 100000u);
+    animate_hierarchy("binary tree", 100000u, 2u);
+    move_root("wide", 1000000u, 1000000u);
+    move_root("binary tree", 1000000u, 2u);
+    children_and_reparenting(1000000u, 2u);
+    children_and_reparenting(1000000u, 1000u);
+}
+
+} // NS SceneNodeBenchmark
+
+#endif // _BIFROST_BENCHMARKS_SCENE_NODE_BENCHMARK_H_
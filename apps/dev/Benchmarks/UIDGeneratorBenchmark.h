@@ -0,0 +1,125 @@
+// UID generator benchmarks.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_BENCHMARKS_UID_GENERATOR_BENCHMARK_H_
+#define _BIFROST_BENCHMARKS_UID_GENERATOR_BENCHMARK_H_
+
+#include <Benchmark.h>
+
+#include <Bifrost/Core/UniqueIDGenerator.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace UIDGeneratorBenchmark {
+
+using namespace Bifrost::Core;
+
+// Iteration over a generator that has grown to a large capacity, but where most IDs have since been erased.
+// The capacity scan mimics the previous iterator, which visited every slot and tested if it was in use.
+inline void iteration_after_churn(unsigned int peak_count, unsigned int live_count) {
+    UIDGenerator generator = UIDGenerator(256u);
+    std::vector<UID> all_IDs;
+    all_IDs.reserve(peak_count);
+    for (unsigned int i = 0; i < peak_count; ++i)
+        all_IDs.push_back(generator.generate());
+
+    std::vector<UID> shuffled_IDs = all_IDs;
+    std::shuffle(shuffled_IDs.begin(), shuffled_IDs.end(), std::minstd_rand(73856093u));
+    for (unsigned int i = live_count; i < peak_count; ++i)
+        generator.erase(shuffled_IDs[i]);
+
+    printf(" Iterate %u live IDs with capacity %u\n", generator.size(), generator.capacity());
+
+    double capacity_scan_time = Benchmark::time_ms([&]() {
+        unsigned int index_sum = 0;
+        for (UID id : all_IDs)
+            if (generator.has(id))
+                index_sum += id.get_index();
+        Benchmark::do_not_optimize(index_sum);
+    });
+    Benchmark::print_result("capacity scan", capacity_scan_time);
+
+    double packed_time = Benchmark::time_ms([&]() {
+        unsigned int index_sum = 0;
+        for (UID id : generator)
+            index_sum += id.get_index();
+        Benchmark::do_not_optimize(index_sum);
+    });
+    Benchmark::print_result("packed live list", packed_time);
+}
+
+// Cost of create and destroy under churn, which now also maintains the packed live list.
+inline void generate_and_erase_churn(unsigned int live_count, unsigned int churn_count) {
+    UIDGenerator generator = UIDGenerator(256u);
+    std::vector<UID> live_IDs;
+    live_IDs.reserve(live_count);
+    for (unsigned int i = 0; i < live_count; ++i)
+        live_IDs.push_back(generator.generate());
+
+    printf(" Erase and generate %u IDs with %u live IDs\n", churn_count, live_count);
+
+    std::minstd_rand rng(19349663u);
+    double churn_time = Benchmark::time_ms([&]() {
+        for (unsigned int i = 0; i < churn_count; ++i) {
+            unsigned int victim = rng() % live_count;
+            generator.erase(live_IDs[victim]);
+            live_IDs[victim] = generator.generate();
+        }
+    });
+    Benchmark::print_result("erase + generate", churn_time);
+}
+
+// Memory and iteration cost of the narrow 32 bit and the wide 64 bit UID layouts.
+template <typename Layout>
+inline void UID_width(const char* layout_name, unsigned int live_count) {
+    typedef TypedUIDGenerator<void, Layout> Generator;
+    typedef typename Generator::UID GeneratorUID;
+
+    Generator generator = Generator(live_count + 1);
+    std::vector<GeneratorUID> IDs;
+    IDs.reserve(live_count);
+    for (unsigned int i = 0; i < live_count; ++i)
+        IDs.push_back(generator.generate());
+    std::shuffle(IDs.begin(), IDs.end(), std::minstd_rand(83492791u));
+
+    // The generator stores a UID pr slot and pr live UID, plus the position of each live UID.
+    double generator_MB = generator.capacity() * (2.0 * sizeof(GeneratorUID) + sizeof(unsigned int)) / (1024.0 * 1024.0);
+    double ID_list_MB = live_count * sizeof(GeneratorUID) / (1024.0 * 1024.0);
+    printf(" %s UIDs, %u bytes pr UID: Generator %.1fMB, list of %u UIDs %.1fMB\n",
+           layout_name, (unsigned int)sizeof(GeneratorUID), generator_MB, live_count, ID_list_MB);
+
+    double iteration_time = Benchmark::time_ms([&]() {
+        unsigned int index_sum = 0;
+        for (GeneratorUID id : generator)
+            index_sum += id.get_index();
+        Benchmark::do_not_optimize(index_sum);
+    });
+    Benchmark::print_result("iterate generator", iteration_time);
+
+    double lookup_time = Benchmark::time_ms([&]() {
+        unsigned int valid_count = 0;
+        for (GeneratorUID id : IDs)
+            valid_count += generator.has(id);
+        Benchmark::do_not_optimize(valid_count);
+    });
+    Benchmark::print_result("has() on shuffled list", lookup_time);
+}
+
+inline void run() {
+    iteration_after_churn(1000000u, 10000u);
+    iteration_after_churn(1000000u, 500000u);
+    generate_and_erase_churn(100000u, 1000000u);
+    UID_width<NarrowUIDLayout>("Narrow", 10000000u);
+    UID_width<WideUIDLayout>("Wide", 10000000u);
+}
+
+} // NS UIDGeneratorBenchmark
+
+#endif // _BIFROST_BENCHMARKS_UID_GENERATOR_BENCHMARK_H_
@@ -0,0 +1,50 @@
+// Bifrost benchmarks.
+// Run all benchmarks or only the ones whose name is given as an argument.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <ChangeLogBenchmark.h>
+#include <LightTreeBenchmark.h>
+#include <MeshBVHBenchmark.h>
+#include <MeshModelBVHBenchmark.h>
+#include <MeshOptimizationBenchmark.h>
+#include <SceneBVHBenchmark.h>
+#include <SceneNodeBenchmark.h>
+#include <UIDGeneratorBenchmark.h>
+
+#include <cstdio>
+#include <cstring>
+
+struct BenchmarkEntry {
+    const char* name;
+    void(*run)();
+};
+
+static const BenchmarkEntry g_benchmarks[] = {
+    { "ChangeLog", ChangeLogBenchmark::run },
+    { "LightTree", LightTreeBenchmark::run },
+    { "MeshBVH", MeshBVHBenchmark::run },
+    { "MeshModelBVH", MeshModelBVHBenchmark::run },
+    { "MeshOptimization", MeshOptimizationBenchmark::run },
+    { "SceneBVH", SceneBVHBenchmark::run },
+    { "SceneNode", SceneNodeBenchmark::run },
+    { "UIDGenerator", UIDGeneratorBenchmark::run },
+};
+
+int main(int argc, char** argv) {
+    for (const BenchmarkEntry& benchmark : g_benchmarks) {
+        bool run_benchmark = argc == 1;
+        for (int i = 1; i < argc; ++i)
+            run_benchmark |= strcmp(argv[i], benchmark.name) == 0;
+
+        if (run_benchmark) {
+            printf("%s\n", benchmark.name);
+            benchmark.run();
+        }
+    }
+    return 0;
+}
@@ -524,7 +524,7 @@ int initialize(Engine& engine) {
 
     // Hook up update callback.
     if (!g_options.headless)
-        engine.add_mutating_callback([&] { update(engine); });
+        engine.add_mutating_callback("Environment convolution", [&] { update(engine); });
 
     return 0;
 }
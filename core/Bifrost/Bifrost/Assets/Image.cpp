@@ -16,8 +16,8 @@ namespace Bifrost {
 namespace Assets {
 
 Images::UIDGenerator Images::m_UID_generator = UIDGenerator(0u);
-Images::MetaInfo* Images::m_metainfo = nullptr;
-Images::PixelData* Images::m_pixels = nullptr;
+Core::ReservedArray<Images::MetaInfo> Images::m_metainfo;
+Core::ReservedArray<Images::PixelData> Images::m_pixels;
 Core::ChangeSet<Images::Changes, Images::UID> Images::m_changes;
 
 void Images::allocate(unsigned int capacity) {
@@ -27,8 +27,8 @@ void Images::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_metainfo = new MetaInfo[capacity];
-    m_pixels = new PixelData[capacity];
+    m_metainfo = Core::ReservedArray<MetaInfo>(m_UID_generator.max_capacity(), capacity);
+    m_pixels = Core::ReservedArray<PixelData>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
@@ -42,26 +42,17 @@ void Images::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_metainfo; m_metainfo = nullptr;
-    delete[] m_pixels; m_pixels = nullptr;
+    m_metainfo.release();
+    m_pixels.release();
     m_changes.resize(0);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void Images::reserve_image_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_metainfo != nullptr);
-    assert(m_pixels != nullptr);
+    assert(m_metainfo.data() != nullptr);
+    assert(m_pixels.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-    m_metainfo = resize_and_copy_array(m_metainfo, new_capacity, copyable_elements);
-    m_pixels = resize_and_copy_array(m_pixels, new_capacity, copyable_elements);
+    m_metainfo.resize(new_capacity);
+    m_pixels.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -71,6 +62,36 @@ void Images::reserve(unsigned int new_capacity) {
     reserve_image_data(m_UID_generator.capacity(), old_capacity);
 }
 
+static inline size_t get_pixel_bytes(Images::UID image_ID) {
+    if (Images::get_pixels(image_ID) == nullptr)
+        return 0;
+    size_t pixel_count = 0;
+    for (unsigned int m = 0; m < Images::get_mipmap_count(image_ID); ++m)
+        pixel_count += Images::get_pixel_count(image_ID, m);
+    return pixel_count * size_of(Images::get_pixel_format(image_ID));
+}
+
+Core::MemoryUsage Images::get_memory_usage(Images::UID image_ID) {
+    Core::MemoryUsage usage;
+    if (!m_UID_generator.has(image_ID))
+        return usage;
+    usage[Core::MemoryCategory::Pixels] = get_pixel_bytes(image_ID);
+    usage[Core::MemoryCategory::Metadata] = sizeof(MetaInfo) + sizeof(PixelData) + Core::get_allocated_bytes(m_metainfo[image_ID].name);
+    return usage;
+}
+
+Core::MemoryUsage Images::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID image_ID : m_UID_generator) {
+        usage[Core::MemoryCategory::Pixels] += get_pixel_bytes(image_ID);
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(m_metainfo[image_ID].name);
+    }
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() +
+        Core::get_allocated_bytes(m_metainfo) + Core::get_allocated_bytes(m_pixels);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 bool Images::has(Images::UID image_ID) {
     return m_UID_generator.has(image_ID) && m_changes.get_changes(image_ID) != Change::Destroyed;
 }
@@ -96,7 +117,7 @@ static inline Images::PixelData allocate_pixels(PixelFormat format, unsigned int
     return nullptr;
 }
 
-static inline void deallocate_pixels(PixelFormat format, Images::PixelData data) {
+void Images::deallocate_pixels(PixelFormat format, PixelData data) {
     switch (format) {
     case PixelFormat::Alpha8:
     case PixelFormat::Intensity8:
@@ -119,8 +140,8 @@ static inline void deallocate_pixels(PixelFormat format, Images::PixelData data)
 }
 
 Images::UID Images::create3D(const std::string& name, PixelFormat format, float gamma, Vector3ui size, unsigned int mipmap_count) {
-    assert(m_metainfo != nullptr);
-    assert(m_pixels != nullptr);
+    assert(m_metainfo.data() != nullptr);
+    assert(m_pixels.data() != nullptr);
     assert(mipmap_count > 0u);
 
     unsigned int old_capacity = m_UID_generator.capacity();
@@ -158,8 +179,8 @@ Images::UID Images::create3D(const std::string& name, PixelFormat format, float
 }
 
 Images::UID Images::create2D(const std::string& name, PixelFormat format, float gamma, Math::Vector2ui size, PixelData& pixels) {
-    assert(m_metainfo != nullptr);
-    assert(m_pixels != nullptr);
+    assert(m_metainfo.data() != nullptr);
+    assert(m_pixels.data() != nullptr);
 
     unsigned int old_capacity = m_UID_generator.capacity();
     UID id = m_UID_generator.generate();
@@ -251,6 +272,10 @@ static RGBA get_nonlinear_pixel(Images::PixelData pixels, PixelFormat format, un
     return RGBA::red();
 }
 
+RGBA Images::decode_pixel(const PixelData pixels, PixelFormat format, float gamma, unsigned int index) {
+    return gammacorrect(get_nonlinear_pixel(pixels, format, index), gamma);
+}
+
 static inline RGBA get_linear_pixel(Images::UID image_ID, unsigned int index) {
     Images::PixelData pixels = Images::get_pixels(image_ID);
     PixelFormat format = Images::get_pixel_format(image_ID);
@@ -587,7 +612,6 @@ Image combine_tint_roughness(const Image tint, const Image roughness, int roughn
         pixel_count += tint.get_pixel_count(m);
 
     int chunk_size = 4096;
-    int chunk_count = ceil_divide(pixel_count, chunk_size);
 
     bool tint_is_byte = tint_format == PixelFormat::RGB24 || tint_format == PixelFormat::RGBA32;
     bool roughness_is_byte = roughness_format == PixelFormat::Alpha8 || roughness_format == PixelFormat::Intensity8 || 
@@ -608,12 +632,7 @@ Image combine_tint_roughness(const Image tint, const Image roughness, int roughn
         const unsigned char* roughness_pixels = (unsigned char*)roughness.get_pixels() + roughness_channel;
         RGBA32* tint_roughness_pixels = tint_roughness.get_pixels<RGBA32>();
 
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int c = 0; c < chunk_count; ++c) {
-
-            int pixel_begin = c * chunk_size;
-            int pixel_end = min(pixel_begin + chunk_size, pixel_count);
-
+        Core::Parallel::for_each_chunk(0, pixel_count, [&](int pixel_begin, int pixel_end) {
             // Fill tint channels
             for (int p = pixel_begin; p < pixel_end; ++p) {
                 tint_roughness_pixels[p].r = tint_pixels[p * tint_pixel_size];
@@ -633,7 +652,7 @@ Image combine_tint_roughness(const Image tint, const Image roughness, int roughn
                     float linear_roughness = powf(nonlinear_roughness, roughness.get_gamma());
                     tint_roughness_pixels[p].a = unsigned char(linear_roughness * 255 + 0.5f);
                 }
-        }
+        }, chunk_size);
 
         return tint_roughness;
 
@@ -641,19 +660,14 @@ Image combine_tint_roughness(const Image tint, const Image roughness, int roughn
         // Fallback path
         Image tint_roughness = Images::create2D(tint.get_name() + "_" + roughness.get_name(), PixelFormat::RGBA32, 2.2f, size, mipmap_count);
 
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int c = 0; c < chunk_count; ++c) {
-
-            int pixel_begin = c * chunk_size;
-            int pixel_end = min(pixel_begin + chunk_size, pixel_count);
-
+        Core::Parallel::for_each_chunk(0, pixel_count, [&](int pixel_begin, int pixel_end) {
             // Fill tint and roughness channels.
             for (int p = pixel_begin; p < pixel_end; ++p) {
                 RGB t = tint.get_pixel(p).rgb();
                 float r = roughness.get_pixel(p)[roughness_channel];
                 tint_roughness.set_pixel(RGBA(t, r), p);
             }
-        }
+        }, chunk_size);
 
         return tint_roughness;
     }
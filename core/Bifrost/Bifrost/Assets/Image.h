@@ -11,6 +11,9 @@
 
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/Color.h>
 #include <Bifrost/Math/Utils.h>
@@ -93,7 +96,7 @@ public:
 
     typedef void* PixelData;
 
-    static bool is_allocated() { return m_metainfo != nullptr; }
+    static bool is_allocated() { return m_metainfo.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -160,6 +163,19 @@ public:
 
     static void change_format(Images::UID image_ID, PixelFormat new_format, float new_gamma);
 
+    // Pixel data that isn't owned by an image, fx the pixels of a screenshot.
+    static Math::RGBA decode_pixel(const PixelData pixels, PixelFormat format, float gamma, unsigned int index);
+    static void deallocate_pixels(PixelFormat format, PixelData pixels);
+
+    // Notifies the change consumers that pixels written directly through get_pixels have been updated.
+    static void flag_pixels_updated(Images::UID image_ID) { m_changes.add_change(image_ID, Change::PixelsUpdated); }
+
+    //-------------------------------------------------------------------------
+    // Memory usage.
+    //-------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(Images::UID image_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //-------------------------------------------------------------------------
     // Changes since last game loop tick.
     //-------------------------------------------------------------------------
@@ -178,6 +194,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_images() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -195,8 +218,8 @@ private:
     };
 
     static UIDGenerator m_UID_generator;
-    static MetaInfo* m_metainfo;
-    static PixelData* m_pixels;
+    static Core::ReservedArray<MetaInfo> m_metainfo;
+    static Core::ReservedArray<PixelData> m_pixels;
     static Core::ChangeSet<Changes, UID> m_changes;
 };
 
@@ -272,11 +295,10 @@ inline Images::UID copy_with_new_format(Images::UID image_ID, PixelFormat new_fo
     Images::UID new_image_ID = Images::create3D(image.get_name(), new_format, new_gamma, size, mipmap_count);
 
     for (unsigned int m = 0; m < mipmap_count; ++m)
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int p = 0; p < int(image.get_pixel_count(m)); ++p) {
+        Core::Parallel::for_each(0, int(image.get_pixel_count(m)), [&](int p) {
             auto pixel = image.get_pixel(p, m);
             Images::set_pixel(new_image_ID, process_pixel(pixel), p, m);
-        }
+        });
 
     Images::set_mipmapable(new_image_ID, image.is_mipmapable());
     return new_image_ID;
@@ -51,6 +51,11 @@ public:
         : m_latlong(latlong_ID)
         , m_distribution(Math::Distribution2D<double>(latlong_PDF, m_latlong.get_image().get_width(), m_latlong.get_image().get_height())) { }
 
+    // Creates the light from the CDFs of another light with the same texture, without recomputing them.
+    InfiniteAreaLight(Textures::UID latlong_ID, const float* marginal_CDF, const float* conditional_CDF, float integral)
+        : m_latlong(latlong_ID)
+        , m_distribution(marginal_CDF, conditional_CDF, integral, m_latlong.get_image().get_width(), m_latlong.get_image().get_height()) { }
+
     //*********************************************************************************************
     // Getters.
     //*********************************************************************************************
@@ -60,6 +65,7 @@ public:
     inline unsigned int get_height() const { return m_latlong.get_image().get_height(); }
     inline const float* const get_image_marginal_CDF() const { return m_distribution.get_marginal_CDF(); }
     inline const float* const get_image_conditional_CDF() const { return m_distribution.get_conditional_CDF(); }
+    inline size_t get_allocated_bytes() const { return m_distribution.get_allocated_bytes(); }
 
     //*********************************************************************************************
     // Evaluate.
@@ -8,6 +8,7 @@
 
 #include <Bifrost/Assets/InfiniteAreaLight.h>
 
+#include <Bifrost/Core/Parallel.h>
 #include <Bifrost/Math/Constants.h>
 #include <Bifrost/Math/Distributions.h>
 #include <Bifrost/Math/Quaternion.h>
@@ -28,8 +29,7 @@ inline void InfiniteAreaLight::compute_PDF(Texture latlong, float* PDF_result) {
     // Use a temporary PDF array if the PDFs should be filtered afterwards, otherwise use the result array.
     float* PDF = filter_pixels ? new float[width * height] : PDF_result;
 
-    #pragma omp parallel for schedule(dynamic, 16)
-    for (int y = 0; y < height; ++y) {
+    Core::Parallel::for_each(0, height, [&](int y) {
         // PBRT p. 728. Account for the non-uniform surface area of the pixels, i.e. the higher density near the poles.
         float sin_theta = sinf(Math::PI<float>() * (y + 0.5f) / float(height));
 
@@ -38,7 +38,7 @@ inline void InfiniteAreaLight::compute_PDF(Texture latlong, float* PDF_result) {
             Math::RGB pixel = image.get_pixel(Math::Vector2ui(x, y)).rgb();
             PDF_row[x] = (pixel.r + pixel.g + pixel.b) * sin_theta;
         }
-    }
+    }, 16);
 
     // If the texture is unfiltered, then the per pixel importance corresponds to the PDF.
     // If filtering is enabled, then we need to filter the PDF as well.
@@ -46,8 +46,7 @@ inline void InfiniteAreaLight::compute_PDF(Texture latlong, float* PDF_result) {
     // avoid artefacts in cases where a black pixel would have a PDF of 0,
     // but due to filtering the entire texel wouldn't actually be black.
     if (filter_pixels) {
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int y = 0; y < height; ++y) {
+        Core::Parallel::for_each(0, height, [&](int y) {
             // Blur per pixel importance to account for linear interpolation.
             // The pixel's own contribution is 20 / 32.
             // Neighbours on the side contribute by 2 / 32.
@@ -97,7 +96,7 @@ inline void InfiniteAreaLight::compute_PDF(Texture latlong, float* PDF_result) {
                 // Normalize.
                 pixel_PDF /= 32.0f;
             }
-        }
+        }, 16);
 
         delete[] PDF;
     }
@@ -122,9 +121,9 @@ inline void convolute(const InfiniteAreaLight& light, IBLConvolution<T>* begin,
     // Precompute light samples.
     std::vector<LightSample> light_samples = std::vector<LightSample>();
     light_samples.resize(max_sample_count * 4);
-    #pragma omp parallel for schedule(dynamic, 16)
-    for (int s = 0; s < light_samples.size(); ++s)
+    Core::Parallel::for_each(0, (int)light_samples.size(), [&](int s) {
         light_samples[s] = light.sample(RNG::sample02(s));
+    }, 16);
 
     for (; begin != end; ++begin) {
 
@@ -135,22 +134,20 @@ inline void convolute(const InfiniteAreaLight& light, IBLConvolution<T>* begin,
         // Handle nearly specular case.
         if (alpha < 0.00000000001f) {
             Textures::UID env_map_ID = light.get_texture_ID();
-            #pragma omp parallel for schedule(dynamic, 16)
-            for (int i = 0; i < width * height; ++i) {
+            Core::Parallel::for_each(0, width * height, [&](int i) {
                 int x = i % width, y = i / width;
                 begin->Pixels[x + y * width] = color_conversion(sample2D(env_map_ID, Vector2f((x + 0.5f) / width, (y + 0.5f) / height)).rgb());
-            }
+            }, 16);
             continue;
         }
 
         std::vector<GGX::Sample> ggx_samples = std::vector<GGX::Sample>();
         ggx_samples.resize(begin->sample_count * 4);
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int s = 0; s < ggx_samples.size(); ++s)
+        Core::Parallel::for_each(0, (int)ggx_samples.size(), [&](int s) {
             ggx_samples[s] = GGX::sample(alpha, RNG::sample02(s));
+        }, 16);
 
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int i = 0; i < width * height; ++i) {
+        Core::Parallel::for_each(0, width * height, [&](int i) {
 
             int x = i % width;
             int y = i / width;
@@ -191,7 +188,7 @@ inline void convolute(const InfiniteAreaLight& light, IBLConvolution<T>* begin,
             // Account for the samples being split evenly between BSDF and light.
             radiance *= 2.0f;
             begin->Pixels[x + y * width] = color_conversion(radiance / float(begin->sample_count));
-        }
+        }, 16);
     }
 }
 
@@ -201,8 +198,7 @@ inline void reconstruct_solid_angle_PDF_sans_sin_theta(const InfiniteAreaLight&
     float PDF_image_scaling = width * height * light.image_integral();
     float PDF_normalization_term = 1.0f / (float(light.image_integral()) * 2.0f * Math::PI<float>() * Math::PI<float>());
     float PDF_scale = PDF_image_scaling * PDF_normalization_term;
-    #pragma omp parallel for schedule(dynamic, 16)
-    for (int y = 0; y < height; ++y) {
+    Core::Parallel::for_each(0, height, [&](int y) {
         float marginal_PDF = light.get_image_marginal_CDF()[y + 1] - light.get_image_marginal_CDF()[y];
 
         for (int x = 0; x < width; ++x) {
@@ -211,7 +207,7 @@ inline void reconstruct_solid_angle_PDF_sans_sin_theta(const InfiniteAreaLight&
 
             per_pixel_PDF[x + y * width] = marginal_PDF * conditional_PDF * PDF_scale;
         }
-    }
+    }, 16);
 }
 
 } // NS InfiniteAreaLightUtils
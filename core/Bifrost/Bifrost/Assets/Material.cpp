@@ -16,8 +16,8 @@ namespace Bifrost {
 namespace Assets {
 
 Materials::UIDGenerator Materials::m_UID_generator = UIDGenerator(0u);
-std::string* Materials::m_names = nullptr;
-Materials::Data* Materials::m_materials = nullptr;
+Core::ReservedArray<std::string> Materials::m_names;
+Core::ReservedArray<Materials::Data> Materials::m_materials;
 Core::ChangeSet<Materials::Changes, Materials::UID> Materials::m_changes;
 
 #ifdef NDEBUG 
@@ -43,8 +43,8 @@ void Materials::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_names = new std::string[capacity];
-    m_materials = new Data[capacity];
+    m_names = Core::ReservedArray<std::string>(m_UID_generator.max_capacity(), capacity);
+    m_materials = Core::ReservedArray<Data>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
@@ -60,27 +60,18 @@ void Materials::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_names; m_names = nullptr;
-    delete[] m_materials; m_materials = nullptr;
+    m_names.release();
+    m_materials.release();
 
     m_changes.resize(0);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void Materials::reserve_material_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_names != nullptr);
-    assert(m_materials != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_materials.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-    m_names = resize_and_copy_array(m_names, new_capacity, copyable_elements);
-    m_materials = resize_and_copy_array(m_materials, new_capacity, copyable_elements);
+    m_names.resize(new_capacity);
+    m_materials.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -90,9 +81,26 @@ void Materials::reserve(unsigned int new_capacity) {
     reserve_material_data(m_UID_generator.capacity(), old_capacity);
 }
 
+Core::MemoryUsage Materials::get_memory_usage(Materials::UID material_ID) {
+    Core::MemoryUsage usage;
+    if (m_UID_generator.has(material_ID))
+        usage[Core::MemoryCategory::Metadata] = sizeof(std::string) + sizeof(Data) + Core::get_allocated_bytes(m_names[material_ID]);
+    return usage;
+}
+
+Core::MemoryUsage Materials::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID material_ID : m_UID_generator)
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(m_names[material_ID]);
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() +
+        Core::get_allocated_bytes(m_names) + Core::get_allocated_bytes(m_materials);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 Materials::UID Materials::create(const std::string& name, const Data& data) {
-    assert(m_names != nullptr);
-    assert(m_materials != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_materials.data() != nullptr);
     assert_coverage_texture(data.coverage_texture_ID);
     assert_metallic_texture(data.metallic_texture_ID);
     assert_tint_roughness_texture(data.tint_roughness_texture_ID);
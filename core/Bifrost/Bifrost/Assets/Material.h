@@ -13,6 +13,8 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/Color.h>
 
@@ -97,7 +99,7 @@ public:
         }
     };
 
-    static bool is_allocated() { return m_materials != nullptr; }
+    static bool is_allocated() { return m_materials.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -148,6 +150,12 @@ public:
     static inline float get_transmission(Materials::UID material_ID) { return m_materials[material_ID].transmission; }
     static void set_transmission(Materials::UID material_ID, float transmission);
 
+    //-------------------------------------------------------------------------
+    // Memory usage.
+    //-------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(Materials::UID material_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //-------------------------------------------------------------------------
     // Changes since last game loop tick.
     //-------------------------------------------------------------------------
@@ -165,6 +173,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_materials() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -174,8 +189,8 @@ private:
 
     static UIDGenerator m_UID_generator;
 
-    static std::string* m_names;
-    static Data* m_materials;
+    static Core::ReservedArray<std::string> m_names;
+    static Core::ReservedArray<Data> m_materials;
     static Core::ChangeSet<Changes, UID> m_changes;
 };
 
@@ -7,10 +7,23 @@
 // ---------------------------------------------------------------------------
 
 #include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshBVH.h>
 
+#include <Bifrost/Core/Parallel.h>
 #include <Bifrost/Math/Conversions.h>
+#include <Bifrost/Math/RNG.h>
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef BIFROST_SSE2
+#include <emmintrin.h>
+#endif
 
 using namespace Bifrost::Math;
 
@@ -18,9 +31,11 @@ namespace Bifrost {
 namespace Assets {
 
 Meshes::UIDGenerator Meshes::m_UID_generator = UIDGenerator(0u);
-std::string* Meshes::m_names = nullptr;
-Meshes::Buffers* Meshes::m_buffers = nullptr;
-AABB* Meshes::m_bounds = nullptr;
+Core::ReservedArray<std::string> Meshes::m_names;
+Core::ReservedArray<Meshes::Buffers> Meshes::m_buffers;
+Core::ReservedArray<AABB> Meshes::m_bounds;
+Core::ReservedArray<std::shared_ptr<const MeshBVH>> Meshes::m_BVHs;
+Core::ReservedArray<std::vector<Meshes::LOD>> Meshes::m_LOD_chains;
 
 Core::ChangeSet<Meshes::Changes, Meshes::UID> Meshes::m_changes;
 
@@ -31,9 +46,11 @@ void Meshes::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_names = new std::string[capacity];
-    m_buffers = new Buffers[capacity];
-    m_bounds = new AABB[capacity];
+    m_names = Core::ReservedArray<std::string>(m_UID_generator.max_capacity(), capacity);
+    m_buffers = Core::ReservedArray<Buffers>(m_UID_generator.max_capacity(), capacity);
+    m_bounds = Core::ReservedArray<AABB>(m_UID_generator.max_capacity(), capacity);
+    m_BVHs = Core::ReservedArray<std::shared_ptr<const MeshBVH>>(m_UID_generator.max_capacity(), capacity);
+    m_LOD_chains = Core::ReservedArray<std::vector<LOD>>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
@@ -53,33 +70,31 @@ void Meshes::deallocate() {
         delete[] buffers.positions;
         delete[] buffers.normals;
         delete[] buffers.texcoords;
+        delete[] buffers.quantized_positions;
+        delete[] buffers.octahedral_normals;
+        delete[] buffers.half_texcoords;
     }
-    delete[] m_names; m_names = nullptr;
-    delete[] m_buffers; m_buffers = nullptr;
-    delete[] m_bounds; m_bounds = nullptr;
+    m_names.release();
+    m_buffers.release();
+    m_bounds.release();
+    m_BVHs.release();
+    m_LOD_chains.release();
     
     m_changes.resize(0);
 
     m_UID_generator = UIDGenerator(0u);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void Meshes::reserve_mesh_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_names != nullptr);
-    assert(m_buffers != nullptr);
-    assert(m_bounds != nullptr);
-
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-    m_names = resize_and_copy_array(m_names, new_capacity, copyable_elements);
-    m_buffers = resize_and_copy_array(m_buffers, new_capacity, copyable_elements);
-    m_bounds = resize_and_copy_array(m_bounds, new_capacity, copyable_elements);
+    assert(m_names.data() != nullptr);
+    assert(m_buffers.data() != nullptr);
+    assert(m_bounds.data() != nullptr);
+
+    m_names.resize(new_capacity);
+    m_buffers.resize(new_capacity);
+    m_bounds.resize(new_capacity);
+    m_BVHs.resize(new_capacity);
+    m_LOD_chains.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -89,10 +104,47 @@ void Meshes::reserve(unsigned int new_capacity) {
     reserve_mesh_data(m_UID_generator.capacity(), old_capacity);
 }
 
+static inline void add_buffer_bytes(Core::MemoryUsage& usage, Meshes::UID mesh_ID) {
+    usage[Core::MemoryCategory::Vertices] += Meshes::get_buffer_size(mesh_ID, MeshFlag::Position) +
+        Meshes::get_buffer_size(mesh_ID, MeshFlag::Normal) + Meshes::get_buffer_size(mesh_ID, MeshFlag::Texcoord);
+    usage[Core::MemoryCategory::Indices] += Meshes::get_primitive_count(mesh_ID) * sizeof(Vector3ui);
+}
+
+static inline void add_BVH_bytes(Core::MemoryUsage& usage, Meshes::UID mesh_ID) {
+    std::shared_ptr<const MeshBVH> BVH = Meshes::get_cached_BVH(mesh_ID);
+    if (BVH != nullptr)
+        usage[Core::MemoryCategory::BVHs] += sizeof(MeshBVH) + BVH->get_allocated_bytes();
+}
+
+Core::MemoryUsage Meshes::get_memory_usage(Meshes::UID mesh_ID) {
+    Core::MemoryUsage usage;
+    if (!m_UID_generator.has(mesh_ID))
+        return usage;
+    add_buffer_bytes(usage, mesh_ID);
+    add_BVH_bytes(usage, mesh_ID);
+    usage[Core::MemoryCategory::Metadata] = sizeof(std::string) + sizeof(Buffers) + sizeof(AABB) + sizeof(std::shared_ptr<const MeshBVH>) +
+        sizeof(std::vector<LOD>) + Core::get_allocated_bytes(m_names[mesh_ID]) + Core::get_allocated_bytes(m_LOD_chains[mesh_ID]);
+    return usage;
+}
+
+Core::MemoryUsage Meshes::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID mesh_ID : m_UID_generator) {
+        add_buffer_bytes(usage, mesh_ID);
+        add_BVH_bytes(usage, mesh_ID);
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(m_names[mesh_ID]) + Core::get_allocated_bytes(m_LOD_chains[mesh_ID]);
+    }
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() + Core::get_allocated_bytes(m_names) +
+        Core::get_allocated_bytes(m_buffers) + Core::get_allocated_bytes(m_bounds) + Core::get_allocated_bytes(m_BVHs) +
+        Core::get_allocated_bytes(m_LOD_chains);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 Meshes::UID Meshes::create(const std::string& name, unsigned int primitive_count, unsigned int vertex_count, MeshFlags buffer_bitmask) {
-    assert(m_buffers != nullptr);
-    assert(m_names != nullptr);
-    assert(m_bounds != nullptr);
+    assert(m_buffers.data() != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_bounds.data() != nullptr);
 
     unsigned int old_capacity = m_UID_generator.capacity();
     UID id = m_UID_generator.generate();
@@ -100,14 +152,36 @@ Meshes::UID Meshes::create(const std::string& name, unsigned int primitive_count
         // The capacity has changed and the size of all arrays need to be adjusted.
         reserve_mesh_data(m_UID_generator.capacity(), old_capacity);
 
+    // The storage flags imply their buffers.
+    if (buffer_bitmask.is_set(MeshFlag::QuantizedPosition))
+        buffer_bitmask |= MeshFlag::Position;
+    if (buffer_bitmask.is_set(MeshFlag::OctahedralNormal))
+        buffer_bitmask |= MeshFlag::Normal;
+    if (buffer_bitmask.is_set(MeshFlag::HalfTexcoord))
+        buffer_bitmask |= MeshFlag::Texcoord;
+    bool has_positions = buffer_bitmask.is_set(MeshFlag::Position);
+    bool has_normals = buffer_bitmask.is_set(MeshFlag::Normal);
+    bool has_texcoords = buffer_bitmask.is_set(MeshFlag::Texcoord);
+
     m_names[id] = name;
-    m_buffers[id].primitive_count = primitive_count;
-    m_buffers[id].primitives = new Vector3ui[primitive_count];
-    m_buffers[id].vertex_count = vertex_count;
-    m_buffers[id].positions = (buffer_bitmask & MeshFlag::Position) ? new Vector3f[vertex_count] : nullptr;
-    m_buffers[id].normals = (buffer_bitmask & MeshFlag::Normal) ? new Vector3f[vertex_count] : nullptr;
-    m_buffers[id].texcoords = (buffer_bitmask & MeshFlag::Texcoord) ? new Vector2f[vertex_count] : nullptr;
+    Buffers& buffers = m_buffers[id];
+    buffers.primitive_count = primitive_count;
+    buffers.primitives = new Vector3ui[primitive_count];
+    buffers.vertex_count = vertex_count;
+    buffers.flags = buffer_bitmask;
+    bool is_quantized = buffer_bitmask.is_set(MeshFlag::QuantizedPosition);
+    buffers.positions = has_positions && !is_quantized ? new Vector3f[vertex_count] : nullptr;
+    buffers.quantized_positions = is_quantized ? new QuantizedPosition[vertex_count] : nullptr;
+    bool is_octahedral = buffer_bitmask.is_set(MeshFlag::OctahedralNormal);
+    buffers.normals = has_normals && !is_octahedral ? new Vector3f[vertex_count] : nullptr;
+    buffers.octahedral_normals = is_octahedral ? new OctahedralNormal[vertex_count] : nullptr;
+    bool is_half = buffer_bitmask.is_set(MeshFlag::HalfTexcoord);
+    buffers.texcoords = has_texcoords && !is_half ? new Vector2f[vertex_count] : nullptr;
+    buffers.half_texcoords = is_half ? new HalfTexcoord[vertex_count] : nullptr;
+    buffers.position_quantization = PositionQuantization::from_bounds(AABB(Vector3f::zero(), Vector3f::zero()));
     m_bounds[id] = AABB::invalid();
+    std::atomic_store(&m_BVHs[id], std::shared_ptr<const MeshBVH>());
+    m_LOD_chains[id].clear();
     m_changes.set_change(id, Change::Created);
 
     return id;
@@ -121,22 +195,317 @@ void Meshes::destroy(Meshes::UID mesh_ID) {
         delete[] buffers.positions;
         delete[] buffers.normals;
         delete[] buffers.texcoords;
+        delete[] buffers.quantized_positions;
+        delete[] buffers.octahedral_normals;
+        delete[] buffers.half_texcoords;
+        std::atomic_store(&m_BVHs[mesh_ID], std::shared_ptr<const MeshBVH>());
 
         m_changes.add_change(mesh_ID, Change::Destroyed);
+
+        // The levels of detail are owned by the mesh.
+        std::vector<LOD> LOD_chain = std::move(m_LOD_chains[mesh_ID]);
+        m_LOD_chains[mesh_ID].clear();
+        for (LOD level : LOD_chain)
+            destroy(level.mesh_ID);
     }
 }
 
+void Meshes::flag_geometry_updated(Meshes::UID mesh_ID) {
+    std::atomic_store(&m_BVHs[mesh_ID], std::shared_ptr<const MeshBVH>());
+    m_changes.add_change(mesh_ID, Change::GeometryUpdated);
+}
+
+std::shared_ptr<const MeshBVH> Meshes::cache_BVH(Meshes::UID mesh_ID, std::shared_ptr<const MeshBVH> BVH) {
+    std::shared_ptr<const MeshBVH> cached_BVH = nullptr;
+    if (std::atomic_compare_exchange_strong(&m_BVHs[mesh_ID], &cached_BVH, BVH))
+        return BVH;
+    return cached_BVH;
+}
+
+void Meshes::set_LOD_chain(Meshes::UID mesh_ID, std::vector<LOD> LOD_chain) {
+    std::vector<LOD>& current_LOD_chain = m_LOD_chains[mesh_ID];
+    for (LOD level : current_LOD_chain) {
+        auto is_same_mesh = [=](LOD new_level) { return new_level.mesh_ID == level.mesh_ID; };
+        if (std::none_of(LOD_chain.begin(), LOD_chain.end(), is_same_mesh))
+            destroy(level.mesh_ID);
+    }
+    current_LOD_chain = std::move(LOD_chain);
+}
+
 AABB Meshes::compute_bounds(Meshes::UID mesh_ID) {
     Buffers& buffers = m_buffers[mesh_ID];
 
-    AABB bounds = AABB(buffers.positions[0], buffers.positions[0]);
-    for (Vector3f* position_itr = buffers.positions + 1; position_itr < (buffers.positions + buffers.vertex_count); ++position_itr)
-        bounds.grow_to_contain(*position_itr);
+    AABB bounds = AABB(get_position(mesh_ID, 0), get_position(mesh_ID, 0));
+    for (unsigned int v = 1; v < buffers.vertex_count; ++v)
+        bounds.grow_to_contain(get_position(mesh_ID, v));
 
     m_bounds[mesh_ID] = bounds;
     return bounds;
 }
 
+template <typename T>
+static inline void resize_buffer(T*& buffer, unsigned int old_element_count, unsigned int new_element_count) {
+    if (buffer == nullptr)
+        return;
+    T* resized_buffer = new T[new_element_count];
+    std::copy(buffer, buffer + std::min(old_element_count, new_element_count), resized_buffer);
+    delete[] buffer;
+    buffer = resized_buffer;
+}
+
+void Meshes::set_vertex_count(Meshes::UID mesh_ID, unsigned int vertex_count) {
+    Buffers& buffers = m_buffers[mesh_ID];
+    if (buffers.vertex_count == vertex_count)
+        return;
+
+    resize_buffer(buffers.positions, buffers.vertex_count, vertex_count);
+    resize_buffer(buffers.normals, buffers.vertex_count, vertex_count);
+    resize_buffer(buffers.texcoords, buffers.vertex_count, vertex_count);
+    resize_buffer(buffers.quantized_positions, buffers.vertex_count, vertex_count);
+    resize_buffer(buffers.octahedral_normals, buffers.vertex_count, vertex_count);
+    resize_buffer(buffers.half_texcoords, buffers.vertex_count, vertex_count);
+    buffers.vertex_count = vertex_count;
+    flag_geometry_updated(mesh_ID);
+}
+
+void Meshes::set_primitive_count(Meshes::UID mesh_ID, unsigned int primitive_count) {
+    Buffers& buffers = m_buffers[mesh_ID];
+    if (buffers.primitive_count == primitive_count)
+        return;
+
+    resize_buffer(buffers.primitives, buffers.primitive_count, primitive_count);
+    buffers.primitive_count = primitive_count;
+    flag_geometry_updated(mesh_ID);
+}
+
+//-----------------------------------------------------------------------------
+// Compressed vertex buffers.
+//-----------------------------------------------------------------------------
+
+// Allocates a buffer and fills it in parallel with fill(buffer, begin, end) for chunks of the elements.
+template <typename T, typename Fill>
+static inline T* create_buffer(unsigned int element_count, Fill fill) {
+    T* buffer = new T[element_count];
+    Core::Parallel::for_each_chunk(0, (int)element_count, [&](int begin, int end) { fill(buffer, begin, end); }, 16384);
+    return buffer;
+}
+
+void Meshes::set_compression(Meshes::UID mesh_ID, MeshFlags compression) {
+    Buffers& buffers = m_buffers[mesh_ID];
+    unsigned int vertex_count = buffers.vertex_count;
+
+    bool quantize_positions = compression.is_set(MeshFlag::QuantizedPosition);
+    if (buffers.flags.is_set(MeshFlag::Position) && quantize_positions != buffers.flags.is_set(MeshFlag::QuantizedPosition)) {
+        if (quantize_positions) {
+            AABB bounds = AABB::invalid();
+            for (unsigned int v = 0; v < vertex_count; ++v)
+                bounds.grow_to_contain(buffers.positions[v]);
+            PositionQuantization quantization = PositionQuantization::from_bounds(bounds);
+            buffers.quantized_positions = create_buffer<QuantizedPosition>(vertex_count, [&](QuantizedPosition* quantized_positions, int begin, int end) {
+                for (int v = begin; v < end; ++v)
+                    quantized_positions[v] = quantization.encode(buffers.positions[v]);
+            });
+            buffers.position_quantization = quantization;
+            delete[] buffers.positions;
+            buffers.positions = nullptr;
+        } else {
+            buffers.positions = create_buffer<Vector3f>(vertex_count, [&](Vector3f* positions, int begin, int end) {
+                decode_positions(mesh_ID, begin, end - begin, positions + begin);
+            });
+            delete[] buffers.quantized_positions;
+            buffers.quantized_positions = nullptr;
+        }
+        buffers.flags ^= MeshFlag::QuantizedPosition;
+        flag_geometry_updated(mesh_ID);
+    }
+
+    bool encode_normals = compression.is_set(MeshFlag::OctahedralNormal);
+    if (buffers.flags.is_set(MeshFlag::Normal) && encode_normals != buffers.flags.is_set(MeshFlag::OctahedralNormal)) {
+        if (encode_normals) {
+            buffers.octahedral_normals = create_buffer<OctahedralNormal>(vertex_count, [&](OctahedralNormal* octahedral_normals, int begin, int end) {
+                for (int v = begin; v < end; ++v)
+                    octahedral_normals[v] = OctahedralNormal::encode_precise(buffers.normals[v]);
+            });
+            delete[] buffers.normals;
+            buffers.normals = nullptr;
+        } else {
+            buffers.normals = create_buffer<Vector3f>(vertex_count, [&](Vector3f* normals, int begin, int end) {
+                decode_normals(mesh_ID, begin, end - begin, normals + begin);
+            });
+            delete[] buffers.octahedral_normals;
+            buffers.octahedral_normals = nullptr;
+        }
+        buffers.flags ^= MeshFlag::OctahedralNormal;
+    }
+
+    bool halve_texcoords = compression.is_set(MeshFlag::HalfTexcoord);
+    if (buffers.flags.is_set(MeshFlag::Texcoord) && halve_texcoords != buffers.flags.is_set(MeshFlag::HalfTexcoord)) {
+        if (halve_texcoords) {
+            buffers.half_texcoords = create_buffer<HalfTexcoord>(vertex_count, [&](HalfTexcoord* half_texcoords, int begin, int end) {
+                for (int v = begin; v < end; ++v)
+                    half_texcoords[v] = HalfTexcoord(buffers.texcoords[v]);
+            });
+            delete[] buffers.texcoords;
+            buffers.texcoords = nullptr;
+        } else {
+            buffers.texcoords = create_buffer<Vector2f>(vertex_count, [&](Vector2f* texcoords, int begin, int end) {
+                decode_texcoords(mesh_ID, begin, end - begin, texcoords + begin);
+            });
+            delete[] buffers.half_texcoords;
+            buffers.half_texcoords = nullptr;
+        }
+        buffers.flags ^= MeshFlag::HalfTexcoord;
+    }
+}
+
+void* Meshes::get_buffer_data(Meshes::UID mesh_ID, MeshFlag buffer) {
+    Buffers& buffers = m_buffers[mesh_ID];
+    switch (buffer) {
+    case MeshFlag::Position:
+        return buffers.positions != nullptr ? (void*)buffers.positions : (void*)buffers.quantized_positions;
+    case MeshFlag::Normal:
+        return buffers.normals != nullptr ? (void*)buffers.normals : (void*)buffers.octahedral_normals;
+    case MeshFlag::Texcoord:
+        return buffers.texcoords != nullptr ? (void*)buffers.texcoords : (void*)buffers.half_texcoords;
+    default:
+        return nullptr;
+    }
+}
+
+size_t Meshes::get_buffer_size(Meshes::UID mesh_ID, MeshFlag buffer) {
+    const Buffers& buffers = m_buffers[mesh_ID];
+    if (!buffers.flags.is_set(buffer))
+        return 0;
+    size_t vertex_count = buffers.vertex_count;
+    switch (buffer) {
+    case MeshFlag::Position:
+        return vertex_count * (buffers.flags.is_set(MeshFlag::QuantizedPosition) ? sizeof(QuantizedPosition) : sizeof(Vector3f));
+    case MeshFlag::Normal:
+        return vertex_count * (buffers.flags.is_set(MeshFlag::OctahedralNormal) ? sizeof(OctahedralNormal) : sizeof(Vector3f));
+    case MeshFlag::Texcoord:
+        return vertex_count * (buffers.flags.is_set(MeshFlag::HalfTexcoord) ? sizeof(HalfTexcoord) : sizeof(Vector2f));
+    default:
+        return 0;
+    }
+}
+
+#ifdef BIFROST_SSE2
+// Converts the half precision floats in the lower 16 bits of each lane to single precision.
+// The exponent is rebiased by a multiplication, which also handles denormals, and infinities and NaNs are patched up afterwards.
+// See Fabian Giesen's half_to_float_SSE2, https://gist.github.com/rygorous/2156668.
+static inline __m128 half_to_float(__m128i halfs) {
+    const __m128 exponent_rebias = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    __m128i exponent_mantissa = _mm_and_si128(halfs, _mm_set1_epi32(0x7FFF));
+    __m128i sign = _mm_slli_epi32(_mm_xor_si128(halfs, exponent_mantissa), 16);
+    __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exponent_mantissa, 13)), exponent_rebias);
+    __m128i is_inf_or_nan = _mm_cmpgt_epi32(exponent_mantissa, _mm_set1_epi32(0x7BFF));
+    __m128i inf_or_nan_exponent = _mm_and_si128(is_inf_or_nan, _mm_set1_epi32(255 << 23));
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, inf_or_nan_exponent)));
+}
+#endif
+
+void Meshes::decode_positions(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Vector3f* positions) {
+    const Buffers& buffers = m_buffers[mesh_ID];
+    if (buffers.positions != nullptr) {
+        std::copy_n(buffers.positions + first_vertex, vertex_count, positions);
+        return;
+    }
+
+    const QuantizedPosition* quantized_positions = buffers.quantized_positions + first_vertex;
+    PositionQuantization quantization = buffers.position_quantization;
+    unsigned int v = 0;
+#ifdef BIFROST_SSE2
+    // Four positions are twelve consecutive components, which are decoded as three lanes of four.
+    // The origin and scale are rotated to match the axes of the components in each lane.
+    Vector3f origin = quantization.origin, scale = quantization.scale;
+    const __m128 origins[3] = { _mm_setr_ps(origin.x, origin.y, origin.z, origin.x),
+                                _mm_setr_ps(origin.y, origin.z, origin.x, origin.y),
+                                _mm_setr_ps(origin.z, origin.x, origin.y, origin.z) };
+    const __m128 scales[3] = { _mm_setr_ps(scale.x, scale.y, scale.z, scale.x),
+                               _mm_setr_ps(scale.y, scale.z, scale.x, scale.y),
+                               _mm_setr_ps(scale.z, scale.x, scale.y, scale.z) };
+    const __m128i zero = _mm_setzero_si128();
+    for (; v + 4 <= vertex_count; v += 4) {
+        const unsigned short* components = &quantized_positions[v].x;
+        __m128i components_01 = _mm_loadu_si128((const __m128i*)components);
+        __m128i components_2 = _mm_loadl_epi64((const __m128i*)(components + 8));
+        __m128 lanes[3] = { _mm_cvtepi32_ps(_mm_unpacklo_epi16(components_01, zero)),
+                            _mm_cvtepi32_ps(_mm_unpackhi_epi16(components_01, zero)),
+                            _mm_cvtepi32_ps(_mm_unpacklo_epi16(components_2, zero)) };
+        float* decoded_components = &positions[v].x;
+        for (int l = 0; l < 3; ++l)
+            _mm_storeu_ps(decoded_components + 4 * l, _mm_add_ps(origins[l], _mm_mul_ps(lanes[l], scales[l])));
+    }
+#endif
+    for (; v < vertex_count; ++v)
+        positions[v] = quantization.decode(quantized_positions[v]);
+}
+
+void Meshes::decode_normals(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Vector3f* normals) {
+    const Buffers& buffers = m_buffers[mesh_ID];
+    if (buffers.normals != nullptr) {
+        std::copy_n(buffers.normals + first_vertex, vertex_count, normals);
+        return;
+    }
+
+    const OctahedralNormal* octahedral_normals = buffers.octahedral_normals + first_vertex;
+    unsigned int v = 0;
+#ifdef BIFROST_SSE2
+    // Same operations as OctahedralNormal::decode on four normals at a time.
+    const __m128 max_encoding = _mm_set1_ps(SHRT_MAX);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    for (; v + 4 <= vertex_count; v += 4) {
+        // The x and y encodings are the low and high 16 bits of each lane.
+        __m128i encodings = _mm_loadu_si128((const __m128i*)(octahedral_normals + v));
+        __m128 x = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(encodings, 16), 16));
+        __m128 y = _mm_cvtepi32_ps(_mm_srai_epi32(encodings, 16));
+        __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+        __m128 abs_y = _mm_andnot_ps(sign_mask, y);
+        __m128 z = _mm_sub_ps(_mm_sub_ps(max_encoding, abs_x), abs_y);
+
+        // Unfold the lower hemisphere.
+        __m128 is_lower_hemisphere = _mm_cmplt_ps(z, _mm_setzero_ps());
+        __m128 unfolded_x = _mm_or_ps(_mm_sub_ps(max_encoding, abs_y), _mm_and_ps(x, sign_mask));
+        __m128 unfolded_y = _mm_or_ps(_mm_sub_ps(max_encoding, abs_x), _mm_and_ps(y, sign_mask));
+        x = _mm_or_ps(_mm_and_ps(is_lower_hemisphere, unfolded_x), _mm_andnot_ps(is_lower_hemisphere, x));
+        y = _mm_or_ps(_mm_and_ps(is_lower_hemisphere, unfolded_y), _mm_andnot_ps(is_lower_hemisphere, y));
+
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        alignas(16) float xs[4], ys[4], zs[4];
+        _mm_store_ps(xs, _mm_div_ps(x, length));
+        _mm_store_ps(ys, _mm_div_ps(y, length));
+        _mm_store_ps(zs, _mm_div_ps(z, length));
+        for (int i = 0; i < 4; ++i)
+            normals[v + i] = Vector3f(xs[i], ys[i], zs[i]);
+    }
+#endif
+    for (; v < vertex_count; ++v)
+        normals[v] = octahedral_normals[v].decode();
+}
+
+void Meshes::decode_texcoords(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Vector2f* texcoords) {
+    const Buffers& buffers = m_buffers[mesh_ID];
+    if (buffers.texcoords != nullptr) {
+        std::copy_n(buffers.texcoords + first_vertex, vertex_count, texcoords);
+        return;
+    }
+
+    const HalfTexcoord* half_texcoords = buffers.half_texcoords + first_vertex;
+    unsigned int v = 0;
+#ifdef BIFROST_SSE2
+    // The four texcoords are eight consecutive halfs and decode to eight consecutive floats.
+    const __m128i zero = _mm_setzero_si128();
+    for (; v + 4 <= vertex_count; v += 4) {
+        __m128i halfs = _mm_loadu_si128((const __m128i*)(half_texcoords + v));
+        float* decoded_components = &texcoords[v].x;
+        _mm_storeu_ps(decoded_components, half_to_float(_mm_unpacklo_epi16(halfs, zero)));
+        _mm_storeu_ps(decoded_components + 4, half_to_float(_mm_unpackhi_epi16(halfs, zero)));
+    }
+#endif
+    for (; v < vertex_count; ++v)
+        texcoords[v] = Vector2f(half_texcoords[v]);
+}
+
 //-----------------------------------------------------------------------------
 // Mesh utils.
 //-----------------------------------------------------------------------------
@@ -147,17 +516,13 @@ Meshes::UID deep_clone(Meshes::UID mesh_ID) {
     Mesh mesh = mesh_ID;
     Meshes::UID new_ID = Meshes::create(mesh.get_name() + "_clone", mesh.get_primitive_count(), mesh.get_vertex_count(), mesh.get_flags());
 
-    Vector3f* positions_begin = mesh.get_positions();
-    if (positions_begin != nullptr)
-        std::copy_n(positions_begin, mesh.get_vertex_count(), Meshes::get_positions(new_ID));
-
-    Vector3f* normals_begin = mesh.get_normals();
-    if (normals_begin != nullptr)
-        std::copy_n(normals_begin, mesh.get_vertex_count(), Meshes::get_normals(new_ID));
-
-    Vector2f* texcoords_begin = mesh.get_texcoords();
-    if (texcoords_begin != nullptr)
-        std::copy_n(texcoords_begin, mesh.get_vertex_count(), Meshes::get_texcoords(new_ID));
+    // Copy the vertex buffers in their storage format.
+    for (MeshFlag buffer : { MeshFlag::Position, MeshFlag::Normal, MeshFlag::Texcoord }) {
+        const void* buffer_data = Meshes::get_buffer_data(mesh_ID, buffer);
+        if (buffer_data != nullptr)
+            memcpy(Meshes::get_buffer_data(new_ID, buffer), buffer_data, Meshes::get_buffer_size(mesh_ID, buffer));
+    }
+    Meshes::set_position_quantization(new_ID, Meshes::get_position_quantization(mesh_ID));
 
     Vector3ui* primitives_begin = mesh.get_primitives();
     if (primitives_begin != nullptr)
@@ -171,6 +536,10 @@ Meshes::UID deep_clone(Meshes::UID mesh_ID) {
 void transform_mesh(Meshes::UID mesh_ID, Matrix3x4f affine_transform) {
     Mesh mesh = mesh_ID;
 
+    // Compressed buffers are transformed decompressed and compressed again afterwards.
+    MeshFlags compression = mesh.get_flags() & MeshFlag::Compressed;
+    mesh.set_compression(MeshFlag::None);
+
     Matrix3x3f rotation;
     rotation.set_column(0, affine_transform.get_column(0));
     rotation.set_column(1, affine_transform.get_column(1));
@@ -187,6 +556,7 @@ void transform_mesh(Meshes::UID mesh_ID, Matrix3x4f affine_transform) {
             bounding_box.grow_to_contain(*positions_itr);
         }
         mesh.set_bounds(bounding_box);
+        Meshes::flag_geometry_updated(mesh_ID);
     }
 
     // Transform normals.
@@ -197,6 +567,8 @@ void transform_mesh(Meshes::UID mesh_ID, Matrix3x4f affine_transform) {
         for (; normals_itr != normals_end; ++normals_itr)
             *normals_itr = normal_rotation * *normals_itr;
     }
+
+    mesh.set_compression(compression);
 }
 
 void transform_mesh(Meshes::UID mesh_ID, Transform transform) {
@@ -218,7 +590,9 @@ Meshes::UID combine(const std::string& name,
         vertex_count += mesh.get_vertex_count();
     }
 
-    // Determine shared buffers.
+    // Determine shared buffers. The buffers are combined decompressed and compressed afterwards if requested.
+    MeshFlags compression = flags & MeshFlag::Compressed;
+    flags &= MeshFlag::AllBuffers;
     for (TransformedMesh transformed_mesh : meshes) {
         Mesh mesh = transformed_mesh.mesh_ID;
         flags &= mesh.get_flags();
@@ -241,8 +615,10 @@ Meshes::UID combine(const std::string& name,
         Vector3f* positions = merged_mesh.get_positions();
         for (TransformedMesh transformed_mesh : meshes) {
             Mesh mesh = transformed_mesh.mesh_ID;
-            for (Vector3f position : mesh.get_position_iterable())
-                *(positions++) = transformed_mesh.transform * position;
+            Meshes::decode_positions(mesh.get_ID(), 0, mesh.get_vertex_count(), positions);
+            for (Vector3f& position : Core::Iterable<Vector3f*>(positions, mesh.get_vertex_count()))
+                position = transformed_mesh.transform * position;
+            positions += mesh.get_vertex_count();
         }
     }
 
@@ -250,8 +626,10 @@ Meshes::UID combine(const std::string& name,
         Vector3f* normals = merged_mesh.get_normals();
         for (TransformedMesh transformed_mesh : meshes) {
             Mesh mesh = transformed_mesh.mesh_ID;
-            for (Vector3f normal : mesh.get_normal_iterable())
-                *(normals++) = transformed_mesh.transform.rotation * normal;
+            Meshes::decode_normals(mesh.get_ID(), 0, mesh.get_vertex_count(), normals);
+            for (Vector3f& normal : Core::Iterable<Vector3f*>(normals, mesh.get_vertex_count()))
+                normal = transformed_mesh.transform.rotation * normal;
+            normals += mesh.get_vertex_count();
         }
     }
 
@@ -259,12 +637,13 @@ Meshes::UID combine(const std::string& name,
         Vector2f* texcoords = merged_mesh.get_texcoords();
         for (TransformedMesh transformed_mesh : meshes) {
             Mesh mesh = transformed_mesh.mesh_ID;
-            memcpy(texcoords, mesh.get_texcoords(), sizeof(Vector2f) * mesh.get_vertex_count());
+            Meshes::decode_texcoords(mesh.get_ID(), 0, mesh.get_vertex_count(), texcoords);
             texcoords += mesh.get_vertex_count();
         }
     }
 
     merged_mesh.compute_bounds();
+    merged_mesh.set_compression(compression);
 
     return merged_mesh.get_ID();
 }
@@ -304,9 +683,365 @@ void compute_normals(Vector3ui* primitives_begin, Vector3ui* primitives_end,
 
 void compute_normals(Meshes::UID mesh_ID) {
     Mesh mesh = mesh_ID;
+
+    // Compressed buffers are decompressed while computing the normals.
+    MeshFlags compression = mesh.get_flags() & MeshFlag::Compressed;
+    mesh.set_compression(MeshFlag::None);
     compute_normals(mesh.get_primitives(), mesh.get_primitives() + mesh.get_primitive_count(),
                     mesh.get_normals(), mesh.get_normals() + mesh.get_vertex_count(),
                     mesh.get_positions());
+    mesh.set_compression(compression);
+}
+
+VertexCacheStatistics compute_vertex_cache_statistics(Meshes::UID mesh_ID, unsigned int cache_size) {
+    Mesh mesh = mesh_ID;
+    unsigned int vertex_count = mesh.get_vertex_count();
+    unsigned int primitive_count = mesh.get_primitive_count();
+    const unsigned int* indices = mesh.get_indices();
+
+    // A vertex is in the FIFO cache if fewer than cache_size vertices have been transformed since it was.
+    std::vector<unsigned int> transform_timestamps(vertex_count, 0u);
+    unsigned int transformed_vertex_count = 0;
+    for (unsigned int i = 0; i < mesh.get_index_count(); ++i) {
+        unsigned int vertex_index = indices[i];
+        bool is_cached = transform_timestamps[vertex_index] > 0 && transformed_vertex_count - transform_timestamps[vertex_index] < cache_size;
+        if (!is_cached)
+            transform_timestamps[vertex_index] = ++transformed_vertex_count;
+    }
+
+    VertexCacheStatistics statistics;
+    statistics.transformed_vertex_count = transformed_vertex_count;
+    statistics.ACMR = primitive_count > 0 ? transformed_vertex_count / float(primitive_count) : 0.0f;
+    statistics.ATVR = vertex_count > 0 ? transformed_vertex_count / float(vertex_count) : 0.0f;
+    return statistics;
+}
+
+// Size of the LRU cache modelled by the vertex cache optimization.
+static const int FORSYTH_CACHE_SIZE = 32;
+
+// Scores a vertex by its position in the modelled cache and by the number of triangles still using it.
+// Vertices used by the latest triangle are scored lower than the rest of the cache, as they are better
+// reused by triangles that don't contain all of them, and vertices with few remaining triangles are
+// scored higher to avoid leaving lone triangles behind.
+static inline float compute_forsyth_vertex_score(int cache_position, unsigned int remaining_triangle_count) {
+    if (remaining_triangle_count == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+        score = cache_position < 3 ? 0.75f : powf(1.0f - (cache_position - 3) / float(FORSYTH_CACHE_SIZE - 3), 1.5f);
+    return score + 2.0f / sqrtf(float(remaining_triangle_count));
+}
+
+void optimize_vertex_cache(Meshes::UID mesh_ID) {
+    Mesh mesh = mesh_ID;
+    unsigned int vertex_count = mesh.get_vertex_count();
+    unsigned int primitive_count = mesh.get_primitive_count();
+    Vector3ui* primitives = mesh.get_primitives();
+    if (primitive_count == 0)
+        return;
+
+    // The triangles using each vertex. The triangles still to be emitted are kept
+    // at the front of each vertex' list, so the list is the vertex' remaining triangles.
+    std::vector<unsigned int> vertex_triangle_offsets(vertex_count + 1, 0u);
+    for (Vector3ui primitive : mesh.get_primitive_iterable()) {
+        ++vertex_triangle_offsets[primitive.x + 1];
+        ++vertex_triangle_offsets[primitive.y + 1];
+        ++vertex_triangle_offsets[primitive.z + 1];
+    }
+    for (unsigned int v = 0; v < vertex_count; ++v)
+        vertex_triangle_offsets[v + 1] += vertex_triangle_offsets[v];
+    std::vector<unsigned int> remaining_triangle_counts(vertex_count, 0u);
+    std::vector<unsigned int> vertex_triangles(primitive_count * 3);
+    for (unsigned int t = 0; t < primitive_count; ++t)
+        for (unsigned int v : primitives[t])
+            vertex_triangles[vertex_triangle_offsets[v] + remaining_triangle_counts[v]++] = t;
+
+    std::vector<int> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (unsigned int v = 0; v < vertex_count; ++v)
+        vertex_scores[v] = compute_forsyth_vertex_score(-1, remaining_triangle_counts[v]);
+
+    std::vector<float> triangle_scores(primitive_count);
+    std::vector<bool> is_triangle_emitted(primitive_count, false);
+    for (unsigned int t = 0; t < primitive_count; ++t) {
+        Vector3ui primitive = primitives[t];
+        triangle_scores[t] = vertex_scores[primitive.x] + vertex_scores[primitive.y] + vertex_scores[primitive.z];
+    }
+
+    std::vector<Vector3ui> optimized_primitives(primitive_count);
+    unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+    int cache_size = 0;
+    int best_triangle = int(std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin());
+    unsigned int next_unemitted_triangle = 0;
+    for (unsigned int i = 0; i < primitive_count; ++i) {
+        if (best_triangle < 0) {
+            // No triangle uses a cached vertex. Continue with the next triangle in the original order.
+            while (is_triangle_emitted[next_unemitted_triangle])
+                ++next_unemitted_triangle;
+            best_triangle = next_unemitted_triangle;
+        }
+
+        Vector3ui primitive = primitives[best_triangle];
+        optimized_primitives[i] = primitive;
+        is_triangle_emitted[best_triangle] = true;
+
+        // Remove the triangle from its vertices' remaining triangles.
+        for (unsigned int v : primitive) {
+            unsigned int* triangles = vertex_triangles.data() + vertex_triangle_offsets[v];
+            unsigned int last = --remaining_triangle_counts[v];
+            for (unsigned int j = 0; j <= last; ++j)
+                if (triangles[j] == (unsigned int)best_triangle) {
+                    std::swap(triangles[j], triangles[last]);
+                    break;
+                }
+        }
+
+        // Move the triangle's vertices to the front of the cache. The vertices pushed
+        // past the end of the cache are kept at the end of the array until rescored.
+        unsigned int new_cache[FORSYTH_CACHE_SIZE + 3] = { primitive.x, primitive.y, primitive.z };
+        int new_cache_size = 3;
+        for (int c = 0; c < cache_size; ++c) {
+            unsigned int v = cache[c];
+            if (v != primitive.x && v != primitive.y && v != primitive.z)
+                new_cache[new_cache_size++] = v;
+        }
+
+        // Rescore the vertices whose cache position or triangle count changed and propagate
+        // the change to their remaining triangles.
+        for (int c = 0; c < new_cache_size; ++c) {
+            unsigned int v = new_cache[c];
+            cache_positions[v] = c < FORSYTH_CACHE_SIZE ? c : -1;
+            float score = compute_forsyth_vertex_score(cache_positions[v], remaining_triangle_counts[v]);
+            float score_delta = score - vertex_scores[v];
+            vertex_scores[v] = score;
+            const unsigned int* triangles = vertex_triangles.data() + vertex_triangle_offsets[v];
+            for (unsigned int j = 0; j < remaining_triangle_counts[v]; ++j)
+                triangle_scores[triangles[j]] += score_delta;
+        }
+        cache_size = std::min(new_cache_size, FORSYTH_CACHE_SIZE);
+        std::copy(new_cache, new_cache + cache_size, cache);
+
+        // The next triangle is the best scored triangle using a cached vertex.
+        best_triangle = -1;
+        float best_score = -1.0f;
+        for (int c = 0; c < cache_size; ++c) {
+            unsigned int v = cache[c];
+            const unsigned int* triangles = vertex_triangles.data() + vertex_triangle_offsets[v];
+            for (unsigned int j = 0; j < remaining_triangle_counts[v]; ++j)
+                if (triangle_scores[triangles[j]] > best_score) {
+                    best_score = triangle_scores[triangles[j]];
+                    best_triangle = triangles[j];
+                }
+        }
+    }
+
+    std::copy(optimized_primitives.begin(), optimized_primitives.end(), primitives);
+    Meshes::flag_geometry_updated(mesh_ID);
+}
+
+template <typename T>
+static inline void remap_vertex_buffer(T* buffer, const std::vector<unsigned int>& vertex_remapping) {
+    if (buffer == nullptr)
+        return;
+    std::vector<T> remapped_buffer(vertex_remapping.size());
+    for (unsigned int v = 0; v < vertex_remapping.size(); ++v)
+        remapped_buffer[vertex_remapping[v]] = buffer[v];
+    std::copy(remapped_buffer.begin(), remapped_buffer.end(), buffer);
+}
+
+void optimize_vertex_fetch(Meshes::UID mesh_ID) {
+    Mesh mesh = mesh_ID;
+    unsigned int vertex_count = mesh.get_vertex_count();
+    unsigned int* indices = mesh.get_indices();
+
+    // Assign new vertex indices in order of first use, followed by the unused vertices.
+    const unsigned int UNUSED_VERTEX = 0xFFFFFFFFu;
+    std::vector<unsigned int> vertex_remapping(vertex_count, UNUSED_VERTEX);
+    unsigned int next_vertex_index = 0;
+    for (unsigned int i = 0; i < mesh.get_index_count(); ++i)
+        if (vertex_remapping[indices[i]] == UNUSED_VERTEX)
+            vertex_remapping[indices[i]] = next_vertex_index++;
+    for (unsigned int& vertex_index : vertex_remapping)
+        if (vertex_index == UNUSED_VERTEX)
+            vertex_index = next_vertex_index++;
+
+    for (unsigned int i = 0; i < mesh.get_index_count(); ++i)
+        indices[i] = vertex_remapping[indices[i]];
+    remap_vertex_buffer(mesh.get_positions(), vertex_remapping);
+    remap_vertex_buffer(mesh.get_normals(), vertex_remapping);
+    remap_vertex_buffer(mesh.get_texcoords(), vertex_remapping);
+    remap_vertex_buffer(mesh.get_quantized_positions(), vertex_remapping);
+    remap_vertex_buffer(mesh.get_octahedral_normals(), vertex_remapping);
+    remap_vertex_buffer(mesh.get_half_texcoords(), vertex_remapping);
+    Meshes::flag_geometry_updated(mesh_ID);
+}
+
+//-------------------------------------------------------------------------
+// Vertex welding.
+//-------------------------------------------------------------------------
+
+// Moves the vertices that are their own representative to their remapped index.
+// The remapped indices never exceed the original indices, so the vertices can be moved in place.
+template <typename T>
+static inline void compact_vertex_buffer(T* buffer, const std::vector<unsigned int>& representatives,
+                                         const std::vector<unsigned int>& vertex_remapping) {
+    if (buffer == nullptr)
+        return;
+    for (unsigned int v = 0; v < representatives.size(); ++v)
+        if (representatives[v] == v)
+            buffer[vertex_remapping[v]] = buffer[v];
+}
+
+unsigned int weld_vertices(Meshes::UID mesh_ID, float epsilon) {
+    Mesh mesh = mesh_ID;
+    unsigned int vertex_count = mesh.get_vertex_count();
+    MeshFlags flags = mesh.get_flags();
+    if (vertex_count == 0 || !flags.is_set(MeshFlag::Position))
+        return 0;
+    bool has_normals = flags.is_set(MeshFlag::Normal);
+    bool has_texcoords = flags.is_set(MeshFlag::Texcoord);
+
+    // Decode the attributes, so compressed vertices are compared by their decoded values.
+    std::vector<Vector3f> positions(vertex_count);
+    std::vector<Vector3f> normals(has_normals ? vertex_count : 0);
+    std::vector<Vector2f> texcoords(has_texcoords ? vertex_count : 0);
+    Core::Parallel::for_each_chunk(0, (int)vertex_count, [&](int begin, int end) {
+        Meshes::decode_positions(mesh_ID, begin, end - begin, positions.data() + begin);
+        if (has_normals)
+            Meshes::decode_normals(mesh_ID, begin, end - begin, normals.data() + begin);
+        if (has_texcoords)
+            Meshes::decode_texcoords(mesh_ID, begin, end - begin, texcoords.data() + begin);
+    }, 16384);
+
+    // The positions are hashed by the cell of size 2 * epsilon that contains them, so the epsilon
+    // neighbourhood of a position overlaps at most two cells along every axis.
+    // Without an epsilon the positions are hashed by their exact value.
+    float cell_size = 2.0f * epsilon;
+    auto cell_coordinate = [=](float p) -> int {
+        if (epsilon > 0.0f)
+            return (int)clamp(std::floor(p / cell_size), -1e9f, 1e9f);
+        float unsigned_zero_p = p + 0.0f; // Hash -0 as +0.
+        int bits;
+        memcpy(&bits, &unsigned_zero_p, sizeof(bits));
+        return bits;
+    };
+
+    unsigned int bucket_count = 1;
+    while (bucket_count < vertex_count)
+        bucket_count *= 2;
+    auto bucket_index = [=](int x, int y, int z) -> unsigned int {
+        return RNG::teschner_hash(x, y, z) & (bucket_count - 1);
+    };
+
+    // Sort the vertices into the buckets by counting them, reserving a range pr bucket and then scattering
+    // the vertices into the ranges. The order of the vertices inside a bucket doesn't matter.
+    // After scattering, bucket b contains the vertices in [bucket_offsets[b], bucket_offsets[b + 1][.
+    std::vector<unsigned int> vertex_buckets(vertex_count);
+    std::unique_ptr<std::atomic<unsigned int>[]> bucket_offsets(new std::atomic<unsigned int>[bucket_count + 1]);
+    Core::Parallel::for_each(0, (int)bucket_count + 1, [&](int b) { bucket_offsets[b].store(0, std::memory_order_relaxed); }, 16384);
+    Core::Parallel::for_each(0, (int)vertex_count, [&](int v) {
+        Vector3f position = positions[v];
+        unsigned int bucket = bucket_index(cell_coordinate(position.x), cell_coordinate(position.y), cell_coordinate(position.z));
+        vertex_buckets[v] = bucket;
+        bucket_offsets[bucket + 1].fetch_add(1, std::memory_order_relaxed);
+    }, 16384);
+
+    unsigned int bucket_begin = 0;
+    for (unsigned int b = 0; b < bucket_count; ++b) {
+        unsigned int bucket_size = bucket_offsets[b + 1].load(std::memory_order_relaxed);
+        bucket_offsets[b + 1].store(bucket_begin, std::memory_order_relaxed);
+        bucket_begin += bucket_size;
+    }
+
+    std::vector<unsigned int> bucket_vertices(vertex_count);
+    Core::Parallel::for_each(0, (int)vertex_count, [&](int v) {
+        unsigned int bucket_vertex_index = bucket_offsets[vertex_buckets[v] + 1].fetch_add(1, std::memory_order_relaxed);
+        bucket_vertices[bucket_vertex_index] = v;
+    }, 16384);
+
+    // Find the first vertex that each vertex matches by searching the buckets of the cells overlapping its epsilon neighbourhood.
+    auto matches = [&](unsigned int v0, unsigned int v1) -> bool {
+        for (int a = 0; a < 3; ++a)
+            if (!(std::abs(positions[v0][a] - positions[v1][a]) <= epsilon))
+                return false;
+        if (has_normals)
+            for (int a = 0; a < 3; ++a)
+                if (!(std::abs(normals[v0][a] - normals[v1][a]) <= epsilon))
+                    return false;
+        if (has_texcoords)
+            for (int a = 0; a < 2; ++a)
+                if (!(std::abs(texcoords[v0][a] - texcoords[v1][a]) <= epsilon))
+                    return false;
+        return true;
+    };
+
+    std::vector<unsigned int> representatives(vertex_count);
+    Core::Parallel::for_each(0, (int)vertex_count, [&](int v) {
+        Vector3f position = positions[v];
+        Vector3i min_cell = Vector3i(cell_coordinate(position.x - epsilon), cell_coordinate(position.y - epsilon), cell_coordinate(position.z - epsilon));
+        Vector3i max_cell = Vector3i(cell_coordinate(position.x + epsilon), cell_coordinate(position.y + epsilon), cell_coordinate(position.z + epsilon));
+
+        unsigned int representative = v;
+        for (int z = min_cell.z; z <= max_cell.z; ++z)
+            for (int y = min_cell.y; y <= max_cell.y; ++y)
+                for (int x = min_cell.x; x <= max_cell.x; ++x) {
+                    unsigned int bucket = bucket_index(x, y, z);
+                    unsigned int bucket_end = bucket_offsets[bucket + 1].load(std::memory_order_relaxed);
+                    for (unsigned int i = bucket_offsets[bucket].load(std::memory_order_relaxed); i < bucket_end; ++i) {
+                        unsigned int candidate = bucket_vertices[i];
+                        if (candidate < representative && matches(candidate, v))
+                            representative = candidate;
+                    }
+                }
+        representatives[v] = representative;
+    }, 4096);
+
+    // Resolve the representatives in vertex order, as a representative always precedes its vertices,
+    // and assign new indices to the representatives in their current order.
+    // A vertex whose representative was merged itself follows it only if it also matches the final
+    // representative, otherwise it is kept, so vertices are never merged transitively.
+    std::vector<unsigned int> vertex_remapping(vertex_count);
+    unsigned int welded_vertex_count = 0;
+    for (unsigned int v = 0; v < vertex_count; ++v) {
+        unsigned int representative = representatives[representatives[v]];
+        representatives[v] = representative == representatives[v] || matches(representative, v) ? representative : v;
+        vertex_remapping[v] = representatives[v] == v ? welded_vertex_count++ : vertex_remapping[representatives[v]];
+    }
+    if (welded_vertex_count == vertex_count)
+        return 0;
+
+    Vector3ui* primitives = mesh.get_primitives();
+    unsigned int primitive_count = mesh.get_primitive_count();
+    Core::Parallel::for_each(0, (int)primitive_count, [&](int p) {
+        Vector3ui& primitive = primitives[p];
+        primitive = Vector3ui(vertex_remapping[primitive.x], vertex_remapping[primitive.y], vertex_remapping[primitive.z]);
+    }, 16384);
+
+    // Exactly equal vertices only collapse triangles that were already degenerate, but an epsilon can collapse
+    // small triangles, which are removed in order.
+    if (epsilon > 0.0f) {
+        unsigned int welded_primitive_count = 0;
+        for (unsigned int p = 0; p < primitive_count; ++p) {
+            Vector3ui primitive = primitives[p];
+            if (primitive.x != primitive.y && primitive.y != primitive.z && primitive.z != primitive.x)
+                primitives[welded_primitive_count++] = primitive;
+        }
+        mesh.set_primitive_count(welded_primitive_count);
+    }
+    compact_vertex_buffer(mesh.get_positions(), representatives, vertex_remapping);
+    compact_vertex_buffer(mesh.get_normals(), representatives, vertex_remapping);
+    compact_vertex_buffer(mesh.get_texcoords(), representatives, vertex_remapping);
+    compact_vertex_buffer(mesh.get_quantized_positions(), representatives, vertex_remapping);
+    compact_vertex_buffer(mesh.get_octahedral_normals(), representatives, vertex_remapping);
+    compact_vertex_buffer(mesh.get_half_texcoords(), representatives, vertex_remapping);
+    mesh.set_vertex_count(welded_vertex_count);
+
+    // Removed vertices can have been on the boundary of the mesh when welding with an epsilon.
+    if (epsilon > 0.0f)
+        mesh.compute_bounds();
+
+    return vertex_count - welded_vertex_count;
 }
 
 } // NS MeshUtils
@@ -318,25 +1053,25 @@ unsigned int normals_correspond_to_winding_order(Meshes::UID mesh_ID) {
     unsigned int failed_primitives = 0;
 
     for (Vector3ui primitive : mesh.get_primitive_iterable()) {
-        Vector3f v0 = mesh.get_positions()[primitive.x];
-        Vector3f v1 = mesh.get_positions()[primitive.y];
-        Vector3f v2 = mesh.get_positions()[primitive.z];
+        Vector3f v0 = mesh.get_position(primitive.x);
+        Vector3f v1 = mesh.get_position(primitive.y);
+        Vector3f v2 = mesh.get_position(primitive.z);
         Vector3f primitive_normal = cross(v1 - v0, v2 - v0); // Not normalized, as we only care about the sign of the dot product below.
 
         bool primitive_failed = false;
-        Vector3f n0 = mesh.get_normals()[primitive.x];
+        Vector3f n0 = mesh.get_normal(primitive.x);
         if (dot(primitive_normal, n0) <= 0.0f) {
             // error_callback(mesh_ID, primitive_index, primitive.x);
             primitive_failed = true;
         }
 
-        Vector3f n1 = mesh.get_normals()[primitive.y];
+        Vector3f n1 = mesh.get_normal(primitive.y);
         if (dot(primitive_normal, n1) <= 0.0f) {
             // error_callback(mesh_ID, primitive_index, primitive.x);
             primitive_failed = true;
         }
 
-        Vector3f n2 = mesh.get_normals()[primitive.z];
+        Vector3f n2 = mesh.get_normal(primitive.z);
         if (dot(primitive_normal, n2) <= 0.0f) {
             // error_callback(mesh_ID, primitive_index, primitive.x);
             primitive_failed = true;
@@ -357,9 +1092,9 @@ unsigned int count_degenerate_primitives(Meshes::UID mesh_ID, float epsilon_squa
         bool degenerate_indices = primitive.x == primitive.y ||
                                   primitive.x == primitive.z ||
                                   primitive.y == primitive.z;
-        Vector3f p0 = mesh.get_positions()[primitive.x];
-        Vector3f p1 = mesh.get_positions()[primitive.y];
-        Vector3f p2 = mesh.get_positions()[primitive.z];
+        Vector3f p0 = mesh.get_position(primitive.x);
+        Vector3f p1 = mesh.get_position(primitive.y);
+        Vector3f p2 = mesh.get_position(primitive.z);
         bool degenerate_positions = magnitude_squared(p0 - p1) < epsilon_squared ||
                                     magnitude_squared(p0 - p2) < epsilon_squared ||
                                     magnitude_squared(p1 - p2) < epsilon_squared;
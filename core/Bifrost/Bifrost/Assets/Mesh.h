@@ -12,26 +12,47 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/AABB.h>
+#include <Bifrost/Math/half.h>
 #include <Bifrost/Math/Matrix.h>
+#include <Bifrost/Math/OctahedralNormal.h>
 #include <Bifrost/Math/Transform.h>
 #include <Bifrost/Math/Vector.h>
 
+#include <memory>
+#include <vector>
+
 namespace Bifrost {
 namespace Assets {
 
+class MeshBVH;
+
 enum class MeshFlag : unsigned char {
     None       = 0u,
     Position   = 1u << 0u,
     Normal     = 1u << 1u,
     Texcoord   = 1u << 2u,
-    AllBuffers = Position | Normal | Texcoord
+    AllBuffers = Position | Normal | Texcoord,
+
+    // Compressed storage of the buffers. Each storage flag implies its buffer.
+    QuantizedPosition = 1u << 3u, // 16 bit fixed point positions relative to the mesh' position quantization.
+    OctahedralNormal  = 1u << 4u, // 32 bit octahedral encoded normals.
+    HalfTexcoord      = 1u << 5u, // Half precision texcoords.
+    Compressed = QuantizedPosition | OctahedralNormal | HalfTexcoord
 };
 typedef Core::Bitmask<MeshFlag> MeshFlags;
 
 //----------------------------------------------------------------------------
 // Container for mesh properties and their bufers.
+// The vertex buffers are either stored as floats or compressed as given by
+// the storage flags in MeshFlag::Compressed. The float buffers are nullptr
+// when the buffer is compressed and the compressed buffers are accessed
+// through get_quantized_positions, get_octahedral_normals and
+// get_half_texcoords. Independently of the storage, vertex attributes can be
+// decoded one at a time, e.g. get_position, or in bulk, e.g. decode_positions.
 // Future work:
 // * Verify that creating and destroying meshes don't leak!
 // * Array access functions should probably map the data as read- or writable
@@ -43,7 +64,35 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static inline bool is_allocated() { return m_buffers != nullptr; }
+    typedef Math::Vector3<unsigned short> QuantizedPosition;
+    typedef Math::Vector2<half_float::half> HalfTexcoord;
+
+    // Maps quantized positions to positions as origin + quantized_position * scale.
+    struct PositionQuantization {
+        Math::Vector3f origin;
+        Math::Vector3f scale;
+
+        // Quantization of the positions inside the bounds with the full 16 bit range along every axis.
+        static inline PositionQuantization from_bounds(Math::AABB bounds) {
+            PositionQuantization quantization = { bounds.minimum, bounds.size() / 65535.0f };
+            return quantization;
+        }
+
+        inline Math::Vector3f decode(QuantizedPosition quantized_position) const {
+            return origin + Math::Vector3f(quantized_position) * scale;
+        }
+
+        inline QuantizedPosition encode(Math::Vector3f position) const {
+            QuantizedPosition quantized_position;
+            for (int a = 0; a < 3; ++a) {
+                float normalized_position = scale[a] > 0.0f ? (position[a] - origin[a]) / scale[a] : 0.0f;
+                quantized_position[a] = (unsigned short)Math::clamp(normalized_position + 0.5f, 0.0f, 65535.0f);
+            }
+            return quantized_position;
+        }
+    };
+
+    static inline bool is_allocated() { return m_buffers.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -51,6 +100,8 @@ public:
     static void reserve(unsigned int new_capacity);
     static inline bool has(Meshes::UID mesh_ID) { return m_UID_generator.has(mesh_ID); }
 
+    // Creates a mesh with the buffers in the bitmask. Buffers with a storage flag are created compressed
+    // and must be filled through the compressed buffer accessors.
     static Meshes::UID create(const std::string& name, unsigned int primitive_count, unsigned int vertex_count, MeshFlags buffer_bitmask = MeshFlag::AllBuffers);
     static void destroy(Meshes::UID mesh_ID);
 
@@ -66,6 +117,7 @@ public:
     static inline unsigned int get_index_count(Meshes::UID mesh_ID) { return get_primitive_count(mesh_ID) * 3; }
     static inline unsigned int* get_indices(Meshes::UID mesh_ID) { return (unsigned int*)(void*)get_primitives(mesh_ID); }
 
+    static inline MeshFlags get_flags(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].flags; }
     static inline unsigned int get_vertex_count(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].vertex_count; }
     static inline Math::Vector3f* get_positions(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].positions; }
     static inline Math::Vector3f* get_normals(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].normals; }
@@ -74,6 +126,91 @@ public:
     static inline void set_bounds(Meshes::UID mesh_ID, Math::AABB bounds) { m_bounds[mesh_ID] = bounds; }
     static Math::AABB compute_bounds(Meshes::UID mesh_ID);
 
+    // Resizes the vertex buffers in their current storage. The first vertices are kept and added vertices are uninitialized.
+    static void set_vertex_count(Meshes::UID mesh_ID, unsigned int vertex_count);
+    // Resizes the primitive buffer. The first primitives are kept and added primitives are uninitialized.
+    static void set_primitive_count(Meshes::UID mesh_ID, unsigned int primitive_count);
+
+    //-------------------------------------------------------------------------
+    // Compressed vertex buffers.
+    //-------------------------------------------------------------------------
+    static inline QuantizedPosition* get_quantized_positions(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].quantized_positions; }
+    static inline Math::OctahedralNormal* get_octahedral_normals(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].octahedral_normals; }
+    static inline HalfTexcoord* get_half_texcoords(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].half_texcoords; }
+    static inline PositionQuantization get_position_quantization(Meshes::UID mesh_ID) { return m_buffers[mesh_ID].position_quantization; }
+    static inline void set_position_quantization(Meshes::UID mesh_ID, PositionQuantization quantization) { m_buffers[mesh_ID].position_quantization = quantization; }
+
+    // Converts the vertex buffers to the storage given by the storage flags in the compression bitmask,
+    // compressing or decompressing the buffers as needed. Positions are quantized against their bounds.
+    static void set_compression(Meshes::UID mesh_ID, MeshFlags compression);
+
+    // The vertex buffer in its storage format, e.g. for serialization. Nullptr if the mesh doesn't have the buffer.
+    // The buffer is given by MeshFlag::Position, MeshFlag::Normal or MeshFlag::Texcoord.
+    static void* get_buffer_data(Meshes::UID mesh_ID, MeshFlag buffer);
+    static size_t get_buffer_size(Meshes::UID mesh_ID, MeshFlag buffer);
+
+    //-------------------------------------------------------------------------
+    // Decoding of vertex attributes independently of their storage.
+    // The mesh must have the buffer.
+    //-------------------------------------------------------------------------
+    static inline Math::Vector3f get_position(Meshes::UID mesh_ID, unsigned int vertex_index) {
+        const Buffers& buffers = m_buffers[mesh_ID];
+        if (buffers.positions != nullptr)
+            return buffers.positions[vertex_index];
+        return buffers.position_quantization.decode(buffers.quantized_positions[vertex_index]);
+    }
+    static inline Math::Vector3f get_normal(Meshes::UID mesh_ID, unsigned int vertex_index) {
+        const Buffers& buffers = m_buffers[mesh_ID];
+        if (buffers.normals != nullptr)
+            return buffers.normals[vertex_index];
+        return buffers.octahedral_normals[vertex_index].decode();
+    }
+    static inline Math::Vector2f get_texcoord(Meshes::UID mesh_ID, unsigned int vertex_index) {
+        const Buffers& buffers = m_buffers[mesh_ID];
+        if (buffers.texcoords != nullptr)
+            return buffers.texcoords[vertex_index];
+        return Math::Vector2f(buffers.half_texcoords[vertex_index]);
+    }
+
+    // Decodes the attributes of the vertices in [first_vertex, first_vertex + vertex_count[ into the output array.
+    // Compressed buffers are decoded four vertices at a time with SSE2 when available.
+    static void decode_positions(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Math::Vector3f* positions);
+    static void decode_normals(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Math::Vector3f* normals);
+    static void decode_texcoords(Meshes::UID mesh_ID, unsigned int first_vertex, unsigned int vertex_count, Math::Vector2f* texcoords);
+
+    //-------------------------------------------------------------------------
+    // Cached bounding volume hierarchy.
+    // The hierarchy built by MeshUtils::build_BVH is cached with the mesh and
+    // released when the mesh is destroyed or its geometry flagged as updated.
+    // The cache can be accessed from multiple threads.
+    //-------------------------------------------------------------------------
+    static std::shared_ptr<const MeshBVH> get_cached_BVH(Meshes::UID mesh_ID) { return std::atomic_load(&m_BVHs[mesh_ID]); }
+    // Caches the hierarchy unless another hierarchy is already cached and returns the cached hierarchy.
+    static std::shared_ptr<const MeshBVH> cache_BVH(Meshes::UID mesh_ID, std::shared_ptr<const MeshBVH> BVH);
+
+    //-------------------------------------------------------------------------
+    // Level of detail chain.
+    // A mesh can hold a chain of simplified versions of itself, ordered from
+    // the finest to the coarsest level, e.g. built by MeshUtils::build_LOD_chain.
+    // The chain owns its levels. They are destroyed with the mesh or when the
+    // chain is replaced and must not be destroyed directly.
+    // The levels are not updated when the geometry of the mesh changes.
+    //-------------------------------------------------------------------------
+    struct LOD {
+        Meshes::UID mesh_ID;
+        float error; // Estimate of the mesh space distance between the level and the mesh.
+    };
+    static inline const std::vector<LOD>& get_LOD_chain(Meshes::UID mesh_ID) { return m_LOD_chains[mesh_ID]; }
+    // Replaces the chain and destroys the levels of the previous chain that aren't in the new chain.
+    static void set_LOD_chain(Meshes::UID mesh_ID, std::vector<LOD> LOD_chain);
+
+    //-------------------------------------------------------------------------
+    // Memory usage.
+    // The levels of a mesh's LOD chain are meshes and report their own usage.
+    //-------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(Meshes::UID mesh_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //-------------------------------------------------------------------------
     // Changes since last game loop tick.
     //-------------------------------------------------------------------------
@@ -81,15 +218,26 @@ public:
         None = 0u,
         Created = 1u << 0u,
         Destroyed = 1u << 1u,
-        All = Created | Destroyed,
+        GeometryUpdated = 1u << 2u,
+        All = Created | Destroyed | GeometryUpdated,
     };
     typedef Core::Bitmask<Change> Changes;
 
     static inline Changes get_changes(Meshes::UID mesh_ID) { return m_changes.get_changes(mesh_ID); }
 
+    // Flags that the primitives or positions of the mesh have been written to and releases its cached hierarchy.
+    static void flag_geometry_updated(Meshes::UID mesh_ID);
+
     typedef std::vector<UID>::iterator ChangedIterator;
     static inline Core::Iterable<ChangedIterator> get_changed_meshes() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -98,18 +246,26 @@ private:
     struct Buffers {
         unsigned int primitive_count;
         unsigned int vertex_count;
+        MeshFlags flags;
 
         Math::Vector3ui* primitives;
         Math::Vector3f* positions;
         Math::Vector3f* normals;
         Math::Vector2f* texcoords;
+
+        QuantizedPosition* quantized_positions;
+        Math::OctahedralNormal* octahedral_normals;
+        HalfTexcoord* half_texcoords;
+        PositionQuantization position_quantization;
     };
 
     static UIDGenerator m_UID_generator;
-    static std::string* m_names;
+    static Core::ReservedArray<std::string> m_names;
 
-    static Buffers* m_buffers;
-    static Math::AABB* m_bounds;
+    static Core::ReservedArray<Buffers> m_buffers;
+    static Core::ReservedArray<Math::AABB> m_bounds;
+    static Core::ReservedArray<std::shared_ptr<const MeshBVH>> m_BVHs;
+    static Core::ReservedArray<std::vector<LOD>> m_LOD_chains;
 
     static Core::ChangeSet<Changes, UID> m_changes;
 };
@@ -152,15 +308,27 @@ public:
     inline void set_bounds(Math::AABB bounds) { Meshes::set_bounds(m_ID, bounds); }
 
     inline Math::AABB compute_bounds() { return Meshes::compute_bounds(m_ID); }
+    inline void set_vertex_count(unsigned int vertex_count) { Meshes::set_vertex_count(m_ID, vertex_count); }
+    inline void set_primitive_count(unsigned int primitive_count) { Meshes::set_primitive_count(m_ID, primitive_count); }
 
-    inline MeshFlags get_flags() {
-        MeshFlags mesh_flags = get_positions() ? MeshFlag::Position : MeshFlag::None;
-        mesh_flags |= get_normals() ? MeshFlag::Normal : MeshFlag::None;
-        mesh_flags |= get_texcoords() ? MeshFlag::Texcoord : MeshFlag::None;
-        return mesh_flags;
-    }
+    inline MeshFlags get_flags() { return Meshes::get_flags(m_ID); }
+
+    inline Meshes::QuantizedPosition* get_quantized_positions() { return Meshes::get_quantized_positions(m_ID); }
+    inline Math::OctahedralNormal* get_octahedral_normals() { return Meshes::get_octahedral_normals(m_ID); }
+    inline Meshes::HalfTexcoord* get_half_texcoords() { return Meshes::get_half_texcoords(m_ID); }
+    inline void set_compression(MeshFlags compression) { Meshes::set_compression(m_ID, compression); }
+
+    inline Math::Vector3f get_position(unsigned int vertex_index) { return Meshes::get_position(m_ID, vertex_index); }
+    inline Math::Vector3f get_normal(unsigned int vertex_index) { return Meshes::get_normal(m_ID, vertex_index); }
+    inline Math::Vector2f get_texcoord(unsigned int vertex_index) { return Meshes::get_texcoord(m_ID, vertex_index); }
+    inline void decode_positions(unsigned int first_vertex, unsigned int vertex_count, Math::Vector3f* positions) { Meshes::decode_positions(m_ID, first_vertex, vertex_count, positions); }
+    inline void decode_normals(unsigned int first_vertex, unsigned int vertex_count, Math::Vector3f* normals) { Meshes::decode_normals(m_ID, first_vertex, vertex_count, normals); }
+    inline void decode_texcoords(unsigned int first_vertex, unsigned int vertex_count, Math::Vector2f* texcoords) { Meshes::decode_texcoords(m_ID, first_vertex, vertex_count, texcoords); }
+
+    inline const std::vector<Meshes::LOD>& get_LOD_chain() const { return Meshes::get_LOD_chain(m_ID); }
 
     inline Meshes::Changes get_changes() { return Meshes::get_changes(m_ID); }
+    inline void flag_geometry_updated() { Meshes::flag_geometry_updated(m_ID); }
 
 private:
     const Meshes::UID m_ID;
@@ -169,8 +337,6 @@ private:
 //----------------------------------------------------------------------------
 // Mesh utilities.
 // Future work:
-// * Forsyth index sorting. https://code.google.com/archive/p/vcacne/
-// * What about vertex sorting? Base it on a morton curve or order of appearance in the index array.
 // * Utility function for computing tangents and normals on bump mapped surfaces. Possibly splitting the mesh.
 //----------------------------------------------------------------------------
 namespace MeshUtils {
@@ -211,6 +377,43 @@ void compute_normals(Math::Vector3ui* primitives_begin, Math::Vector3ui* primiti
                      Math::Vector3f* normals_begin, Math::Vector3f* normals_end, Math::Vector3f* positions_begin);
 void compute_normals(Meshes::UID mesh_ID);
 
+//-------------------------------------------------------------------------
+// Vertex cache and vertex fetch optimization.
+//-------------------------------------------------------------------------
+
+// How well the triangle order of a mesh reuses vertices in a simulated FIFO post-transform vertex cache.
+struct VertexCacheStatistics {
+    unsigned int transformed_vertex_count; // The cache misses.
+    float ACMR; // Average cache miss ratio. Vertices transformed pr triangle, 0.5 at best for large regular meshes and 3 at worst.
+    float ATVR; // Average transform to vertex ratio. Vertices transformed pr vertex, 1 at best.
+};
+VertexCacheStatistics compute_vertex_cache_statistics(Meshes::UID mesh_ID, unsigned int cache_size = 16);
+
+// Reorders the triangles to increase post-transform vertex cache hits with Tom Forsyth's Linear-Speed
+// Vertex Cache Optimisation, https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html.
+// The vertex order within each triangle is preserved, so winding order is unaffected.
+void optimize_vertex_cache(Meshes::UID mesh_ID);
+
+// Reorders the vertices in the order the triangles first reference them and remaps the indices,
+// so vertex fetches become close to sequential. Should be done after optimize_vertex_cache.
+// Vertices that aren't referenced by any triangle are moved to the end of the buffers.
+void optimize_vertex_fetch(Meshes::UID mesh_ID);
+
+//-------------------------------------------------------------------------
+// Vertex welding.
+//-------------------------------------------------------------------------
+
+// Merges vertices whose positions, normals and texcoords all differ by at most epsilon pr component,
+// remaps the indices and shrinks the vertex buffers. Vertices that only share their position,
+// e.g. along normal or texcoord seams, are kept apart. Compressed vertices are compared by their
+// decoded attributes and stay compressed.
+// The vertices are found through a spatial hash of their positions, which is built and queried in parallel.
+// A vertex is merged into the first vertex it matches. Matches are not chained, so merged vertices are
+// always within epsilon of the vertex they are merged into. When welding with a positive epsilon,
+// triangles that become degenerate are removed.
+// Returns the number of vertices removed.
+unsigned int weld_vertices(Meshes::UID mesh_ID, float epsilon = 0.0f);
+
 // Expands a buffer and a list of triangle vertex indices into a non-indexed buffer.
 // Useful for expanding meshes that uses indexing into a mesh that does not.
 template <typename RandomAccessIterator>
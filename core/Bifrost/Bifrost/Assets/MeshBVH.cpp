@@ -0,0 +1,177 @@
+// Bifrost bounding volume hierarchy over the triangles of a mesh.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Assets/MeshBVH.h>
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Math/Intersect.h>
+
+#include <algorithm>
+#include <assert.h>
+
+using namespace Bifrost::Math;
+
+namespace Bifrost::Assets {
+
+// The bitmask of the lanes of a triangle block holding the triangles in [first_triangle, end_triangle).
+static inline int get_lane_mask(unsigned int block, unsigned int first_triangle, unsigned int end_triangle) {
+    unsigned int block_first = block * 4;
+    unsigned int begin_lane = std::max(first_triangle, block_first) - block_first;
+    unsigned int end_lane = std::min(end_triangle, block_first + 4) - block_first;
+    return ((1 << end_lane) - 1) & ~((1 << begin_lane) - 1);
+}
+
+MeshBVH::MeshBVH(Meshes::UID mesh_ID) {
+    const Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+    assert(Meshes::get_flags(mesh_ID).is_set(MeshFlag::Position));
+    int primitive_count = (int)Meshes::get_primitive_count(mesh_ID);
+
+    // Compressed positions are decoded for the duration of the build.
+    const Vector3f* positions = Meshes::get_positions(mesh_ID);
+    std::vector<Vector3f> decoded_positions;
+    if (positions == nullptr) {
+        decoded_positions.resize(Meshes::get_vertex_count(mesh_ID));
+        Meshes::decode_positions(mesh_ID, 0, Meshes::get_vertex_count(mesh_ID), decoded_positions.data());
+        positions = decoded_positions.data();
+    }
+
+    std::vector<AABB> primitive_bounds(primitive_count);
+    Core::Parallel::for_each_chunk(0, primitive_count, [&](int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            Vector3ui primitive = primitives[p];
+            AABB bounds = AABB(positions[primitive.x], positions[primitive.x]);
+            bounds.grow_to_contain(positions[primitive.y]);
+            bounds.grow_to_contain(positions[primitive.z]);
+            primitive_bounds[p] = bounds;
+        }
+    }, 4096);
+
+    build_BVH4_SAH(primitive_bounds.data(), primitive_count, MAX_LEAF_SIZE, m_nodes, m_primitive_indices);
+
+    int block_count = (primitive_count + 3) / 4;
+    m_triangles.resize(block_count);
+    Core::Parallel::for_each_chunk(0, block_count, [&](int begin, int end) {
+        for (int b = begin; b < end; ++b)
+            for (int lane = 0; lane < 4; ++lane) {
+                int t = b * 4 + lane;
+                if (t < primitive_count) {
+                    Vector3ui primitive = primitives[m_primitive_indices[t]];
+                    Vector3f vertex0 = positions[primitive.x];
+                    m_triangles[b].set(lane, vertex0, positions[primitive.y] - vertex0, positions[primitive.z] - vertex0);
+                } else
+                    m_triangles[b].set(lane, Vector3f::zero(), Vector3f::zero(), Vector3f::zero());
+            }
+    }, 1024);
+}
+
+size_t MeshBVH::get_allocated_bytes() const {
+    return Core::get_allocated_bytes(m_nodes) + Core::get_allocated_bytes(m_triangles) + Core::get_allocated_bytes(m_primitive_indices);
+}
+
+bool MeshBVH::intersect(Ray ray, float& max_distance, unsigned int& primitive_index, Vector2f& barycentric) const {
+    if (m_nodes.empty())
+        return false;
+
+    int hit_triangle = -1;
+    traverse_BVH4(m_nodes.data(), ray, max_distance, [&](unsigned int first_triangle, unsigned int triangle_count, float& max_distance) -> bool {
+        unsigned int end_triangle = first_triangle + triangle_count;
+        for (unsigned int b = first_triangle / 4; b * 4 < end_triangle; ++b) {
+            float distances[4], us[4], vs[4];
+            int hit_mask = intersect_triangles(ray, m_triangles[b], max_distance, distances, us, vs) & get_lane_mask(b, first_triangle, end_triangle);
+            for (int lane = 0; lane < 4; ++lane)
+                if ((hit_mask & (1 << lane)) && distances[lane] < max_distance) {
+                    max_distance = distances[lane];
+                    barycentric = Vector2f(us[lane], vs[lane]);
+                    hit_triangle = b * 4 + lane;
+                }
+        }
+        return false;
+    });
+
+    if (hit_triangle < 0)
+        return false;
+    primitive_index = m_primitive_indices[hit_triangle];
+    return true;
+}
+
+bool MeshBVH::intersects(Ray ray, float max_distance) const {
+    if (m_nodes.empty())
+        return false;
+
+    bool hit = false;
+    traverse_BVH4(m_nodes.data(), ray, max_distance, [&](unsigned int first_triangle, unsigned int triangle_count, float& max_distance) -> bool {
+        unsigned int end_triangle = first_triangle + triangle_count;
+        for (unsigned int b = first_triangle / 4; b * 4 < end_triangle; ++b) {
+            float distances[4], us[4], vs[4];
+            if (intersect_triangles(ray, m_triangles[b], max_distance, distances, us, vs) & get_lane_mask(b, first_triangle, end_triangle)) {
+                hit = true;
+                return true;
+            }
+        }
+        return false;
+    });
+    return hit;
+}
+
+int MeshBVH::intersect(const RayPacket4& rays, int ray_mask, float* max_distances, unsigned int* primitive_indices, Vector2f* barycentrics) const {
+    if (m_nodes.empty())
+        return 0;
+
+    int hit_ray_mask = 0;
+    traverse_BVH4_packet(m_nodes.data(), rays, ray_mask, max_distances, [&](unsigned int first_triangle, unsigned int triangle_count, int leaf_ray_mask, float* max_distances) -> int {
+        for (unsigned int t = first_triangle; t < first_triangle + triangle_count; ++t) {
+            const Triangle4& block = m_triangles[t / 4];
+            int lane = t % 4;
+            float distances[4], us[4], vs[4];
+            int triangle_ray_mask = leaf_ray_mask & intersect_triangle(rays, block.get_vertex0(lane), block.get_edge1(lane), block.get_edge2(lane), max_distances, distances, us, vs);
+            for (int r = 0; r < 4; ++r)
+                if (triangle_ray_mask & (1 << r)) {
+                    max_distances[r] = distances[r];
+                    primitive_indices[r] = m_primitive_indices[t];
+                    barycentrics[r] = Vector2f(us[r], vs[r]);
+                }
+            hit_ray_mask |= triangle_ray_mask;
+        }
+        return leaf_ray_mask;
+    });
+    return hit_ray_mask;
+}
+
+int MeshBVH::intersects(const RayPacket4& rays, int ray_mask, const float* max_distances) const {
+    if (m_nodes.empty())
+        return 0;
+
+    float traversal_max_distances[4] = { max_distances[0], max_distances[1], max_distances[2], max_distances[3] };
+    int hit_ray_mask = 0;
+    traverse_BVH4_packet(m_nodes.data(), rays, ray_mask, traversal_max_distances, [&](unsigned int first_triangle, unsigned int triangle_count, int leaf_ray_mask, float* max_distances) -> int {
+        for (unsigned int t = first_triangle; t < first_triangle + triangle_count && leaf_ray_mask != 0; ++t) {
+            const Triangle4& block = m_triangles[t / 4];
+            int lane = t % 4;
+            float distances[4], us[4], vs[4];
+            int triangle_ray_mask = leaf_ray_mask & intersect_triangle(rays, block.get_vertex0(lane), block.get_edge1(lane), block.get_edge2(lane), max_distances, distances, us, vs);
+            hit_ray_mask |= triangle_ray_mask;
+            leaf_ray_mask &= ~triangle_ray_mask;
+        }
+        // Rays that hit a triangle are done.
+        return leaf_ray_mask;
+    });
+    return hit_ray_mask;
+}
+
+namespace MeshUtils {
+
+std::shared_ptr<const MeshBVH> build_BVH(Meshes::UID mesh_ID) {
+    std::shared_ptr<const MeshBVH> BVH = Meshes::get_cached_BVH(mesh_ID);
+    if (BVH != nullptr)
+        return BVH;
+    return Meshes::cache_BVH(mesh_ID, std::make_shared<const MeshBVH>(mesh_ID));
+}
+
+} // NS MeshUtils
+
+} // NS Bifrost::Assets
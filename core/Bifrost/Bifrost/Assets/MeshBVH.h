@@ -0,0 +1,82 @@
+// Bifrost bounding volume hierarchy over the triangles of a mesh.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_ASSETS_MESH_BVH_H_
+#define _BIFROST_ASSETS_MESH_BVH_H_
+
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Math/BVH4.h>
+#include <Bifrost/Math/Intersect.h>
+#include <Bifrost/Math/Ray.h>
+
+#include <memory>
+#include <vector>
+
+namespace Bifrost::Assets {
+
+// ------------------------------------------------------------------------------------------------
+// Four wide bounding volume hierarchy over the triangles of a mesh in mesh space.
+// The hierarchy is built with the surface area heuristic. The triangles are copied in hierarchy
+// order as a vertex and two edges into blocks of four, so a leaf is intersected with a few four
+// wide tests and doesn't touch the mesh's index and position buffers.
+// Rays can be traced one at a time or as packets of four coherent rays.
+// The hierarchy is a snapshot of the mesh at construction and has to be rebuilt if the mesh changes.
+// MeshUtils::build_BVH caches the hierarchy with the mesh until its geometry is flagged as updated.
+// Future work
+// * Eight wide nodes and triangle blocks with AVX.
+// * Spatial splits for meshes with long thin triangles.
+// ------------------------------------------------------------------------------------------------
+class MeshBVH final {
+public:
+    static const unsigned int MAX_LEAF_SIZE = 4;
+
+    MeshBVH() = default;
+    // Builds the hierarchy over the triangles of the mesh. Requires the mesh to have positions.
+    explicit MeshBVH(Meshes::UID mesh_ID);
+
+    inline unsigned int get_primitive_count() const { return (unsigned int)m_primitive_indices.size(); }
+    inline unsigned int get_node_count() const { return (unsigned int)m_nodes.size(); }
+    inline Math::AABB get_bounds() const { return m_nodes.empty() ? Math::AABB::invalid() : m_nodes[0].get_bounds(); }
+    size_t get_allocated_bytes() const;
+
+    // Finds the closest triangle hit by the ray within max_distance.
+    // On a hit max_distance is set to the distance to the hit and the index and barycentric coordinates
+    // of the triangle are returned. Triangles are double sided.
+    bool intersect(Math::Ray ray, float& max_distance, unsigned int& primitive_index, Math::Vector2f& barycentric) const;
+
+    // Returns true if any triangle is hit by the ray within max_distance.
+    bool intersects(Math::Ray ray, float max_distance) const;
+
+    // Finds the closest triangles hit by the rays in ray_mask within their max distances.
+    // Returns the bitmask of the rays that hit a triangle and sets their max distances,
+    // primitive indices and barycentric coordinates.
+    int intersect(const Math::RayPacket4& rays, int ray_mask, float* max_distances, unsigned int* primitive_indices, Math::Vector2f* barycentrics) const;
+
+    // Returns the bitmask of the rays in ray_mask that hit any triangle within their max distances.
+    int intersects(const Math::RayPacket4& rays, int ray_mask, const float* max_distances) const;
+
+private:
+    std::vector<Math::BVH4Node> m_nodes;
+
+    // The triangles in hierarchy order in blocks of four and the index of the mesh primitive they were created from.
+    // The last block is padded with degenerate triangles.
+    std::vector<Math::Triangle4> m_triangles;
+    std::vector<unsigned int> m_primitive_indices;
+};
+
+namespace MeshUtils {
+
+// Returns the mesh's cached hierarchy or builds and caches it. Requires the mesh to have positions.
+// Concurrent calls may build the hierarchy more than once, but all return the one cached first.
+std::shared_ptr<const MeshBVH> build_BVH(Meshes::UID mesh_ID);
+
+} // NS MeshUtils
+
+} // NS Bifrost::Assets
+
+#endif // _BIFROST_ASSETS_MESH_BVH_H_
@@ -8,13 +8,16 @@
 
 #include <Bifrost/Assets/MeshModel.h>
 
+#include <algorithm>
 #include <assert.h>
 
 namespace Bifrost {
 namespace Assets {
 
 MeshModels::UIDGenerator MeshModels::m_UID_generator = UIDGenerator(0u);
-MeshModels::Model* MeshModels::m_models = nullptr;
+Core::ReservedArray<MeshModels::Model> MeshModels::m_models;
+Core::ReservedArray<MeshModels::ReferenceLinks> MeshModels::m_reference_links;
+std::vector<unsigned int> MeshModels::m_first_referencing_models[MeshModels::REFERENCE_COUNT];
 Core::ChangeSet<MeshModels::Changes, MeshModels::UID> MeshModels::m_changes;
 
 void MeshModels::allocate(unsigned int capacity) {
@@ -24,11 +27,13 @@ void MeshModels::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_models = new Model[capacity];
+    m_models = Core::ReservedArray<Model>(m_UID_generator.max_capacity(), capacity);
+    m_reference_links = Core::ReservedArray<ReferenceLinks>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
     m_models[0] = { Scene::SceneNodes::UID::invalid_UID(), Meshes::UID::invalid_UID() };
+    m_reference_links[0] = { UID::invalid_UID(), { NO_MODEL, NO_MODEL, NO_MODEL }, { NO_MODEL, NO_MODEL, NO_MODEL } };
 }
 
 void MeshModels::deallocate() {
@@ -36,23 +41,18 @@ void MeshModels::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_models; m_models = nullptr;
+    m_models.release();
+    m_reference_links.release();
+    for (std::vector<unsigned int>& first_models : m_first_referencing_models)
+        first_models = std::vector<unsigned int>();
     m_changes.resize(0);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void MeshModels::reserve_model_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_models != nullptr);
+    assert(m_models.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-    m_models = resize_and_copy_array(m_models, new_capacity, copyable_elements);
+    m_models.resize(new_capacity);
+    m_reference_links.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -62,8 +62,25 @@ void MeshModels::reserve(unsigned int new_capacity) {
     reserve_model_data(m_UID_generator.capacity(), old_capacity);
 }
 
+Core::MemoryUsage MeshModels::get_memory_usage(MeshModels::UID model_ID) {
+    Core::MemoryUsage usage;
+    if (m_UID_generator.has(model_ID))
+        usage[Core::MemoryCategory::Metadata] = sizeof(Model) + sizeof(ReferenceLinks);
+    return usage;
+}
+
+Core::MemoryUsage MeshModels::get_memory_usage() {
+    Core::MemoryUsage usage;
+    usage[Core::MemoryCategory::Metadata] = m_UID_generator.get_allocated_bytes() + Core::get_allocated_bytes(m_models) +
+        Core::get_allocated_bytes(m_reference_links);
+    for (const std::vector<unsigned int>& first_models : m_first_referencing_models)
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(first_models);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 MeshModels::UID MeshModels::create(Scene::SceneNodes::UID scene_node_ID, Meshes::UID mesh_ID, Materials::UID material_ID) {
-    assert(m_models != nullptr);
+    assert(m_models.data() != nullptr);
     assert(Scene::SceneNodes::has(scene_node_ID));
     assert(Meshes::has(mesh_ID));
     assert(Materials::has(material_ID));
@@ -75,23 +92,61 @@ MeshModels::UID MeshModels::create(Scene::SceneNodes::UID scene_node_ID, Meshes:
         reserve_model_data(m_UID_generator.capacity(), old_capacity);
 
     m_models[id] = { scene_node_ID, mesh_ID, material_ID };
+    m_reference_links[id].model_ID = id;
+    link_model(id, get_reference_index(mesh_ID), mesh_ID.get_index());
+    link_model(id, get_reference_index(material_ID), material_ID.get_index());
+    link_model(id, get_reference_index(scene_node_ID), scene_node_ID.get_index());
     m_changes.set_change(id, Change::Created);
 
     return id;
 }
 
 void MeshModels::destroy(MeshModels::UID model_ID) {
-    if (m_UID_generator.erase(model_ID))
+    if (m_UID_generator.erase(model_ID)) {
+        const Model& model = m_models[model_ID];
+        unlink_model(model_ID, get_reference_index(model.mesh_ID), model.mesh_ID.get_index());
+        unlink_model(model_ID, get_reference_index(model.material_ID), model.material_ID.get_index());
+        unlink_model(model_ID, get_reference_index(model.scene_node_ID), model.scene_node_ID.get_index());
         m_changes.add_change(model_ID, Change::Destroyed);
+    }
 }
 
 void MeshModels::set_material_ID(MeshModels::UID model_ID, Materials::UID material_ID) {
     assert(has(model_ID));
     assert(Materials::has(material_ID));
 
+    Materials::UID old_material_ID = m_models[model_ID].material_ID;
+    unlink_model(model_ID, get_reference_index(old_material_ID), old_material_ID.get_index());
+    link_model(model_ID, get_reference_index(material_ID), material_ID.get_index());
+
     m_models[model_ID].material_ID = material_ID;
     m_changes.add_change(model_ID, Change::Material);
 }
 
+void MeshModels::link_model(unsigned int model_index, int reference_index, unsigned int referenced_index) {
+    std::vector<unsigned int>& first_models = m_first_referencing_models[reference_index];
+    if (referenced_index >= first_models.size())
+        first_models.resize(std::max<size_t>(referenced_index + 1, 2 * first_models.size()), NO_MODEL);
+
+    unsigned int next_model_index = first_models[referenced_index];
+    m_reference_links[model_index].next_models[reference_index] = next_model_index;
+    m_reference_links[model_index].previous_models[reference_index] = NO_MODEL;
+    if (next_model_index != NO_MODEL)
+        m_reference_links[next_model_index].previous_models[reference_index] = model_index;
+    first_models[referenced_index] = model_index;
+}
+
+void MeshModels::unlink_model(unsigned int model_index, int reference_index, unsigned int referenced_index) {
+    const ReferenceLinks& links = m_reference_links[model_index];
+    unsigned int next_model_index = links.next_models[reference_index];
+    unsigned int previous_model_index = links.previous_models[reference_index];
+    if (previous_model_index != NO_MODEL)
+        m_reference_links[previous_model_index].next_models[reference_index] = next_model_index;
+    else
+        m_first_referencing_models[reference_index][referenced_index] = next_model_index;
+    if (next_model_index != NO_MODEL)
+        m_reference_links[next_model_index].previous_models[reference_index] = previous_model_index;
+}
+
 } // NS Assets
 } // NS Bifrost
@@ -14,6 +14,8 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Scene/SceneNode.h>
 
@@ -29,7 +31,7 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static bool is_allocated() { return m_models != nullptr; }
+    static bool is_allocated() { return m_models.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -49,6 +51,47 @@ public:
     static inline Materials::UID get_material_ID(MeshModels::UID model_ID) { return m_models[model_ID].material_ID; }
     static void set_material_ID(MeshModels::UID model_ID, Materials::UID material_ID);
 
+    //---------------------------------------------------------------------------------------------
+    // Reverse lookup of the models referencing a mesh, material or scene node.
+    // The models referencing a resource are linked in a list pr resource index, which is updated
+    // when models are created, destroyed or change material. Models still referencing a destroyed
+    // resource whose index has been reused are skipped.
+    // The iterators are invalidated when models are created, destroyed or change material.
+    //---------------------------------------------------------------------------------------------
+    template <typename ReferencedUID>
+    class ReferencingModelIterator final {
+    public:
+        ReferencingModelIterator(unsigned int model_index, ReferencedUID referenced_ID)
+            : m_model_index(model_index), m_referenced_ID(referenced_ID) { skip_other_models(); }
+        inline ReferencingModelIterator& operator++() { m_model_index = get_next_model(m_model_index); skip_other_models(); return *this; }
+        inline ReferencingModelIterator operator++(int) { ReferencingModelIterator tmp(*this); operator++(); return tmp; }
+        inline bool operator==(const ReferencingModelIterator& rhs) const { return m_model_index == rhs.m_model_index; }
+        inline bool operator!=(const ReferencingModelIterator& rhs) const { return m_model_index != rhs.m_model_index; }
+        inline UID operator*() const { return m_reference_links[m_model_index].model_ID; }
+
+    private:
+        inline unsigned int get_next_model(unsigned int model_index) const {
+            return m_reference_links[model_index].next_models[get_reference_index(m_referenced_ID)];
+        }
+        inline void skip_other_models() {
+            while (m_model_index != NO_MODEL && !(get_referenced_ID(m_models[m_model_index], m_referenced_ID) == m_referenced_ID))
+                m_model_index = get_next_model(m_model_index);
+        }
+
+        unsigned int m_model_index;
+        ReferencedUID m_referenced_ID;
+    };
+
+    static Core::Iterable<ReferencingModelIterator<Meshes::UID>> get_models_with_mesh(Meshes::UID mesh_ID) { return get_referencing_models(mesh_ID); }
+    static Core::Iterable<ReferencingModelIterator<Materials::UID>> get_models_with_material(Materials::UID material_ID) { return get_referencing_models(material_ID); }
+    static Core::Iterable<ReferencingModelIterator<Scene::SceneNodes::UID>> get_models_on_scene_node(Scene::SceneNodes::UID node_ID) { return get_referencing_models(node_ID); }
+
+    //---------------------------------------------------------------------------------------------
+    // Memory usage.
+    //---------------------------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(MeshModels::UID model_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //---------------------------------------------------------------------------------------------
     // Changes since last game loop tick.
     //---------------------------------------------------------------------------------------------
@@ -66,6 +109,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_models() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -77,8 +127,40 @@ private:
         Materials::UID material_ID;
     };
 
+    // The lists of models referencing the same mesh, material and scene node.
+    // The dummy model at index 0 terminates the lists.
+    static constexpr unsigned int NO_MODEL = 0u;
+    static constexpr int REFERENCE_COUNT = 3;
+    struct ReferenceLinks final {
+        UID model_ID;
+        unsigned int next_models[REFERENCE_COUNT];
+        unsigned int previous_models[REFERENCE_COUNT];
+    };
+
+    static inline int get_reference_index(Meshes::UID) { return 0; }
+    static inline int get_reference_index(Materials::UID) { return 1; }
+    static inline int get_reference_index(Scene::SceneNodes::UID) { return 2; }
+    static inline Meshes::UID get_referenced_ID(const Model& model, Meshes::UID) { return model.mesh_ID; }
+    static inline Materials::UID get_referenced_ID(const Model& model, Materials::UID) { return model.material_ID; }
+    static inline Scene::SceneNodes::UID get_referenced_ID(const Model& model, Scene::SceneNodes::UID) { return model.scene_node_ID; }
+
+    template <typename ReferencedUID>
+    static inline Core::Iterable<ReferencingModelIterator<ReferencedUID>> get_referencing_models(ReferencedUID referenced_ID) {
+        const std::vector<unsigned int>& first_models = m_first_referencing_models[get_reference_index(referenced_ID)];
+        unsigned int referenced_index = referenced_ID.get_index();
+        unsigned int first_model = referenced_index < first_models.size() ? first_models[referenced_index] : NO_MODEL;
+        return Core::Iterable<ReferencingModelIterator<ReferencedUID>>(ReferencingModelIterator<ReferencedUID>(first_model, referenced_ID),
+                                                                       ReferencingModelIterator<ReferencedUID>(NO_MODEL, referenced_ID));
+    }
+
+    static void link_model(unsigned int model_index, int reference_index, unsigned int referenced_index);
+    static void unlink_model(unsigned int model_index, int reference_index, unsigned int referenced_index);
+
     static UIDGenerator m_UID_generator;
-    static Model* m_models;
+    static Core::ReservedArray<Model> m_models;
+    static Core::ReservedArray<ReferenceLinks> m_reference_links;
+    // The first model referencing a mesh, material and scene node, indexed by the referenced resource's index.
+    static std::vector<unsigned int> m_first_referencing_models[REFERENCE_COUNT];
     static Core::ChangeSet<Changes, UID> m_changes;
 };
 
@@ -0,0 +1,557 @@
+// Bifrost mesh simplification and level of detail chains.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Assets/MeshSimplification.h>
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Math/RNG.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Bifrost::Math;
+
+namespace Bifrost::Assets {
+namespace MeshUtils {
+
+static const unsigned int NO_VERTEX = 0xFFFFFFFFu;
+static const float MAX_TRIANGLE_ROTATION_COS = 0.5f;
+
+// ------------------------------------------------------------------------------------------------
+// Sum of weighted squared distances to a set of planes, stored as the upper triangle of the
+// symmetric matrix A, the vector b and the scalar c in p^T A p + 2 b^T p + c.
+// ------------------------------------------------------------------------------------------------
+struct Quadric final {
+    float a00, a11, a22, a10, a20, a21;
+    float b0, b1, b2;
+    float c;
+    float weight;
+
+    static inline Quadric zero() {
+        Quadric quadric = {};
+        return quadric;
+    }
+
+    // The plane is given by its unit normal and distance, dot(normal, p) + distance = 0.
+    static inline Quadric from_plane(Vector3f normal, float distance, float weight) {
+        Quadric quadric;
+        quadric.a00 = weight * normal.x * normal.x;
+        quadric.a11 = weight * normal.y * normal.y;
+        quadric.a22 = weight * normal.z * normal.z;
+        quadric.a10 = weight * normal.y * normal.x;
+        quadric.a20 = weight * normal.z * normal.x;
+        quadric.a21 = weight * normal.z * normal.y;
+        quadric.b0 = weight * normal.x * distance;
+        quadric.b1 = weight * normal.y * distance;
+        quadric.b2 = weight * normal.z * distance;
+        quadric.c = weight * distance * distance;
+        quadric.weight = weight;
+        return quadric;
+    }
+
+    inline Quadric& operator+=(const Quadric& rhs) {
+        a00 += rhs.a00; a11 += rhs.a11; a22 += rhs.a22;
+        a10 += rhs.a10; a20 += rhs.a20; a21 += rhs.a21;
+        b0 += rhs.b0; b1 += rhs.b1; b2 += rhs.b2;
+        c += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    // The weighted mean of the squared distances from the point to the planes.
+    inline float error(Vector3f p) const {
+        float rx = a00 * p.x + a10 * p.y + a20 * p.z;
+        float ry = a10 * p.x + a11 * p.y + a21 * p.z;
+        float rz = a20 * p.x + a21 * p.y + a22 * p.z;
+        float r = rx * p.x + ry * p.y + rz * p.z + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return weight > 0.0f ? std::abs(r) / weight : 0.0f;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Quadric error edge collapse simplifier.
+// Vertices sharing a position are split by attribute seams. The first vertex with a position
+// represents it and holds the position's quadric. Every vertex is classified by the open edges
+// around it, i.e. edges without a twin in the opposite direction, which decides the edges it can
+// collapse along. The collapses are performed in passes. Every pass sorts the possible collapses
+// by their error and performs the cheapest ones that don't flip a triangle or touch a triangle
+// already changed in the pass.
+// The simplifier can be called repeatedly with decreasing targets to build levels of detail, in
+// which case the errors of the later levels are still relative to the source mesh.
+// See also Arseny Kapoulkine's meshoptimizer, https://github.com/zeux/meshoptimizer.
+// ------------------------------------------------------------------------------------------------
+class QuadricSimplifier final {
+public:
+    explicit QuadricSimplifier(Meshes::UID mesh_ID);
+
+    // Collapses edges until at most target_triangle_count triangles are left or the next collapse
+    // would have an error above the target.
+    void simplify(unsigned int target_triangle_count, float target_error);
+
+    inline unsigned int get_triangle_count() const { return (unsigned int)m_indices.size() / 3; }
+    inline const std::vector<unsigned int>& get_indices() const { return m_indices; }
+    // The largest error of the collapses performed so far in mesh space.
+    inline float get_error() const { return std::sqrt(m_max_error) * m_scale; }
+
+private:
+    enum class VertexKind : unsigned char {
+        Manifold, // A single vertex at its position and no open edges.
+        Border,   // A single vertex at its position on one border loop.
+        Seam,     // Two vertices at their position, split by one seam.
+        Locked,   // Everything else, e.g. corners where seams or borders meet.
+    };
+
+    struct Collapse {
+        unsigned int from_vertex;
+        unsigned int to_vertex;
+        float error;
+    };
+
+    bool can_collapse(unsigned int from_vertex, unsigned int to_vertex) const;
+    bool has_triangle_flips(unsigned int from_position, unsigned int to_position) const;
+    void update_triangle_adjacency();
+    void remove_degenerate_triangles();
+
+    std::vector<unsigned int> m_indices;
+    std::vector<Vector3f> m_positions; // Normalized to the unit cube for precision.
+    float m_scale; // From normalized to mesh space.
+
+    std::vector<unsigned int> m_remap; // The vertex representing the position of each vertex.
+    std::vector<unsigned int> m_wedges; // Ring of the vertices sharing a position.
+    std::vector<VertexKind> m_kinds;
+    // The next and previous vertex along the open edges of border and seam vertices.
+    // The vertex itself if it has more than one open edge in that direction, and NO_VERTEX if it has none.
+    std::vector<unsigned int> m_loop;
+    std::vector<unsigned int> m_loopback;
+    std::vector<Quadric> m_quadrics; // Pr position representative.
+    float m_max_error;
+
+    // The triangles around each position representative.
+    std::vector<unsigned int> m_triangle_offsets;
+    std::vector<unsigned int> m_adjacent_triangles;
+};
+
+QuadricSimplifier::QuadricSimplifier(Meshes::UID mesh_ID)
+    : m_max_error(0.0f) {
+    assert(Meshes::get_flags(mesh_ID).is_set(MeshFlag::Position));
+    unsigned int vertex_count = Meshes::get_vertex_count(mesh_ID);
+    const unsigned int* indices = Meshes::get_indices(mesh_ID);
+    m_indices.assign(indices, indices + Meshes::get_index_count(mesh_ID));
+
+    m_positions.resize(vertex_count);
+    Meshes::decode_positions(mesh_ID, 0, vertex_count, m_positions.data());
+    AABB bounds = AABB::invalid();
+    for (Vector3f position : m_positions)
+        bounds.grow_to_contain(position);
+    Vector3f size = bounds.size();
+    m_scale = max(size.x, max(size.y, size.z));
+    if (!(m_scale > 0.0f))
+        m_scale = 1.0f;
+    for (Vector3f& position : m_positions)
+        position = (position - bounds.minimum) / m_scale;
+
+    { // Find the vertices sharing a position with a spatial hash.
+        auto position_hash = [](Vector3f position) -> size_t {
+            unsigned int bits[3];
+            memcpy(bits, &position.x, sizeof(bits));
+            return RNG::teschner_hash(bits[0], bits[1], bits[2]);
+        };
+        std::unordered_map<Vector3f, unsigned int, decltype(position_hash)> position_vertices(vertex_count, position_hash);
+        m_remap.resize(vertex_count);
+        m_wedges.resize(vertex_count);
+        for (unsigned int v = 0; v < vertex_count; ++v) {
+            unsigned int representative = position_vertices.emplace(m_positions[v], v).first->second;
+            m_remap[v] = representative;
+            if (representative == v)
+                m_wedges[v] = v;
+            else {
+                m_wedges[v] = m_wedges[representative];
+                m_wedges[representative] = v;
+            }
+        }
+    }
+
+    remove_degenerate_triangles();
+
+    // Outgoing edges pr vertex.
+    std::vector<unsigned int> edge_offsets(vertex_count + 1, 0);
+    for (unsigned int index : m_indices)
+        ++edge_offsets[index + 1];
+    std::partial_sum(edge_offsets.begin(), edge_offsets.end(), edge_offsets.begin());
+    std::vector<unsigned int> edge_targets(m_indices.size());
+    {
+        std::vector<unsigned int> edge_cursors(edge_offsets.begin(), edge_offsets.end() - 1);
+        for (unsigned int i = 0; i < m_indices.size(); ++i) {
+            unsigned int next_i = i % 3 == 2 ? i - 2 : i + 1;
+            edge_targets[edge_cursors[m_indices[i]]++] = m_indices[next_i];
+        }
+    }
+    auto has_edge = [&](unsigned int from_vertex, unsigned int to_vertex) -> bool {
+        for (unsigned int e = edge_offsets[from_vertex]; e < edge_offsets[from_vertex + 1]; ++e)
+            if (edge_targets[e] == to_vertex)
+                return true;
+        return false;
+    };
+
+    // Find the open edges and add quadrics keeping the triangles in place to the positions.
+    // Open edges additionally add a plane through the edge perpendicular to the triangle,
+    // which keeps borders and seams in place.
+    const float BORDER_WEIGHT = 10.0f;
+    m_loop.assign(vertex_count, NO_VERTEX);
+    m_loopback.assign(vertex_count, NO_VERTEX);
+    m_quadrics.assign(vertex_count, Quadric::zero());
+    for (unsigned int t = 0; t < m_indices.size(); t += 3) {
+        Vector3f p0 = m_positions[m_indices[t]], p1 = m_positions[m_indices[t + 1]], p2 = m_positions[m_indices[t + 2]];
+        Vector3f normal = cross(p1 - p0, p2 - p0);
+        float area = magnitude(normal);
+        if (area > 0.0f)
+            normal /= area;
+        Quadric triangle_quadric = Quadric::from_plane(normal, -dot(normal, p0), area);
+        for (int k = 0; k < 3; ++k)
+            m_quadrics[m_remap[m_indices[t + k]]] += triangle_quadric;
+
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v0 = m_indices[t + k], v1 = m_indices[t + (k + 1) % 3];
+            if (has_edge(v1, v0))
+                continue;
+            m_loop[v0] = m_loop[v0] == NO_VERTEX ? v1 : v0;
+            m_loopback[v1] = m_loopback[v1] == NO_VERTEX ? v0 : v1;
+
+            Vector3f edge_start = m_positions[v0];
+            Vector3f edge = m_positions[v1] - edge_start;
+            float edge_length = magnitude(edge);
+            Vector3f edge_normal = cross(edge, normal);
+            float edge_normal_length = magnitude(edge_normal);
+            if (edge_normal_length > 0.0f)
+                edge_normal /= edge_normal_length;
+            Quadric edge_quadric = Quadric::from_plane(edge_normal, -dot(edge_normal, edge_start), edge_length * edge_length * BORDER_WEIGHT);
+            m_quadrics[m_remap[v0]] += edge_quadric;
+            m_quadrics[m_remap[v1]] += edge_quadric;
+        }
+    }
+
+    // Classify the vertices. Representatives come before the other vertices at their position.
+    m_kinds.resize(vertex_count);
+    auto has_single_loop = [&](unsigned int v) {
+        return m_loop[v] != NO_VERTEX && m_loop[v] != v && m_loopback[v] != NO_VERTEX && m_loopback[v] != v;
+    };
+    for (unsigned int v = 0; v < vertex_count; ++v) {
+        if (m_remap[v] != v)
+            m_kinds[v] = m_kinds[m_remap[v]];
+        else if (m_wedges[v] == v) {
+            if (m_loop[v] == NO_VERTEX && m_loopback[v] == NO_VERTEX)
+                m_kinds[v] = VertexKind::Manifold;
+            else
+                m_kinds[v] = has_single_loop(v) ? VertexKind::Border : VertexKind::Locked;
+        } else if (m_wedges[m_wedges[v]] == v) {
+            // The open edges of the two vertices must run along the same seam in opposite directions.
+            unsigned int w = m_wedges[v];
+            bool is_seam = has_single_loop(v) && has_single_loop(w) &&
+                m_remap[m_loop[v]] == m_remap[m_loopback[w]] && m_remap[m_loopback[v]] == m_remap[m_loop[w]];
+            m_kinds[v] = is_seam ? VertexKind::Seam : VertexKind::Locked;
+        } else
+            m_kinds[v] = VertexKind::Locked;
+    }
+}
+
+bool QuadricSimplifier::can_collapse(unsigned int from_vertex, unsigned int to_vertex) const {
+    // Manifold vertices can collapse onto any vertex, border and seam vertices only onto their own
+    // kind or locked vertices, and locked vertices are never collapsed.
+    static const bool kind_can_collapse[4][4] = {
+        { true, true, true, true },
+        { false, true, false, true },
+        { false, false, true, true },
+        { false, false, false, false },
+    };
+    VertexKind from_kind = m_kinds[from_vertex], to_kind = m_kinds[to_vertex];
+    if (!kind_can_collapse[(int)from_kind][(int)to_kind])
+        return false;
+
+    // Border and seam vertices collapse along their open edges.
+    if (from_kind == VertexKind::Border || from_kind == VertexKind::Seam)
+        if (m_loop[from_vertex] != to_vertex && m_loopback[from_vertex] != to_vertex)
+            return false;
+
+    // The other side of the seam must collapse onto the same position.
+    if (from_kind == VertexKind::Seam) {
+        unsigned int seam_vertex = m_wedges[from_vertex];
+        unsigned int seam_target = m_loop[from_vertex] == to_vertex ? m_loopback[seam_vertex] : m_loop[seam_vertex];
+        if (seam_target == NO_VERTEX || seam_target == seam_vertex || m_remap[seam_target] != m_remap[to_vertex])
+            return false;
+    }
+
+    return true;
+}
+
+// Tests if moving the position onto another position flips any of the triangles around it that
+// aren't removed by the collapse.
+bool QuadricSimplifier::has_triangle_flips(unsigned int from_position, unsigned int to_position) const {
+    Vector3f from = m_positions[from_position], to = m_positions[to_position];
+    for (unsigned int a = m_triangle_offsets[from_position]; a < m_triangle_offsets[from_position + 1]; ++a) {
+        unsigned int t = m_adjacent_triangles[a];
+        unsigned int corners[3] = { m_remap[m_indices[t]], m_remap[m_indices[t + 1]], m_remap[m_indices[t + 2]] };
+        if (corners[0] == to_position || corners[1] == to_position || corners[2] == to_position)
+            continue;
+
+        int k = corners[0] == from_position ? 0 : (corners[1] == from_position ? 1 : 2);
+        Vector3f p1 = m_positions[corners[(k + 1) % 3]], p2 = m_positions[corners[(k + 2) % 3]];
+        Vector3f normal = cross(p1 - from, p2 - from);
+        Vector3f collapsed_normal = cross(p1 - to, p2 - to);
+        if (dot(normal, collapsed_normal) <= MAX_TRIANGLE_ROTATION_COS * magnitude(normal) * magnitude(collapsed_normal))
+            return true;
+    }
+    return false;
+}
+
+void QuadricSimplifier::update_triangle_adjacency() {
+    unsigned int vertex_count = (unsigned int)m_positions.size();
+    m_triangle_offsets.assign(vertex_count + 1, 0);
+    for (unsigned int index : m_indices)
+        ++m_triangle_offsets[m_remap[index] + 1];
+    std::partial_sum(m_triangle_offsets.begin(), m_triangle_offsets.end(), m_triangle_offsets.begin());
+
+    m_adjacent_triangles.resize(m_indices.size());
+    std::vector<unsigned int> cursors(m_triangle_offsets.begin(), m_triangle_offsets.end() - 1);
+    for (unsigned int i = 0; i < m_indices.size(); ++i)
+        m_adjacent_triangles[cursors[m_remap[m_indices[i]]]++] = i - i % 3;
+}
+
+void QuadricSimplifier::remove_degenerate_triangles() {
+    size_t triangle_end = 0;
+    for (size_t t = 0; t < m_indices.size(); t += 3) {
+        unsigned int r0 = m_remap[m_indices[t]], r1 = m_remap[m_indices[t + 1]], r2 = m_remap[m_indices[t + 2]];
+        if (r0 == r1 || r0 == r2 || r1 == r2)
+            continue;
+        m_indices[triangle_end++] = m_indices[t];
+        m_indices[triangle_end++] = m_indices[t + 1];
+        m_indices[triangle_end++] = m_indices[t + 2];
+    }
+    m_indices.resize(triangle_end);
+}
+
+void QuadricSimplifier::simplify(unsigned int target_triangle_count, float target_error) {
+    unsigned int vertex_count = (unsigned int)m_positions.size();
+    float normalized_target_error = target_error / m_scale;
+    float error_limit = normalized_target_error * normalized_target_error;
+
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> collapse_remap(vertex_count);
+    std::vector<unsigned char> collapse_locked(vertex_count);
+    std::vector<unsigned int> previous_loop;
+
+    while (get_triangle_count() > target_triangle_count) {
+        update_triangle_adjacency();
+
+        // Every edge is collapsed along the direction of its half edges. Border edges only have one
+        // half edge, so they are also collapsed against it.
+        collapses.clear();
+        auto add_collapse = [&](unsigned int from_vertex, unsigned int to_vertex) {
+            if (can_collapse(from_vertex, to_vertex)) {
+                float error = m_quadrics[m_remap[from_vertex]].error(m_positions[to_vertex]);
+                collapses.push_back({ from_vertex, to_vertex, error });
+            }
+        };
+        for (unsigned int i = 0; i < m_indices.size(); ++i) {
+            unsigned int v0 = m_indices[i], v1 = m_indices[i % 3 == 2 ? i - 2 : i + 1];
+            add_collapse(v0, v1);
+            if (m_kinds[v1] == VertexKind::Border)
+                add_collapse(v1, v0);
+        }
+        std::sort(collapses.begin(), collapses.end(), [](Collapse lhs, Collapse rhs) { return lhs.error < rhs.error; });
+
+        // Perform the cheapest collapses. Manifold and seam collapses remove two triangles and border
+        // collapses one, which is used to stop the pass around the target triangle count.
+        std::iota(collapse_remap.begin(), collapse_remap.end(), 0u);
+        std::fill(collapse_locked.begin(), collapse_locked.end(), (unsigned char)0);
+        unsigned int triangle_collapse_goal = get_triangle_count() - target_triangle_count;
+        unsigned int collapsed_triangle_count = 0;
+        unsigned int collapse_count = 0;
+        for (Collapse collapse : collapses) {
+            if (collapse.error > error_limit || collapsed_triangle_count >= triangle_collapse_goal)
+                break;
+
+            unsigned int from_position = m_remap[collapse.from_vertex], to_position = m_remap[collapse.to_vertex];
+            if (collapse_locked[from_position] || collapse_locked[to_position])
+                continue;
+            if (has_triangle_flips(from_position, to_position))
+                continue;
+
+            VertexKind from_kind = m_kinds[collapse.from_vertex];
+            collapse_remap[collapse.from_vertex] = collapse.to_vertex;
+            if (from_kind == VertexKind::Seam) {
+                unsigned int seam_vertex = m_wedges[collapse.from_vertex];
+                bool is_forward = m_loop[collapse.from_vertex] == collapse.to_vertex;
+                collapse_remap[seam_vertex] = is_forward ? m_loopback[seam_vertex] : m_loop[seam_vertex];
+            }
+
+            // The triangles around the collapsed position change, so their positions are locked for the rest
+            // of the pass to keep the flip tests of later collapses valid.
+            m_quadrics[to_position] += m_quadrics[from_position];
+            for (unsigned int a = m_triangle_offsets[from_position]; a < m_triangle_offsets[from_position + 1]; ++a) {
+                unsigned int t = m_adjacent_triangles[a];
+                for (int k = 0; k < 3; ++k)
+                    collapse_locked[m_remap[m_indices[t + k]]] = 1;
+            }
+            collapsed_triangle_count += from_kind == VertexKind::Border ? 1 : 2;
+            m_max_error = max(m_max_error, collapse.error);
+            ++collapse_count;
+        }
+
+        if (collapse_count == 0)
+            break;
+
+        for (unsigned int& index : m_indices)
+            index = collapse_remap[index];
+
+        // Follow the open edges past the collapsed vertices. If the vertex an open edge points to was
+        // collapsed onto the vertex itself, the edge continues from where the collapsed vertex's edge went.
+        auto remap_loop = [&](std::vector<unsigned int>& loop, std::vector<unsigned int>& previous_loop) {
+            previous_loop = loop;
+            for (unsigned int v = 0; v < vertex_count; ++v) {
+                if (loop[v] == NO_VERTEX)
+                    continue;
+                unsigned int next_vertex = collapse_remap[loop[v]];
+                if (next_vertex == v)
+                    next_vertex = previous_loop[loop[v]] == NO_VERTEX ? NO_VERTEX : collapse_remap[previous_loop[loop[v]]];
+                loop[v] = next_vertex;
+            }
+        };
+        remap_loop(m_loop, previous_loop);
+        remap_loop(m_loopback, previous_loop);
+
+        remove_degenerate_triangles();
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Simplified meshes.
+// ------------------------------------------------------------------------------------------------
+
+// Creates a mesh from the simplified triangles, keeping the vertices of the source mesh that the
+// triangles use in the order they are first used.
+static Meshes::UID create_simplified_mesh(Meshes::UID mesh_ID, const std::string& name, const std::vector<unsigned int>& indices) {
+    std::vector<unsigned int> vertex_remapping(Meshes::get_vertex_count(mesh_ID), NO_VERTEX);
+    std::vector<unsigned int> used_vertices;
+    for (unsigned int index : indices)
+        if (vertex_remapping[index] == NO_VERTEX) {
+            vertex_remapping[index] = (unsigned int)used_vertices.size();
+            used_vertices.push_back(index);
+        }
+
+    // The buffers are filled decompressed and compressed like the source mesh afterwards.
+    MeshFlags flags = Meshes::get_flags(mesh_ID);
+    unsigned int vertex_count = (unsigned int)used_vertices.size();
+    Mesh simplified_mesh = Meshes::create(name, (unsigned int)indices.size() / 3, vertex_count, flags & MeshFlag::AllBuffers);
+
+    unsigned int* simplified_indices = simplified_mesh.get_indices();
+    for (unsigned int i = 0; i < indices.size(); ++i)
+        simplified_indices[i] = vertex_remapping[indices[i]];
+
+    Vector3f* positions = simplified_mesh.get_positions();
+    for (unsigned int v = 0; v < vertex_count; ++v)
+        positions[v] = Meshes::get_position(mesh_ID, used_vertices[v]);
+    if (Vector3f* normals = simplified_mesh.get_normals())
+        for (unsigned int v = 0; v < vertex_count; ++v)
+            normals[v] = Meshes::get_normal(mesh_ID, used_vertices[v]);
+    if (Vector2f* texcoords = simplified_mesh.get_texcoords())
+        for (unsigned int v = 0; v < vertex_count; ++v)
+            texcoords[v] = Meshes::get_texcoord(mesh_ID, used_vertices[v]);
+
+    if (vertex_count > 0)
+        simplified_mesh.compute_bounds();
+    simplified_mesh.set_compression(flags & MeshFlag::Compressed);
+
+    return simplified_mesh.get_ID();
+}
+
+Meshes::UID simplify(Meshes::UID mesh_ID, unsigned int target_triangle_count, float target_error, float* result_error) {
+    QuadricSimplifier simplifier = QuadricSimplifier(mesh_ID);
+    simplifier.simplify(target_triangle_count, target_error);
+    if (result_error != nullptr)
+        *result_error = simplifier.get_error();
+    return create_simplified_mesh(mesh_ID, Meshes::get_name(mesh_ID) + "_simplified", simplifier.get_indices());
+}
+
+// ------------------------------------------------------------------------------------------------
+// Level of detail chains.
+// ------------------------------------------------------------------------------------------------
+
+struct LODLevel {
+    std::vector<unsigned int> indices;
+    float error;
+};
+
+// Simplifies the mesh level by level with a single simplifier, so the errors of all levels are
+// relative to the mesh. Only reads the mesh, so it can run concurrently for different meshes.
+static std::vector<LODLevel> simplify_LOD_levels(Meshes::UID mesh_ID, unsigned int max_level_count, float triangle_ratio) {
+    std::vector<LODLevel> levels;
+    QuadricSimplifier simplifier = QuadricSimplifier(mesh_ID);
+    unsigned int previous_triangle_count = simplifier.get_triangle_count();
+    while (levels.size() < max_level_count) {
+        unsigned int target_triangle_count = (unsigned int)(previous_triangle_count * triangle_ratio);
+        if (target_triangle_count >= previous_triangle_count)
+            break;
+        simplifier.simplify(target_triangle_count, std::numeric_limits<float>::infinity());
+
+        // End the chain if less than half of the requested triangles could be removed.
+        unsigned int triangle_count = simplifier.get_triangle_count();
+        if (triangle_count == 0 || previous_triangle_count - triangle_count < (previous_triangle_count - target_triangle_count) / 2)
+            break;
+
+        levels.push_back({ simplifier.get_indices(), simplifier.get_error() });
+        previous_triangle_count = triangle_count;
+    }
+    return levels;
+}
+
+static void create_LOD_chain(Meshes::UID mesh_ID, const std::vector<LODLevel>& levels) {
+    std::string name = Meshes::get_name(mesh_ID);
+    std::vector<Meshes::LOD> LOD_chain;
+    LOD_chain.reserve(levels.size());
+    for (unsigned int l = 0; l < levels.size(); ++l) {
+        Meshes::UID level_ID = create_simplified_mesh(mesh_ID, name + "_LOD" + std::to_string(l + 1), levels[l].indices);
+        LOD_chain.push_back({ level_ID, levels[l].error });
+    }
+    Meshes::set_LOD_chain(mesh_ID, std::move(LOD_chain));
+}
+
+void build_LOD_chain(Meshes::UID mesh_ID, unsigned int max_level_count, float triangle_ratio) {
+    create_LOD_chain(mesh_ID, simplify_LOD_levels(mesh_ID, max_level_count, triangle_ratio));
+}
+
+void build_LOD_chains(const Meshes::UID* mesh_IDs_begin, const Meshes::UID* mesh_IDs_end, unsigned int max_level_count, float triangle_ratio) {
+    int mesh_count = int(mesh_IDs_end - mesh_IDs_begin);
+    std::vector<std::vector<LODLevel>> mesh_levels(mesh_count);
+    Core::Parallel::for_each(0, mesh_count, [&](int m) {
+        mesh_levels[m] = simplify_LOD_levels(mesh_IDs_begin[m], max_level_count, triangle_ratio);
+    }, 1);
+
+    // Meshes can't be created concurrently.
+    for (int m = 0; m < mesh_count; ++m)
+        create_LOD_chain(mesh_IDs_begin[m], mesh_levels[m]);
+}
+
+Meshes::UID select_LOD(Meshes::UID mesh_ID, float distance, float projection_scale, float max_pixel_error) {
+    Meshes::UID selected_mesh_ID = mesh_ID;
+    for (Meshes::LOD level : Meshes::get_LOD_chain(mesh_ID)) {
+        // Compare without dividing by the distance, which may be zero.
+        if (level.error * projection_scale > max_pixel_error * distance)
+            break;
+        selected_mesh_ID = level.mesh_ID;
+    }
+    return selected_mesh_ID;
+}
+
+} // NS MeshUtils
+} // NS Bifrost::Assets
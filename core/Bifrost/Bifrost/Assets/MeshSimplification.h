@@ -0,0 +1,66 @@
+// Bifrost mesh simplification and level of detail chains.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_ASSETS_MESH_SIMPLIFICATION_H_
+#define _BIFROST_ASSETS_MESH_SIMPLIFICATION_H_
+
+#include <Bifrost/Assets/Mesh.h>
+
+#include <limits>
+
+namespace Bifrost::Assets {
+namespace MeshUtils {
+
+// ------------------------------------------------------------------------------------------------
+// Simplifies the mesh by collapsing edges in order of their quadric error, see Garland and
+// Heckbert, Surface Simplification Using Quadric Error Metrics, 1997. The simplification stops
+// when the mesh has at most target_triangle_count triangles or when the next collapse would have
+// an error above target_error, whichever comes first.
+// Vertices are collapsed onto one of their neighbours instead of being moved, so the remaining
+// vertices keep their normals and texcoords. Vertices on attribute seams only collapse along the
+// seam onto the vertex on the same side of it, vertices on the mesh border only collapse along
+// the border, and vertices where several seams or borders meet are never collapsed.
+// The error is an estimate of the mesh space distance between the simplified and the source mesh
+// and is returned through result_error if given.
+// Returns a new mesh with the buffers and storage of the source mesh, which must have positions.
+// Future work
+// * Optimal vertex placement for vertices without attributes.
+// * Include the attributes in the quadrics.
+// ------------------------------------------------------------------------------------------------
+Meshes::UID simplify(Meshes::UID mesh_ID, unsigned int target_triangle_count,
+                     float target_error = std::numeric_limits<float>::infinity(), float* result_error = nullptr);
+
+// ------------------------------------------------------------------------------------------------
+// Level of detail chains.
+// ------------------------------------------------------------------------------------------------
+
+// Builds a chain of up to max_level_count levels of detail for the mesh and sets it as the mesh's
+// chain. Each level is simplified to triangle_ratio of the triangles of the previous level. The
+// chain ends early when a level can't get close to its triangle target, e.g. because the
+// remaining vertices are on seams.
+void build_LOD_chain(Meshes::UID mesh_ID, unsigned int max_level_count = 4, float triangle_ratio = 0.5f);
+
+// Builds the chains of the meshes in parallel. Only the creation of the level meshes is serial.
+void build_LOD_chains(const Meshes::UID* mesh_IDs_begin, const Meshes::UID* mesh_IDs_end,
+                      unsigned int max_level_count = 4, float triangle_ratio = 0.5f);
+
+// The size in pixels of a mesh space error seen at the given distance.
+// The projection scale is the number of pixels covered by one unit at distance one, which is
+// viewport_height / (2 * tan(vertical_field_of_view / 2)) for a perspective projection.
+inline float compute_screen_space_error(float error, float distance, float projection_scale) {
+    return error * projection_scale / distance;
+}
+
+// Returns the coarsest level of the mesh's chain whose screen space error is at most
+// max_pixel_error, or the mesh itself if no level is precise enough.
+Meshes::UID select_LOD(Meshes::UID mesh_ID, float distance, float projection_scale, float max_pixel_error = 1.0f);
+
+} // NS MeshUtils
+} // NS Bifrost::Assets
+
+#endif // _BIFROST_ASSETS_MESH_SIMPLIFICATION_H_
@@ -17,7 +17,7 @@ namespace Bifrost {
 namespace Assets {
 
 Textures::UIDGenerator Textures::m_UID_generator = UIDGenerator(0u);
-Textures::Sampler* Textures::m_samplers = nullptr;
+Core::ReservedArray<Textures::Sampler> Textures::m_samplers;
 Core::ChangeSet<Textures::Changes, Textures::UID> Textures::m_changes;
 
 void Textures::allocate(unsigned int capacity) {
@@ -27,7 +27,7 @@ void Textures::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_samplers = new Sampler[capacity];
+    m_samplers = Core::ReservedArray<Sampler>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
@@ -45,23 +45,14 @@ void Textures::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_samplers; m_samplers = nullptr;
+    m_samplers.release();
     m_changes.resize(0);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void Textures::reserve_image_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_samplers != nullptr);
+    assert(m_samplers.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-    m_samplers = resize_and_copy_array(m_samplers, new_capacity, copyable_elements);
+    m_samplers.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -71,8 +62,22 @@ void Textures::reserve(unsigned int new_capacity) {
     reserve_image_data(m_UID_generator.capacity(), old_capacity);
 }
 
+Core::MemoryUsage Textures::get_memory_usage(Textures::UID texture_ID) {
+    Core::MemoryUsage usage;
+    if (m_UID_generator.has(texture_ID))
+        usage[Core::MemoryCategory::Metadata] = sizeof(Sampler);
+    return usage;
+}
+
+Core::MemoryUsage Textures::get_memory_usage() {
+    Core::MemoryUsage usage;
+    usage[Core::MemoryCategory::Metadata] = m_UID_generator.get_allocated_bytes() + Core::get_allocated_bytes(m_samplers);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 Textures::UID Textures::create2D(Images::UID image_ID, MagnificationFilter magnification_filter, MinificationFilter minification_filter, WrapMode wrapmode_U, WrapMode wrapmode_V) {
-    assert(m_samplers != nullptr);
+    assert(m_samplers.data() != nullptr);
 
     if (!Images::has(image_ID))
         return Textures::UID::invalid_UID();
@@ -13,6 +13,8 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 
 namespace Bifrost {
@@ -52,7 +54,7 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static bool is_allocated() { return m_samplers != nullptr; }
+    static bool is_allocated() { return m_samplers.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -75,6 +77,12 @@ public:
     static inline WrapMode get_wrapmode_V(Textures::UID texture_ID) { return m_samplers[texture_ID].wrapmode_V; }
     static inline WrapMode get_wrapmode_W(Textures::UID texture_ID) { return m_samplers[texture_ID].wrapmode_W; }
 
+    //---------------------------------------------------------------------------------------------
+    // Memory usage.
+    //---------------------------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(Textures::UID texture_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //---------------------------------------------------------------------------------------------
     // Changes since last game loop tick.
     //---------------------------------------------------------------------------------------------
@@ -91,6 +99,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_textures() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -108,7 +123,7 @@ private:
     };
 
     static UIDGenerator m_UID_generator;
-    static Sampler* m_samplers;
+    static Core::ReservedArray<Sampler> m_samplers;
     static Core::ChangeSet<Changes, UID> m_changes;
 };
 
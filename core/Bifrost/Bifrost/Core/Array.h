@@ -10,35 +10,100 @@
 #define _BIFROST_CORE_ARRAY_H_
 
 #include <assert.h>
+#include <cstring>
 #include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace Bifrost {
 namespace Core {
 
 // ---------------------------------------------------------------------------
-// Array is similar to std::vector, except that size and capacity are the same 
-// and it will not require objects to have a default constructor, and as such 
-// elements not explicitly initialized will contain undefined data.
+// Heap allocator returning memory aligned to the given alignment,
+// fx 16, 32 or 64 bytes for SIMD types.
+// Array allocators expose their alignment and allocate and deallocate bytes.
+// Stateful allocators, fx allocating from an arena, are stored by the array.
+// ---------------------------------------------------------------------------
+template <size_t Alignment>
+struct AlignedAllocator final {
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two.");
+    static constexpr size_t alignment = Alignment;
+
+    inline void* allocate(size_t byte_count) { return ::operator new(byte_count, std::align_val_t(Alignment)); }
+    inline void deallocate(void* pointer, size_t byte_count) { ::operator delete(pointer, std::align_val_t(Alignment)); }
+};
+
+// ---------------------------------------------------------------------------
+// Array is similar to std::vector, except that it will not require objects
+// to have a default constructor, and as such elements of trivial types not
+// explicitly initialized will contain undefined data.
+// Appending grows the capacity geometrically, while resize and reserve
+// allocate exactly the requested capacity.
 // Future work
 // * Support function pointers. (possibly by using aligned_alloc? Check how std::vector does it.)
 // * Constructor taking two iterators as argument.
-// * Add emplace.
-// * Add swap.
 // * Specialize for booleans and add 'clearAll()' and 'setAll()' methods.
 // * Specialize for arbitrary bits pr integer element?
-// * Use malloc to allocate, but make sure that it supports memory aligned structs.
 // ---------------------------------------------------------------------------
-template <typename T, typename SizeType = unsigned int>
+template <typename T, typename SizeType = unsigned int, typename Allocator = AlignedAllocator<alignof(T)>>
 struct Array final {
 public:
     typedef T value_type;
     typedef SizeType size_type;
+    typedef Allocator allocator_type;
     typedef T* iterator;
     typedef const T* const_iterator;
 
+    static_assert(Allocator::alignment >= alignof(T), "The allocator's alignment must be at least the alignment of T.");
+
 private:
     size_type m_size;
+    size_type m_capacity;
     T* m_data;
+    Allocator m_allocator;
+
+    inline T* allocate(size_type capacity) {
+        return capacity == 0 ? nullptr : static_cast<T*>(m_allocator.allocate(sizeof(T) * capacity));
+    }
+
+    inline void deallocate(T* data, size_type capacity) {
+        if (data != nullptr)
+            m_allocator.deallocate(data, sizeof(T) * capacity);
+    }
+
+    static inline void destroy(T* begin, T* end) {
+        if (!std::is_trivially_destructible<T>::value)
+            for (T* element = begin; element != end; ++element)
+                element->~T();
+    }
+
+    // Moves the elements into uninitialized memory and destroys the moved from elements.
+    static inline void relocate(T* from_begin, T* from_end, T* to) {
+        if (std::is_trivially_copyable<T>::value) {
+            if (from_begin != from_end)
+                memcpy((void*)to, (const void*)from_begin, sizeof(T) * (from_end - from_begin));
+        } else
+            for (T* from = from_begin; from != from_end; ++from, ++to) {
+                new (to) T(std::move(*from));
+                from->~T();
+            }
+    }
+
+    inline size_type grown_capacity(size_type required_capacity) const {
+        size_type capacity = m_capacity + m_capacity / 2;
+        return capacity < required_capacity ? required_capacity : capacity;
+    }
+
+    // Reallocates to the new capacity, which must be able to hold the current elements.
+    inline void reallocate(size_type new_capacity) {
+        T* new_data = allocate(new_capacity);
+        relocate(m_data, m_data + m_size, new_data);
+        deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_capacity = new_capacity;
+    }
 
 public:
 
@@ -46,44 +111,56 @@ public:
     // Constructors and destructor
     // -----------------------------------------------------------------------
     Array()
-        : m_size(0), m_data(nullptr) {
-    }
-    explicit Array(size_type size)
-        : m_size(size), m_data(new T[m_size]) {}
-    Array(Array<T>&& other)
-        : m_size(other.m_size), m_data(other.m_data) {
-        other.m_size = 0; other.m_data = nullptr;
-    }
-	Array(const Array<T>& other)
-		: m_size(other.m_size), m_data(new T[m_size]) {
-		std::copy(other.m_data, other.m_data + m_size, m_data);
-	}
-    Array(const std::initializer_list<T>& list)
-        : m_size(static_cast<size_type>(list.size())), m_data(new T[m_size]) {
-        std::copy(list.begin(), list.end(), m_data);
+        : m_size(0), m_capacity(0), m_data(nullptr), m_allocator() {
+    }
+    explicit Array(const Allocator& allocator)
+        : m_size(0), m_capacity(0), m_data(nullptr), m_allocator(allocator) {
+    }
+    explicit Array(size_type size, const Allocator& allocator = Allocator())
+        : m_size(0), m_capacity(0), m_data(nullptr), m_allocator(allocator) {
+        resize(size);
+    }
+    Array(Array&& other)
+        : m_size(other.m_size), m_capacity(other.m_capacity), m_data(other.m_data), m_allocator(std::move(other.m_allocator)) {
+        other.m_size = other.m_capacity = 0; other.m_data = nullptr;
+    }
+    Array(const Array& other)
+        : m_size(other.m_size), m_capacity(other.m_size), m_data(nullptr), m_allocator(other.m_allocator) {
+        m_data = allocate(m_capacity);
+        std::uninitialized_copy(other.m_data, other.m_data + m_size, m_data);
+    }
+    Array(const std::initializer_list<T>& list, const Allocator& allocator = Allocator())
+        : m_size(static_cast<size_type>(list.size())), m_capacity(m_size), m_data(nullptr), m_allocator(allocator) {
+        m_data = allocate(m_capacity);
+        std::uninitialized_copy(list.begin(), list.end(), m_data);
     }
     ~Array() {
-        if (m_data) 
-            delete[] m_data;
+        destroy(m_data, m_data + m_size);
+        deallocate(m_data, m_capacity);
     }
 
     // -----------------------------------------------------------------------
     // Assignment
     // -----------------------------------------------------------------------
-    Array& operator=(Array<T>&& rhs) {
-        m_size = rhs.m_size; 
-        m_data = rhs.m_data;
-        rhs.m_size = 0;
-        rhs.m_data = nullptr;
+    Array& operator=(Array&& rhs) {
+        swap(rhs);
         return *this;
     }
-    Array& operator=(const Array<T>& rhs) {
-        m_size = rhs.m_size;
-        m_data = new T[m_size];
-        std::copy(rhs.m_data, rhs.m_data + m_size, m_data);
+    Array& operator=(const Array& rhs) {
+        if (this != &rhs) {
+            Array copy = rhs;
+            swap(copy);
+        }
         return *this;
     }
-    
+
+    inline void swap(Array& other) {
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_data, other.m_data);
+        std::swap(m_allocator, other.m_allocator);
+    }
+
     // -----------------------------------------------------------------------
     // Iterators
     // -----------------------------------------------------------------------
@@ -93,18 +170,35 @@ public:
     inline const_iterator end() const { return m_data + m_size; }
 
     // -----------------------------------------------------------------------
-    // Size
+    // Size and capacity
     // -----------------------------------------------------------------------
     inline size_type size() const { return m_size; }
+    inline size_type capacity() const { return m_capacity; }
+
+    // Resizes the array. New elements are default initialized, i.e. left uninitialized for trivial types.
     inline void resize(size_type size) {
-        T* new_data = new T[size];
-        size_type minSize = size < m_size ? size : m_size;
-        memcpy(new_data, m_data, sizeof(T) * minSize);
-        delete[] m_data;
-        m_data = new_data;
+        if (size > m_capacity)
+            reallocate(size);
+        if (size < m_size)
+            destroy(m_data + size, m_data + m_size);
+        else if (!std::is_trivially_default_constructible<T>::value)
+            for (T* element = m_data + m_size; element != m_data + size; ++element)
+                new (element) T;
         m_size = size;
     }
 
+    inline void reserve(size_type capacity) {
+        if (capacity > m_capacity)
+            reallocate(capacity);
+    }
+
+    inline void shrink_to_fit() {
+        if (m_size < m_capacity)
+            reallocate(m_size);
+    }
+
+    inline void clear() { resize(0); }
+
     // -----------------------------------------------------------------------
     // Element access
     // -----------------------------------------------------------------------
@@ -112,31 +206,61 @@ public:
     inline const T& operator[](size_type i) const { assert(i < m_size); return m_data[i]; }
     inline T* data() { return m_data; }
     inline const T* data() const { return m_data; }
+    inline T& back() { assert(m_size > 0); return m_data[m_size - 1]; }
+    inline const T& back() const { assert(m_size > 0); return m_data[m_size - 1]; }
+
+    inline Allocator& get_allocator() { return m_allocator; }
 
     // -----------------------------------------------------------------------
     // Modifiers
     // -----------------------------------------------------------------------
-    void push_back(T element) {
-        size_type previous_size = m_size;
-        resize(m_size + 1u);
-        m_data[previous_size] = element;
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (m_size < m_capacity)
+            new (m_data + m_size) T(std::forward<Args>(args)...);
+        else {
+            // Construct the new element before relocating the old ones, as the arguments may reference them.
+            size_type new_capacity = grown_capacity(m_size + 1);
+            T* new_data = allocate(new_capacity);
+            new (new_data + m_size) T(std::forward<Args>(args)...);
+            relocate(m_data, m_data + m_size, new_data);
+            deallocate(m_data, m_capacity);
+            m_data = new_data;
+            m_capacity = new_capacity;
+        }
+        return m_data[m_size++];
     }
+    void push_back(const T& element) { emplace_back(element); }
+    void push_back(T&& element) { emplace_back(std::move(element)); }
     void push_back(const T* begin, const T* end) {
-        size_type previous_size = m_size;
-        resize(m_size + size_type(end - begin));
-        const T* from = begin;
-        T* to = m_data + previous_size;
-        while (from != end) {
-            *to = *from;
-            ++from;
-            ++to;
-        }
+        size_type count = size_type(end - begin);
+        if (m_size + count > m_capacity) {
+            // Copy into the new buffer before releasing the old one, as the range may be part of this array.
+            size_type new_capacity = grown_capacity(m_size + count);
+            T* new_data = allocate(new_capacity);
+            std::uninitialized_copy(begin, end, new_data + m_size);
+            relocate(m_data, m_data + m_size, new_data);
+            deallocate(m_data, m_capacity);
+            m_data = new_data;
+            m_capacity = new_capacity;
+        } else
+            std::uninitialized_copy(begin, end, m_data + m_size);
+        m_size += count;
     }
     void push_back(const std::initializer_list<T>& list) {
         push_back(list.begin(), list.end());
     }
+    void pop_back() {
+        assert(m_size > 0);
+        --m_size;
+        destroy(m_data + m_size, m_data + m_size + 1);
+    }
 };
 
+// Array with elements aligned to the given alignment, fx 16, 32 or 64 bytes for SIMD types.
+template <typename T, size_t Alignment, typename SizeType = unsigned int>
+using AlignedArray = Array<T, SizeType, AlignedAllocator<Alignment < alignof(T) ? alignof(T) : Alignment>>;
+
 } // NS Core
 } // NS Bifrost
 
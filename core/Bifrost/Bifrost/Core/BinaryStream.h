@@ -0,0 +1,128 @@
+// Bifrost binary streams.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_BINARY_STREAM_H_
+#define _BIFROST_CORE_BINARY_STREAM_H_
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+namespace Bifrost::Core {
+
+// Alignment of blocks in binary streams, so blocks can be used directly from a memory mapped stream.
+static const size_t BINARY_BLOCK_ALIGNMENT = 64;
+
+// ------------------------------------------------------------------------------------------------
+// Writes trivially copyable values, length prefixed strings and aligned blocks to a binary file.
+// Values are written in the native memory layout.
+// ------------------------------------------------------------------------------------------------
+class BinaryWriter final {
+public:
+    explicit BinaryWriter(const std::string& path) : m_file(path, std::ios::binary) { }
+
+    inline bool succeeded() const { return m_file.good(); }
+    inline void flush() { m_file.flush(); }
+
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written directly.");
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_string(const std::string& str) {
+        write((unsigned int)str.size());
+        write_bytes(str.data(), str.size());
+    }
+
+    // Writes the size of the block and pads the stream to the block alignment before writing the block.
+    void write_block(const void* data, size_t byte_count) {
+        write((unsigned long long)byte_count);
+        static const char padding[BINARY_BLOCK_ALIGNMENT] = {};
+        write_bytes(padding, (BINARY_BLOCK_ALIGNMENT - m_offset % BINARY_BLOCK_ALIGNMENT) % BINARY_BLOCK_ALIGNMENT);
+        write_bytes(data, byte_count);
+    }
+
+private:
+    void write_bytes(const void* data, size_t byte_count) {
+        m_file.write((const char*)data, byte_count);
+        m_offset += byte_count;
+    }
+
+    std::ofstream m_file;
+    size_t m_offset = 0;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Reads the values written by a BinaryWriter from memory, fx a memory mapped file.
+// Reading past the end fails the reader, after which all reads return default values.
+// ------------------------------------------------------------------------------------------------
+class BinaryReader final {
+public:
+    BinaryReader(const unsigned char* data, size_t size) : m_data(data), m_size(size) { }
+
+    inline bool failed() const { return m_failed; }
+    inline void fail() { m_failed = true; }
+    inline bool is_at_end() const { return m_offset == m_size; }
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read directly.");
+        T value = {};
+        if (reserve(sizeof(T)))
+            memcpy(&value, m_data + m_offset - sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::string read_string() {
+        unsigned int length = read<unsigned int>();
+        if (!reserve(length))
+            return std::string();
+        return std::string((const char*)m_data + m_offset - length, length);
+    }
+
+    // Returns the block or nullptr if its size isn't the expected size.
+    const void* read_block(size_t expected_byte_count) {
+        unsigned long long byte_count = read<unsigned long long>();
+        size_t padding = (BINARY_BLOCK_ALIGNMENT - m_offset % BINARY_BLOCK_ALIGNMENT) % BINARY_BLOCK_ALIGNMENT;
+        if (byte_count != expected_byte_count)
+            m_failed = true;
+        if (!reserve(padding) || !reserve(expected_byte_count))
+            return nullptr;
+        return m_data + m_offset - expected_byte_count;
+    }
+
+    // Skips the next block regardless of its size.
+    void skip_block() {
+        unsigned long long byte_count = read<unsigned long long>();
+        size_t padding = (BINARY_BLOCK_ALIGNMENT - m_offset % BINARY_BLOCK_ALIGNMENT) % BINARY_BLOCK_ALIGNMENT;
+        if (reserve(padding))
+            reserve(byte_count);
+    }
+
+private:
+    // Advances past the next byte_count bytes if they are inside the data.
+    bool reserve(size_t byte_count) {
+        if (m_failed || byte_count > m_size - m_offset) {
+            m_failed = true;
+            return false;
+        }
+        m_offset += byte_count;
+        return true;
+    }
+
+    const unsigned char* m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+    bool m_failed = false;
+};
+
+} // NS Bifrost::Core
+
+#endif // _BIFROST_CORE_BINARY_STREAM_H_
@@ -11,6 +11,7 @@
 
 #include <Bifrost/Core/Iterable.h>
 
+#include <cstddef>
 #include <vector>
 
 namespace Bifrost {
@@ -18,49 +19,124 @@ namespace Core {
 
 // ---------------------------------------------------------------------------
 // List changes for bifrost resources.
+// The changes since the last reset are stored pr resource and in a list of
+// changed resources. Resetting only clears the changed resources, so the
+// cost of a reset is proportional to the number of changes.
+// Consumers that cannot process changes every tick, fx a renderer that only
+// renders every other frame, can instead register a consumer and consume the
+// changes when ready. Changes are logged until all consumers have read them
+// and the changes to a resource are merged when consumed, so no changes are
+// lost when the global change notifications are reset.
+// Consuming only reads the log and the consumer's own state, so different
+// consumers can consume concurrently. The consumed part of the log is trimmed
+// when the change notifications are reset.
+// Future work
+// * Bound the log size for consumers that never consume their changes.
 // ---------------------------------------------------------------------------
 template <typename Bitmask, typename UID>
 struct ChangeSet final {
 public:
     typedef typename std::vector<UID>::iterator AssetIterator;
 
+    typedef unsigned int ConsumerID;
+
+    struct ResourceChanges final {
+        UID ID;
+        Bitmask changes;
+    };
+    typedef typename std::vector<ResourceChanges>::iterator ConsumedIterator;
+
 private:
-    Bitmask* m_changes;
+    static constexpr unsigned int NOT_CONSUMED = 0xFFFFFFFF;
+
+    struct Consumer final {
+        bool is_active;
+        unsigned long long next_entry; // Sequence number of the next log entry to consume.
+        std::vector<ResourceChanges> consumed_changes;
+        std::vector<unsigned int> consumed_positions; // Position of the resource in the consumed changes, indexed by UID index.
+    };
+
+    std::vector<Bitmask> m_changes;
     std::vector<UID> m_resources_changed;
-    int m_size;
 
-public:
+    std::vector<Consumer> m_consumers;
+    unsigned int m_active_consumer_count;
+    std::vector<ResourceChanges> m_log; // Changes not yet consumed by all consumers.
+    unsigned long long m_log_begin; // Sequence number of the first entry in the log.
 
-    ChangeSet() {
-        m_size = 0;
-        m_changes = nullptr;
+    inline void log_change(UID id, Bitmask change) {
+        if (m_active_consumer_count > 0)
+            m_log.push_back({ id, change });
     }
 
-    ChangeSet(unsigned int size) {
-        m_size = size;
-        m_changes = new Bitmask[m_size];
-        std::memset(m_changes, 0, m_size * sizeof(Bitmask));
-        m_resources_changed.reserve(m_size / 4);
+    void trim_log() {
+        unsigned long long log_end = m_log_begin + m_log.size();
+        unsigned long long first_unconsumed_entry = log_end;
+        for (const Consumer& consumer : m_consumers)
+            if (consumer.is_active && consumer.next_entry < first_unconsumed_entry)
+                first_unconsumed_entry = consumer.next_entry;
+
+        // Only erase once half the log has been consumed, to amortize the cost of moving the remaining entries.
+        size_t consumed_entry_count = size_t(first_unconsumed_entry - m_log_begin);
+        if (consumed_entry_count > 0 && 2 * consumed_entry_count >= m_log.size()) {
+            m_log.erase(m_log.begin(), m_log.begin() + consumed_entry_count);
+            m_log_begin = first_unconsumed_entry;
+        }
+    }
+
+public:
+
+    ChangeSet() : m_active_consumer_count(0), m_log_begin(0) { }
+
+    ChangeSet(unsigned int size)
+        : m_changes(size), m_active_consumer_count(0), m_log_begin(0) {
+        m_resources_changed.reserve(size / 4);
     }
 
+    // Grows the storage geometrically, so consecutive capacity bumps do not reallocate and copy every time.
     void resize(int new_size) {
-        Bitmask* new_changes = new Bitmask[new_size];
-        int copyable_elements = min(new_size, m_size);
-        std::copy(m_changes, m_changes + copyable_elements, new_changes);
-        delete[] m_changes;
-        m_changes = new_changes;
-        if (copyable_elements < new_size)
-            std::memset(m_changes + copyable_elements, 0, (new_size - copyable_elements) * sizeof(Bitmask));
-        m_size = new_size;
+        size_t size = size_t(new_size);
+        if (size > m_changes.capacity()) {
+            size_t new_capacity = m_changes.capacity() * 2;
+            m_changes.reserve(size < new_capacity ? new_capacity : size);
+        }
+
+        if (size < m_changes.size()) {
+            // Changes to the removed resources would be out of bounds, so all logged changes are discarded.
+            m_resources_changed.clear();
+            m_log.clear();
+            m_log_begin = 0;
+            for (Consumer& consumer : m_consumers)
+                consumer.next_entry = 0;
+            for (Bitmask& changes : m_changes)
+                changes = Bitmask();
+            if (size == 0) {
+                m_changes = std::vector<Bitmask>();
+                for (Consumer& consumer : m_consumers)
+                    consumer.consumed_positions = std::vector<unsigned int>();
+                return;
+            }
+        }
+
+        m_changes.resize(size, Bitmask());
+        for (Consumer& consumer : m_consumers)
+            if (consumer.is_active)
+                consumer.consumed_positions.resize(size, NOT_CONSUMED);
     }
 
-    inline void set_change(UID id, Bitmask change) { 
+    inline void set_change(UID id, Bitmask change) {
         if (m_changes[id].none_set())
             m_resources_changed.push_back(id);
         m_changes[id] = change;
+        log_change(id, change);
     }
 
-    inline void add_change(UID id, Bitmask change) { set_change(id, m_changes[id] | change); }
+    inline void add_change(UID id, Bitmask change) {
+        if (m_changes[id].none_set())
+            m_resources_changed.push_back(id);
+        m_changes[id] |= change;
+        log_change(id, change);
+    }
 
     inline Bitmask get_changes(UID id) { return m_changes[id]; }
 
@@ -69,12 +145,81 @@ public:
     }
 
     inline void reset_change_notifications() {
-        // NOTE We could use some heuristic here to choose between looping over 
-        // the notifications and only resetting the changed materials instead of resetting all.
-        std::memset(m_changes, 0, m_size * sizeof(Bitmask));
+        for (UID id : m_resources_changed)
+            m_changes[id] = Bitmask();
         m_resources_changed.resize(0);
+        trim_log();
+    }
+
+    // Bytes allocated for the changes, the list of changed resources and the consumer logs.
+    size_t get_allocated_bytes() const {
+        size_t byte_count = m_changes.capacity() * sizeof(Bitmask) + m_resources_changed.capacity() * sizeof(UID) +
+            m_consumers.capacity() * sizeof(Consumer) + m_log.capacity() * sizeof(ResourceChanges);
+        for (const Consumer& consumer : m_consumers)
+            byte_count += consumer.consumed_changes.capacity() * sizeof(ResourceChanges) +
+                consumer.consumed_positions.capacity() * sizeof(unsigned int);
+        return byte_count;
     }
 
+    // -----------------------------------------------------------------------
+    // Consumers.
+    // -----------------------------------------------------------------------
+    ConsumerID add_consumer() {
+        ++m_active_consumer_count;
+        Consumer consumer = { true, m_log_begin + m_log.size(), {}, std::vector<unsigned int>(m_changes.size(), NOT_CONSUMED) };
+        for (ConsumerID c = 0; c < m_consumers.size(); ++c)
+            if (!m_consumers[c].is_active) {
+                m_consumers[c] = std::move(consumer);
+                return c;
+            }
+        m_consumers.push_back(std::move(consumer));
+        return ConsumerID(m_consumers.size() - 1);
+    }
+
+    // Removing an unknown consumer is a no-op, fx when the change set was reallocated after the consumer was added.
+    void remove_consumer(ConsumerID consumer_ID) {
+        if (consumer_ID >= m_consumers.size())
+            return;
+        Consumer& consumer = m_consumers[consumer_ID];
+        if (!consumer.is_active)
+            return;
+        consumer = { false, 0, {}, {} };
+
+        // The entries only read by the removed consumer are trimmed on the next reset.
+        if (--m_active_consumer_count == 0) {
+            m_log.clear();
+            m_log_begin = 0;
+        }
+    }
+
+    // Returns the changes made since the consumer last consumed, merged pr resource.
+    // The returned changes are valid until the next time the consumer consumes changes.
+    // Different consumers can consume concurrently, as long as no changes are made or reset meanwhile.
+    Core::Iterable<ConsumedIterator> consume_changes(ConsumerID consumer_ID) {
+        Consumer& consumer = m_consumers[consumer_ID];
+        std::vector<ResourceChanges>& consumed_changes = consumer.consumed_changes;
+        std::vector<unsigned int>& consumed_positions = consumer.consumed_positions;
+        consumed_changes.clear();
+
+        for (size_t e = size_t(consumer.next_entry - m_log_begin); e < m_log.size(); ++e) {
+            const ResourceChanges& entry = m_log[e];
+            unsigned int& position = consumed_positions[entry.ID];
+            // A resource slot can be reused within the log, in which case the new resource gets its own entry.
+            if (position != NOT_CONSUMED && consumed_changes[position].ID == entry.ID)
+                consumed_changes[position].changes |= entry.changes;
+            else {
+                position = (unsigned int)consumed_changes.size();
+                consumed_changes.push_back(entry);
+            }
+        }
+
+        for (const ResourceChanges& changes : consumed_changes)
+            consumed_positions[changes.ID] = NOT_CONSUMED;
+
+        consumer.next_entry = m_log_begin + m_log.size();
+
+        return Core::Iterable<ConsumedIterator>(consumed_changes.begin(), consumed_changes.end());
+    }
 };
 
 } // NS Core
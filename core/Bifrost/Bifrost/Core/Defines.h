@@ -15,4 +15,9 @@
 #define __always_inline__ inline
 #endif
 
+// SSE2 is available on all x64 targets. Code using it must provide a scalar fallback.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIFROST_SSE2 1
+#endif
+
 #endif // _BIFROST_CORE_DEFINES_H_
@@ -7,37 +7,132 @@
 // ---------------------------------------------------------------------------
 
 #include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/Profiler.h>
+#include <Bifrost/Core/TaskScheduler.h>
 
 #include <Bifrost/Input/Keyboard.h>
 #include <Bifrost/Input/Mouse.h>
 
+#include <mutex>
+
 namespace Bifrost {
 namespace Core {
 
 Engine::Engine(const std::filesystem::path& data_directory)
     : m_window(Window("Bifrost", 640, 480))
-    , m_mutating_callbacks(0)
-    , m_non_mutating_callbacks(0)
-    , m_tick_cleanup_callbacks(0)
     , m_quit(false)
+    , m_mutating_callbacks("Mutating callbacks")
+    , m_non_mutating_callbacks("Non-mutating callbacks")
+    , m_tick_cleanup_callbacks("Tick cleanup callbacks")
     , m_keyboard(nullptr)
     , m_mouse(nullptr) 
     , m_data_directory(data_directory) {
 }
 
 void Engine::do_tick(double delta_time) {
+    Profiler::begin_frame();
+    BIFROST_PROFILE_SCOPE("Engine::do_tick");
+
     m_time.tick(delta_time);
 
     m_window.reset_change_notifications();
 
-    for (auto callback : m_mutating_callbacks)
-        callback();
+    m_mutating_callbacks.execute();
+    m_non_mutating_callbacks.execute();
+    m_tick_cleanup_callbacks.execute();
+}
+
+// ---------------------------------------------------------------------------
+// Callback graph.
+// ---------------------------------------------------------------------------
+
+void Engine::CallbackGraph::add(const char* name, std::function<void()> function, Managers reads, Managers writes) {
+    int callback_index = int(m_callbacks.size());
+    Callback callback = { name, std::move(function), reads, writes, {}, 0 };
+
+    // The new callback depends on all previous callbacks it has a conflicting access with.
+    for (int c = 0; c < callback_index; ++c) {
+        Callback& previous = m_callbacks[c];
+        bool conflicts = (previous.writes & (reads | writes)) || (previous.reads & writes);
+        if (conflicts) {
+            previous.dependents.push_back(callback_index);
+            ++callback.dependency_count;
+        }
+    }
+
+    m_callbacks.push_back(std::move(callback));
+    m_remaining_dependencies = std::unique_ptr<std::atomic<int>[]>(new std::atomic<int>[m_callbacks.size()]);
+}
+
+void Engine::CallbackGraph::execute() {
+    BIFROST_PROFILE_SCOPE(m_name);
+
+    int callback_count = int(m_callbacks.size());
+    TaskScheduler& scheduler = TaskScheduler::get_global();
+
+    // Fast path for graphs where every callback depends on all the previous ones. Callbacks are registered
+    // after their dependencies, so registration order is always a valid execution order.
+    bool is_sequential = true;
+    for (int c = 0; c < callback_count && is_sequential; ++c)
+        is_sequential = m_callbacks[c].dependents.size() == size_t(callback_count - c - 1);
+    is_sequential |= scheduler.get_worker_count() == 0;
+    if (is_sequential) {
+        for (Callback& callback : m_callbacks) {
+            BIFROST_PROFILE_SCOPE(callback.name);
+            callback.function();
+        }
+        return;
+    }
+
+    for (int c = 0; c < callback_count; ++c)
+        m_remaining_dependencies[c].store(m_callbacks[c].dependency_count, std::memory_order_relaxed);
+
+    // Callbacks writing to the window are handed to the ticking thread, the rest to the task scheduler.
+    std::atomic<int> remaining_callback_count = callback_count;
+    std::mutex ticking_thread_mutex;
+    std::vector<int> ticking_thread_callbacks;
+    TaskGroup group(scheduler);
+
+    std::function<void(int)> run_callback;
+    auto schedule_callback = [&](int callback_index) {
+        if (m_callbacks[callback_index].is_exclusive()) {
+            std::lock_guard<std::mutex> lock(ticking_thread_mutex);
+            ticking_thread_callbacks.push_back(callback_index);
+        } else
+            group.run([&run_callback, callback_index]() { run_callback(callback_index); });
+    };
+    run_callback = [&](int callback_index) {
+        Callback& callback = m_callbacks[callback_index];
+        {
+            BIFROST_PROFILE_SCOPE(callback.name);
+            callback.function();
+        }
+        for (int dependent_index : callback.dependents)
+            if (m_remaining_dependencies[dependent_index].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                schedule_callback(dependent_index);
+        remaining_callback_count.fetch_sub(1, std::memory_order_release);
+    };
+
+    for (int c = 0; c < callback_count; ++c)
+        if (m_callbacks[c].dependency_count == 0)
+            schedule_callback(c);
 
-    for (auto callback : m_non_mutating_callbacks)
-        callback();
+    while (remaining_callback_count.load(std::memory_order_acquire) > 0) {
+        int callback_index = -1;
+        {
+            std::lock_guard<std::mutex> lock(ticking_thread_mutex);
+            if (!ticking_thread_callbacks.empty()) {
+                callback_index = ticking_thread_callbacks.back();
+                ticking_thread_callbacks.pop_back();
+            }
+        }
 
-    for (auto callback : m_tick_cleanup_callbacks)
-        callback();
+        if (callback_index >= 0)
+            run_callback(callback_index);
+        else if (!scheduler.try_execute_one())
+            std::this_thread::yield();
+    }
+    group.wait();
 }
 
 } // NS Core
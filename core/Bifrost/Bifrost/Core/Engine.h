@@ -9,11 +9,14 @@
 #ifndef _BIFROST_CORE_ENGINE_H_
 #define _BIFROST_CORE_ENGINE_H_
 
+#include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/Time.h>
 #include <Bifrost/Core/Window.h>
 
+#include <atomic>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <vector>
 
 namespace Bifrost::Input {
@@ -26,6 +29,16 @@ namespace Bifrost::Core {
 // ---------------------------------------------------------------------------
 // Engine driver, responsible for invoking the modules and handling all engine
 // 'tick' logic not related to the operating system.
+// A tick runs the mutating, non-mutating and tick cleanup callbacks as three
+// consecutive stages. Inside a stage the callbacks form a job graph, where a
+// callback depends on the callbacks registered before it that write to a manager
+// it reads or writes, or that read a manager it writes.
+// Independent callbacks run in parallel on the global task scheduler.
+// Callbacks that write to the window, such as renderers presenting a frame,
+// are run on the ticking thread, so callbacks bound to a graphics context keep
+// working. Callbacks that don't declare their manager access are assumed to
+// read and write everything, so they also run on the ticking thread in
+// registration order.
 // Future work
 // * Add a 'mutation complete' (said in the Zerg voice) callback.
 // * Add on_exit callback and deallocate the managers internal state.
@@ -53,9 +66,34 @@ public:
     // -----------------------------------------------------------------------
     // Callbacks
     // -----------------------------------------------------------------------
-    inline void add_mutating_callback(std::function<void()> callback) { m_mutating_callbacks.push_back(callback); }
-    inline void add_non_mutating_callback(std::function<void()> callback) { m_non_mutating_callbacks.push_back(callback); }
-    inline void add_tick_cleanup_callback(std::function<void()> callback) { m_tick_cleanup_callbacks.push_back(callback); }
+    enum class Manager : unsigned short {
+        None = 0u,
+        Cameras = 1u << 0u,
+        Images = 1u << 1u,
+        LightSources = 1u << 2u,
+        Materials = 1u << 3u,
+        Meshes = 1u << 4u,
+        MeshModels = 1u << 5u,
+        Renderers = 1u << 6u,
+        SceneNodes = 1u << 7u,
+        SceneRoots = 1u << 8u,
+        Textures = 1u << 9u,
+        Window = 1u << 10u,
+        Input = 1u << 11u,
+        All = 0xFFFF
+    };
+    typedef Core::Bitmask<Manager> Managers;
+
+    // The name labels the callback's profiler scope and must be a string literal or otherwise outlive the profiler.
+    inline void add_mutating_callback(const char* name, std::function<void()> callback, Managers reads = Manager::All, Managers writes = Manager::All) {
+        m_mutating_callbacks.add(name, std::move(callback), reads, writes);
+    }
+    inline void add_non_mutating_callback(const char* name, std::function<void()> callback, Managers reads = Manager::All, Managers writes = Manager::All) {
+        m_non_mutating_callbacks.add(name, std::move(callback), reads, writes);
+    }
+    inline void add_tick_cleanup_callback(const char* name, std::function<void()> callback, Managers reads = Manager::All, Managers writes = Manager::All) {
+        m_tick_cleanup_callbacks.add(name, std::move(callback), reads, writes);
+    }
 
     // -----------------------------------------------------------------------
     // Paths
@@ -73,14 +111,40 @@ private:
     Engine(const Engine& rhs) = delete;
     Engine& operator=(Engine& rhs) = delete;
 
+    // -----------------------------------------------------------------------
+    // Callbacks of a tick stage and their dependencies.
+    // -----------------------------------------------------------------------
+    class CallbackGraph final {
+    public:
+        CallbackGraph(const char* name) : m_name(name) {}
+        void add(const char* name, std::function<void()> callback, Managers reads, Managers writes);
+        void execute();
+
+    private:
+        struct Callback final {
+            const char* name;
+            std::function<void()> function;
+            Managers reads;
+            Managers writes;
+            std::vector<int> dependents;
+            int dependency_count;
+
+            inline bool is_exclusive() const { return writes.is_set(Manager::Window); }
+        };
+
+        const char* m_name;
+        std::vector<Callback> m_callbacks;
+        std::unique_ptr<std::atomic<int>[]> m_remaining_dependencies;
+    };
+
     Time m_time;
     Window m_window;
     bool m_quit;
 
     // All engine callbacks.
-    std::vector<std::function<void()>> m_mutating_callbacks;
-    std::vector<std::function<void()>> m_non_mutating_callbacks;
-    std::vector<std::function<void()>> m_tick_cleanup_callbacks;
+    CallbackGraph m_mutating_callbacks;
+    CallbackGraph m_non_mutating_callbacks;
+    CallbackGraph m_tick_cleanup_callbacks;
 
     // Input should only be updated by whoever created it and not by access via the engine.
     const Input::Keyboard* m_keyboard;
@@ -0,0 +1,129 @@
+// Bifrost read only memory mapped file.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Core/MemoryMappedFile.h>
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Bifrost::Core {
+
+#if defined(_WIN32)
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = (const unsigned char*)data;
+    m_size = (size_t)file_size.QuadPart;
+}
+
+void MemoryMappedFile::close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_file = m_mapping = nullptr;
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other)
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+    , m_file(std::exchange(other.m_file, nullptr)), m_mapping(std::exchange(other.m_mapping, nullptr)) { }
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& rhs) {
+    if (this != &rhs) {
+        close();
+        m_data = std::exchange(rhs.m_data, nullptr);
+        m_size = std::exchange(rhs.m_size, 0);
+        m_file = std::exchange(rhs.m_file, nullptr);
+        m_mapping = std::exchange(rhs.m_mapping, nullptr);
+    }
+    return *this;
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return;
+
+    struct stat file_status;
+    if (fstat(file, &file_status) != 0 || file_status.st_size == 0) {
+        ::close(file);
+        return;
+    }
+
+    // The mapping keeps the file referenced, so the descriptor can be closed right away.
+    void* data = mmap(nullptr, (size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED)
+        return;
+    madvise(data, (size_t)file_status.st_size, MADV_SEQUENTIAL);
+
+    m_data = (const unsigned char*)data;
+    m_size = (size_t)file_status.st_size;
+}
+
+void MemoryMappedFile::close() {
+    if (m_data != nullptr)
+        munmap((void*)m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other)
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) { }
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& rhs) {
+    if (this != &rhs) {
+        close();
+        m_data = std::exchange(rhs.m_data, nullptr);
+        m_size = std::exchange(rhs.m_size, 0);
+    }
+    return *this;
+}
+
+#endif
+
+} // NS Bifrost::Core
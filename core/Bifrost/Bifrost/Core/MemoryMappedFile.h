@@ -0,0 +1,51 @@
+// Bifrost read only memory mapped file.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_MEMORY_MAPPED_FILE_H_
+#define _BIFROST_CORE_MEMORY_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace Bifrost::Core {
+
+// ------------------------------------------------------------------------------------------------
+// Maps a file read only into the address space of the process.
+// The pages are read from the file when they are first touched, so mapping a file is cheap
+// regardless of its size and only the parts that are accessed are loaded.
+// ------------------------------------------------------------------------------------------------
+class MemoryMappedFile final {
+public:
+    MemoryMappedFile() = default;
+    // Maps the file. Check is_open() to see if the file could be mapped.
+    explicit MemoryMappedFile(const std::string& path);
+    ~MemoryMappedFile() { close(); }
+
+    MemoryMappedFile(MemoryMappedFile&& other);
+    MemoryMappedFile& operator=(MemoryMappedFile&& rhs);
+    MemoryMappedFile(const MemoryMappedFile& other) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile& rhs) = delete;
+
+    inline bool is_open() const { return m_data != nullptr; }
+    inline const unsigned char* data() const { return m_data; }
+    inline size_t size() const { return m_size; }
+
+    void close();
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+#if defined(_WIN32)
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+} // NS Bifrost::Core
+
+#endif // _BIFROST_CORE_MEMORY_MAPPED_FILE_H_
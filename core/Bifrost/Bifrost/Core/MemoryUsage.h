@@ -0,0 +1,93 @@
+// Bifrost memory usage.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_MEMORY_USAGE_H_
+#define _BIFROST_CORE_MEMORY_USAGE_H_
+
+#include <Bifrost/Core/ReservedArray.h>
+
+#include <string>
+#include <vector>
+
+namespace Bifrost::Core {
+
+enum class MemoryCategory : unsigned char {
+    Pixels,        // Image pixels, including mipmaps and screenshots.
+    Vertices,      // Mesh positions, normals and texcoords.
+    Indices,       // Mesh primitives.
+    Distributions, // Sampling distributions, fx the CDFs of environment lights.
+    BVHs,          // Bounding volume hierarchies cached with meshes.
+    Metadata,      // Per resource properties, names and UID generators.
+    ChangeSets,    // Change notifications and logs for change consumers.
+    Count
+};
+
+static constexpr unsigned int MEMORY_CATEGORY_COUNT = (unsigned int)MemoryCategory::Count;
+
+inline const char* to_string(MemoryCategory category) {
+    switch (category) {
+    case MemoryCategory::Pixels: return "pixels";
+    case MemoryCategory::Vertices: return "vertices";
+    case MemoryCategory::Indices: return "indices";
+    case MemoryCategory::Distributions: return "distributions";
+    case MemoryCategory::BVHs: return "BVHs";
+    case MemoryCategory::Metadata: return "metadata";
+    case MemoryCategory::ChangeSets: return "change sets";
+    default: return "unknown";
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// Bytes allocated pr memory category.
+// ------------------------------------------------------------------------------------------------
+struct MemoryUsage final {
+    size_t bytes[MEMORY_CATEGORY_COUNT] = {};
+
+    inline size_t& operator[](MemoryCategory category) { return bytes[(unsigned int)category]; }
+    inline size_t operator[](MemoryCategory category) const { return bytes[(unsigned int)category]; }
+
+    inline size_t get_total_bytes() const {
+        size_t total_bytes = 0;
+        for (size_t category_bytes : bytes)
+            total_bytes += category_bytes;
+        return total_bytes;
+    }
+
+    inline MemoryUsage& operator+=(const MemoryUsage& rhs) {
+        for (unsigned int c = 0; c < MEMORY_CATEGORY_COUNT; ++c)
+            bytes[c] += rhs.bytes[c];
+        return *this;
+    }
+
+    inline MemoryUsage operator+(const MemoryUsage& rhs) const {
+        MemoryUsage sum = *this;
+        return sum += rhs;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Allocated bytes of common containers. Only memory allocated by the containers is counted,
+// not the size of the container objects themselves.
+// ------------------------------------------------------------------------------------------------
+
+// Strings short enough to be stored inside the string object do not allocate.
+inline size_t get_allocated_bytes(const std::string& str) {
+    const char* data = str.data();
+    bool is_stored_locally = (const char*)&str <= data && data < (const char*)(&str + 1);
+    return is_stored_locally ? 0 : str.capacity() + 1;
+}
+
+template <typename T>
+inline size_t get_allocated_bytes(const std::vector<T>& vector) { return vector.capacity() * sizeof(T); }
+
+template <typename T>
+inline size_t get_allocated_bytes(const ReservedArray<T>& array) { return array.committed_bytes(); }
+
+} // NS Bifrost::Core
+
+#endif // _BIFROST_CORE_MEMORY_USAGE_H_
@@ -2,37 +2,90 @@
 // ------------------------------------------------------------------------------------------------
 // Copyright (C) Bifrost. See AUTHORS.txt for authors.
 //
-// This program is open source and distributed under the New BSD License. 
+// This program is open source and distributed under the New BSD License.
 // See LICENSE.txt for more detail.
 // ------------------------------------------------------------------------------------------------
 
 #ifndef _BIFROST_CORE_PARALLEL_H_
 #define _BIFROST_CORE_PARALLEL_H_
 
-#include <functional>
+#include <Bifrost/Core/TaskScheduler.h>
 
-#include <omp.h>
+#include <type_traits>
+#include <vector>
 
 namespace Bifrost {
 namespace Core {
 namespace Parallel {
 
-template <typename LocalState>
-void for_range(int begin, int end, std::function<LocalState()> local_init, 
-               std::function<void(int, LocalState&)> body, 
-               std::function<void(LocalState)> local_finally) {
-#pragma omp parallel
-    {
-        auto local_state = local_init();
+// ------------------------------------------------------------------------------------------------
+// Calls body(i) for every i in [begin, end[ using the global task scheduler.
+// Every task processes a contiguous chunk of indices and the body is inlined into the chunk loop.
+// ------------------------------------------------------------------------------------------------
+template <typename Body>
+inline void for_each(int begin, int end, Body body, int grain_size = 0) {
+    TaskScheduler::get_global().parallel_for(begin, end, grain_size, [&](int chunk_begin, int chunk_end) {
+        for (int i = chunk_begin; i < chunk_end; ++i)
+            body(i);
+    });
+}
+
+// ------------------------------------------------------------------------------------------------
+// Calls body(chunk_begin, chunk_end) for contiguous chunks of [begin, end[.
+// ------------------------------------------------------------------------------------------------
+template <typename Body>
+inline void for_each_chunk(int begin, int end, Body body, int grain_size = 0) {
+    TaskScheduler::get_global().parallel_for(begin, end, grain_size, body);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Reduces [begin, end[ without locking.
+// map(i) -> T is called for every index and the results are combined with combine(T, T) -> T.
+// ------------------------------------------------------------------------------------------------
+template <typename T, typename Map, typename Combine>
+inline T reduce(int begin, int end, T identity, Map map, Combine combine, int grain_size = 0) {
+    return TaskScheduler::get_global().parallel_reduce(begin, end, grain_size, identity,
+        [&](int chunk_begin, int chunk_end, T result) -> T {
+            for (int i = chunk_begin; i < chunk_end; ++i)
+                result = combine(result, map(i));
+            return result;
+        }, combine);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Loops over [begin, end[ with a local state pr chunk.
+// local_init() creates the state of a chunk, body(i, state) is called for every index in the
+// chunk and local_finally(state) is called for every chunk state once all chunks are done.
+// The finalizers run sequentially on the calling thread, so they can merge into shared state
+// without a critical section.
+// ------------------------------------------------------------------------------------------------
+template <typename LocalInit, typename Body, typename LocalFinally>
+void for_range(int begin, int end, LocalInit local_init, Body body, LocalFinally local_finally) {
+    typedef std::invoke_result_t<LocalInit> LocalState;
+
+    TaskScheduler& scheduler = TaskScheduler::get_global();
+    int chunk_count = scheduler.compute_chunk_count(end - begin, 0);
+    if (chunk_count == 0)
+        return;
+
+    std::vector<LocalState> local_states;
+    local_states.reserve(chunk_count);
+    for (int c = 0; c < chunk_count; ++c)
+        local_states.emplace_back(local_init());
 
-        int thread_id = omp_get_thread_num();
-        int thread_count = omp_get_num_threads();
-        for (int i = begin + thread_id; i < end; i += thread_count)
-            body(i, local_state);
+    int chunk_size = (end - begin + chunk_count - 1) / chunk_count;
+    scheduler.parallel_for(0, chunk_count, 1, [&](int chunk_begin, int chunk_end) {
+        for (int c = chunk_begin; c < chunk_end; ++c) {
+            LocalState& local_state = local_states[c];
+            int range_begin = begin + c * chunk_size;
+            int range_end = range_begin + chunk_size < end ? range_begin + chunk_size : end;
+            for (int i = range_begin; i < range_end; ++i)
+                body(i, local_state);
+        }
+    });
 
-#pragma omp critical
+    for (LocalState& local_state : local_states)
         local_finally(local_state);
-    }
 }
 
 } // NS Parallel
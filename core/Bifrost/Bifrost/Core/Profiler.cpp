@@ -0,0 +1,209 @@
+// Bifrost frame profiler.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Core/Profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace Bifrost::Core {
+
+std::atomic<bool> Profiler::m_enabled = false;
+std::atomic<unsigned int> Profiler::m_frame = 0u;
+
+// ------------------------------------------------------------------------------------------------
+// Per thread event ring buffer.
+// Only the owning thread writes events. The write index is published after the event is written,
+// so readers only see completed events.
+// ------------------------------------------------------------------------------------------------
+struct ThreadBuffer final {
+    static constexpr unsigned long long INDEX_MASK = Profiler::EVENTS_PR_THREAD - 1;
+
+    unsigned int thread_index;
+    unsigned int depth;
+    std::unique_ptr<Profiler::Event[]> events;
+    std::atomic<unsigned long long> write_index;
+    std::atomic<unsigned long long> read_begin; // Events before this index have been reset.
+
+    ThreadBuffer(unsigned int thread_index)
+        : thread_index(thread_index), depth(0), events(new Profiler::Event[Profiler::EVENTS_PR_THREAD])
+        , write_index(0), read_begin(0) { }
+};
+
+static std::mutex g_thread_buffers_mutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> g_thread_buffers;
+static thread_local ThreadBuffer* g_thread_buffer = nullptr;
+
+static ThreadBuffer& get_thread_buffer() {
+    if (g_thread_buffer == nullptr) {
+        // Buffers are never released, as a thread may exit before its events are exported.
+        std::lock_guard<std::mutex> lock(g_thread_buffers_mutex);
+        g_thread_buffers.emplace_back(new ThreadBuffer((unsigned int)g_thread_buffers.size()));
+        g_thread_buffer = g_thread_buffers.back().get();
+    }
+    return *g_thread_buffer;
+}
+
+long long Profiler::now_ns() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+long long Profiler::begin_scope() {
+    ++get_thread_buffer().depth;
+    return now_ns();
+}
+
+void Profiler::end_scope(const char* name, long long begin_ns) {
+    long long end_ns = now_ns();
+    ThreadBuffer& buffer = get_thread_buffer();
+    --buffer.depth;
+
+    unsigned long long index = buffer.write_index.load(std::memory_order_relaxed);
+    buffer.events[index & ThreadBuffer::INDEX_MASK] = { name, begin_ns, end_ns, get_frame(), buffer.depth };
+    buffer.write_index.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(g_thread_buffers_mutex);
+    for (auto& buffer : g_thread_buffers)
+        buffer->read_begin.store(buffer->write_index.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::collect_events() {
+    std::lock_guard<std::mutex> lock(g_thread_buffers_mutex);
+
+    std::vector<ThreadEvents> thread_events;
+    thread_events.reserve(g_thread_buffers.size());
+    for (auto& buffer : g_thread_buffers) {
+        unsigned long long end = buffer->write_index.load(std::memory_order_acquire);
+        unsigned long long begin = buffer->read_begin.load(std::memory_order_relaxed);
+        if (end - begin > EVENTS_PR_THREAD)
+            begin = end - EVENTS_PR_THREAD;
+
+        std::vector<Event> events;
+        events.reserve(size_t(end - begin));
+        for (unsigned long long i = begin; i < end; ++i)
+            events.push_back(buffer->events[i & ThreadBuffer::INDEX_MASK]);
+
+        // Drop the events that the owning thread may have overwritten while they were copied.
+        unsigned long long new_end = buffer->write_index.load(std::memory_order_acquire);
+        if (new_end - begin >= EVENTS_PR_THREAD) {
+            size_t overwritten_count = size_t(std::min(new_end - begin - EVENTS_PR_THREAD + 1, end - begin));
+            events.erase(events.begin(), events.begin() + overwritten_count);
+        }
+
+        thread_events.push_back({ buffer->thread_index, std::move(events) });
+    }
+
+    return thread_events;
+}
+
+std::vector<Profiler::ScopeSummary> Profiler::get_frame_summary(unsigned int frame) {
+    struct FirstOccurrence {
+        long long begin_ns;
+        ScopeSummary summary;
+    };
+    std::vector<FirstOccurrence> scopes;
+
+    for (const ThreadEvents& thread : collect_events())
+        for (const Event& event : thread.events) {
+            if (event.frame != frame)
+                continue;
+
+            double duration_ms = (event.end_ns - event.begin_ns) / 1000000.0;
+            auto scope_itr = std::find_if(scopes.begin(), scopes.end(), [&](const FirstOccurrence& scope) {
+                return scope.summary.name == event.name && scope.summary.depth == event.depth;
+            });
+            if (scope_itr == scopes.end())
+                scopes.push_back({ event.begin_ns, { event.name, event.depth, 1, duration_ms, duration_ms } });
+            else {
+                ScopeSummary& summary = scope_itr->summary;
+                scope_itr->begin_ns = std::min(scope_itr->begin_ns, event.begin_ns);
+                ++summary.call_count;
+                summary.total_ms += duration_ms;
+                summary.max_ms = std::max(summary.max_ms, duration_ms);
+            }
+        }
+
+    // Parents begin before their children, so ordering by begin time yields a hierarchical order.
+    std::sort(scopes.begin(), scopes.end(), [](const FirstOccurrence& lhs, const FirstOccurrence& rhs) {
+        return lhs.begin_ns < rhs.begin_ns || (lhs.begin_ns == rhs.begin_ns && lhs.summary.depth < rhs.summary.depth);
+    });
+
+    std::vector<ScopeSummary> summaries;
+    summaries.reserve(scopes.size());
+    for (const FirstOccurrence& scope : scopes)
+        summaries.push_back(scope.summary);
+    return summaries;
+}
+
+void Profiler::write_frame_summary(std::ostream& out, unsigned int frame) {
+    out << "Frame " << frame << ":\n";
+    for (const ScopeSummary& summary : get_frame_summary(frame)) {
+        for (unsigned int d = 0; d < summary.depth; ++d)
+            out << "  ";
+        out << summary.name << ": " << summary.total_ms << "ms";
+        if (summary.call_count > 1)
+            out << " (" << summary.call_count << " calls, max " << summary.max_ms << "ms)";
+        out << "\n";
+    }
+}
+
+static void write_json_string(std::ostream& out, const char* str) {
+    out << '"';
+    for (const char* c = str; *c != 0; ++c) {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+void Profiler::write_chrome_trace(std::ostream& out) {
+    std::vector<ThreadEvents> thread_events = collect_events();
+
+    // Timestamps are written relative to the first event to keep them short and precise.
+    long long trace_begin_ns = LLONG_MAX;
+    for (const ThreadEvents& thread : thread_events)
+        for (const Event& event : thread.events)
+            trace_begin_ns = std::min(trace_begin_ns, event.begin_ns);
+
+    std::streamsize previous_precision = out.precision(12);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first_event = true;
+    for (const ThreadEvents& thread : thread_events)
+        for (const Event& event : thread.events) {
+            if (!first_event)
+                out << ",";
+            first_event = false;
+
+            // Chrome traces use microseconds.
+            out << "\n{\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"cat\":\"bifrost\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.thread_index
+                << ",\"ts\":" << (event.begin_ns - trace_begin_ns) / 1000.0 << ",\"dur\":" << (event.end_ns - event.begin_ns) / 1000.0
+                << ",\"args\":{\"frame\":" << event.frame << "}}";
+        }
+    out << "\n]}\n";
+    out.precision(previous_precision);
+}
+
+bool Profiler::write_chrome_trace(const std::filesystem::path& path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    write_chrome_trace(out);
+    return bool(out);
+}
+
+} // NS Bifrost::Core
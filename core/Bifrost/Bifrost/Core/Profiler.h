@@ -0,0 +1,121 @@
+// Bifrost frame profiler.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_PROFILER_H_
+#define _BIFROST_CORE_PROFILER_H_
+
+#include <atomic>
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+namespace Bifrost::Core {
+
+// ------------------------------------------------------------------------------------------------
+// Hierarchical scope profiler.
+// Scopes are recorded into a fixed size ring buffer owned by the recording thread, so recording
+// never takes a lock. When the buffer is full the oldest events are overwritten.
+// Profiling is disabled by default and a disabled scope costs a single relaxed atomic load.
+// Defining BIFROST_DISABLE_PROFILING compiles all BIFROST_PROFILE_SCOPE markers out.
+// Scope names must be string literals or otherwise outlive the profiler.
+// The recorded events can be exported as Chrome trace JSON, viewable in chrome://tracing or
+// https://ui.perfetto.dev, or summarized pr frame.
+// ------------------------------------------------------------------------------------------------
+class Profiler final {
+public:
+    static constexpr unsigned int EVENTS_PR_THREAD = 1u << 16u;
+
+    struct Event final {
+        const char* name;
+        long long begin_ns;
+        long long end_ns;
+        unsigned int frame;
+        unsigned int depth;
+    };
+
+    struct ThreadEvents final {
+        unsigned int thread_index;
+        std::vector<Event> events;
+    };
+
+    struct ScopeSummary final {
+        const char* name;
+        unsigned int depth;
+        unsigned int call_count;
+        double total_ms;
+        double max_ms;
+    };
+
+    static inline bool is_enabled() { return m_enabled.load(std::memory_order_relaxed); }
+    static inline void set_enabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+    // Advances the frame counter. Called by the engine at the beginning of every tick.
+    static inline void begin_frame() { m_frame.fetch_add(1, std::memory_order_relaxed); }
+    static inline unsigned int get_frame() { return m_frame.load(std::memory_order_relaxed); }
+
+    // Discards all recorded events.
+    static void reset();
+
+    // Nanoseconds since an arbitrary, but fixed, point in time.
+    static long long now_ns();
+
+    // --------------------------------------------------------------------------------------------
+    // Scoped marker. Records the time from construction to destruction.
+    // --------------------------------------------------------------------------------------------
+    class Scope final {
+    public:
+        explicit inline Scope(const char* name) : m_name(is_enabled() ? name : nullptr) {
+            if (m_name != nullptr)
+                m_begin_ns = begin_scope();
+        }
+        inline ~Scope() {
+            if (m_name != nullptr)
+                end_scope(m_name, m_begin_ns);
+        }
+
+    private:
+        Scope(const Scope& rhs) = delete;
+        Scope& operator=(Scope& rhs) = delete;
+
+        const char* m_name;
+        long long m_begin_ns;
+    };
+
+    // --------------------------------------------------------------------------------------------
+    // Export.
+    // Exporting while other threads are recording is safe, but events overwritten during the
+    // export are dropped.
+    // --------------------------------------------------------------------------------------------
+    static std::vector<ThreadEvents> collect_events();
+
+    // Aggregates the events of a frame by name and depth, ordered by their first occurrence.
+    static std::vector<ScopeSummary> get_frame_summary(unsigned int frame);
+    static void write_frame_summary(std::ostream& out, unsigned int frame);
+
+    static void write_chrome_trace(std::ostream& out);
+    static bool write_chrome_trace(const std::filesystem::path& path);
+
+private:
+    static long long begin_scope();
+    static void end_scope(const char* name, long long begin_ns);
+
+    static std::atomic<bool> m_enabled;
+    static std::atomic<unsigned int> m_frame;
+};
+
+} // NS Bifrost::Core
+
+#ifdef BIFROST_DISABLE_PROFILING
+#define BIFROST_PROFILE_SCOPE(name)
+#else
+#define BIFROST_PROFILE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define BIFROST_PROFILE_SCOPE_CONCAT(a, b) BIFROST_PROFILE_SCOPE_CONCAT_IMPL(a, b)
+#define BIFROST_PROFILE_SCOPE(name) ::Bifrost::Core::Profiler::Scope BIFROST_PROFILE_SCOPE_CONCAT(_bifrost_profile_scope_, __LINE__)(name)
+#endif
+
+#endif // _BIFROST_CORE_PROFILER_H_
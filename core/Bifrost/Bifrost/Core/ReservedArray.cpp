@@ -0,0 +1,84 @@
+// Bifrost array in reserved virtual memory.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Core/ReservedArray.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Bifrost::Core::VirtualMemory {
+
+#if defined(_WIN32)
+
+size_t page_size() {
+    static const size_t page_bytes = []() -> size_t {
+        SYSTEM_INFO system_info;
+        GetSystemInfo(&system_info);
+        return system_info.dwPageSize;
+    }();
+    return page_bytes;
+}
+
+void* reserve(size_t byte_count) {
+    void* address = VirtualAlloc(nullptr, byte_count, MEM_RESERVE, PAGE_NOACCESS);
+    if (address == nullptr)
+        throw std::bad_alloc();
+    return address;
+}
+
+void commit(void* address, size_t byte_count) {
+    if (VirtualAlloc(address, byte_count, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        throw std::bad_alloc();
+}
+
+void decommit(void* address, size_t byte_count) {
+    VirtualFree(address, byte_count, MEM_DECOMMIT);
+}
+
+void release(void* address, size_t byte_count) {
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+#else
+
+size_t page_size() {
+    static const size_t page_bytes = (size_t)sysconf(_SC_PAGESIZE);
+    return page_bytes;
+}
+
+void* reserve(size_t byte_count) {
+    void* address = mmap(nullptr, byte_count, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (address == MAP_FAILED)
+        throw std::bad_alloc();
+    return address;
+}
+
+void commit(void* address, size_t byte_count) {
+    if (mprotect(address, byte_count, PROT_READ | PROT_WRITE) != 0)
+        throw std::bad_alloc();
+}
+
+void decommit(void* address, size_t byte_count) {
+    // Drop the pages, so they are zero filled if committed again, and make the range inaccessible.
+    madvise(address, byte_count, MADV_DONTNEED);
+    mprotect(address, byte_count, PROT_NONE);
+}
+
+void release(void* address, size_t byte_count) {
+    munmap(address, byte_count);
+}
+
+#endif
+
+} // NS Bifrost::Core::VirtualMemory
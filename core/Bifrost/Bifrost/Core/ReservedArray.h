@@ -0,0 +1,182 @@
+// Bifrost array in reserved virtual memory.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_RESERVED_ARRAY_H_
+#define _BIFROST_CORE_RESERVED_ARRAY_H_
+
+#include <assert.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Bifrost::Core {
+
+// ------------------------------------------------------------------------------------------------
+// Thin wrapper around the OS virtual memory API.
+// Reserved address space is not backed by memory until it is committed.
+// Committed memory is zero initialized.
+// ------------------------------------------------------------------------------------------------
+namespace VirtualMemory {
+
+size_t page_size();
+inline size_t round_up_to_page_size(size_t byte_count) {
+    size_t page_bytes = page_size();
+    return (byte_count + page_bytes - 1) / page_bytes * page_bytes;
+}
+
+// Reserves the address space. Throws std::bad_alloc if the address space cannot be reserved.
+void* reserve(size_t byte_count);
+// Commits the page aligned range. Throws std::bad_alloc if the memory cannot be committed.
+void commit(void* address, size_t byte_count);
+// Returns the page aligned range to the OS, but keeps the address space reserved.
+void decommit(void* address, size_t byte_count);
+// Releases the address space returned by reserve.
+void release(void* address, size_t byte_count);
+
+} // NS VirtualMemory
+
+// ------------------------------------------------------------------------------------------------
+// Array of default constructed elements stored in reserved address space.
+// The address space for max_size elements is reserved up front and pages
+// are committed when the array grows, so growing up to the max size never
+// moves the elements. Pointers and references to the elements therefore stay
+// valid while the array grows, fx while another thread reads the elements.
+// Growing beyond the max size falls back to reserving a larger range and
+// moving the elements.
+// The reservation is clamped to MAX_RESERVED_BYTES, so arrays with a huge
+// max size, fx indexed by 64 bit UIDs, do not exhaust the address space.
+// ------------------------------------------------------------------------------------------------
+template <typename T>
+class ReservedArray final {
+public:
+    typedef T value_type;
+
+    static constexpr size_t MAX_RESERVED_BYTES = size_t(1) << 36;
+
+private:
+    T* m_data;
+    size_t m_size;
+    size_t m_max_size;
+    size_t m_committed_bytes;
+
+    static inline size_t clamped_max_size(size_t max_size) {
+        size_t max_reservable_size = MAX_RESERVED_BYTES / sizeof(T);
+        return max_size < max_reservable_size ? max_size : max_reservable_size;
+    }
+
+    inline void commit(size_t size) {
+        size_t required_bytes = VirtualMemory::round_up_to_page_size(sizeof(T) * size);
+        if (required_bytes > m_committed_bytes) {
+            VirtualMemory::commit((char*)m_data + m_committed_bytes, required_bytes - m_committed_bytes);
+            m_committed_bytes = required_bytes;
+        }
+    }
+
+    // Moves the elements to a larger reservation. Invalidates all pointers to the elements.
+    void grow_reservation(size_t max_size) {
+        ReservedArray new_array = ReservedArray(max_size);
+        new_array.commit(m_size);
+        for (size_t i = 0; i < m_size; ++i)
+            new (new_array.m_data + i) T(std::move(m_data[i]));
+        new_array.m_size = m_size;
+        swap(new_array);
+    }
+
+public:
+
+    constexpr ReservedArray() : m_data(nullptr), m_size(0), m_max_size(0), m_committed_bytes(0) { }
+
+    explicit ReservedArray(size_t max_size, size_t size = 0)
+        : m_data(nullptr), m_size(0), m_max_size(clamped_max_size(max_size)), m_committed_bytes(0) {
+        if (m_max_size > 0)
+            m_data = (T*)VirtualMemory::reserve(VirtualMemory::round_up_to_page_size(sizeof(T) * m_max_size));
+        resize(size);
+    }
+
+    ReservedArray(ReservedArray&& other)
+        : m_data(other.m_data), m_size(other.m_size), m_max_size(other.m_max_size), m_committed_bytes(other.m_committed_bytes) {
+        other.m_data = nullptr;
+        other.m_size = other.m_max_size = other.m_committed_bytes = 0;
+    }
+
+    ReservedArray(const ReservedArray& other) = delete;
+
+    ~ReservedArray() {
+        resize(0);
+        if (m_data != nullptr)
+            VirtualMemory::release(m_data, VirtualMemory::round_up_to_page_size(sizeof(T) * m_max_size));
+    }
+
+    ReservedArray& operator=(ReservedArray&& rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ReservedArray& operator=(const ReservedArray& rhs) = delete;
+
+    inline void swap(ReservedArray& other) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_max_size, other.m_max_size);
+        std::swap(m_committed_bytes, other.m_committed_bytes);
+    }
+
+    // --------------------------------------------------------------------------------------------
+    // Size and capacity.
+    // --------------------------------------------------------------------------------------------
+    inline size_t size() const { return m_size; }
+    inline size_t max_size() const { return m_max_size; }
+    inline size_t committed_bytes() const { return m_committed_bytes; }
+
+    // Resizes the array. New elements are default constructed. Shrinking destroys the removed
+    // elements and decommits the pages no longer in use, but keeps the address space reserved.
+    void resize(size_t size) {
+        if (size > m_max_size)
+            grow_reservation(size < 2 * m_max_size ? 2 * m_max_size : size);
+
+        if (size > m_size) {
+            commit(size);
+            if (!std::is_trivially_default_constructible<T>::value)
+                for (size_t i = m_size; i < size; ++i)
+                    new (m_data + i) T;
+        } else if (size < m_size) {
+            if (!std::is_trivially_destructible<T>::value)
+                for (size_t i = size; i < m_size; ++i)
+                    m_data[i].~T();
+            size_t required_bytes = VirtualMemory::round_up_to_page_size(sizeof(T) * size);
+            if (required_bytes < m_committed_bytes) {
+                VirtualMemory::decommit((char*)m_data + required_bytes, m_committed_bytes - required_bytes);
+                m_committed_bytes = required_bytes;
+            }
+        }
+        m_size = size;
+    }
+
+    // Destroys the elements and releases the reserved address space.
+    inline void release() {
+        ReservedArray empty_array;
+        swap(empty_array);
+    }
+
+    // --------------------------------------------------------------------------------------------
+    // Element access.
+    // --------------------------------------------------------------------------------------------
+    inline T& operator[](size_t i) { assert(i < m_size); return m_data[i]; }
+    inline const T& operator[](size_t i) const { assert(i < m_size); return m_data[i]; }
+    inline T* data() { return m_data; }
+    inline const T* data() const { return m_data; }
+    inline T* begin() { return m_data; }
+    inline const T* begin() const { return m_data; }
+    inline T* end() { return m_data + m_size; }
+    inline const T* end() const { return m_data + m_size; }
+};
+
+} // NS Bifrost::Core
+
+#endif // _BIFROST_CORE_RESERVED_ARRAY_H_
@@ -0,0 +1,151 @@
+// Bifrost task scheduler.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Core/TaskScheduler.h>
+
+#include <assert.h>
+
+namespace Bifrost::Core {
+
+// The scheduler and queue owned by the current thread, if it is a worker thread.
+static thread_local const TaskScheduler* g_thread_scheduler = nullptr;
+static thread_local unsigned int g_thread_index = 0;
+
+TaskScheduler::TaskScheduler(unsigned int worker_count)
+    : m_queues(new Queue[worker_count + 1]), m_queued_task_count(0), m_shutdown(false) {
+    m_workers.reserve(worker_count);
+    for (unsigned int w = 0; w < worker_count; ++w)
+        m_workers.emplace_back([this, w]() { worker_loop(w); });
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_shutdown = true;
+    }
+    m_wake_condition.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+TaskScheduler& TaskScheduler::get_global() {
+    static TaskScheduler global_scheduler;
+    return global_scheduler;
+}
+
+unsigned int TaskScheduler::default_worker_count() {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    // The thread submitting work participates as well, so leave a hardware thread for it.
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+unsigned int TaskScheduler::get_thread_index() const {
+    return g_thread_scheduler == this ? g_thread_index : get_worker_count();
+}
+
+void TaskScheduler::submit(Task task, TaskGroup* group) {
+    if (get_worker_count() == 0) {
+        // No workers to hand the task to, so execute it immediately.
+        Entry entry = { std::move(task), group };
+        execute(entry);
+        return;
+    }
+
+    Queue& queue = m_queues[get_thread_index()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.entries.push_back({ std::move(task), group });
+    }
+    m_queued_task_count.fetch_add(1, std::memory_order_release);
+
+    // Take the sleep lock before notifying, so a worker can't miss the wakeup between testing for
+    // queued tasks and going to sleep.
+    { std::lock_guard<std::mutex> lock(m_sleep_mutex); }
+    m_wake_condition.notify_one();
+}
+
+bool TaskScheduler::try_pop(unsigned int queue_index, bool from_back, Entry& entry) {
+    Queue& queue = m_queues[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.entries.empty())
+        return false;
+
+    if (from_back) {
+        entry = std::move(queue.entries.back());
+        queue.entries.pop_back();
+    } else {
+        entry = std::move(queue.entries.front());
+        queue.entries.pop_front();
+    }
+    m_queued_task_count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool TaskScheduler::try_acquire(unsigned int thread_index, Entry& entry) {
+    if (m_queued_task_count.load(std::memory_order_acquire) == 0)
+        return false;
+
+    // Pop the most recently pushed task from the thread's own queue.
+    unsigned int queue_count = get_worker_count() + 1;
+    if (try_pop(thread_index, true, entry))
+        return true;
+
+    // Steal the oldest task from the other queues, starting with the neighbour
+    // to avoid all thieves hammering the same queue.
+    for (unsigned int i = 1; i < queue_count; ++i) {
+        unsigned int victim_index = (thread_index + i) % queue_count;
+        if (try_pop(victim_index, false, entry))
+            return true;
+    }
+
+    return false;
+}
+
+void TaskScheduler::execute(Entry& entry) {
+    entry.task();
+    if (entry.group != nullptr)
+        entry.group->m_pending_count.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool TaskScheduler::try_execute_one() {
+    Entry entry;
+    if (!try_acquire(get_thread_index(), entry))
+        return false;
+    execute(entry);
+    return true;
+}
+
+void TaskScheduler::worker_loop(unsigned int worker_index) {
+    g_thread_scheduler = this;
+    g_thread_index = worker_index;
+
+    while (true) {
+        Entry entry;
+        if (try_acquire(worker_index, entry)) {
+            execute(entry);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake_condition.wait(lock, [this]() {
+            return m_shutdown || m_queued_task_count.load(std::memory_order_acquire) > 0;
+        });
+        if (m_shutdown)
+            return;
+    }
+}
+
+void TaskGroup::wait() {
+    while (!is_done()) {
+        // Help out instead of blocking. This lets tasks wait on nested groups without deadlocking.
+        if (!m_scheduler.try_execute_one())
+            std::this_thread::yield();
+    }
+}
+
+} // NS Bifrost::Core
@@ -0,0 +1,228 @@
+// Bifrost task scheduler.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_TASK_SCHEDULER_H_
+#define _BIFROST_CORE_TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Bifrost::Core {
+
+class TaskGroup;
+
+// ------------------------------------------------------------------------------------------------
+// Work stealing task scheduler.
+// Every worker thread owns a task queue. Tasks spawned from a worker are pushed to and popped from
+// the back of its own queue, which keeps recently touched data in cache, while idle workers steal
+// from the front of the other queues. Tasks spawned from threads outside the pool are pushed to a
+// shared injection queue.
+// Threads waiting on a TaskGroup execute pending tasks while they wait, which makes nested
+// parallelism safe, i.e. a task may itself spawn and wait for a TaskGroup.
+// Tasks are expected to be coarse grained, e.g. a chunk of a range, and must not throw.
+// Future work
+// * Lock-free Chase-Lev deques instead of a mutex pr queue.
+// * Task priorities.
+// ------------------------------------------------------------------------------------------------
+class TaskScheduler final {
+public:
+    typedef std::function<void()> Task;
+
+    // Creates a scheduler with worker_count worker threads.
+    // The thread waiting for a task group also executes tasks, so a scheduler with N workers
+    // runs on N + 1 threads.
+    explicit TaskScheduler(unsigned int worker_count = default_worker_count());
+    ~TaskScheduler();
+
+    // The global scheduler shared by the engine, asset utilities and extensions.
+    static TaskScheduler& get_global();
+    static unsigned int default_worker_count();
+
+    inline unsigned int get_worker_count() const { return (unsigned int)m_workers.size(); }
+    inline unsigned int get_thread_count() const { return get_worker_count() + 1; }
+
+    // Returns the index of the calling thread in [0, worker_count[ if it is a worker of this
+    // scheduler and worker_count otherwise.
+    unsigned int get_thread_index() const;
+
+    // Schedules a task. If a group is given, then the task is tracked by that group.
+    void submit(Task task, TaskGroup* group = nullptr);
+
+    // Schedules a task and returns a future holding the result.
+    // NOTE Blocking on the future from inside a task will not help execute pending tasks,
+    //      so nested waits should use a TaskGroup.
+    template <typename F>
+    std::future<std::invoke_result_t<F>> async(F function);
+
+    // Executes a single pending task on the calling thread, if one is available.
+    // Returns true if a task was executed.
+    bool try_execute_one();
+
+    // --------------------------------------------------------------------------------------------
+    // Parallel algorithms.
+    // The range [begin, end[ is split into contiguous chunks of at least grain_size elements.
+    // A grain size of zero lets the scheduler choose one based on the thread count.
+    // --------------------------------------------------------------------------------------------
+
+    // Calls body(chunk_begin, chunk_end) for every chunk in parallel.
+    template <typename Body>
+    void parallel_for(int begin, int end, int grain_size, Body body);
+
+    // Reduces every chunk with body(chunk_begin, chunk_end, identity) -> T and combines the
+    // partial results in chunk order with combine(T, T) -> T. No locks are taken, as every chunk
+    // writes its partial result to its own slot.
+    template <typename T, typename Body, typename Combine>
+    T parallel_reduce(int begin, int end, int grain_size, T identity, Body body, Combine combine);
+
+    int compute_chunk_count(int element_count, int grain_size) const;
+
+private:
+    friend class TaskGroup;
+
+    // Delete copy constructors.
+    TaskScheduler(const TaskScheduler& rhs) = delete;
+    TaskScheduler& operator=(TaskScheduler& rhs) = delete;
+
+    struct Entry final {
+        Task task;
+        TaskGroup* group;
+    };
+
+    struct alignas(64) Queue final {
+        std::mutex mutex;
+        std::deque<Entry> entries;
+    };
+
+    bool try_pop(unsigned int queue_index, bool from_back, Entry& entry);
+    bool try_acquire(unsigned int thread_index, Entry& entry);
+    void execute(Entry& entry);
+    void worker_loop(unsigned int worker_index);
+
+    std::vector<std::thread> m_workers;
+    std::unique_ptr<Queue[]> m_queues; // One pr worker plus the injection queue.
+
+    std::atomic<int> m_queued_task_count;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake_condition;
+    bool m_shutdown;
+};
+
+// ------------------------------------------------------------------------------------------------
+// A group of tasks that can be waited on.
+// Waiting executes pending tasks on the waiting thread until all tasks in the group are done.
+// ------------------------------------------------------------------------------------------------
+class TaskGroup final {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::get_global())
+        : m_scheduler(scheduler), m_pending_count(0) {}
+    ~TaskGroup() { wait(); }
+
+    template <typename F>
+    inline void run(F function) {
+        m_pending_count.fetch_add(1, std::memory_order_relaxed);
+        m_scheduler.submit(TaskScheduler::Task(std::move(function)), this);
+    }
+
+    void wait();
+
+    inline bool is_done() const { return m_pending_count.load(std::memory_order_acquire) == 0; }
+    inline TaskScheduler& get_scheduler() { return m_scheduler; }
+
+private:
+    friend class TaskScheduler;
+
+    // Delete copy constructors.
+    TaskGroup(const TaskGroup& rhs) = delete;
+    TaskGroup& operator=(TaskGroup& rhs) = delete;
+
+    TaskScheduler& m_scheduler;
+    std::atomic<int> m_pending_count;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Template implementations.
+// ------------------------------------------------------------------------------------------------
+
+template <typename F>
+std::future<std::invoke_result_t<F>> TaskScheduler::async(F function) {
+    typedef std::invoke_result_t<F> Result;
+    auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+    std::future<Result> future = packaged_task->get_future();
+    submit([packaged_task]() { (*packaged_task)(); });
+    return future;
+}
+
+inline int TaskScheduler::compute_chunk_count(int element_count, int grain_size) const {
+    if (element_count <= 0)
+        return 0;
+    if (grain_size <= 0) {
+        // Oversubscribe by a factor of four to let stealing balance uneven workloads.
+        int target_chunk_count = int(get_thread_count()) * 4;
+        grain_size = (element_count + target_chunk_count - 1) / target_chunk_count;
+    }
+    return (element_count + grain_size - 1) / grain_size;
+}
+
+template <typename Body>
+void TaskScheduler::parallel_for(int begin, int end, int grain_size, Body body) {
+    int element_count = end - begin;
+    int chunk_count = compute_chunk_count(element_count, grain_size);
+    if (chunk_count <= 1 || get_worker_count() == 0) {
+        if (element_count > 0)
+            body(begin, end);
+        return;
+    }
+
+    // Distribute the remainder over the first chunks, so chunk sizes differ by at most one.
+    int chunk_size = element_count / chunk_count;
+    int remainder = element_count % chunk_count;
+    auto chunk_begin = [=](int c) { return begin + c * chunk_size + (c < remainder ? c : remainder); };
+
+    TaskGroup group(*this);
+    for (int c = 1; c < chunk_count; ++c) {
+        int range_begin = chunk_begin(c), range_end = chunk_begin(c + 1);
+        group.run([&body, range_begin, range_end]() { body(range_begin, range_end); });
+    }
+    body(chunk_begin(0), chunk_begin(1));
+    group.wait();
+}
+
+template <typename T, typename Body, typename Combine>
+T TaskScheduler::parallel_reduce(int begin, int end, int grain_size, T identity, Body body, Combine combine) {
+    int element_count = end - begin;
+    int chunk_count = compute_chunk_count(element_count, grain_size);
+    if (chunk_count <= 1 || get_worker_count() == 0)
+        return element_count > 0 ? body(begin, end, identity) : identity;
+
+    int chunk_size = element_count / chunk_count;
+    int remainder = element_count % chunk_count;
+    auto chunk_begin = [=](int c) { return begin + c * chunk_size + (c < remainder ? c : remainder); };
+
+    std::vector<T> partial_results(chunk_count, identity);
+    TaskGroup group(*this);
+    for (int c = 1; c < chunk_count; ++c)
+        group.run([&, c]() { partial_results[c] = body(chunk_begin(c), chunk_begin(c + 1), identity); });
+    partial_results[0] = body(chunk_begin(0), chunk_begin(1), identity);
+    group.wait();
+
+    T result = partial_results[0];
+    for (int c = 1; c < chunk_count; ++c)
+        result = combine(result, partial_results[c]);
+    return result;
+}
+
+} // NS Bifrost::Core
+
+#endif // _BIFROST_CORE_TASK_SCHEDULER_H_
@@ -9,50 +9,82 @@
 #ifndef _BIFROST_CORE_UNIQUE_ID_GENERATOR_H_
 #define _BIFROST_CORE_UNIQUE_ID_GENERATOR_H_
 
+#include <cstddef>
+
 namespace Bifrost {
 namespace Core {
 
+//----------------------------------------------------------------------------
+// UID layouts.
+// The narrow layout packs a 24 bit index and an 8 bit incarnation count into
+// 32 bits. The wide layout uses a 32 bit index and a 32 bit incarnation count,
+// supporting more than 16.7M resources pr manager and making stale UIDs
+// practically impossible to alias, at the cost of twice the UID storage.
+// Defining BIFROST_WIDE_UIDS makes all managers use wide UIDs.
+//----------------------------------------------------------------------------
+struct NarrowUIDLayout final {
+    typedef unsigned int Bits;
+    static constexpr unsigned int INDEX_BIT_COUNT = 24u;
+};
+
+struct WideUIDLayout final {
+    typedef unsigned long long Bits;
+    static constexpr unsigned int INDEX_BIT_COUNT = 32u;
+};
+
+#ifdef BIFROST_WIDE_UIDS
+typedef WideUIDLayout DefaultUIDLayout;
+#else
+typedef NarrowUIDLayout DefaultUIDLayout;
+#endif
+
 //----------------------------------------------------------------------------
 // Unique ID Generator.
 // Used to generate unique ID's, which can be associated with different resources, 
 // fx a unique ID is created pr resource, to distinguish between all resources, 
 // but a unique ID is also created pr SceneNode to distinguish all nodes.
 // See http://bitsquid.blogspot.de/2011/09/managing-decoupling-part-4-id-lookup.html.
+// The live UIDs are additionally kept in a packed list, sparse set style,
+// so iterating over them costs O(live UIDs) instead of O(capacity).
 // Future work
 // * Enable assert in has(UID). It requires the last free element to always point inside the array, preferably at the sentinel element. If that happens, then I need to special case erase() to the case where next_element is 0, because then last_element is invalid.
 //----------------------------------------------------------------------------
-template <typename T>
+template <typename T, typename Layout = DefaultUIDLayout>
 class TypedUIDGenerator final {
 public:
 
     //------------------------------------------------------------------------
     // Unique identifier.
-    // The unique identifier contains a 24bit identifier, mID. 
-    // Apart from that it contains an 8 bit incarnation count, 
+    // The unique identifier contains an index, 24 or 32 bits depending on the layout.
+    // Apart from that it contains an incarnation count in the remaining bits,
     // which is used to avoid clashes when an ID is reused.
     //------------------------------------------------------------------------
     struct UID final {
     private:
-        unsigned int m_ID_incarnation;
+        typedef typename Layout::Bits Bits;
+        static constexpr unsigned int INDEX_BIT_COUNT = Layout::INDEX_BIT_COUNT;
+        static constexpr Bits INDEX_MASK = (Bits(1) << INDEX_BIT_COUNT) - 1;
+
+        Bits m_ID_incarnation;
 
         // Make the TypedUIDGenerator a friend class to allow it to construct UIDs.
         friend class TypedUIDGenerator;
 
-        UID(unsigned int id, unsigned int incarnation) : m_ID_incarnation((incarnation << 24u) | id) {}
+        UID(unsigned int id, unsigned int incarnation) : m_ID_incarnation((Bits(incarnation) << INDEX_BIT_COUNT) | id) {}
 
-        inline void set_index(unsigned int id) { m_ID_incarnation = (m_ID_incarnation & 0xFF000000) | id; }
-        inline unsigned int get_incarnation_count() const { return m_ID_incarnation >> 24u; }
-        inline void increment_incarnation() { m_ID_incarnation += 0x01000000; }
+        inline void set_index(unsigned int id) { m_ID_incarnation = (m_ID_incarnation & ~INDEX_MASK) | id; }
+        inline unsigned int get_incarnation_count() const { return (unsigned int)(m_ID_incarnation >> INDEX_BIT_COUNT); }
+        inline void increment_incarnation() { m_ID_incarnation += Bits(1) << INDEX_BIT_COUNT; }
 
     public:
-        static const unsigned int MAX_IDS = 0xFFFFFF;
+        static constexpr unsigned int MAX_IDS = (unsigned int)INDEX_MASK;
 
         // Creates a sentinel UID that will never be valid.
         UID() : m_ID_incarnation(0u) { } // NOTE AVH Should really be private or non-existent, but that requires not using the UID in any containers that needs default initialization
         static inline UID invalid_UID() { return UID(0u, 0u); }
 
         // The ID.
-        inline unsigned int get_index() const { return m_ID_incarnation & MAX_IDS; }
+        inline unsigned int get_index() const { return (unsigned int)(m_ID_incarnation & INDEX_MASK); }
 
         // Implicit conversion to unsigned int is a shorthand way of accessing the ID.
         inline operator unsigned int() const { return get_index(); }
@@ -65,56 +97,65 @@ public:
 
     //------------------------------------------------------------------------
     // Constant iterator.
-    // Searches all UIDs linearly and returns the ones that are valid.
+    // Iterates the packed list of live UIDs from the front, which is the order
+    // the UIDs were generated in until a UID is erased. Erasing moves the last
+    // UID in the list into the erased UID's position.
+    // Erasing the UID currently pointed to is safe, as the iterator then visits
+    // the UID moved into its position. Erasing any other UID invalidates the iterator.
+    // Dereferencing the end iterator returns the invalid UID.
+    //------------------------------------------------------------------------
     class ConstIterator {
     public:
-        ConstIterator(UID* id, const TypedUIDGenerator& UID_generator)
-            : m_id(id), m_UID_generator(UID_generator) { }
+        ConstIterator(unsigned int position, const TypedUIDGenerator& UID_generator)
+            : m_position(position), m_UID_generator(&UID_generator), m_UID(get_current_UID()) { }
         inline ConstIterator& operator++() {
-            ++m_id;
-            while (m_id != m_UID_generator.end().m_id && !m_UID_generator.has(*m_id))
-            // while (m_id != m_UID_generator.end().m_id && m_UID_generator.m_IDs[*m_id] != *m_id)
-                ++m_id;
+            // Only advance if the current UID wasn't erased and replaced by an unvisited UID.
+            if (get_current_UID() == m_UID)
+                ++m_position;
+            m_UID = get_current_UID();
             return *this;
         }
         inline ConstIterator operator++(int) { ConstIterator tmp(*this); operator++(); return tmp; }
-        inline bool operator==(const ConstIterator& rhs) const { return m_id == rhs.m_id; }
-        inline bool operator!=(const ConstIterator& rhs) const { return m_id != rhs.m_id; }
-        inline UID operator*() const { return *m_id; }
-        inline UID operator->() const { return *m_id; }
+        inline bool operator==(const ConstIterator& rhs) const {
+            bool at_end = is_at_end(), rhs_at_end = rhs.is_at_end();
+            return at_end || rhs_at_end ? at_end == rhs_at_end : m_position == rhs.m_position;
+        }
+        inline bool operator!=(const ConstIterator& rhs) const { return !(*this == rhs); }
+        inline UID operator*() const { return get_current_UID(); }
+        inline UID operator->() const { return get_current_UID(); }
     private:
-        UID* m_id;
-        const TypedUIDGenerator& m_UID_generator;
+        // The end is evaluated when compared, as erasing while iterating shrinks the packed list.
+        inline bool is_at_end() const { return m_position > m_UID_generator->m_live_count; }
+        inline UID get_current_UID() const { return is_at_end() ? UID::invalid_UID() : m_UID_generator->m_live_IDs[m_position]; }
+
+        unsigned int m_position; // Position of the UID in the packed list.
+        const TypedUIDGenerator* m_UID_generator;
+        UID m_UID; // The UID at the position when the iterator was last moved.
     };
 
     TypedUIDGenerator(unsigned int start_capacity = 256);
-    TypedUIDGenerator(TypedUIDGenerator<T>&& other);
+    TypedUIDGenerator(TypedUIDGenerator&& other);
     ~TypedUIDGenerator();
 
-    TypedUIDGenerator<T>& operator=(TypedUIDGenerator<T>&& rhs);
+    TypedUIDGenerator& operator=(TypedUIDGenerator&& rhs);
 
     UID generate();
     bool erase(UID id);
     bool has(UID id) const;
 
     unsigned int capacity() const { return m_capacity; }
+    unsigned int size() const { return m_live_count; }
     void reserve(unsigned int capacity);
     unsigned int max_capacity() { return UID::MAX_IDS; }
+    // The UID slots, the packed list of live UIDs and their positions.
+    size_t get_allocated_bytes() const { return size_t(m_capacity) * (2 * sizeof(UID) + sizeof(unsigned int)); }
 
-    inline ConstIterator begin() const {
-        UID* first_valid_ID = m_IDs + 1u; // Skip sentinel invalid id.
-        ConstIterator itr = ConstIterator(first_valid_ID, *this);
-        if (!has(*itr))
-            // Advance iterator if the first element in the array isn't valid.
-            ++itr;
-        return itr;
-    }
-
-    inline ConstIterator end() const { return ConstIterator(m_IDs + m_capacity, *this); }
+    inline ConstIterator begin() const { return ConstIterator(1u, *this); }
+    inline ConstIterator end() const { return ConstIterator(m_live_count + 1u, *this); }
 
     inline ConstIterator get_iterator(UID id) const {
         if (has(id))
-            return ConstIterator(m_IDs + id.get_index(), *this);
+            return ConstIterator(m_live_positions[id.get_index()], *this);
         else
             return end();
     }
@@ -123,14 +164,20 @@ public:
 
 private:
     // Delete copy constructors to avoid having multiple versions of the same UID generator.
-    TypedUIDGenerator(TypedUIDGenerator<T>& other) = delete;
-    TypedUIDGenerator<T>& operator=(const TypedUIDGenerator<T>& rhs) = delete;
+    TypedUIDGenerator(TypedUIDGenerator& other) = delete;
+    TypedUIDGenerator& operator=(const TypedUIDGenerator& rhs) = delete;
 
     unsigned int m_capacity;
     UID* m_IDs;
         
     unsigned int m_next_index;
     unsigned int m_last_index;
+
+    // Packed list of live UIDs and the position of each live UID in it, indexed by UID index.
+    // The live UIDs are stored from position 1, so position 0 is never a valid position.
+    UID* m_live_IDs;
+    unsigned int* m_live_positions;
+    unsigned int m_live_count;
 };
 
 // Typedefs for 'untyped' UIDs.
@@ -0,0 +1,404 @@
+// Bifrost four wide bounding volume hierarchy.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Math/BVH4.h>
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Math/MortonEncode.h>
+
+#include <limits>
+
+namespace Bifrost::Math {
+
+static int build_BVH4_node(unsigned int first_primitive, unsigned int primitive_count, int parent, unsigned int max_leaf_size,
+                           std::vector<BVH4Node>& nodes) {
+    // Partition the primitives into up to four ranges by repeatedly splitting the largest range in the middle.
+    unsigned int range_firsts[4] = { first_primitive };
+    unsigned int range_counts[4] = { primitive_count };
+    int range_count = 1;
+    while (range_count < 4) {
+        int split_range = 0;
+        for (int r = 1; r < range_count; ++r)
+            if (range_counts[r] > range_counts[split_range])
+                split_range = r;
+        unsigned int split_count = range_counts[split_range];
+        if (split_count <= max_leaf_size)
+            break;
+
+        unsigned int left_count = split_count / 2;
+        range_firsts[range_count] = range_firsts[split_range] + left_count;
+        range_counts[range_count] = split_count - left_count;
+        range_counts[split_range] = left_count;
+        ++range_count;
+    }
+
+    // Keep the ranges in primitive order.
+    for (int r = 1; r < range_count; ++r)
+        for (int i = r; i > 0 && range_firsts[i] < range_firsts[i - 1]; --i) {
+            std::swap(range_firsts[i], range_firsts[i - 1]);
+            std::swap(range_counts[i], range_counts[i - 1]);
+        }
+
+    int node_index = (int)nodes.size();
+    nodes.emplace_back();
+    nodes[node_index].parent = parent;
+    for (int s = 0; s < 4; ++s) {
+        unsigned int first = s < range_count ? range_firsts[s] : 0u;
+        unsigned int count = s < range_count ? range_counts[s] : 0u;
+        int child_index = count > max_leaf_size ? build_BVH4_node(first, count, node_index, max_leaf_size, nodes) : -1;
+
+        // Set after building the child, as building it can reallocate the nodes.
+        BVH4Node& node = nodes[node_index];
+        node.children[s] = child_index;
+        node.first_primitives[s] = first;
+        node.primitive_counts[s] = count;
+    }
+
+    return node_index;
+}
+
+void build_BVH4(const AABB* primitive_bounds, unsigned int primitive_count, unsigned int max_leaf_size,
+                std::vector<BVH4Node>& nodes, std::vector<unsigned int>& primitive_order) {
+    assert(max_leaf_size > 0);
+    nodes.clear();
+    primitive_order.clear();
+    if (primitive_count == 0)
+        return;
+
+    // Order the primitives along a Morton curve through their centers.
+    AABB center_bounds = AABB::invalid();
+    for (unsigned int p = 0; p < primitive_count; ++p)
+        center_bounds.grow_to_contain(primitive_bounds[p].center());
+    Vector3f center_size = center_bounds.size();
+    float max_size = std::max(center_size.x, std::max(center_size.y, center_size.z));
+    float center_scale = max_size > 0.0f ? 1023.0f / max_size : 0.0f;
+
+    // Sort keys with the Morton code in the upper 32 bits and the primitive index in the lower.
+    std::vector<unsigned long long> keys(primitive_count);
+    Core::Parallel::for_each_chunk(0, (int)primitive_count, [&](int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            Vector3f cell = (primitive_bounds[p].center() - center_bounds.minimum) * center_scale;
+            unsigned int morton_code = morton_encode((unsigned int)cell.x, (unsigned int)cell.y, (unsigned int)cell.z);
+            keys[p] = ((unsigned long long)morton_code << 32) | (unsigned int)p;
+        }
+    }, 1024);
+    std::sort(keys.begin(), keys.end());
+
+    primitive_order.resize(primitive_count);
+    for (unsigned int p = 0; p < primitive_count; ++p)
+        primitive_order[p] = (unsigned int)keys[p];
+
+    nodes.reserve(primitive_count / 2 + 1);
+    build_BVH4_node(0, primitive_count, -1, max_leaf_size, nodes);
+
+    std::vector<AABB> ordered_primitive_bounds(primitive_count);
+    for (unsigned int p = 0; p < primitive_count; ++p)
+        ordered_primitive_bounds[p] = primitive_bounds[primitive_order[p]];
+    for (int n = (int)nodes.size() - 1; n >= 0; --n)
+        refit_BVH4_node(nodes, n, ordered_primitive_bounds.data());
+}
+
+// ------------------------------------------------------------------------------------------------
+// Binned surface area heuristic build.
+// ------------------------------------------------------------------------------------------------
+
+static const int SAH_BIN_COUNT = 16;
+// Ranges with at least this many primitives are binned in parallel.
+static const unsigned int SAH_PARALLEL_BINNING_SIZE = 1u << 16;
+// Subtrees with more primitives than this are built as separate tasks.
+static const unsigned int SAH_PARALLEL_SUBTREE_SIZE = 1u << 12;
+
+// A range in the primitive order with the bounds of its primitives and of their centers.
+struct SAHRange {
+    unsigned int first;
+    unsigned int count;
+    AABB bounds;
+    AABB center_bounds;
+};
+
+// The primitives of a range binned by their centers along all three axes.
+struct SAHBins {
+    AABB bounds[3][SAH_BIN_COUNT];
+    AABB center_bounds[3][SAH_BIN_COUNT];
+    unsigned int counts[3][SAH_BIN_COUNT];
+};
+
+struct SAHBuildContext {
+    const AABB* primitive_bounds;
+    const Vector3f* centers;
+    unsigned int* primitive_order; // Partitioned in place during the build.
+    unsigned int max_leaf_size;
+};
+
+// Half the surface area, which is all the heuristic needs.
+static inline float surface_area(AABB bounds) {
+    Vector3f size = bounds.size();
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static inline int get_SAH_bin(float center, float minimum, float scale) {
+    return std::min(int((center - minimum) * scale), SAH_BIN_COUNT - 1);
+}
+
+static SAHBins bin_primitives(const SAHBuildContext& context, int begin, int end, Vector3f minimum, Vector3f scale, SAHBins bins) {
+    for (int i = begin; i < end; ++i) {
+        unsigned int p = context.primitive_order[i];
+        AABB bounds = context.primitive_bounds[p];
+        Vector3f center = context.centers[p];
+        for (int a = 0; a < 3; ++a) {
+            int b = get_SAH_bin(center[a], minimum[a], scale[a]);
+            bins.bounds[a][b].grow_to_contain(bounds);
+            bins.center_bounds[a][b].grow_to_contain(center);
+            ++bins.counts[a][b];
+        }
+    }
+    return bins;
+}
+
+// Computes the bounds of the primitives in [first, first + count) of the primitive order.
+static SAHRange create_SAH_range(const SAHBuildContext& context, unsigned int first, unsigned int count) {
+    SAHRange range = { first, count, AABB::invalid(), AABB::invalid() };
+    for (unsigned int i = first; i < first + count; ++i) {
+        unsigned int p = context.primitive_order[i];
+        range.bounds.grow_to_contain(context.primitive_bounds[p]);
+        range.center_bounds.grow_to_contain(context.centers[p]);
+    }
+    return range;
+}
+
+// Splits the range at the binned plane with the lowest surface area cost,
+// or in the middle of the range if the primitive centers can't be separated.
+static void split_SAH_range(const SAHBuildContext& context, const SAHRange& range, SAHRange& left, SAHRange& right) {
+    Vector3f minimum = range.center_bounds.minimum;
+    Vector3f center_size = range.center_bounds.size();
+    Vector3f scale;
+    for (int a = 0; a < 3; ++a)
+        scale[a] = center_size[a] > 0.0f ? SAH_BIN_COUNT * 0.9999f / center_size[a] : 0.0f;
+
+    SAHBins bins;
+    for (int a = 0; a < 3; ++a)
+        for (int b = 0; b < SAH_BIN_COUNT; ++b) {
+            bins.bounds[a][b] = bins.center_bounds[a][b] = AABB::invalid();
+            bins.counts[a][b] = 0u;
+        }
+    int begin = (int)range.first, end = (int)(range.first + range.count);
+    if (range.count >= SAH_PARALLEL_BINNING_SIZE) {
+        auto merge_bins = [](SAHBins lhs, const SAHBins& rhs) -> SAHBins {
+            for (int a = 0; a < 3; ++a)
+                for (int b = 0; b < SAH_BIN_COUNT; ++b) {
+                    lhs.bounds[a][b].grow_to_contain(rhs.bounds[a][b]);
+                    lhs.center_bounds[a][b].grow_to_contain(rhs.center_bounds[a][b]);
+                    lhs.counts[a][b] += rhs.counts[a][b];
+                }
+            return lhs;
+        };
+        bins = Core::TaskScheduler::get_global().parallel_reduce(begin, end, 0, bins, [&](int chunk_begin, int chunk_end, SAHBins bins) {
+            return bin_primitives(context, chunk_begin, chunk_end, minimum, scale, bins);
+        }, merge_bins);
+    } else
+        bins = bin_primitives(context, begin, end, minimum, scale, bins);
+
+    // Sweep the bins from both sides to find the split with the lowest cost.
+    // Splitting after bin b puts bins [0, b] in the left child.
+    int best_axis = -1, best_bin = 0;
+    float best_cost = std::numeric_limits<float>::infinity();
+    for (int a = 0; a < 3; ++a) {
+        if (scale[a] == 0.0f)
+            continue;
+
+        float right_costs[SAH_BIN_COUNT];
+        AABB right_bounds = AABB::invalid();
+        unsigned int right_count = 0;
+        for (int b = SAH_BIN_COUNT - 1; b > 0; --b) {
+            right_bounds.grow_to_contain(bins.bounds[a][b]);
+            right_count += bins.counts[a][b];
+            right_costs[b - 1] = right_count > 0 ? surface_area(right_bounds) * right_count : 0.0f;
+        }
+
+        AABB left_bounds = AABB::invalid();
+        unsigned int left_count = 0;
+        for (int b = 0; b < SAH_BIN_COUNT - 1; ++b) {
+            left_bounds.grow_to_contain(bins.bounds[a][b]);
+            left_count += bins.counts[a][b];
+            if (left_count == 0 || left_count == range.count)
+                continue;
+            float cost = surface_area(left_bounds) * left_count + right_costs[b];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = a;
+                best_bin = b;
+            }
+        }
+    }
+
+    if (best_axis < 0) {
+        // All centers coincide, so any split is as good as another.
+        unsigned int left_count = range.count / 2;
+        left = create_SAH_range(context, range.first, left_count);
+        right = create_SAH_range(context, range.first + left_count, range.count - left_count);
+        return;
+    }
+
+    unsigned int* order_begin = context.primitive_order + range.first;
+    unsigned int* order_middle = std::partition(order_begin, order_begin + range.count, [&](unsigned int p) {
+        return get_SAH_bin(context.centers[p][best_axis], minimum[best_axis], scale[best_axis]) <= best_bin;
+    });
+
+    left = { range.first, (unsigned int)(order_middle - order_begin), AABB::invalid(), AABB::invalid() };
+    right = { left.first + left.count, range.count - left.count, AABB::invalid(), AABB::invalid() };
+    for (int b = 0; b < SAH_BIN_COUNT; ++b) {
+        SAHRange& side = b <= best_bin ? left : right;
+        side.bounds.grow_to_contain(bins.bounds[best_axis][b]);
+        side.center_bounds.grow_to_contain(bins.center_bounds[best_axis][b]);
+    }
+}
+
+// Splits the range at the median of the primitive centers along the largest axis of the center bounds.
+static void split_median_range(const SAHBuildContext& context, const SAHRange& range, SAHRange& left, SAHRange& right) {
+    Vector3f center_size = range.center_bounds.size();
+    int axis = center_size.x >= center_size.y ? (center_size.x >= center_size.z ? 0 : 2) : (center_size.y >= center_size.z ? 1 : 2);
+    unsigned int left_count = range.count / 2;
+    unsigned int* order_begin = context.primitive_order + range.first;
+    std::nth_element(order_begin, order_begin + left_count, order_begin + range.count, [&](unsigned int lhs, unsigned int rhs) {
+        return context.centers[lhs][axis] < context.centers[rhs][axis];
+    });
+    left = create_SAH_range(context, range.first, left_count);
+    right = create_SAH_range(context, range.first + left_count, range.count - left_count);
+}
+
+static int build_BVH4_SAH_node(const SAHBuildContext& context, const SAHRange& range, int depth, int parent, std::vector<BVH4Node>& nodes) {
+    // Splitting the child with the most primitives at its median reduces the primitives to a quarter pr level,
+    // so switching to median splits this far above the max depth is enough for any primitive count.
+    const int MEDIAN_SPLIT_LEVEL_COUNT = 17;
+    bool split_at_median = depth >= BVH4_MAX_DEPTH - MEDIAN_SPLIT_LEVEL_COUNT;
+
+    // Form up to four children by repeatedly splitting the child with the largest surface area, or with the most primitives for median splits.
+    SAHRange ranges[4] = { range };
+    int range_count = 1;
+    while (range_count < 4) {
+        int split_range = -1;
+        float largest_size = -1.0f;
+        for (int r = 0; r < range_count; ++r) {
+            float size = split_at_median ? float(ranges[r].count) : surface_area(ranges[r].bounds);
+            if (ranges[r].count > context.max_leaf_size && size > largest_size) {
+                split_range = r;
+                largest_size = size;
+            }
+        }
+        if (split_range < 0)
+            break;
+
+        SAHRange left, right;
+        if (split_at_median)
+            split_median_range(context, ranges[split_range], left, right);
+        else
+            split_SAH_range(context, ranges[split_range], left, right);
+        ranges[split_range] = left;
+        ranges[range_count++] = right;
+    }
+
+    // Keep the ranges in primitive order.
+    for (int r = 1; r < range_count; ++r)
+        for (int i = r; i > 0 && ranges[i].first < ranges[i - 1].first; --i)
+            std::swap(ranges[i], ranges[i - 1]);
+
+    int node_index = (int)nodes.size();
+    nodes.emplace_back();
+    nodes[node_index].parent = parent;
+
+    // Build the large children as tasks into their own node arrays and the small ones in place.
+    int child_indices[4] = { -1, -1, -1, -1 };
+    std::vector<BVH4Node> subtrees[4];
+    Core::TaskGroup subtree_tasks;
+    for (int s = 0; s < range_count; ++s) {
+        if (ranges[s].count <= context.max_leaf_size)
+            continue;
+        if (ranges[s].count > SAH_PARALLEL_SUBTREE_SIZE)
+            subtree_tasks.run([&, s]() { build_BVH4_SAH_node(context, ranges[s], depth + 1, -1, subtrees[s]); });
+        else
+            child_indices[s] = build_BVH4_SAH_node(context, ranges[s], depth + 1, node_index, nodes);
+    }
+    subtree_tasks.wait();
+
+    // Append the subtrees, offsetting their node indices. Children still come after their parents.
+    for (int s = 0; s < range_count; ++s) {
+        if (subtrees[s].empty())
+            continue;
+        int offset = (int)nodes.size();
+        for (BVH4Node subtree_node : subtrees[s]) {
+            subtree_node.parent = subtree_node.parent < 0 ? node_index : subtree_node.parent + offset;
+            for (int c = 0; c < 4; ++c)
+                if (subtree_node.children[c] >= 0)
+                    subtree_node.children[c] += offset;
+            nodes.push_back(subtree_node);
+        }
+        child_indices[s] = offset;
+    }
+
+    BVH4Node& node = nodes[node_index];
+    for (int s = 0; s < 4; ++s) {
+        bool is_used = s < range_count;
+        node.children[s] = child_indices[s];
+        node.first_primitives[s] = is_used ? ranges[s].first : 0u;
+        node.primitive_counts[s] = is_used ? ranges[s].count : 0u;
+        node.set_child_bounds(s, is_used ? ranges[s].bounds : AABB::invalid());
+    }
+
+    return node_index;
+}
+
+void build_BVH4_SAH(const AABB* primitive_bounds, unsigned int primitive_count, unsigned int max_leaf_size,
+                    std::vector<BVH4Node>& nodes, std::vector<unsigned int>& primitive_order) {
+    assert(max_leaf_size > 0);
+    nodes.clear();
+    primitive_order.clear();
+    if (primitive_count == 0)
+        return;
+
+    std::vector<Vector3f> centers(primitive_count);
+    primitive_order.resize(primitive_count);
+    Core::Parallel::for_each_chunk(0, (int)primitive_count, [&](int begin, int end) {
+        for (int p = begin; p < end; ++p) {
+            centers[p] = primitive_bounds[p].center();
+            primitive_order[p] = p;
+        }
+    }, 4096);
+
+    SAHBuildContext context = { primitive_bounds, centers.data(), primitive_order.data(), max_leaf_size };
+    SAHRange root_range = Core::TaskScheduler::get_global().parallel_reduce(0, (int)primitive_count, 0, SAHRange{ 0u, primitive_count, AABB::invalid(), AABB::invalid() },
+        [&](int begin, int end, SAHRange range) {
+            for (int p = begin; p < end; ++p) {
+                range.bounds.grow_to_contain(primitive_bounds[p]);
+                range.center_bounds.grow_to_contain(centers[p]);
+            }
+            return range;
+        }, [](SAHRange lhs, SAHRange rhs) {
+            lhs.bounds.grow_to_contain(rhs.bounds);
+            lhs.center_bounds.grow_to_contain(rhs.center_bounds);
+            return lhs;
+        });
+
+    nodes.reserve(primitive_count / 2 + 1);
+    build_BVH4_SAH_node(context, root_range, 0, -1, nodes);
+}
+
+void refit_BVH4_node(std::vector<BVH4Node>& nodes, unsigned int node_index, const AABB* ordered_primitive_bounds) {
+    BVH4Node& node = nodes[node_index];
+    for (int s = 0; s < 4; ++s) {
+        AABB bounds = AABB::invalid();
+        int child_index = node.children[s];
+        if (child_index >= 0)
+            bounds = nodes[child_index].get_bounds();
+        else
+            for (unsigned int p = node.first_primitives[s]; p < node.first_primitives[s] + node.primitive_counts[s]; ++p)
+                bounds.grow_to_contain(ordered_primitive_bounds[p]);
+        node.set_child_bounds(s, bounds);
+    }
+}
+
+} // NS Bifrost::Math
@@ -0,0 +1,328 @@
+// Bifrost four wide bounding volume hierarchy.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_MATH_BVH4_H_
+#define _BIFROST_MATH_BVH4_H_
+
+#include <Bifrost/Core/Defines.h>
+#include <Bifrost/Math/AABB.h>
+#include <Bifrost/Math/Frustum.h>
+#include <Bifrost/Math/Ray.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+#include <vector>
+
+#ifdef BIFROST_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Bifrost::Math {
+
+// ------------------------------------------------------------------------------------------------
+// Node in a four wide bounding volume hierarchy.
+// The bounds of the four children are stored as structure of arrays, so all four can be tested at once.
+// A slot either references a child node, holds a leaf of primitives or is empty.
+// The primitives below a slot are contiguous in the hierarchy's primitive order, so a whole subtree
+// can be accepted without visiting it.
+// ------------------------------------------------------------------------------------------------
+struct alignas(16) BVH4Node final {
+    float min_x[4], min_y[4], min_z[4];
+    float max_x[4], max_y[4], max_z[4];
+    int children[4]; // Index of the child node or -1 for leaves and empty slots.
+    unsigned int first_primitives[4];
+    unsigned int primitive_counts[4]; // Zero for empty slots.
+    int parent;
+
+    __always_inline__ bool is_empty(int slot) const { return primitive_counts[slot] == 0; }
+    __always_inline__ bool is_leaf(int slot) const { return children[slot] < 0 && primitive_counts[slot] > 0; }
+
+    __always_inline__ int get_non_empty_mask() const {
+        return (primitive_counts[0] > 0 ? 1 : 0) | (primitive_counts[1] > 0 ? 2 : 0) |
+               (primitive_counts[2] > 0 ? 4 : 0) | (primitive_counts[3] > 0 ? 8 : 0);
+    }
+
+    __always_inline__ AABB get_child_bounds(int slot) const {
+        return AABB(Vector3f(min_x[slot], min_y[slot], min_z[slot]), Vector3f(max_x[slot], max_y[slot], max_z[slot]));
+    }
+
+    __always_inline__ void set_child_bounds(int slot, AABB bounds) {
+        min_x[slot] = bounds.minimum.x; min_y[slot] = bounds.minimum.y; min_z[slot] = bounds.minimum.z;
+        max_x[slot] = bounds.maximum.x; max_y[slot] = bounds.maximum.y; max_z[slot] = bounds.maximum.z;
+    }
+
+    // The union of the bounds of the non-empty children.
+    __always_inline__ AABB get_bounds() const {
+        AABB bounds = AABB::invalid();
+        for (int s = 0; s < 4; ++s)
+            if (!is_empty(s))
+                bounds.grow_to_contain(get_child_bounds(s));
+        return bounds;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Construction and refitting.
+// ------------------------------------------------------------------------------------------------
+
+// The builds keep the hierarchies at most BVH4_MAX_DEPTH nodes deep, so traversals can use fixed size stacks.
+// Every node visited pushes at most four children and pops itself, so a stack holds at most 3 * depth + 1 entries.
+const int BVH4_MAX_DEPTH = 40;
+const int BVH4_MAX_STACK_SIZE = 3 * BVH4_MAX_DEPTH + 1;
+
+// Builds a hierarchy over the primitive bounds with at most max_leaf_size primitives pr leaf.
+// The primitives are ordered along a Morton curve through their centers and every node splits its
+// primitives at the middle of that order, so the build is dominated by a single sort.
+// The leaves reference the primitives by their position in primitive_order, which holds the
+// index of the primitive at each position. The root is the first node.
+void build_BVH4(const AABB* primitive_bounds, unsigned int primitive_count, unsigned int max_leaf_size,
+                std::vector<BVH4Node>& nodes, std::vector<unsigned int>& primitive_order);
+
+// Builds a hierarchy over the primitive bounds with at most max_leaf_size primitives pr leaf using
+// the surface area heuristic. Every split is chosen among binned candidate planes along all three axes
+// as the one minimizing the sum of the children's surface areas weighted by their primitive counts,
+// and a node is formed by repeatedly splitting its child with the largest surface area.
+// Deep below the root, where degenerate inputs can make every split peel off a few primitives,
+// the children are split at their median instead to bound the depth.
+// Binning of large ranges and building of large subtrees run in parallel.
+// The build is slower than build_BVH4, but the hierarchy is considerably faster to trace.
+// The output is laid out as by build_BVH4.
+void build_BVH4_SAH(const AABB* primitive_bounds, unsigned int primitive_count, unsigned int max_leaf_size,
+                    std::vector<BVH4Node>& nodes, std::vector<unsigned int>& primitive_order);
+
+// Recomputes the child bounds of a node from its child nodes and the bounds of the primitives
+// stored in hierarchy order. Children have larger indices than their parents, so refitting the
+// nodes in reverse order refits the whole hierarchy.
+void refit_BVH4_node(std::vector<BVH4Node>& nodes, unsigned int node_index, const AABB* ordered_primitive_bounds);
+
+// ------------------------------------------------------------------------------------------------
+// Child tests.
+// ------------------------------------------------------------------------------------------------
+
+// Tests the four children against the ray segment [0, max_distance] with the slab test.
+// Returns a bitmask of the children hit and stores the entry distances.
+__always_inline__ int intersect_children(const BVH4Node& node, Vector3f origin, Vector3f inverse_direction, float max_distance, float* distances) {
+#ifdef BIFROST_SSE2
+    __m128 origin_x = _mm_set1_ps(origin.x), origin_y = _mm_set1_ps(origin.y), origin_z = _mm_set1_ps(origin.z);
+    __m128 inverse_x = _mm_set1_ps(inverse_direction.x), inverse_y = _mm_set1_ps(inverse_direction.y), inverse_z = _mm_set1_ps(inverse_direction.z);
+    __m128 t0_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.min_x), origin_x), inverse_x);
+    __m128 t1_x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.max_x), origin_x), inverse_x);
+    __m128 t0_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.min_y), origin_y), inverse_y);
+    __m128 t1_y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.max_y), origin_y), inverse_y);
+    __m128 t0_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.min_z), origin_z), inverse_z);
+    __m128 t1_z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.max_z), origin_z), inverse_z);
+    __m128 near_distance = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0_x, t1_x), _mm_min_ps(t0_y, t1_y)), _mm_max_ps(_mm_min_ps(t0_z, t1_z), _mm_setzero_ps()));
+    __m128 far_distance = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0_x, t1_x), _mm_max_ps(t0_y, t1_y)), _mm_min_ps(_mm_max_ps(t0_z, t1_z), _mm_set1_ps(max_distance)));
+    _mm_storeu_ps(distances, near_distance);
+    return _mm_movemask_ps(_mm_cmple_ps(near_distance, far_distance)) & node.get_non_empty_mask();
+#else
+    int hit_mask = 0;
+    for (int s = 0; s < 4; ++s) {
+        float t0_x = (node.min_x[s] - origin.x) * inverse_direction.x, t1_x = (node.max_x[s] - origin.x) * inverse_direction.x;
+        float t0_y = (node.min_y[s] - origin.y) * inverse_direction.y, t1_y = (node.max_y[s] - origin.y) * inverse_direction.y;
+        float t0_z = (node.min_z[s] - origin.z) * inverse_direction.z, t1_z = (node.max_z[s] - origin.z) * inverse_direction.z;
+        float near_distance = std::max(std::max(std::min(t0_x, t1_x), std::min(t0_y, t1_y)), std::max(std::min(t0_z, t1_z), 0.0f));
+        float far_distance = std::min(std::min(std::max(t0_x, t1_x), std::max(t0_y, t1_y)), std::min(std::max(t0_z, t1_z), max_distance));
+        distances[s] = near_distance;
+        if (near_distance <= far_distance)
+            hit_mask |= 1 << s;
+    }
+    return hit_mask & node.get_non_empty_mask();
+#endif
+}
+
+// Tests a child against the four rays of a packet with the slab test.
+// Returns a bitmask of the rays hitting the child within their max distances and stores the entry distances.
+__always_inline__ int intersect_child(const BVH4Node& node, int slot, const RayPacket4& rays, const float* inverse_direction_x,
+                                      const float* inverse_direction_y, const float* inverse_direction_z, const float* max_distances, float* distances) {
+#ifdef BIFROST_SSE2
+    __m128 origin_x = _mm_load_ps(rays.origin_x), origin_y = _mm_load_ps(rays.origin_y), origin_z = _mm_load_ps(rays.origin_z);
+    __m128 inverse_x = _mm_loadu_ps(inverse_direction_x), inverse_y = _mm_loadu_ps(inverse_direction_y), inverse_z = _mm_loadu_ps(inverse_direction_z);
+    __m128 t0_x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min_x[slot]), origin_x), inverse_x);
+    __m128 t1_x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max_x[slot]), origin_x), inverse_x);
+    __m128 t0_y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min_y[slot]), origin_y), inverse_y);
+    __m128 t1_y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max_y[slot]), origin_y), inverse_y);
+    __m128 t0_z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min_z[slot]), origin_z), inverse_z);
+    __m128 t1_z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max_z[slot]), origin_z), inverse_z);
+    __m128 near_distance = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0_x, t1_x), _mm_min_ps(t0_y, t1_y)), _mm_max_ps(_mm_min_ps(t0_z, t1_z), _mm_setzero_ps()));
+    __m128 far_distance = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0_x, t1_x), _mm_max_ps(t0_y, t1_y)), _mm_min_ps(_mm_max_ps(t0_z, t1_z), _mm_loadu_ps(max_distances)));
+    _mm_storeu_ps(distances, near_distance);
+    return _mm_movemask_ps(_mm_cmple_ps(near_distance, far_distance));
+#else
+    int hit_mask = 0;
+    for (int r = 0; r < 4; ++r) {
+        float t0_x = (node.min_x[slot] - rays.origin_x[r]) * inverse_direction_x[r], t1_x = (node.max_x[slot] - rays.origin_x[r]) * inverse_direction_x[r];
+        float t0_y = (node.min_y[slot] - rays.origin_y[r]) * inverse_direction_y[r], t1_y = (node.max_y[slot] - rays.origin_y[r]) * inverse_direction_y[r];
+        float t0_z = (node.min_z[slot] - rays.origin_z[r]) * inverse_direction_z[r], t1_z = (node.max_z[slot] - rays.origin_z[r]) * inverse_direction_z[r];
+        float near_distance = std::max(std::max(std::min(t0_x, t1_x), std::min(t0_y, t1_y)), std::max(std::min(t0_z, t1_z), 0.0f));
+        float far_distance = std::min(std::min(std::max(t0_x, t1_x), std::max(t0_y, t1_y)), std::min(std::max(t0_z, t1_z), max_distances[r]));
+        distances[r] = near_distance;
+        if (near_distance <= far_distance)
+            hit_mask |= 1 << r;
+    }
+    return hit_mask;
+#endif
+}
+
+// Tests the four children against the frustum.
+// Returns a bitmask of the children intersecting the frustum and a bitmask of the children fully inside it.
+__always_inline__ void classify_children(const BVH4Node& node, const Frustum& frustum, int& intersected_mask, int& contained_mask) {
+#ifdef BIFROST_SSE2
+    __m128 min_x = _mm_load_ps(node.min_x), min_y = _mm_load_ps(node.min_y), min_z = _mm_load_ps(node.min_z);
+    __m128 max_x = _mm_load_ps(node.max_x), max_y = _mm_load_ps(node.max_y), max_z = _mm_load_ps(node.max_z);
+    __m128 zero = _mm_setzero_ps();
+    __m128 intersected = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 contained = intersected;
+    for (const Plane& plane : frustum.planes) {
+        __m128 a = _mm_set1_ps(plane.a), b = _mm_set1_ps(plane.b), c = _mm_set1_ps(plane.c), d = _mm_set1_ps(plane.d);
+        __m128 ax0 = _mm_mul_ps(a, min_x), ax1 = _mm_mul_ps(a, max_x);
+        __m128 by0 = _mm_mul_ps(b, min_y), by1 = _mm_mul_ps(b, max_y);
+        __m128 cz0 = _mm_mul_ps(c, min_z), cz1 = _mm_mul_ps(c, max_z);
+        __m128 far_distance = _mm_add_ps(_mm_add_ps(_mm_max_ps(ax0, ax1), _mm_max_ps(by0, by1)), _mm_add_ps(_mm_max_ps(cz0, cz1), d));
+        __m128 near_distance = _mm_add_ps(_mm_add_ps(_mm_min_ps(ax0, ax1), _mm_min_ps(by0, by1)), _mm_add_ps(_mm_min_ps(cz0, cz1), d));
+        intersected = _mm_and_ps(intersected, _mm_cmpge_ps(far_distance, zero));
+        contained = _mm_and_ps(contained, _mm_cmpge_ps(near_distance, zero));
+    }
+    intersected_mask = _mm_movemask_ps(intersected) & node.get_non_empty_mask();
+    contained_mask = _mm_movemask_ps(contained) & intersected_mask;
+#else
+    intersected_mask = contained_mask = 0;
+    for (int s = 0; s < 4; ++s) {
+        AABB child_bounds = node.get_child_bounds(s);
+        if (!node.is_empty(s) && frustum.intersects(child_bounds)) {
+            intersected_mask |= 1 << s;
+            if (frustum.contains(child_bounds))
+                contained_mask |= 1 << s;
+        }
+    }
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+// Traversal.
+// ------------------------------------------------------------------------------------------------
+
+// Visits the leaves hit by the ray front to back. The visitor is called as
+// bool visit_leaf(unsigned int first_primitive, unsigned int primitive_count, float& max_distance)
+// and can shorten max_distance to cull the nodes behind a hit, or return true to stop the traversal.
+template <typename LeafVisitor>
+inline void traverse_BVH4(const BVH4Node* nodes, Ray ray, float& max_distance, LeafVisitor visit_leaf) {
+    struct StackEntry {
+        float distance;
+        int node_index; // -1 for leaves.
+        unsigned int first_primitive;
+        unsigned int primitive_count;
+    };
+
+    StackEntry stack[BVH4_MAX_STACK_SIZE];
+    int stack_size = 0;
+    stack[stack_size++] = { 0.0f, 0, 0, 0 };
+
+    Vector3f inverse_direction = Vector3f(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    while (stack_size > 0) {
+        StackEntry entry = stack[--stack_size];
+        if (entry.distance > max_distance)
+            continue;
+
+        if (entry.node_index < 0) {
+            if (visit_leaf(entry.first_primitive, entry.primitive_count, max_distance))
+                return;
+            continue;
+        }
+
+        const BVH4Node& node = nodes[entry.node_index];
+        float distances[4];
+        int hit_mask = intersect_children(node, ray.origin, inverse_direction, max_distance, distances);
+
+        // Push the hit children sorted by decreasing distance, so the closest child is visited first.
+        int first_pushed = stack_size;
+        for (int s = 0; s < 4; ++s) {
+            if ((hit_mask & (1 << s)) == 0)
+                continue;
+            StackEntry child_entry = { distances[s], node.children[s], node.first_primitives[s], node.primitive_counts[s] };
+            int i = stack_size++;
+            assert(stack_size <= BVH4_MAX_STACK_SIZE);
+            for (; i > first_pushed && stack[i - 1].distance < child_entry.distance; --i)
+                stack[i] = stack[i - 1];
+            stack[i] = child_entry;
+        }
+    }
+}
+
+// Visits the leaves hit by the active rays of the packet, closest first as seen by the rays hitting them.
+// The visitor is called as
+// int visit_leaf(unsigned int first_primitive, unsigned int primitive_count, int ray_mask, float* max_distances)
+// with the bitmask of the active rays hitting the leaf. It can shorten the rays' max distances to cull
+// the nodes behind their hits and returns the rays in ray_mask that should continue the traversal,
+// so e.g. occlusion rays can be terminated on their first hit.
+template <typename LeafVisitor>
+inline void traverse_BVH4_packet(const BVH4Node* nodes, const RayPacket4& rays, int ray_mask, float* max_distances, LeafVisitor visit_leaf) {
+    struct StackEntry {
+        float distance; // The closest entry distance of the rays hitting the node.
+        int ray_mask;
+        int node_index; // -1 for leaves.
+        unsigned int first_primitive;
+        unsigned int primitive_count;
+    };
+
+    StackEntry stack[BVH4_MAX_STACK_SIZE];
+    int stack_size = 0;
+    stack[stack_size++] = { 0.0f, ray_mask, 0, 0, 0 };
+
+    float inverse_direction_x[4], inverse_direction_y[4], inverse_direction_z[4];
+    for (int r = 0; r < 4; ++r) {
+        inverse_direction_x[r] = 1.0f / rays.direction_x[r];
+        inverse_direction_y[r] = 1.0f / rays.direction_y[r];
+        inverse_direction_z[r] = 1.0f / rays.direction_z[r];
+    }
+
+    while (stack_size > 0 && ray_mask != 0) {
+        StackEntry entry = stack[--stack_size];
+        int entry_ray_mask = entry.ray_mask & ray_mask;
+        float max_distance = 0.0f;
+        for (int r = 0; r < 4; ++r)
+            if (entry_ray_mask & (1 << r))
+                max_distance = std::max(max_distance, max_distances[r]);
+        if (entry_ray_mask == 0 || entry.distance > max_distance)
+            continue;
+
+        if (entry.node_index < 0) {
+            int continuing_ray_mask = visit_leaf(entry.first_primitive, entry.primitive_count, entry_ray_mask, max_distances);
+            ray_mask = (ray_mask & ~entry_ray_mask) | (continuing_ray_mask & entry_ray_mask);
+            continue;
+        }
+
+        // Push the hit children sorted by decreasing distance, so the closest child is visited first.
+        const BVH4Node& node = nodes[entry.node_index];
+        int first_pushed = stack_size;
+        for (int s = 0; s < 4; ++s) {
+            if (node.is_empty(s))
+                continue;
+            float distances[4];
+            int hit_ray_mask = entry_ray_mask & intersect_child(node, s, rays, inverse_direction_x, inverse_direction_y, inverse_direction_z, max_distances, distances);
+            if (hit_ray_mask == 0)
+                continue;
+
+            float child_distance = std::numeric_limits<float>::infinity();
+            for (int r = 0; r < 4; ++r)
+                if (hit_ray_mask & (1 << r))
+                    child_distance = std::min(child_distance, distances[r]);
+            StackEntry child_entry = { child_distance, hit_ray_mask, node.children[s], node.first_primitives[s], node.primitive_counts[s] };
+            int i = stack_size++;
+            assert(stack_size <= BVH4_MAX_STACK_SIZE);
+            for (; i > first_pushed && stack[i - 1].distance < child_entry.distance; --i)
+                stack[i] = stack[i - 1];
+            stack[i] = child_entry;
+        }
+    }
+}
+
+} // NS Bifrost::Math
+
+#endif // _BIFROST_MATH_BVH4_H_
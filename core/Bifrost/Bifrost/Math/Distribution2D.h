@@ -10,8 +10,10 @@
 #define _BIFROST_MATH_DISTRIBUTION2D_H_
 
 #include <Bifrost/Core/Defines.h>
+#include <Bifrost/Core/Parallel.h>
 #include <Bifrost/Math/Vector.h>
 
+#include <algorithm>
 #include <assert.h>
 
 namespace Bifrost {
@@ -49,6 +51,14 @@ public:
         m_integral = compute_CDFs(function, m_width, m_height, m_marginal_CDF, m_conditional_CDF);
     }
 
+    // Copies precomputed CDFs, fx the CDFs of another distribution that were stored on disk.
+    Distribution2D(const T* marginal_CDF, const T* conditional_CDF, T integral, int width, int height)
+        : m_width(width), m_height(height), m_integral(integral)
+        , m_marginal_CDF(new T[m_height + 1]), m_conditional_CDF(new T[(m_width + 1) * m_height]) {
+        std::copy_n(marginal_CDF, m_height + 1, m_marginal_CDF);
+        std::copy_n(conditional_CDF, (m_width + 1) * m_height, m_conditional_CDF);
+    }
+
     template <typename U>
     Distribution2D(Distribution2D<U>& other)
         : m_width(other.get_width()), m_height(other.get_height()), m_integral(T(other.get_integral()))
@@ -78,6 +88,8 @@ public:
     __always_inline__ const T* const get_conditional_CDF() const { return m_conditional_CDF; }
     __always_inline__ Vector2i get_conditional_CDF_size() const { return Vector2i(m_width + 1, m_height); }
 
+    size_t get_allocated_bytes() const { return sizeof(T) * (get_marginal_CDF_size() + (m_width + 1) * m_height); }
+
     //*********************************************************************************************
     // Evaluate.
     //*********************************************************************************************
@@ -167,14 +179,13 @@ public:
     static T compute_CDFs(U* function, int width, int height, T* marginal_CDF, T* conditional_CDF) {
 
         // Compute conditional CDF.
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int y = 0; y < height; ++y) {
+        Core::Parallel::for_each(0, height, [=](int y) {
             U* function_row = function + y * width;
             T* conditional_CDF_row = conditional_CDF + y * (width + 1);
             conditional_CDF_row[0] = T(0.0);
             for (int x = 0; x < width; ++x)
                 conditional_CDF_row[x + 1] = conditional_CDF_row[x] + T(function_row[x]);
-        }
+        });
 
         // Compute marginal CDF.
         marginal_CDF[0] = T(0.0);
@@ -190,8 +201,7 @@ public:
         marginal_CDF[height] = 1.0;
 
         // Normalize conditional CDF.
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int y = 0; y < height; ++y) {
+        Core::Parallel::for_each(0, height, [=](int y) {
             T* conditional_CDF_row = conditional_CDF + y * (width + 1);
             if (conditional_CDF_row[width] > 0.0f)
                 for (int x = 1; x < width; ++x)
@@ -199,7 +209,7 @@ public:
             // Last value should always be one. Even in rows with no contribution.
             // This ensures that the binary search is well-defined and will never select the last element.
             conditional_CDF_row[width] = 1.0f;
-        }
+        });
 
         return integral;
     }
@@ -0,0 +1,87 @@
+// Bifrost view frustum.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_MATH_FRUSTUM_H_
+#define _BIFROST_MATH_FRUSTUM_H_
+
+#include <Bifrost/Core/Defines.h>
+#include <Bifrost/Math/AABB.h>
+#include <Bifrost/Math/Matrix.h>
+#include <Bifrost/Math/Plane.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Bifrost::Math {
+
+// ------------------------------------------------------------------------------------------------
+// View frustum represented by six planes with normals pointing into the frustum.
+// ------------------------------------------------------------------------------------------------
+struct Frustum final {
+    enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PLANE_COUNT };
+
+    Plane planes[PLANE_COUNT];
+
+    // Extracts the planes from a view projection matrix with clip space depth in [-1, 1].
+    // Gribb and Hartmann, Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix.
+    // Degenerate planes, fx the far plane of an infinite projection, are replaced by planes that contain everything.
+    static Frustum from_view_projection_matrix(const Matrix4x4f& view_projection_matrix) {
+        const Matrix4x4f& m = view_projection_matrix;
+        auto plane_from_rows = [&](int row, float sign) -> Plane {
+            float a = m(3, 0) + sign * m(row, 0);
+            float b = m(3, 1) + sign * m(row, 1);
+            float c = m(3, 2) + sign * m(row, 2);
+            float d = m(3, 3) + sign * m(row, 3);
+            float normal_length = std::sqrt(a * a + b * b + c * c);
+            if (normal_length == 0.0f)
+                return Plane(0.0f, 0.0f, 0.0f, 1.0f);
+            float inv_normal_length = 1.0f / normal_length;
+            return Plane(a * inv_normal_length, b * inv_normal_length, c * inv_normal_length, d * inv_normal_length);
+        };
+
+        Frustum frustum;
+        frustum.planes[Left] = plane_from_rows(0, 1.0f);
+        frustum.planes[Right] = plane_from_rows(0, -1.0f);
+        frustum.planes[Bottom] = plane_from_rows(1, 1.0f);
+        frustum.planes[Top] = plane_from_rows(1, -1.0f);
+        frustum.planes[Near] = plane_from_rows(2, 1.0f);
+        frustum.planes[Far] = plane_from_rows(2, -1.0f);
+        return frustum;
+    }
+
+    // Conservative overlap test. Returns false only if the AABB is fully outside one of the planes,
+    // so AABBs close to the corners of the frustum can be reported as intersecting.
+    __always_inline__ bool intersects(AABB aabb) const {
+        for (const Plane& plane : planes) {
+            // Signed distance of the corner furthest along the plane normal.
+            float distance = std::max(plane.a * aabb.minimum.x, plane.a * aabb.maximum.x) +
+                             std::max(plane.b * aabb.minimum.y, plane.b * aabb.maximum.y) +
+                             std::max(plane.c * aabb.minimum.z, plane.c * aabb.maximum.z) + plane.d;
+            if (distance < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // Returns true if the AABB is fully inside the frustum.
+    __always_inline__ bool contains(AABB aabb) const {
+        for (const Plane& plane : planes) {
+            // Signed distance of the corner furthest against the plane normal.
+            float distance = std::min(plane.a * aabb.minimum.x, plane.a * aabb.maximum.x) +
+                             std::min(plane.b * aabb.minimum.y, plane.b * aabb.maximum.y) +
+                             std::min(plane.c * aabb.minimum.z, plane.c * aabb.maximum.z) + plane.d;
+            if (distance < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+} // NS Bifrost::Math
+
+#endif // _BIFROST_MATH_FRUSTUM_H_
@@ -10,9 +10,17 @@
 #define _BIFROST_MATH_INTERSECT_H_
 
 #include <Bifrost/Core/Defines.h>
+#include <Bifrost/Math/AABB.h>
 #include <Bifrost/Math/Plane.h>
 #include <Bifrost/Math/Ray.h>
 
+#include <algorithm>
+#include <limits>
+
+#ifdef BIFROST_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Bifrost {
 namespace Math {
 
@@ -21,7 +29,149 @@ __always_inline__ float intersect(Ray ray, Plane plane) {
     return -(dot(plane.get_normal(), ray.origin) + plane.d) / dot(plane.get_normal(), ray.direction);
 }
 
+// Slab test with the reciprocal of the ray direction precomputed.
+// Returns the distance to where the ray enters the AABB, zero if the origin is inside it and infinity if the AABB is missed.
+__always_inline__ float intersect(Vector3f origin, Vector3f inverse_direction, AABB aabb) {
+    Vector3f t0 = (aabb.minimum - origin) * inverse_direction;
+    Vector3f t1 = (aabb.maximum - origin) * inverse_direction;
+    float near_distance = std::max(std::max(std::min(t0.x, t1.x), std::min(t0.y, t1.y)), std::max(std::min(t0.z, t1.z), 0.0f));
+    float far_distance = std::min(std::min(std::max(t0.x, t1.x), std::max(t0.y, t1.y)), std::max(t0.z, t1.z));
+    return near_distance <= far_distance ? near_distance : std::numeric_limits<float>::infinity();
+}
+
+__always_inline__ float intersect(Ray ray, AABB aabb) {
+    Vector3f inverse_direction = Vector3f(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    return intersect(ray.origin, inverse_direction, aabb);
+}
+
+// Moller and Trumbore, Fast, Minimum Storage Ray/Triangle Intersection.
+// The triangle is given by a vertex and the two edges from it and both sides of the triangle are hit.
+// Returns the distance to the hit and the barycentric coordinates of the second and third vertex,
+// or infinity if the triangle is missed or behind the ray.
+__always_inline__ float intersect_triangle(Ray ray, Vector3f vertex0, Vector3f edge1, Vector3f edge2, Vector2f& barycentric) {
+    Vector3f p = cross(ray.direction, edge2);
+    float determinant = dot(edge1, p);
+    if (determinant == 0.0f)
+        return std::numeric_limits<float>::infinity();
+    float inverse_determinant = 1.0f / determinant;
+
+    Vector3f origin_offset = ray.origin - vertex0;
+    float u = dot(origin_offset, p) * inverse_determinant;
+    Vector3f q = cross(origin_offset, edge1);
+    float v = dot(ray.direction, q) * inverse_determinant;
+    float t = dot(edge2, q) * inverse_determinant;
+    if (u < 0.0f || v < 0.0f || u + v > 1.0f || t < 0.0f)
+        return std::numeric_limits<float>::infinity();
+
+    barycentric = Vector2f(u, v);
+    return t;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Four wide triangle intersection.
+// ------------------------------------------------------------------------------------------------
+
+// Four triangles stored as structure of arrays, each given by a vertex and the two edges from it.
+// Unused lanes are degenerate triangles with zero edges, which are never hit.
+struct alignas(16) Triangle4 final {
+    float vertex0_x[4], vertex0_y[4], vertex0_z[4];
+    float edge1_x[4], edge1_y[4], edge1_z[4];
+    float edge2_x[4], edge2_y[4], edge2_z[4];
+
+    __always_inline__ Vector3f get_vertex0(int lane) const { return Vector3f(vertex0_x[lane], vertex0_y[lane], vertex0_z[lane]); }
+    __always_inline__ Vector3f get_edge1(int lane) const { return Vector3f(edge1_x[lane], edge1_y[lane], edge1_z[lane]); }
+    __always_inline__ Vector3f get_edge2(int lane) const { return Vector3f(edge2_x[lane], edge2_y[lane], edge2_z[lane]); }
+
+    __always_inline__ void set(int lane, Vector3f vertex0, Vector3f edge1, Vector3f edge2) {
+        vertex0_x[lane] = vertex0.x; vertex0_y[lane] = vertex0.y; vertex0_z[lane] = vertex0.z;
+        edge1_x[lane] = edge1.x; edge1_y[lane] = edge1.y; edge1_z[lane] = edge1.z;
+        edge2_x[lane] = edge2.x; edge2_y[lane] = edge2.y; edge2_z[lane] = edge2.z;
+    }
+};
+
+#ifdef BIFROST_SSE2
+// Moller and Trumbore evaluated lane by lane, i.e. ray i against triangle i.
+// Returns a bitmask of the lanes hit in front of max_distance and stores their distances and barycentric coordinates.
+__always_inline__ int intersect_triangles_lanewise(const __m128* origin, const __m128* direction, const __m128* vertex0, const __m128* edge1, const __m128* edge2,
+                                                   __m128 max_distance, float* distances, float* us, float* vs) {
+    __m128 p_x = _mm_sub_ps(_mm_mul_ps(direction[1], edge2[2]), _mm_mul_ps(direction[2], edge2[1]));
+    __m128 p_y = _mm_sub_ps(_mm_mul_ps(direction[2], edge2[0]), _mm_mul_ps(direction[0], edge2[2]));
+    __m128 p_z = _mm_sub_ps(_mm_mul_ps(direction[0], edge2[1]), _mm_mul_ps(direction[1], edge2[0]));
+    __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1[0], p_x), _mm_mul_ps(edge1[1], p_y)), _mm_mul_ps(edge1[2], p_z));
+    __m128 inverse_determinant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+    __m128 offset_x = _mm_sub_ps(origin[0], vertex0[0]), offset_y = _mm_sub_ps(origin[1], vertex0[1]), offset_z = _mm_sub_ps(origin[2], vertex0[2]);
+    __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(offset_x, p_x), _mm_mul_ps(offset_y, p_y)), _mm_mul_ps(offset_z, p_z)), inverse_determinant);
+    __m128 q_x = _mm_sub_ps(_mm_mul_ps(offset_y, edge1[2]), _mm_mul_ps(offset_z, edge1[1]));
+    __m128 q_y = _mm_sub_ps(_mm_mul_ps(offset_z, edge1[0]), _mm_mul_ps(offset_x, edge1[2]));
+    __m128 q_z = _mm_sub_ps(_mm_mul_ps(offset_x, edge1[1]), _mm_mul_ps(offset_y, edge1[0]));
+    __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction[0], q_x), _mm_mul_ps(direction[1], q_y)), _mm_mul_ps(direction[2], q_z)), inverse_determinant);
+    __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2[0], q_x), _mm_mul_ps(edge2[1], q_y)), _mm_mul_ps(edge2[2], q_z)), inverse_determinant);
+
+    __m128 zero = _mm_setzero_ps();
+    __m128 hit = _mm_cmpneq_ps(determinant, zero);
+    hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero)));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmplt_ps(t, max_distance)));
+    _mm_storeu_ps(distances, t);
+    _mm_storeu_ps(us, u);
+    _mm_storeu_ps(vs, v);
+    return _mm_movemask_ps(hit);
+}
+#endif
+
+// Intersects the ray with four triangles.
+// Returns a bitmask of the triangles hit in front of max_distance and stores their distances and barycentric coordinates.
+__always_inline__ int intersect_triangles(Ray ray, const Triangle4& triangles, float max_distance, float* distances, float* us, float* vs) {
+#ifdef BIFROST_SSE2
+    __m128 origin[3] = { _mm_set1_ps(ray.origin.x), _mm_set1_ps(ray.origin.y), _mm_set1_ps(ray.origin.z) };
+    __m128 direction[3] = { _mm_set1_ps(ray.direction.x), _mm_set1_ps(ray.direction.y), _mm_set1_ps(ray.direction.z) };
+    __m128 vertex0[3] = { _mm_load_ps(triangles.vertex0_x), _mm_load_ps(triangles.vertex0_y), _mm_load_ps(triangles.vertex0_z) };
+    __m128 edge1[3] = { _mm_load_ps(triangles.edge1_x), _mm_load_ps(triangles.edge1_y), _mm_load_ps(triangles.edge1_z) };
+    __m128 edge2[3] = { _mm_load_ps(triangles.edge2_x), _mm_load_ps(triangles.edge2_y), _mm_load_ps(triangles.edge2_z) };
+    return intersect_triangles_lanewise(origin, direction, vertex0, edge1, edge2, _mm_set1_ps(max_distance), distances, us, vs);
+#else
+    int hit_mask = 0;
+    for (int t = 0; t < 4; ++t) {
+        Vector2f barycentric;
+        distances[t] = intersect_triangle(ray, triangles.get_vertex0(t), triangles.get_edge1(t), triangles.get_edge2(t), barycentric);
+        if (distances[t] < max_distance) {
+            us[t] = barycentric.x;
+            vs[t] = barycentric.y;
+            hit_mask |= 1 << t;
+        }
+    }
+    return hit_mask;
+#endif
+}
+
+// Intersects four rays with the triangle.
+// Returns a bitmask of the rays hitting the triangle in front of their max distance and stores the distances and barycentric coordinates.
+__always_inline__ int intersect_triangle(const RayPacket4& rays, Vector3f vertex0, Vector3f edge1, Vector3f edge2,
+                                         const float* max_distances, float* distances, float* us, float* vs) {
+#ifdef BIFROST_SSE2
+    __m128 origin[3] = { _mm_load_ps(rays.origin_x), _mm_load_ps(rays.origin_y), _mm_load_ps(rays.origin_z) };
+    __m128 direction[3] = { _mm_load_ps(rays.direction_x), _mm_load_ps(rays.direction_y), _mm_load_ps(rays.direction_z) };
+    __m128 vertex0_4[3] = { _mm_set1_ps(vertex0.x), _mm_set1_ps(vertex0.y), _mm_set1_ps(vertex0.z) };
+    __m128 edge1_4[3] = { _mm_set1_ps(edge1.x), _mm_set1_ps(edge1.y), _mm_set1_ps(edge1.z) };
+    __m128 edge2_4[3] = { _mm_set1_ps(edge2.x), _mm_set1_ps(edge2.y), _mm_set1_ps(edge2.z) };
+    return intersect_triangles_lanewise(origin, direction, vertex0_4, edge1_4, edge2_4, _mm_loadu_ps(max_distances), distances, us, vs);
+#else
+    int hit_mask = 0;
+    for (int r = 0; r < 4; ++r) {
+        Vector2f barycentric;
+        distances[r] = intersect_triangle(rays.get_ray(r), vertex0, edge1, edge2, barycentric);
+        if (distances[r] < max_distances[r]) {
+            us[r] = barycentric.x;
+            vs[r] = barycentric.y;
+            hit_mask |= 1 << r;
+        }
+    }
+    return hit_mask;
+#endif
+}
+
 } // NS Math
 } // NS Bifrost
 
-#endif // _BIFROST_MATH_PLANE_H_
+#endif // _BIFROST_MATH_INTERSECT_H_
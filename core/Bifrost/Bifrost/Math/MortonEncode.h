@@ -28,6 +28,20 @@ __always_inline__ unsigned int morton_encode(unsigned int x, unsigned int y) {
     return part_by_1(y) | (part_by_1(x) << 1);
 }
 
+__always_inline__ unsigned int part_by_2(unsigned int v) {
+    v &= 0x000003ff;                  // v = ---- ---- ---- ---- ---- --98 7654 3210
+    v = (v ^ (v << 16)) & 0xff0000ff; // v = ---- --98 ---- ---- ---- ---- 7654 3210
+    v = (v ^ (v << 8)) & 0x0300f00f;  // v = ---- --98 ---- ---- 7654 ---- ---- 3210
+    v = (v ^ (v << 4)) & 0x030c30c3;  // v = ---- --98 ---- 76-- --54 ---- 32-- --10
+    v = (v ^ (v << 2)) & 0x09249249;  // v = ---- 9--8 --7- -6-- 5--4 --3- -2-- 1--0
+    return v;
+}
+
+// Interleaves the lower 10 bits of each coordinate.
+__always_inline__ unsigned int morton_encode(unsigned int x, unsigned int y, unsigned int z) {
+    return part_by_2(z) | (part_by_2(y) << 1) | (part_by_2(x) << 2);
+}
+
 } // NS Math
 } // NS Bifrost
 
@@ -54,6 +54,31 @@ public:
     }
 };
 
+//----------------------------------------------------------------------------
+// Four rays stored as structure of arrays, so they can be traversed and
+// intersected as a packet.
+//----------------------------------------------------------------------------
+struct alignas(16) RayPacket4 final {
+public:
+    float origin_x[4], origin_y[4], origin_z[4];
+    float direction_x[4], direction_y[4], direction_z[4];
+
+    RayPacket4() = default;
+    RayPacket4(const Ray* rays) {
+        for (int r = 0; r < 4; ++r)
+            set_ray(r, rays[r]);
+    }
+
+    __always_inline__ Ray get_ray(int lane) const {
+        return Ray(Vector3f(origin_x[lane], origin_y[lane], origin_z[lane]), Vector3f(direction_x[lane], direction_y[lane], direction_z[lane]));
+    }
+
+    __always_inline__ void set_ray(int lane, Ray ray) {
+        origin_x[lane] = ray.origin.x; origin_y[lane] = ray.origin.y; origin_z[lane] = ray.origin.z;
+        direction_x[lane] = ray.direction.x; direction_y[lane] = ray.direction.y; direction_z[lane] = ray.direction.z;
+    }
+};
+
 } // NS Math
 } // NS Bifrost
 
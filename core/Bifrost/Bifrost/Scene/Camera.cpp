@@ -7,7 +7,9 @@
 // ---------------------------------------------------------------------------
 
 #include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/MeshModelBVH.h>
 
+#include <algorithm>
 #include <assert.h>
 
 using namespace Bifrost::Math;
@@ -21,17 +23,18 @@ namespace Scene {
 
 Cameras::UIDGenerator Cameras::m_UID_generator = UIDGenerator(0u);
 
-std::string* Cameras::m_names = nullptr;
-SceneRoots::UID* Cameras::m_scene_IDs = nullptr;
-int* Cameras::m_z_indices = nullptr;
-Transform* Cameras::m_transforms = nullptr;
-Matrix4x4f* Cameras::m_projection_matrices = nullptr;
-Matrix4x4f* Cameras::m_inverse_projection_matrices = nullptr;
-Rectf* Cameras::m_viewports = nullptr;
-Core::Renderers::UID* Cameras::m_renderer_IDs = nullptr;
-CameraEffects::Settings* Cameras::m_effects_settings = nullptr;
-Cameras::ScreenshotRequest* Cameras::m_screenshot_request = nullptr;
+Core::ReservedArray<std::string> Cameras::m_names;
+Core::ReservedArray<SceneRoots::UID> Cameras::m_scene_IDs;
+Core::ReservedArray<int> Cameras::m_z_indices;
+Core::ReservedArray<Transform> Cameras::m_transforms;
+Core::ReservedArray<Matrix4x4f> Cameras::m_projection_matrices;
+Core::ReservedArray<Matrix4x4f> Cameras::m_inverse_projection_matrices;
+Core::ReservedArray<Rectf> Cameras::m_viewports;
+Core::ReservedArray<Core::Renderers::UID> Cameras::m_renderer_IDs;
+Core::ReservedArray<CameraEffects::Settings> Cameras::m_effects_settings;
+Core::ReservedArray<Cameras::ScreenshotRequest> Cameras::m_screenshot_request;
 Core::ChangeSet<Cameras::Changes, Cameras::UID> Cameras::m_changes;
+std::unique_ptr<MeshModelBVH> Cameras::m_model_BVH;
 
 void Cameras::allocate(unsigned int capacity) {
     if (is_allocated())
@@ -40,16 +43,16 @@ void Cameras::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_names = new std::string[capacity];
-    m_scene_IDs = new SceneRoots::UID[capacity];
-    m_transforms = new Transform[capacity];
-    m_projection_matrices = new Matrix4x4f[capacity];
-    m_inverse_projection_matrices = new Matrix4x4f[capacity];
-    m_z_indices = new int[capacity];
-    m_viewports = new Rectf[capacity];
-    m_renderer_IDs = new Core::Renderers::UID[capacity];
-    m_effects_settings = new CameraEffects::Settings[capacity];
-    m_screenshot_request = new ScreenshotRequest[capacity];
+    m_names = Core::ReservedArray<std::string>(m_UID_generator.max_capacity(), capacity);
+    m_scene_IDs = Core::ReservedArray<SceneRoots::UID>(m_UID_generator.max_capacity(), capacity);
+    m_transforms = Core::ReservedArray<Transform>(m_UID_generator.max_capacity(), capacity);
+    m_projection_matrices = Core::ReservedArray<Matrix4x4f>(m_UID_generator.max_capacity(), capacity);
+    m_inverse_projection_matrices = Core::ReservedArray<Matrix4x4f>(m_UID_generator.max_capacity(), capacity);
+    m_z_indices = Core::ReservedArray<int>(m_UID_generator.max_capacity(), capacity);
+    m_viewports = Core::ReservedArray<Rectf>(m_UID_generator.max_capacity(), capacity);
+    m_renderer_IDs = Core::ReservedArray<Core::Renderers::UID>(m_UID_generator.max_capacity(), capacity);
+    m_effects_settings = Core::ReservedArray<CameraEffects::Settings>(m_UID_generator.max_capacity(), capacity);
+    m_screenshot_request = Core::ReservedArray<ScreenshotRequest>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy camera at 0.
@@ -71,18 +74,20 @@ void Cameras::deallocate() {
 
     m_UID_generator = UIDGenerator(0u);
 
-    delete[] m_names; m_names = nullptr;
-    delete[] m_scene_IDs; m_scene_IDs = nullptr;
-    delete[] m_transforms; m_transforms = nullptr;
-    delete[] m_projection_matrices; m_projection_matrices = nullptr;
-    delete[] m_inverse_projection_matrices; m_inverse_projection_matrices = nullptr;
-    delete[] m_z_indices; m_z_indices = nullptr;
-    delete[] m_viewports; m_viewports = nullptr;
-    delete[] m_renderer_IDs; m_renderer_IDs = nullptr;
-    delete[] m_effects_settings; m_effects_settings = nullptr;
-    delete[] m_screenshot_request; m_screenshot_request = nullptr;
+    m_names.release();
+    m_scene_IDs.release();
+    m_transforms.release();
+    m_projection_matrices.release();
+    m_inverse_projection_matrices.release();
+    m_z_indices.release();
+    m_viewports.release();
+    m_renderer_IDs.release();
+    m_effects_settings.release();
+    m_screenshot_request.release();
 
     m_changes.resize(0);
+
+    m_model_BVH.reset();
 }
 
 void Cameras::reserve(unsigned int new_capacity) {
@@ -91,51 +96,75 @@ void Cameras::reserve(unsigned int new_capacity) {
     reserve_camera_data(m_UID_generator.capacity(), old_capacity);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void Cameras::reserve_camera_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_scene_IDs != nullptr);
-    assert(m_transforms != nullptr);
-    assert(m_projection_matrices != nullptr);
-    assert(m_inverse_projection_matrices != nullptr);
-    assert(m_z_indices != nullptr);
-    assert(m_viewports != nullptr);
+    assert(m_scene_IDs.data() != nullptr);
+    assert(m_transforms.data() != nullptr);
+    assert(m_projection_matrices.data() != nullptr);
+    assert(m_inverse_projection_matrices.data() != nullptr);
+    assert(m_z_indices.data() != nullptr);
+    assert(m_viewports.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
+    m_names.resize(new_capacity);
 
-    m_names = resize_and_copy_array(m_names, new_capacity, copyable_elements);
+    m_scene_IDs.resize(new_capacity);
 
-    m_scene_IDs = resize_and_copy_array(m_scene_IDs, new_capacity, copyable_elements);
+    m_transforms.resize(new_capacity);
+    m_projection_matrices.resize(new_capacity);
+    m_inverse_projection_matrices.resize(new_capacity);
 
-    m_transforms = resize_and_copy_array(m_transforms, new_capacity, copyable_elements);
-    m_projection_matrices = resize_and_copy_array(m_projection_matrices, new_capacity, copyable_elements);
-    m_inverse_projection_matrices = resize_and_copy_array(m_inverse_projection_matrices, new_capacity, copyable_elements);
-
-    m_z_indices = resize_and_copy_array(m_z_indices, new_capacity, copyable_elements);
-    m_viewports = resize_and_copy_array(m_viewports, new_capacity, copyable_elements);
-    m_renderer_IDs = resize_and_copy_array(m_renderer_IDs, new_capacity, copyable_elements);
-    m_effects_settings = resize_and_copy_array(m_effects_settings, new_capacity, copyable_elements);
-    m_screenshot_request = resize_and_copy_array(m_screenshot_request, new_capacity, copyable_elements);
+    m_z_indices.resize(new_capacity);
+    m_viewports.resize(new_capacity);
+    m_renderer_IDs.resize(new_capacity);
+    m_effects_settings.resize(new_capacity);
+    m_screenshot_request.resize(new_capacity);
 
     m_changes.resize(new_capacity);
 }
 
+static inline size_t get_screenshot_bytes(const std::vector<Screenshot>& screenshots) {
+    size_t byte_count = Core::get_allocated_bytes(screenshots);
+    for (const Screenshot& screenshot : screenshots)
+        if (screenshot.pixels != nullptr)
+            byte_count += size_t(screenshot.width) * screenshot.height * Assets::size_of(screenshot.format);
+    return byte_count;
+}
+
+Core::MemoryUsage Cameras::get_memory_usage(Cameras::UID camera_ID) {
+    Core::MemoryUsage usage;
+    if (!m_UID_generator.has(camera_ID))
+        return usage;
+    usage[Core::MemoryCategory::Pixels] = get_screenshot_bytes(m_screenshot_request[camera_ID].images);
+    usage[Core::MemoryCategory::Metadata] = sizeof(std::string) + sizeof(SceneRoots::UID) + sizeof(Transform) + 2 * sizeof(Matrix4x4f) +
+        sizeof(int) + sizeof(Rectf) + sizeof(Core::Renderers::UID) + sizeof(CameraEffects::Settings) + sizeof(ScreenshotRequest) +
+        Core::get_allocated_bytes(m_names[camera_ID]);
+    return usage;
+}
+
+Core::MemoryUsage Cameras::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID camera_ID : m_UID_generator) {
+        usage[Core::MemoryCategory::Pixels] += get_screenshot_bytes(m_screenshot_request[camera_ID].images);
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(m_names[camera_ID]);
+    }
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() +
+        Core::get_allocated_bytes(m_names) + Core::get_allocated_bytes(m_scene_IDs) + Core::get_allocated_bytes(m_transforms) +
+        Core::get_allocated_bytes(m_projection_matrices) + Core::get_allocated_bytes(m_inverse_projection_matrices) +
+        Core::get_allocated_bytes(m_z_indices) + Core::get_allocated_bytes(m_viewports) + Core::get_allocated_bytes(m_renderer_IDs) +
+        Core::get_allocated_bytes(m_effects_settings) + Core::get_allocated_bytes(m_screenshot_request);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 Cameras::UID Cameras::create(const std::string& name, SceneRoots::UID scene_ID, 
                              Matrix4x4f projection_matrix, Matrix4x4f inverse_projection_matrix, 
                              Core::Renderers::UID renderer_ID) {
-    assert(m_names != nullptr);
-    assert(m_scene_IDs != nullptr);
-    assert(m_z_indices != nullptr);
-    assert(m_transforms != nullptr);
-    assert(m_projection_matrices != nullptr);
-    assert(m_inverse_projection_matrices != nullptr);
-    assert(m_viewports != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_scene_IDs.data() != nullptr);
+    assert(m_z_indices.data() != nullptr);
+    assert(m_transforms.data() != nullptr);
+    assert(m_projection_matrices.data() != nullptr);
+    assert(m_inverse_projection_matrices.data() != nullptr);
+    assert(m_viewports.data() != nullptr);
 
     if (!SceneRoots::has(scene_ID))
         return Cameras::UID::invalid_UID();
@@ -177,6 +206,29 @@ std::vector<Cameras::UID> Cameras::get_z_sorted_IDs() {
     return IDs;
 }
 
+void Cameras::update_model_BVH() {
+    if (m_model_BVH == nullptr)
+        m_model_BVH = std::make_unique<MeshModelBVH>();
+    else
+        m_model_BVH->update();
+}
+
+std::vector<Assets::MeshModels::UID> Cameras::get_visible_models(Cameras::UID camera_ID) {
+    std::vector<Assets::MeshModels::UID> visible_model_IDs;
+    if (m_model_BVH == nullptr)
+        return visible_model_IDs;
+
+    m_model_BVH->find_models_in_frustum(get_frustum(camera_ID), visible_model_IDs);
+
+    // The hierarchy covers the models of all scenes, so the models outside the camera's scene are removed.
+    SceneNodes::UID root_node_ID = SceneRoots::get_root_node(get_scene_ID(camera_ID));
+    auto outside_scene = [=](Assets::MeshModels::UID model_ID) {
+        return !SceneNodes::is_in_subtree(root_node_ID, Assets::MeshModels::get_scene_node_ID(model_ID));
+    };
+    visible_model_IDs.erase(std::remove_if(visible_model_IDs.begin(), visible_model_IDs.end(), outside_scene), visible_model_IDs.end());
+    return visible_model_IDs;
+}
+
 void Cameras::fill_screenshot(Cameras::UID camera_ID, ScreenshotFiller screenshot_filler) {
     if (is_screenshot_requested(camera_ID)) {
         auto& screenshot_info = m_screenshot_request[camera_ID];
@@ -197,18 +249,23 @@ Cameras::ScreenshotContent Cameras::pending_screenshots(Cameras::UID camera_ID)
 }
 
 Assets::Images::UID Cameras::resolve_screenshot(Cameras::UID camera_ID, Screenshot::Content image_content, const std::string& name) {
+    Screenshot image = take_screenshot(camera_ID, image_content);
+    if (image.pixels == nullptr)
+        return Assets::Images::UID::invalid_UID();
+    return Assets::Images::create2D(name, image.format, image.get_gamma(), Vector2ui(image.width, image.height), image.pixels);
+}
+
+Screenshot Cameras::take_screenshot(Cameras::UID camera_ID, Screenshot::Content image_content) {
     auto& info = m_screenshot_request[camera_ID];
     for (int i = 0; i < info.images.size(); ++i) {
-        auto& image = info.images[i];
-        if (image.content == image_content) {
-            bool is_HDR = image.content == Screenshot::Content::ColorHDR;
-            auto image_ID = Assets::Images::create2D(name, image.format, is_HDR ? 1.0f : 2.2f, Vector2ui(image.width, image.height), image.pixels);
+        if (info.images[i].content == image_content) {
+            Screenshot image = info.images[i];
             info.images.erase(info.images.begin() + i);
-            return image_ID;
+            return image;
         }
     }
 
-    return Assets::Images::UID::invalid_UID();
+    return Screenshot(0, 0, Screenshot::Content::None, Assets::PixelFormat::Unknown, nullptr);
 }
 
 //*****************************************************************************
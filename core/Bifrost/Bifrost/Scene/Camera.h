@@ -10,9 +10,13 @@
 #define _BIFROST_SCENE_CAMERA_H_
 
 #include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/MeshModel.h>
 #include <Bifrost/Core/Renderer.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Math/CameraEffects.h>
 #include <Bifrost/Math/Conversions.h>
+#include <Bifrost/Math/Frustum.h>
 #include <Bifrost/Math/Matrix.h>
 #include <Bifrost/Math/Ray.h>
 #include <Bifrost/Math/Rect.h>
@@ -20,10 +24,13 @@
 #include <Bifrost/Scene/SceneRoot.h>
 
 #include <functional>
+#include <memory>
 
 namespace Bifrost {
 namespace Scene {
 
+class MeshModelBVH;
+
 // ------------------------------------------------------------------------------------------------
 // Container for screenshots from the camera.
 // ------------------------------------------------------------------------------------------------
@@ -47,6 +54,9 @@ struct Screenshot {
 
     Screenshot(int width, int height, Content content, Assets::PixelFormat format, Assets::Images::PixelData pixels)
         : width(width), height(height), content(content), format(format), pixels(pixels) { }
+
+    // HDR color is stored linearly and all other content is gamma encoded.
+    inline float get_gamma() const { return content == Content::ColorHDR ? 1.0f : 2.2f; }
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -58,7 +68,7 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static bool is_allocated() { return m_scene_IDs != nullptr; }
+    static bool is_allocated() { return m_scene_IDs.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -108,6 +118,20 @@ public:
         return to_matrix4x4(get_inverse_view_transform(camera_ID)) * get_inverse_projection_matrix(camera_ID);
     }
 
+    static Math::Frustum get_frustum(Cameras::UID camera_ID) {
+        return Math::Frustum::from_view_projection_matrix(get_view_projection_matrix(camera_ID));
+    }
+
+    // Creates the bounding volume hierarchy over the models used by get_visible_models or refits it from the
+    // SceneNodes and MeshModels changes made since the last update. Requires the SceneNodes, Meshes and
+    // MeshModels to be allocated. Call it once pr tick before querying, fx from a mutating callback.
+    static void update_model_BVH();
+
+    // Returns the models in the camera's scene whose world space bounds intersect the camera's frustum.
+    // Returns the models found by the last update_model_BVH, or no models if the hierarchy hasn't been created.
+    // Queries do not modify the hierarchy and are thread safe between updates.
+    static std::vector<Assets::MeshModels::UID> get_visible_models(Cameras::UID camera_ID);
+
     // Order that cameras are draw in. Cameras with higher z-index are rendered in front of cameras with lower z-index.
     static int get_z_index(Cameras::UID camera_ID) { return m_z_indices[camera_ID]; }
     static void set_z_index(Cameras::UID camera_ID, int index) { m_z_indices[camera_ID] = index; }
@@ -137,6 +161,15 @@ public:
     static void fill_screenshot(Cameras::UID camera_ID, ScreenshotFiller screenshot_filler);
     static ScreenshotContent pending_screenshots(Cameras::UID camera_ID);
     static Assets::Images::UID resolve_screenshot(Cameras::UID camera_ID, Screenshot::Content image_content, const std::string& name); // Resolves the last screenshot into an image.
+    // Moves the last screenshot out of the camera without copying its pixels, fx to hand it to a ScreenshotWriter.
+    // The caller owns the pixels afterwards. Returns a screenshot without content and pixels if none is pending.
+    static Screenshot take_screenshot(Cameras::UID camera_ID, Screenshot::Content image_content);
+
+    //---------------------------------------------------------------------------------------------
+    // Memory usage.
+    //---------------------------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(Cameras::UID camera_ID);
+    static Core::MemoryUsage get_memory_usage();
 
     //---------------------------------------------------------------------------------------------
     // Changes since last game loop tick.
@@ -155,6 +188,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_cameras() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { return m_changes.reset_change_notifications(); }
 
 private:
@@ -163,15 +203,15 @@ private:
 
     static UIDGenerator m_UID_generator;
 
-    static std::string* m_names;
-    static SceneRoots::UID* m_scene_IDs;
-    static Math::Transform* m_transforms;
-    static Math::Matrix4x4f* m_projection_matrices;
-    static Math::Matrix4x4f* m_inverse_projection_matrices;
-    static int* m_z_indices;
-    static Math::Rectf* m_viewports;
-    static Core::Renderers::UID* m_renderer_IDs;
-    static Math::CameraEffects::Settings* m_effects_settings;
+    static Core::ReservedArray<std::string> m_names;
+    static Core::ReservedArray<SceneRoots::UID> m_scene_IDs;
+    static Core::ReservedArray<Math::Transform> m_transforms;
+    static Core::ReservedArray<Math::Matrix4x4f> m_projection_matrices;
+    static Core::ReservedArray<Math::Matrix4x4f> m_inverse_projection_matrices;
+    static Core::ReservedArray<int> m_z_indices;
+    static Core::ReservedArray<Math::Rectf> m_viewports;
+    static Core::ReservedArray<Core::Renderers::UID> m_renderer_IDs;
+    static Core::ReservedArray<Math::CameraEffects::Settings> m_effects_settings;
 
     struct ScreenshotRequest {
         Core::Bitmask<Screenshot::Content> content_requested;
@@ -180,9 +220,11 @@ private:
         std::vector<Screenshot> images;
     };
 
-    static ScreenshotRequest* m_screenshot_request;
+    static Core::ReservedArray<ScreenshotRequest> m_screenshot_request;
 
     static Core::ChangeSet<Changes, UID> m_changes;
+
+    static std::unique_ptr<MeshModelBVH> m_model_BVH;
 };
 
 //-------------------------------------------------------------------------------------------------
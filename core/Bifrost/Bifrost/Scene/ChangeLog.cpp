@@ -0,0 +1,563 @@
+// Bifrost recording and replay of the datamodel changes made each tick.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/ChangeLog.h>
+#include <Bifrost/Scene/SerializationUtils.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene::SerializationUtils;
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Log layout.
+// The header is followed by the ticks. A tick starts with its delta time, followed by the indices
+// of the destroyed resources pr manager, in the reverse order of the references between managers,
+// and then the created and updated resources pr manager, in the order of the references.
+// A created or updated resource is stored as its index and change flags followed by its state.
+// References between resources are stored as indices.
+// ------------------------------------------------------------------------------------------------
+
+static const char MAGIC[8] = { 'B', 'F', 'C', 'H', 'A', 'N', 'G', 'E' };
+static const unsigned int NO_CONSUMER = 0xFFFFFFFFu;
+
+// ------------------------------------------------------------------------------------------------
+// Change recorder.
+// ------------------------------------------------------------------------------------------------
+
+template <typename Manager>
+static inline unsigned int add_consumer() {
+    return Manager::is_allocated() ? Manager::add_change_consumer() : NO_CONSUMER;
+}
+
+template <typename Manager>
+static inline void remove_consumer(unsigned int consumer_ID) {
+    if (consumer_ID != NO_CONSUMER && Manager::is_allocated())
+        Manager::remove_change_consumer(consumer_ID);
+}
+
+// The consumed changes of a manager split into the destroyed resources and the living resources that changed.
+template <typename Manager>
+struct ConsumedChanges {
+    std::vector<unsigned int> destroyed_indices;
+    std::vector<std::pair<typename Manager::UID, typename Manager::Changes>> changed_resources;
+
+    explicit ConsumedChanges(unsigned int consumer_ID) {
+        if (consumer_ID == NO_CONSUMER)
+            return;
+        for (auto resource_changes : Manager::consume_changes(consumer_ID)) {
+            if (resource_changes.changes.is_set(Manager::Change::Destroyed))
+                destroyed_indices.push_back(resource_changes.ID.get_index());
+            // Resources created and destroyed in the same tick don't exist anymore and are only replayed as destroyed.
+            if (Manager::has(resource_changes.ID))
+                changed_resources.emplace_back(resource_changes.ID, resource_changes.changes);
+        }
+    }
+
+    void write_destroyed(Core::BinaryWriter& writer) const {
+        writer.write((unsigned int)destroyed_indices.size());
+        for (unsigned int index : destroyed_indices)
+            writer.write(index);
+    }
+};
+
+ChangeRecorder::ChangeRecorder(const std::string& path)
+    : m_writer(path), m_tick_count(0u) {
+    if (!m_writer.succeeded())
+        printf("ChangeRecorder error: Could not open '%s' for writing.\n", path.c_str());
+
+    m_writer.write(create_header(MAGIC, VERSION));
+
+    m_image_consumer_ID = add_consumer<Images>();
+    m_texture_consumer_ID = add_consumer<Textures>();
+    m_material_consumer_ID = add_consumer<Materials>();
+    m_mesh_consumer_ID = add_consumer<Meshes>();
+    m_model_consumer_ID = add_consumer<MeshModels>();
+    m_node_consumer_ID = add_consumer<SceneNodes>();
+    m_scene_consumer_ID = add_consumer<SceneRoots>();
+    m_light_consumer_ID = add_consumer<LightSources>();
+    m_camera_consumer_ID = add_consumer<Cameras>();
+}
+
+ChangeRecorder::~ChangeRecorder() {
+    remove_consumer<Images>(m_image_consumer_ID);
+    remove_consumer<Textures>(m_texture_consumer_ID);
+    remove_consumer<Materials>(m_material_consumer_ID);
+    remove_consumer<Meshes>(m_mesh_consumer_ID);
+    remove_consumer<MeshModels>(m_model_consumer_ID);
+    remove_consumer<SceneNodes>(m_node_consumer_ID);
+    remove_consumer<SceneRoots>(m_scene_consumer_ID);
+    remove_consumer<LightSources>(m_light_consumer_ID);
+    remove_consumer<Cameras>(m_camera_consumer_ID);
+}
+
+void ChangeRecorder::record_tick(double delta_time) {
+    ConsumedChanges<Images> image_changes = ConsumedChanges<Images>(m_image_consumer_ID);
+    ConsumedChanges<Textures> texture_changes = ConsumedChanges<Textures>(m_texture_consumer_ID);
+    ConsumedChanges<Materials> material_changes = ConsumedChanges<Materials>(m_material_consumer_ID);
+    ConsumedChanges<Meshes> mesh_changes = ConsumedChanges<Meshes>(m_mesh_consumer_ID);
+    ConsumedChanges<SceneRoots> scene_changes = ConsumedChanges<SceneRoots>(m_scene_consumer_ID);
+    ConsumedChanges<SceneNodes> node_changes = ConsumedChanges<SceneNodes>(m_node_consumer_ID);
+    ConsumedChanges<MeshModels> model_changes = ConsumedChanges<MeshModels>(m_model_consumer_ID);
+    ConsumedChanges<LightSources> light_changes = ConsumedChanges<LightSources>(m_light_consumer_ID);
+    ConsumedChanges<Cameras> camera_changes = ConsumedChanges<Cameras>(m_camera_consumer_ID);
+
+    m_writer.write(delta_time);
+
+    camera_changes.write_destroyed(m_writer);
+    light_changes.write_destroyed(m_writer);
+    model_changes.write_destroyed(m_writer);
+    node_changes.write_destroyed(m_writer);
+    scene_changes.write_destroyed(m_writer);
+    mesh_changes.write_destroyed(m_writer);
+    material_changes.write_destroyed(m_writer);
+    texture_changes.write_destroyed(m_writer);
+    image_changes.write_destroyed(m_writer);
+
+    m_writer.write((unsigned int)image_changes.changed_resources.size());
+    for (auto [image_ID, changes] : image_changes.changed_resources) {
+        m_writer.write(image_ID.get_index());
+        m_writer.write(changes);
+        if (changes.is_set(Images::Change::Created)) {
+            m_writer.write_string(Images::get_name(image_ID));
+            m_writer.write(Vector3ui(Images::get_width(image_ID), Images::get_height(image_ID), Images::get_depth(image_ID)));
+            m_writer.write(Images::get_mipmap_count(image_ID));
+        }
+        m_writer.write(Images::is_mipmapable(image_ID));
+        if (changes.any_set(Images::Change::Created, Images::Change::PixelsUpdated)) {
+            m_writer.write(Images::get_pixel_format(image_ID));
+            m_writer.write(Images::get_gamma(image_ID));
+            m_writer.write_block(Images::get_pixels(image_ID), get_pixel_bytes(image_ID));
+        }
+    }
+
+    m_writer.write((unsigned int)texture_changes.changed_resources.size());
+    for (auto [texture_ID, changes] : texture_changes.changed_resources) {
+        m_writer.write(texture_ID.get_index());
+        m_writer.write(changes);
+        m_writer.write(index_of<Images>(Textures::get_image_ID(texture_ID)));
+        m_writer.write(Textures::get_magnification_filter(texture_ID));
+        m_writer.write(Textures::get_minification_filter(texture_ID));
+        m_writer.write(Textures::get_wrapmode_U(texture_ID));
+        m_writer.write(Textures::get_wrapmode_V(texture_ID));
+    }
+
+    m_writer.write((unsigned int)material_changes.changed_resources.size());
+    for (auto [material_ID, changes] : material_changes.changed_resources) {
+        m_writer.write(material_ID.get_index());
+        m_writer.write(changes);
+        write_material(m_writer, material_ID);
+    }
+
+    // Meshes are stored in full, both when created and when their geometry is updated.
+    m_writer.write((unsigned int)mesh_changes.changed_resources.size());
+    for (auto [mesh_ID, changes] : mesh_changes.changed_resources) {
+        m_writer.write(mesh_ID.get_index());
+        m_writer.write(changes);
+        write_mesh(m_writer, mesh_ID);
+    }
+
+    m_writer.write((unsigned int)scene_changes.changed_resources.size());
+    for (auto [scene_ID, changes] : scene_changes.changed_resources) {
+        m_writer.write(scene_ID.get_index());
+        m_writer.write(changes);
+        m_writer.write(index_of<SceneNodes>(SceneRoots::get_root_node(scene_ID)));
+        m_writer.write(SceneRoots::get_environment_tint(scene_ID));
+        m_writer.write(index_of<Textures>(SceneRoots::get_environment_map(scene_ID)));
+    }
+
+    // Local transforms are stored, as they can be replayed independently of the order of the nodes.
+    m_writer.write((unsigned int)node_changes.changed_resources.size());
+    for (auto [node_ID, changes] : node_changes.changed_resources) {
+        m_writer.write(node_ID.get_index());
+        m_writer.write(changes);
+        if (changes.is_set(SceneNodes::Change::Created))
+            m_writer.write_string(SceneNodes::get_name(node_ID));
+        m_writer.write(index_of<SceneNodes>(SceneNodes::get_parent_ID(node_ID)));
+        m_writer.write(SceneNodes::get_local_transform(node_ID));
+    }
+
+    m_writer.write((unsigned int)model_changes.changed_resources.size());
+    for (auto [model_ID, changes] : model_changes.changed_resources) {
+        m_writer.write(model_ID.get_index());
+        m_writer.write(changes);
+        m_writer.write(index_of<SceneNodes>(MeshModels::get_scene_node_ID(model_ID)));
+        m_writer.write(index_of<Meshes>(MeshModels::get_mesh_ID(model_ID)));
+        m_writer.write(index_of<Materials>(MeshModels::get_material_ID(model_ID)));
+    }
+
+    m_writer.write((unsigned int)light_changes.changed_resources.size());
+    for (auto [light_ID, changes] : light_changes.changed_resources) {
+        m_writer.write(light_ID.get_index());
+        m_writer.write(changes);
+        write_light(m_writer, light_ID);
+    }
+
+    // Only created cameras are stored, as the renderer changes are not recorded.
+    unsigned int created_camera_count = 0;
+    for (auto [camera_ID, changes] : camera_changes.changed_resources)
+        created_camera_count += changes.is_set(Cameras::Change::Created);
+    m_writer.write(created_camera_count);
+    for (auto [camera_ID, changes] : camera_changes.changed_resources) {
+        if (!changes.is_set(Cameras::Change::Created))
+            continue;
+        m_writer.write(camera_ID.get_index());
+        m_writer.write(changes);
+        m_writer.write_string(Cameras::get_name(camera_ID));
+        m_writer.write(index_of<SceneRoots>(Cameras::get_scene_ID(camera_ID)));
+    }
+
+    // The camera state isn't covered by change flags and is stored for all cameras.
+    std::vector<Cameras::UID> camera_IDs;
+    if (m_camera_consumer_ID != NO_CONSUMER)
+        for (Cameras::UID camera_ID : Cameras::get_iterable())
+            camera_IDs.push_back(camera_ID);
+    m_writer.write((unsigned int)camera_IDs.size());
+    for (Cameras::UID camera_ID : camera_IDs) {
+        m_writer.write(camera_ID.get_index());
+        m_writer.write(Cameras::get_transform(camera_ID));
+        m_writer.write(Cameras::get_projection_matrix(camera_ID));
+        m_writer.write(Cameras::get_inverse_projection_matrix(camera_ID));
+        m_writer.write(Cameras::get_z_index(camera_ID));
+        m_writer.write(Cameras::get_viewport(camera_ID));
+        m_writer.write(Cameras::get_effects_settings(camera_ID));
+    }
+
+    m_writer.flush();
+    ++m_tick_count;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Change replayer.
+// ------------------------------------------------------------------------------------------------
+
+template <typename UID>
+static inline void map(std::vector<UID>& IDs, unsigned int index, UID resource_ID) {
+    if (index >= IDs.size())
+        IDs.resize(index + 1, UID::invalid_UID());
+    IDs[index] = resource_ID;
+}
+
+// Destroys the replayed resources of the destroyed resource indices.
+template <typename Manager>
+static inline void replay_destroyed(Core::BinaryReader& reader, std::vector<typename Manager::UID>& IDs) {
+    unsigned int destroyed_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < destroyed_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        typename Manager::UID resource_ID = lookup(IDs, index);
+        if (Manager::has(resource_ID))
+            Manager::destroy(resource_ID);
+        if (index < IDs.size())
+            IDs[index] = Manager::UID::invalid_UID();
+    }
+}
+
+// Copies a block into the destination if the block is the expected size.
+static inline void read_block_into(Core::BinaryReader& reader, void* destination, size_t byte_count) {
+    const void* block = reader.read_block(byte_count);
+    if (block != nullptr && destination != nullptr)
+        memcpy(destination, block, byte_count);
+}
+
+ChangeReplayer::ChangeReplayer(const std::string& path)
+    : m_file(path), m_reader(m_file.data(), m_file.size()), m_tick_count(0u), m_next_delta_time(0.0) {
+    if (!m_file.is_open()) {
+        printf("ChangeReplayer error: Could not map '%s'.\n", path.c_str());
+        return;
+    }
+    restart();
+    if (!is_valid())
+        printf("ChangeReplayer error: '%s' is not a change log of version %u.\n", path.c_str(), ChangeRecorder::VERSION);
+}
+
+void ChangeReplayer::restart() {
+    m_reader = Core::BinaryReader(m_file.data(), m_file.size());
+    m_tick_count = 0u;
+
+    Header header = m_reader.read<Header>();
+    if (!has_magic(header, MAGIC) || !is_native(header, ChangeRecorder::VERSION))
+        m_reader.fail();
+    read_tick_header();
+}
+
+void ChangeReplayer::read_tick_header() {
+    m_next_delta_time = m_reader.is_at_end() ? 0.0 : m_reader.read<double>();
+}
+
+bool ChangeReplayer::replay_tick() {
+    if (is_at_end())
+        return false;
+
+    Core::BinaryReader& reader = m_reader;
+
+    replay_destroyed<Cameras>(reader, m_camera_IDs);
+    replay_destroyed<LightSources>(reader, m_light_IDs);
+    replay_destroyed<MeshModels>(reader, m_model_IDs);
+    replay_destroyed<SceneNodes>(reader, m_node_IDs);
+    replay_destroyed<SceneRoots>(reader, m_scene_IDs);
+    replay_destroyed<Meshes>(reader, m_mesh_IDs);
+    replay_destroyed<Materials>(reader, m_material_IDs);
+    replay_destroyed<Textures>(reader, m_texture_IDs);
+    replay_destroyed<Images>(reader, m_image_IDs);
+
+    unsigned int image_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < image_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        Images::Changes changes = reader.read<Images::Changes>();
+        Images::UID image_ID = lookup(m_image_IDs, index);
+        if (changes.is_set(Images::Change::Created)) {
+            std::string name = reader.read_string();
+            Vector3ui size = reader.read<Vector3ui>();
+            unsigned int mipmap_count = reader.read<unsigned int>();
+            bool is_mipmapable = reader.read<bool>();
+            PixelFormat format = reader.read<PixelFormat>();
+            float gamma = reader.read<float>();
+            if (reader.failed() || size_of(format) == 0 || mipmap_count == 0)
+                return reader.fail(), false;
+            image_ID = Images::create3D(name, format, gamma, size, mipmap_count);
+            Images::set_mipmapable(image_ID, is_mipmapable);
+            map(m_image_IDs, index, image_ID);
+            read_block_into(reader, Images::get_pixels(image_ID), get_pixel_bytes(image_ID));
+            continue;
+        }
+
+        bool is_mipmapable = reader.read<bool>();
+        if (Images::has(image_ID))
+            Images::set_mipmapable(image_ID, is_mipmapable);
+        if (changes.is_set(Images::Change::PixelsUpdated)) {
+            PixelFormat format = reader.read<PixelFormat>();
+            float gamma = reader.read<float>();
+            if (reader.failed() || size_of(format) == 0)
+                return reader.fail(), false;
+            if (!Images::has(image_ID)) {
+                // Images created before the recording are not replayed.
+                reader.skip_block();
+                continue;
+            }
+            if (Images::get_pixel_format(image_ID) != format || Images::get_gamma(image_ID) != gamma)
+                Images::change_format(image_ID, format, gamma);
+            read_block_into(reader, Images::get_pixels(image_ID), get_pixel_bytes(image_ID));
+            Images::flag_pixels_updated(image_ID);
+        }
+    }
+
+    unsigned int texture_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < texture_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        reader.read<Textures::Changes>();
+        Images::UID image_ID = lookup(m_image_IDs, reader.read<unsigned int>());
+        MagnificationFilter magnification_filter = reader.read<MagnificationFilter>();
+        MinificationFilter minification_filter = reader.read<MinificationFilter>();
+        WrapMode wrapmode_U = reader.read<WrapMode>();
+        WrapMode wrapmode_V = reader.read<WrapMode>();
+        if (!reader.failed() && lookup(m_texture_IDs, index) == Textures::UID::invalid_UID())
+            map(m_texture_IDs, index, Textures::create2D(image_ID, magnification_filter, minification_filter, wrapmode_U, wrapmode_V));
+    }
+
+    unsigned int material_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < material_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        Materials::Changes changes = reader.read<Materials::Changes>();
+        MaterialState material = read_material(reader, m_texture_IDs);
+        if (reader.failed())
+            break;
+
+        const Materials::Data& data = material.data;
+        Materials::UID material_ID = lookup(m_material_IDs, index);
+        if (changes.is_set(Materials::Change::Created))
+            map(m_material_IDs, index, Materials::create(material.name, data));
+        else if (Materials::has(material_ID)) {
+            Materials::set_flags(material_ID, data.flags);
+            Materials::set_tint(material_ID, data.tint);
+            Materials::set_tint_roughness_texture_ID(material_ID, data.tint_roughness_texture_ID);
+            Materials::set_roughness(material_ID, data.roughness);
+            Materials::set_specularity(material_ID, data.specularity);
+            Materials::set_metallic(material_ID, data.metallic);
+            Materials::set_metallic_texture_ID(material_ID, data.metallic_texture_ID);
+            Materials::set_coat(material_ID, data.coat);
+            Materials::set_coat_roughness(material_ID, data.coat_roughness);
+            Materials::set_coverage(material_ID, data.coverage);
+            Materials::set_coverage_texture_ID(material_ID, data.coverage_texture_ID);
+            Materials::set_transmission(material_ID, data.transmission);
+        }
+    }
+
+    unsigned int mesh_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < mesh_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        Meshes::Changes changes = reader.read<Meshes::Changes>();
+        MeshHeader mesh_header = read_mesh_header(reader);
+        if (reader.failed())
+            break;
+
+        Meshes::UID mesh_ID = lookup(m_mesh_IDs, index);
+        bool is_created = changes.is_set(Meshes::Change::Created);
+        if (is_created) {
+            mesh_ID = create_mesh(mesh_header);
+            map(m_mesh_IDs, index, mesh_ID);
+        } else if (!Meshes::has(mesh_ID) || Meshes::get_primitive_count(mesh_ID) != mesh_header.primitive_count ||
+                   Meshes::get_vertex_count(mesh_ID) != mesh_header.vertex_count || Meshes::get_flags(mesh_ID) != mesh_header.buffers) {
+            // Meshes created before the recording are not replayed.
+            skip_mesh_blocks(reader, mesh_header.buffers);
+            continue;
+        } else {
+            Meshes::set_bounds(mesh_ID, mesh_header.bounds);
+            Meshes::set_position_quantization(mesh_ID, mesh_header.position_quantization);
+        }
+
+        for_each_mesh_block(mesh_ID, [&](void* destination, size_t byte_count) { read_block_into(reader, destination, byte_count); });
+        if (!is_created)
+            Meshes::flag_geometry_updated(mesh_ID);
+    }
+
+    // Scene roots create their root nodes, which are afterwards named and transformed by the scene node changes.
+    unsigned int scene_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < scene_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        SceneRoots::Changes changes = reader.read<SceneRoots::Changes>();
+        unsigned int root_node_index = reader.read<unsigned int>();
+        RGB environment_tint = reader.read<RGB>();
+        Textures::UID environment_map_ID = lookup(m_texture_IDs, reader.read<unsigned int>());
+        if (reader.failed())
+            break;
+
+        SceneRoots::UID scene_ID = lookup(m_scene_IDs, index);
+        if (changes.is_set(SceneRoots::Change::Created)) {
+            scene_ID = SceneRoots::create("", environment_map_ID, environment_tint);
+            map(m_scene_IDs, index, scene_ID);
+            map(m_node_IDs, root_node_index, SceneRoots::get_root_node(scene_ID));
+        } else if (SceneRoots::has(scene_ID)) {
+            if (changes.is_set(SceneRoots::Change::EnvironmentTint))
+                SceneRoots::set_environment_tint(scene_ID, environment_tint);
+            if (changes.is_set(SceneRoots::Change::EnvironmentMap))
+                SceneRoots::set_environment_map(scene_ID, environment_map_ID);
+        }
+    }
+
+    // Create all nodes before connecting them, as parents can be created after their children in the same tick.
+    struct NodeState {
+        SceneNodes::UID node_ID;
+        unsigned int parent_index;
+        Transform local_transform;
+    };
+    std::vector<NodeState> node_states;
+    unsigned int node_count = reader.read<unsigned int>();
+    node_states.reserve(node_count);
+    for (unsigned int i = 0; i < node_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        SceneNodes::Changes changes = reader.read<SceneNodes::Changes>();
+        std::string name = changes.is_set(SceneNodes::Change::Created) ? reader.read_string() : std::string();
+        unsigned int parent_index = reader.read<unsigned int>();
+        Transform local_transform = reader.read<Transform>();
+        if (reader.failed())
+            break;
+
+        SceneNodes::UID node_ID = lookup(m_node_IDs, index);
+        if (changes.is_set(SceneNodes::Change::Created)) {
+            if (SceneNodes::has(node_ID))
+                SceneNodes::set_name(node_ID, name); // Root node created by its scene root.
+            else {
+                node_ID = SceneNodes::create(name);
+                map(m_node_IDs, index, node_ID);
+            }
+        }
+        if (SceneNodes::has(node_ID))
+            node_states.push_back({ node_ID, parent_index, local_transform });
+    }
+    for (const NodeState& node_state : node_states) {
+        SceneNodes::UID parent_ID = lookup(m_node_IDs, node_state.parent_index);
+        if (SceneNodes::get_parent_ID(node_state.node_ID) != parent_ID)
+            SceneNodes::set_parent(node_state.node_ID, parent_ID);
+    }
+    for (const NodeState& node_state : node_states)
+        SceneNodes::set_local_transform(node_state.node_ID, node_state.local_transform);
+
+    unsigned int model_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < model_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        MeshModels::Changes changes = reader.read<MeshModels::Changes>();
+        SceneNodes::UID node_ID = lookup(m_node_IDs, reader.read<unsigned int>());
+        Meshes::UID mesh_ID = lookup(m_mesh_IDs, reader.read<unsigned int>());
+        Materials::UID material_ID = lookup(m_material_IDs, reader.read<unsigned int>());
+        if (reader.failed())
+            break;
+
+        MeshModels::UID model_ID = lookup(m_model_IDs, index);
+        if (changes.is_set(MeshModels::Change::Created))
+            map(m_model_IDs, index, MeshModels::create(node_ID, mesh_ID, material_ID));
+        else if (MeshModels::has(model_ID) && changes.is_set(MeshModels::Change::Material))
+            MeshModels::set_material_ID(model_ID, material_ID);
+    }
+
+    unsigned int light_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < light_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        LightSources::Changes changes = reader.read<LightSources::Changes>();
+        LightState light = read_light(reader, m_node_IDs);
+        if (reader.failed())
+            break;
+
+        LightSources::UID light_ID = lookup(m_light_IDs, index);
+        if (changes.is_set(LightSources::Change::Created))
+            map(m_light_IDs, index, create_light(light));
+        else if (LightSources::has(light_ID) && LightSources::get_type(light_ID) == light.type) {
+            if (light.type == LightSources::Type::Sphere) {
+                LightSources::set_sphere_light_power(light_ID, light.power);
+                LightSources::set_sphere_light_radius(light_ID, light.radius);
+            } else if (light.type == LightSources::Type::Spot) {
+                LightSources::set_spot_light_power(light_ID, light.power);
+                LightSources::set_spot_light_radius(light_ID, light.radius);
+                LightSources::set_spot_light_cos_angle(light_ID, light.cos_angle);
+            } else
+                LightSources::set_directional_light_radiance(light_ID, light.power);
+        }
+    }
+
+    unsigned int camera_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < camera_count && !reader.failed(); ++i) {
+        unsigned int index = reader.read<unsigned int>();
+        reader.read<Cameras::Changes>();
+        std::string name = reader.read_string();
+        SceneRoots::UID scene_ID = lookup(m_scene_IDs, reader.read<unsigned int>());
+        if (!reader.failed())
+            map(m_camera_IDs, index, Cameras::create(name, scene_ID, Matrix4x4f::identity(), Matrix4x4f::identity()));
+    }
+
+    unsigned int camera_state_count = reader.read<unsigned int>();
+    for (unsigned int i = 0; i < camera_state_count && !reader.failed(); ++i) {
+        Cameras::UID camera_ID = lookup(m_camera_IDs, reader.read<unsigned int>());
+        Transform transform = reader.read<Transform>();
+        Matrix4x4f projection_matrix = reader.read<Matrix4x4f>();
+        Matrix4x4f inverse_projection_matrix = reader.read<Matrix4x4f>();
+        int z_index = reader.read<int>();
+        Rectf viewport = reader.read<Rectf>();
+        CameraEffects::Settings effects_settings = reader.read<CameraEffects::Settings>();
+        if (reader.failed() || !Cameras::has(camera_ID))
+            continue;
+        Cameras::set_transform(camera_ID, transform);
+        Cameras::set_projection_matrices(camera_ID, projection_matrix, inverse_projection_matrix);
+        Cameras::set_z_index(camera_ID, z_index);
+        Cameras::set_viewport(camera_ID, viewport);
+        Cameras::set_effects_settings(camera_ID, effects_settings);
+    }
+
+    if (reader.failed()) {
+        printf("ChangeReplayer error: Tick %u of the change log is corrupt.\n", m_tick_count);
+        return false;
+    }
+
+    ++m_tick_count;
+    read_tick_header();
+    return true;
+}
+
+} // NS Bifrost::Scene
@@ -0,0 +1,129 @@
+// Bifrost recording and replay of the datamodel changes made each tick.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_CHANGE_LOG_H_
+#define _BIFROST_SCENE_CHANGE_LOG_H_
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Core/BinaryStream.h>
+#include <Bifrost/Core/MemoryMappedFile.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Scene/SceneRoot.h>
+
+#include <string>
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Records the changes made to the managers each tick, together with the changed data, to a log
+// that can be replayed through the managers without the application that made the changes,
+// fx to benchmark the renderers' change handling against a captured session.
+// The recorder consumes the changes of all managers that are allocated when it is created.
+// Created resources are stored in full, updated resources store the state covered by their change
+// flags and destroyed resources only store their index. Cameras don't flag transform changes,
+// so the camera state is stored every tick.
+// The log is stored in the native memory layout, like snapshots, and replaying a log recorded on
+// top of an existing scene requires that scene to be loaded first, fx from a Snapshot saved when
+// the recording started.
+// The recorder must be destroyed before the managers are deallocated.
+// Future work
+// * Record the parent changes of scene nodes that don't also change their transform.
+// * Record the renderers assigned to cameras.
+// ------------------------------------------------------------------------------------------------
+class ChangeRecorder final {
+public:
+    static const unsigned int VERSION = 2u;
+
+    explicit ChangeRecorder(const std::string& path);
+    ~ChangeRecorder();
+
+    ChangeRecorder(const ChangeRecorder& other) = delete;
+    ChangeRecorder& operator=(const ChangeRecorder& rhs) = delete;
+
+    inline bool succeeded() const { return m_writer.succeeded(); }
+    inline unsigned int get_tick_count() const { return m_tick_count; }
+
+    // Records the changes made since the last recorded tick. Call once pr tick after the mutating callbacks.
+    void record_tick(double delta_time);
+
+private:
+    Core::BinaryWriter m_writer;
+    unsigned int m_tick_count;
+
+    Assets::Images::ChangeConsumerID m_image_consumer_ID;
+    Assets::Textures::ChangeConsumerID m_texture_consumer_ID;
+    Assets::Materials::ChangeConsumerID m_material_consumer_ID;
+    Assets::Meshes::ChangeConsumerID m_mesh_consumer_ID;
+    Assets::MeshModels::ChangeConsumerID m_model_consumer_ID;
+    SceneNodes::ChangeConsumerID m_node_consumer_ID;
+    SceneRoots::ChangeConsumerID m_scene_consumer_ID;
+    LightSources::ChangeConsumerID m_light_consumer_ID;
+    Cameras::ChangeConsumerID m_camera_consumer_ID;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Replays a log recorded by a ChangeRecorder one tick at a time. Replaying a tick creates, updates
+// and destroys resources in the allocated managers, so the renderers see the same change
+// notifications as during the recording. References between recorded resources are remapped to
+// the replayed resources and resources that existed before the recording started are unknown to
+// the replayer, so references to them are replayed as invalid IDs.
+// Future work
+// * Map the resources that existed before the recording to the resources loaded from a snapshot.
+// ------------------------------------------------------------------------------------------------
+class ChangeReplayer final {
+public:
+    explicit ChangeReplayer(const std::string& path);
+
+    ChangeReplayer(const ChangeReplayer& other) = delete;
+    ChangeReplayer& operator=(const ChangeReplayer& rhs) = delete;
+
+    // Returns false if the log couldn't be mapped, isn't a change log or is corrupt.
+    inline bool is_valid() const { return m_file.is_open() && !m_reader.failed(); }
+    inline bool is_at_end() const { return !is_valid() || m_reader.is_at_end(); }
+    inline unsigned int get_tick_count() const { return m_tick_count; }
+
+    // The delta time of the tick that will be replayed next, fx to pass on to Engine::do_tick.
+    inline double get_next_delta_time() const { return m_next_delta_time; }
+
+    // Applies the changes of the next tick in the log, fx from a mutating engine callback.
+    // Returns false when the log has been fully replayed or is corrupt.
+    bool replay_tick();
+
+    // Restarts the replay from the first tick. Already replayed resources are kept.
+    void restart();
+
+private:
+    void read_tick_header();
+
+    Core::MemoryMappedFile m_file;
+    Core::BinaryReader m_reader;
+    unsigned int m_tick_count;
+    double m_next_delta_time;
+
+    // The replayed resources indexed by the index of the recorded resources.
+    std::vector<Assets::Images::UID> m_image_IDs;
+    std::vector<Assets::Textures::UID> m_texture_IDs;
+    std::vector<Assets::Materials::UID> m_material_IDs;
+    std::vector<Assets::Meshes::UID> m_mesh_IDs;
+    std::vector<Assets::MeshModels::UID> m_model_IDs;
+    std::vector<SceneNodes::UID> m_node_IDs;
+    std::vector<SceneRoots::UID> m_scene_IDs;
+    std::vector<LightSources::UID> m_light_IDs;
+    std::vector<Cameras::UID> m_camera_IDs;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_CHANGE_LOG_H_
@@ -15,7 +15,7 @@ namespace Scene {
 
 LightSources::UIDGenerator LightSources::m_UID_generator = UIDGenerator(0u);
 
-LightSources::Light* LightSources::m_lights = nullptr;
+Core::ReservedArray<LightSources::Light> LightSources::m_lights;
 
 Core::ChangeSet<LightSources::Changes, LightSources::UID> LightSources::m_changes;
 
@@ -26,7 +26,7 @@ void LightSources::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_lights = new Light[capacity];
+    m_lights = Core::ReservedArray<Light>(m_UID_generator.max_capacity(), capacity);
 
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
@@ -43,24 +43,14 @@ void LightSources::deallocate() {
 
     m_UID_generator = UIDGenerator(0u);
 
-    delete[] m_lights; m_lights = nullptr;
+    m_lights.release();
     m_changes.resize(0);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void LightSources::reserve_light_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_lights != nullptr);
+    assert(m_lights.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
-
-    m_lights = resize_and_copy_array(m_lights, new_capacity, copyable_elements);
+    m_lights.resize(new_capacity);
     m_changes.resize(new_capacity);
 }
 
@@ -70,8 +60,22 @@ void LightSources::reserve(unsigned int new_capacity) {
     reserve_light_data(m_UID_generator.capacity(), old_capacity);
 }
 
+Core::MemoryUsage LightSources::get_memory_usage(LightSources::UID light_ID) {
+    Core::MemoryUsage usage;
+    if (m_UID_generator.has(light_ID))
+        usage[Core::MemoryCategory::Metadata] = sizeof(Light);
+    return usage;
+}
+
+Core::MemoryUsage LightSources::get_memory_usage() {
+    Core::MemoryUsage usage;
+    usage[Core::MemoryCategory::Metadata] = m_UID_generator.get_allocated_bytes() + Core::get_allocated_bytes(m_lights);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 inline LightSources::UID LightSources::create_light(SceneNodes::UID node_ID, LightSources::Light light) {
-    assert(m_lights != nullptr);
+    assert(m_lights.data() != nullptr);
 
     if (!SceneNodes::has(node_ID))
         return LightSources::UID::invalid_UID();
@@ -12,9 +12,11 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/Color.h>
-#include <Bifrost/Math/Half.h>
+#include <Bifrost/Math/half.h>
 #include <Bifrost/Scene/SceneNode.h>
 
 namespace Bifrost {
@@ -37,7 +39,7 @@ public:
         Directional
     };
 
-    static bool is_allocated() { return m_lights != nullptr; }
+    static bool is_allocated() { return m_lights.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -79,6 +81,12 @@ public:
     static inline Math::RGB get_directional_light_radiance(LightSources::UID light_ID) { return m_lights[light_ID].color; }
     static void set_directional_light_radiance(LightSources::UID light_ID, Math::RGB radiance);
 
+    //-------------------------------------------------------------------------
+    // Memory usage.
+    //-------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(LightSources::UID light_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //-------------------------------------------------------------------------
     // Changes since last game loop tick.
     //-------------------------------------------------------------------------
@@ -96,6 +104,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_lights() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 
 private:
@@ -120,7 +135,7 @@ private:
         };
     };
 
-    static Light* m_lights;
+    static Core::ReservedArray<Light> m_lights;
 
     static void flag_as_updated(LightSources::UID light_ID);
 
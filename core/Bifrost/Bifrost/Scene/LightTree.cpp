@@ -0,0 +1,447 @@
+// Bifrost light tree for importance sampling many lights.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/LightTree.h>
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Math/BVH4.h>
+#include <Bifrost/Math/Constants.h>
+#include <Bifrost/Math/Quaternion.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <cfloat>
+#include <cmath>
+
+using namespace Bifrost::Math;
+
+namespace Bifrost::Scene {
+
+// The squared distance is clamped to avoid infinite importances for lights at the shading point.
+static const float MIN_DISTANCE_SQUARED = 1e-6f;
+static const unsigned int NO_SLOT = 0xFFFFFFFFu;
+
+// ------------------------------------------------------------------------------------------------
+// Importance estimation.
+// The estimate is the power of the lights divided by the squared distance to their bounds, scaled
+// by the cosine of the smallest angle between the emission cone and the direction to the shading
+// point and by the cosine of the smallest angle between the normal and the directions to the
+// bounds, where the angles are expanded by the angle subtended by the bounding sphere.
+// ------------------------------------------------------------------------------------------------
+
+// cos(max(0, a - b)) and sin(max(0, a - b)) for angles in [0, pi] given by their sines and cosines.
+static __always_inline__ float cos_subtract_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    return cos_a > cos_b ? 1.0f : cos_a * cos_b + sin_a * sin_b;
+}
+static __always_inline__ float sin_subtract_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+    return cos_a > cos_b ? 0.0f : sin_a * cos_b - cos_a * sin_b;
+}
+
+static inline float estimate_importance(const LightTreeNode& node, int slot, Vector3f position, Vector3f normal) {
+    if (node.power[slot] <= 0.0f)
+        return 0.0f;
+
+    Vector3f offset = position - Vector3f(node.center_x[slot], node.center_y[slot], node.center_z[slot]);
+    float distance_squared = magnitude_squared(offset);
+    float radius_squared = node.radius[slot] * node.radius[slot];
+    Vector3f direction = distance_squared > 0.0f ? offset / std::sqrt(distance_squared) : Vector3f::zero();
+
+    // The angle subtended by the bounding sphere. Positions inside the sphere see it in all directions.
+    bool is_inside = distance_squared < radius_squared;
+    float sin_squared_theta_b = radius_squared / std::max(distance_squared, FLT_MIN);
+    float cos_theta_b = is_inside ? -1.0f : std::sqrt(std::max(1.0f - sin_squared_theta_b, 0.0f));
+    float sin_theta_b = is_inside ? 0.0f : std::sqrt(std::min(sin_squared_theta_b, 1.0f));
+
+    // The smallest angle between the emission cone and the direction to the position.
+    float cos_theta_w = node.axis_x[slot] * direction.x + node.axis_y[slot] * direction.y + node.axis_z[slot] * direction.z;
+    float sin_theta_w = std::sqrt(std::max(1.0f - cos_theta_w * cos_theta_w, 0.0f));
+    float cos_theta_o = node.cos_theta_o[slot];
+    float sin_theta_o = std::sqrt(std::max(1.0f - cos_theta_o * cos_theta_o, 0.0f));
+    float cos_theta_x = cos_subtract_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+    float sin_theta_x = sin_subtract_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+    float cos_theta_p = cos_subtract_clamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+    if (cos_theta_p < node.cos_theta_e[slot])
+        return 0.0f;
+
+    float importance = node.power[slot] * cos_theta_p / std::max(std::max(distance_squared, radius_squared), MIN_DISTANCE_SQUARED);
+
+    // The smallest angle between the normal and the bounds.
+    if (normal != Vector3f::zero()) {
+        float cos_theta_i = std::abs(dot(direction, normal));
+        float sin_theta_i = std::sqrt(std::max(1.0f - cos_theta_i * cos_theta_i, 0.0f));
+        importance *= cos_subtract_clamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+    }
+
+    return std::max(importance, 0.0f);
+}
+
+#ifdef BIFROST_SSE2
+static __always_inline__ __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+static __always_inline__ __m128 sqrt_one_minus_squared(__m128 v) {
+    return _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(v, v)), _mm_setzero_ps()));
+}
+static __always_inline__ __m128 cos_subtract_clamped(__m128 sin_a, __m128 cos_a, __m128 sin_b, __m128 cos_b) {
+    __m128 cos_difference = _mm_add_ps(_mm_mul_ps(cos_a, cos_b), _mm_mul_ps(sin_a, sin_b));
+    return select(_mm_cmpgt_ps(cos_a, cos_b), _mm_set1_ps(1.0f), cos_difference);
+}
+static __always_inline__ __m128 sin_subtract_clamped(__m128 sin_a, __m128 cos_a, __m128 sin_b, __m128 cos_b) {
+    __m128 sin_difference = _mm_sub_ps(_mm_mul_ps(sin_a, cos_b), _mm_mul_ps(cos_a, sin_b));
+    return _mm_andnot_ps(_mm_cmpgt_ps(cos_a, cos_b), sin_difference);
+}
+#endif
+
+// Estimates the importance of the four children of the node. Returns the sum of the importances.
+static __always_inline__ float estimate_child_importances(const LightTreeNode& node, Vector3f position, Vector3f normal, float* importances) {
+#ifdef BIFROST_SSE2
+    __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    __m128 offset_x = _mm_sub_ps(_mm_set1_ps(position.x), _mm_load_ps(node.center_x));
+    __m128 offset_y = _mm_sub_ps(_mm_set1_ps(position.y), _mm_load_ps(node.center_y));
+    __m128 offset_z = _mm_sub_ps(_mm_set1_ps(position.z), _mm_load_ps(node.center_z));
+    __m128 distance_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offset_x, offset_x), _mm_mul_ps(offset_y, offset_y)), _mm_mul_ps(offset_z, offset_z));
+    __m128 radius = _mm_load_ps(node.radius);
+    __m128 radius_squared = _mm_mul_ps(radius, radius);
+    __m128 inverse_distance = _mm_and_ps(_mm_cmpgt_ps(distance_squared, zero), _mm_div_ps(one, _mm_sqrt_ps(distance_squared)));
+    __m128 direction_x = _mm_mul_ps(offset_x, inverse_distance);
+    __m128 direction_y = _mm_mul_ps(offset_y, inverse_distance);
+    __m128 direction_z = _mm_mul_ps(offset_z, inverse_distance);
+
+    __m128 is_inside = _mm_cmplt_ps(distance_squared, radius_squared);
+    __m128 sin_squared_theta_b = _mm_div_ps(radius_squared, _mm_max_ps(distance_squared, _mm_set1_ps(FLT_MIN)));
+    __m128 cos_theta_b = select(is_inside, _mm_set1_ps(-1.0f), _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, sin_squared_theta_b), zero)));
+    __m128 sin_theta_b = _mm_andnot_ps(is_inside, _mm_sqrt_ps(_mm_min_ps(sin_squared_theta_b, one)));
+
+    __m128 cos_theta_w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(node.axis_x), direction_x), _mm_mul_ps(_mm_load_ps(node.axis_y), direction_y)),
+                                    _mm_mul_ps(_mm_load_ps(node.axis_z), direction_z));
+    __m128 sin_theta_w = sqrt_one_minus_squared(cos_theta_w);
+    __m128 cos_theta_o = _mm_load_ps(node.cos_theta_o);
+    __m128 sin_theta_o = sqrt_one_minus_squared(cos_theta_o);
+    __m128 cos_theta_x = cos_subtract_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+    __m128 sin_theta_x = sin_subtract_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+    __m128 cos_theta_p = cos_subtract_clamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+
+    __m128 power = _mm_load_ps(node.power);
+    __m128 clamped_distance_squared = _mm_max_ps(_mm_max_ps(distance_squared, radius_squared), _mm_set1_ps(MIN_DISTANCE_SQUARED));
+    __m128 importance = _mm_div_ps(_mm_mul_ps(power, cos_theta_p), clamped_distance_squared);
+
+    if (normal != Vector3f::zero()) {
+        __m128 cos_theta_i = _mm_add_ps(_mm_add_ps(_mm_mul_ps(direction_x, _mm_set1_ps(normal.x)), _mm_mul_ps(direction_y, _mm_set1_ps(normal.y))),
+                                        _mm_mul_ps(direction_z, _mm_set1_ps(normal.z)));
+        cos_theta_i = _mm_andnot_ps(_mm_set1_ps(-0.0f), cos_theta_i);
+        __m128 sin_theta_i = sqrt_one_minus_squared(cos_theta_i);
+        importance = _mm_mul_ps(importance, cos_subtract_clamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b));
+    }
+
+    // Clear the importance of empty slots and of slots whose emission doesn't reach the position.
+    __m128 is_valid = _mm_and_ps(_mm_cmpgt_ps(power, zero), _mm_cmpge_ps(cos_theta_p, _mm_load_ps(node.cos_theta_e)));
+    importance = _mm_max_ps(_mm_and_ps(is_valid, importance), zero);
+    _mm_storeu_ps(importances, importance);
+
+    __m128 sum = _mm_add_ps(importance, _mm_shuffle_ps(importance, importance, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_add_ss(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(sum);
+#else
+    float total_importance = 0.0f;
+    for (int s = 0; s < 4; ++s) {
+        importances[s] = estimate_importance(node, s, position, normal);
+        total_importance += importances[s];
+    }
+    return total_importance;
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+// Light bounds.
+// ------------------------------------------------------------------------------------------------
+
+LightTree::LightBounds LightTree::compute_light_bounds(LightSources::UID light_ID) {
+    Transform transform = SceneNodes::get_global_transform(LightSources::get_node_ID(light_ID));
+    Vector3f position = transform.translation;
+
+    LightBounds light_bounds;
+    if (LightSources::get_type(light_ID) == LightSources::Type::Spot) {
+        float radius = LightSources::get_spot_light_radius(light_ID);
+        light_bounds.bounds = AABB(position - radius, position + radius);
+        light_bounds.power = luminance(LightSources::get_spot_light_power(light_ID));
+        light_bounds.axis = transform.rotation.forward();
+        light_bounds.cos_theta_o = LightSources::get_spot_light_cos_angle(light_ID);
+        light_bounds.cos_theta_e = 1.0f; // No emission outside the cone.
+    } else {
+        assert(LightSources::get_type(light_ID) == LightSources::Type::Sphere);
+        float radius = LightSources::get_sphere_light_radius(light_ID);
+        light_bounds.bounds = AABB(position - radius, position + radius);
+        light_bounds.power = luminance(LightSources::get_sphere_light_power(light_ID));
+        light_bounds.axis = Vector3f::forward();
+        light_bounds.cos_theta_o = -1.0f; // Emits in all directions.
+        light_bounds.cos_theta_e = 0.0f;
+    }
+    return light_bounds;
+}
+
+LightTree::LightBounds LightTree::merge(const LightBounds& lhs, const LightBounds& rhs) {
+    if (lhs.power <= 0.0f)
+        return rhs;
+    if (rhs.power <= 0.0f)
+        return lhs;
+
+    LightBounds merged_bounds;
+    merged_bounds.bounds = lhs.bounds;
+    merged_bounds.bounds.grow_to_contain(rhs.bounds);
+    merged_bounds.power = lhs.power + rhs.power;
+    merged_bounds.cos_theta_e = std::min(lhs.cos_theta_e, rhs.cos_theta_e);
+
+    // The smallest cone containing both emission cones.
+    float theta_lhs = std::acos(clamp(lhs.cos_theta_o, -1.0f, 1.0f));
+    float theta_rhs = std::acos(clamp(rhs.cos_theta_o, -1.0f, 1.0f));
+    float theta_between = std::acos(clamp(dot(lhs.axis, rhs.axis), -1.0f, 1.0f));
+    if (std::min(theta_between + theta_rhs, PI<float>()) <= theta_lhs) {
+        merged_bounds.axis = lhs.axis;
+        merged_bounds.cos_theta_o = lhs.cos_theta_o;
+    } else if (std::min(theta_between + theta_lhs, PI<float>()) <= theta_rhs) {
+        merged_bounds.axis = rhs.axis;
+        merged_bounds.cos_theta_o = rhs.cos_theta_o;
+    } else {
+        float theta_o = 0.5f * (theta_lhs + theta_between + theta_rhs);
+        Vector3f rotation_axis = cross(lhs.axis, rhs.axis);
+        if (theta_o >= PI<float>() || magnitude_squared(rotation_axis) == 0.0f) {
+            merged_bounds.axis = lhs.axis;
+            merged_bounds.cos_theta_o = -1.0f;
+        } else {
+            Quaternionf rotation = Quaternionf::from_angle_axis(theta_o - theta_lhs, normalize(rotation_axis));
+            merged_bounds.axis = normalize(rotation * lhs.axis);
+            merged_bounds.cos_theta_o = std::cos(theta_o);
+        }
+    }
+
+    return merged_bounds;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Light tree.
+// ------------------------------------------------------------------------------------------------
+
+LightTree::LightTree() {
+    m_scene_node_consumer_ID = SceneNodes::add_change_consumer();
+    m_light_consumer_ID = LightSources::add_change_consumer();
+    build();
+}
+
+LightTree::~LightTree() {
+    if (SceneNodes::is_allocated())
+        SceneNodes::remove_change_consumer(m_scene_node_consumer_ID);
+    if (LightSources::is_allocated())
+        LightSources::remove_change_consumer(m_light_consumer_ID);
+}
+
+size_t LightTree::get_allocated_bytes() const {
+    return Core::get_allocated_bytes(m_nodes) + Core::get_allocated_bytes(m_light_IDs) + Core::get_allocated_bytes(m_light_bounds) +
+        Core::get_allocated_bytes(m_light_slots) + Core::get_allocated_bytes(m_directional_light_IDs);
+}
+
+void LightTree::update() {
+    bool rebuild = false;
+    std::vector<unsigned int> changed_lights;
+    for (auto light_changes : LightSources::consume_changes(m_light_consumer_ID)) {
+        if (light_changes.changes.any_set(LightSources::Change::Created, LightSources::Change::Destroyed))
+            rebuild = true;
+        else if (light_changes.changes.is_set(LightSources::Change::Updated)) {
+            unsigned int light_index = light_changes.ID.get_index();
+            if (light_index < m_light_slots.size() && m_light_slots[light_index] != NO_SLOT) {
+                unsigned int node_slot = m_light_slots[light_index];
+                changed_lights.push_back(m_nodes[node_slot / 4].first_lights[node_slot % 4]);
+            }
+        }
+    }
+
+    auto scene_node_changes = SceneNodes::consume_changes(m_scene_node_consumer_ID);
+    if (rebuild) {
+        build();
+        return;
+    }
+
+    std::vector<bool> moved_scene_nodes;
+    for (auto node_changes : scene_node_changes) {
+        if (!node_changes.changes.is_set(SceneNodes::Change::Transform))
+            continue;
+        if (moved_scene_nodes.empty())
+            moved_scene_nodes.resize(SceneNodes::capacity(), false);
+        moved_scene_nodes[node_changes.ID.get_index()] = true;
+    }
+    if (!moved_scene_nodes.empty())
+        for (unsigned int l = 0; l < m_light_IDs.size(); ++l)
+            if (moved_scene_nodes[LightSources::get_node_ID(m_light_IDs[l]).get_index()])
+                changed_lights.push_back(l);
+
+    if (changed_lights.empty())
+        return;
+
+    Core::Parallel::for_each_chunk(0, (int)changed_lights.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            m_light_bounds[changed_lights[i]] = compute_light_bounds(m_light_IDs[changed_lights[i]]);
+    }, 256);
+    refit();
+}
+
+void LightTree::build() {
+    m_light_IDs.clear();
+    m_directional_light_IDs.clear();
+    std::vector<LightSources::UID> light_IDs;
+    for (LightSources::UID light_ID : LightSources::get_iterable())
+        if (LightSources::get_type(light_ID) == LightSources::Type::Directional)
+            m_directional_light_IDs.push_back(light_ID);
+        else
+            light_IDs.push_back(light_ID);
+    int light_count = (int)light_IDs.size();
+
+    std::vector<LightBounds> light_bounds(light_count);
+    std::vector<AABB> light_AABBs(light_count);
+    Core::Parallel::for_each_chunk(0, light_count, [&](int begin, int end) {
+        for (int l = begin; l < end; ++l) {
+            light_bounds[l] = compute_light_bounds(light_IDs[l]);
+            light_AABBs[l] = light_bounds[l].bounds;
+        }
+    }, 256);
+
+    // Build the topology with a single light pr leaf.
+    std::vector<BVH4Node> BVH_nodes;
+    std::vector<unsigned int> light_order;
+    build_BVH4(light_AABBs.data(), light_count, 1, BVH_nodes, light_order);
+
+    m_light_IDs.resize(light_count);
+    m_light_bounds.resize(light_count);
+    for (int l = 0; l < light_count; ++l) {
+        m_light_IDs[l] = light_IDs[light_order[l]];
+        m_light_bounds[l] = light_bounds[light_order[l]];
+    }
+
+    m_nodes.resize(BVH_nodes.size());
+    m_light_slots.assign(LightSources::capacity(), NO_SLOT);
+    for (unsigned int n = 0; n < m_nodes.size(); ++n) {
+        const BVH4Node& BVH_node = BVH_nodes[n];
+        LightTreeNode& node = m_nodes[n];
+        node.parent = BVH_node.parent;
+        if (n == 0)
+            node.parent_slot = -1;
+        for (int s = 0; s < 4; ++s) {
+            node.children[s] = BVH_node.children[s];
+            node.first_lights[s] = BVH_node.first_primitives[s];
+            node.light_counts[s] = BVH_node.primitive_counts[s];
+            if (node.children[s] >= 0)
+                m_nodes[node.children[s]].parent_slot = s;
+            else if (node.light_counts[s] > 0)
+                m_light_slots[m_light_IDs[node.first_lights[s]].get_index()] = n * 4 + s;
+        }
+    }
+
+    refit();
+}
+
+void LightTree::refit() {
+    // Children have larger indices than their parents, so refitting the nodes in reverse order refits the whole tree.
+    LightBounds no_bounds = { AABB::invalid(), 0.0f, Vector3f::forward(), 1.0f, 1.0f };
+    std::vector<LightBounds> node_bounds(m_nodes.size());
+    for (int n = (int)m_nodes.size() - 1; n >= 0; --n) {
+        LightTreeNode& node = m_nodes[n];
+        LightBounds merged_bounds = no_bounds;
+        for (int s = 0; s < 4; ++s) {
+            LightBounds slot_bounds = no_bounds;
+            if (node.is_light(s))
+                slot_bounds = m_light_bounds[node.first_lights[s]];
+            else if (!node.is_empty(s))
+                slot_bounds = node_bounds[node.children[s]];
+
+            bool has_power = slot_bounds.power > 0.0f;
+            Vector3f center = has_power ? slot_bounds.bounds.center() : Vector3f::zero();
+            node.center_x[s] = center.x; node.center_y[s] = center.y; node.center_z[s] = center.z;
+            node.radius[s] = has_power ? 0.5f * magnitude(slot_bounds.bounds.size()) : 0.0f;
+            node.power[s] = std::max(slot_bounds.power, 0.0f);
+            node.axis_x[s] = slot_bounds.axis.x; node.axis_y[s] = slot_bounds.axis.y; node.axis_z[s] = slot_bounds.axis.z;
+            node.cos_theta_o[s] = slot_bounds.cos_theta_o;
+            node.cos_theta_e[s] = slot_bounds.cos_theta_e;
+
+            merged_bounds = merge(merged_bounds, slot_bounds);
+        }
+        node_bounds[n] = merged_bounds;
+    }
+}
+
+LightTree::Sample LightTree::sample(Vector3f position, Vector3f normal, float random) const {
+    // Select either one of the directional lights or the tree.
+    unsigned int directional_light_count = (unsigned int)m_directional_light_IDs.size();
+    unsigned int choice_count = directional_light_count + (m_nodes.empty() ? 0 : 1);
+    if (choice_count == 0)
+        return { LightSources::UID::invalid_UID(), 0.0f };
+    float scaled_random = random * choice_count;
+    unsigned int choice = std::min((unsigned int)scaled_random, choice_count - 1);
+    if (choice < directional_light_count)
+        return { m_directional_light_IDs[choice], 1.0f / choice_count };
+    random = std::min(scaled_random - choice, nearly_one);
+
+    // Descend the tree, choosing children proportionally to their importance and reusing the random number.
+    float probability = 1.0f / choice_count;
+    int node_index = 0;
+    while (true) {
+        const LightTreeNode& node = m_nodes[node_index];
+        float importances[4];
+        float total_importance = estimate_child_importances(node, position, normal, importances);
+        if (!(total_importance > 0.0f))
+            return { LightSources::UID::invalid_UID(), 0.0f };
+
+        float target = random * total_importance;
+        float accumulated_importance = 0.0f;
+        int slot = -1;
+        for (int s = 0; s < 4; ++s) {
+            if (importances[s] <= 0.0f)
+                continue;
+            slot = s;
+            if (target < accumulated_importance + importances[s])
+                break;
+            accumulated_importance += importances[s];
+        }
+
+        random = std::min((target - accumulated_importance) / importances[slot], nearly_one);
+        random = std::max(random, 0.0f);
+        probability *= importances[slot] / total_importance;
+        if (node.children[slot] < 0)
+            return { m_light_IDs[node.first_lights[slot]], probability };
+        node_index = node.children[slot];
+    }
+}
+
+float LightTree::PDF(LightSources::UID light_ID, Vector3f position, Vector3f normal) const {
+    unsigned int directional_light_count = (unsigned int)m_directional_light_IDs.size();
+    float choice_PDF = 1.0f / (directional_light_count + (m_nodes.empty() ? 0 : 1));
+    if (std::find(m_directional_light_IDs.begin(), m_directional_light_IDs.end(), light_ID) != m_directional_light_IDs.end())
+        return choice_PDF;
+
+    unsigned int light_index = light_ID.get_index();
+    if (light_index >= m_light_slots.size() || m_light_slots[light_index] == NO_SLOT)
+        return 0.0f;
+    unsigned int node_slot = m_light_slots[light_index];
+    if (m_light_IDs[m_nodes[node_slot / 4].first_lights[node_slot % 4]] != light_ID)
+        return 0.0f;
+
+    // Multiply the probabilities of choosing the slots on the path from the light to the root.
+    float probability = get_tree_probability();
+    int node_index = node_slot / 4;
+    int slot = node_slot % 4;
+    while (node_index >= 0) {
+        const LightTreeNode& node = m_nodes[node_index];
+        float importances[4];
+        float total_importance = estimate_child_importances(node, position, normal, importances);
+        if (!(importances[slot] > 0.0f))
+            return 0.0f;
+        probability *= importances[slot] / total_importance;
+        slot = node.parent_slot;
+        node_index = node.parent;
+    }
+    return probability;
+}
+
+} // NS Bifrost::Scene
@@ -0,0 +1,125 @@
+// Bifrost light tree for importance sampling many lights.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_LIGHT_TREE_H_
+#define _BIFROST_SCENE_LIGHT_TREE_H_
+
+#include <Bifrost/Core/Defines.h>
+#include <Bifrost/Math/AABB.h>
+#include <Bifrost/Scene/LightSource.h>
+
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Node in a four wide light tree.
+// Every child slot bounds the lights below it by a bounding sphere, their total power and a cone
+// bounding their emission directions, stored as structure of arrays so the importance of all four
+// children can be estimated at once.
+// A slot either references a child node, holds a single light or is empty.
+// ------------------------------------------------------------------------------------------------
+struct alignas(16) LightTreeNode final {
+    float center_x[4], center_y[4], center_z[4], radius[4];
+    float power[4]; // Zero for empty slots and lights without power.
+    // The emission cone. Lights emit along directions within theta_o of the axis and their emission falls off to zero
+    // at theta_e beyond that. The angles are stored as cosines.
+    float axis_x[4], axis_y[4], axis_z[4];
+    float cos_theta_o[4], cos_theta_e[4];
+    int children[4]; // Index of the child node or -1 for lights and empty slots.
+    unsigned int first_lights[4];
+    unsigned int light_counts[4]; // Zero for empty slots.
+    int parent;
+    int parent_slot;
+
+    __always_inline__ bool is_empty(int slot) const { return light_counts[slot] == 0; }
+    __always_inline__ bool is_light(int slot) const { return children[slot] < 0 && light_counts[slot] > 0; }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Light tree over the light sources, used to sample a light proportionally to an estimate of its
+// contribution at a shading point. The estimate accounts for the power, distance and emission
+// directions of the lights and the orientation of the shading point.
+// The topology is built over the light bounds like the BVH4, with a single light pr leaf, and the
+// tree tracks the SceneNodes and LightSources changes through change consumers. Moving lights or
+// changing their power refits the tree, while creating or destroying lights rebuilds it.
+// Directional lights have no position, so they are kept outside the tree and are sampled with
+// the same probability as the tree as a whole.
+// The tree must be destroyed before the SceneNodes and LightSources are deallocated.
+// Future work
+// * Split the nodes by a surface area orientation heuristic instead of the Morton order.
+// * Sample directional lights by power.
+// * Upload the tree to the OptiX renderer and sample it in sample_single_light.
+// ------------------------------------------------------------------------------------------------
+class LightTree final {
+public:
+    struct Sample {
+        LightSources::UID light_ID;
+        float PDF; // The probability of sampling the light.
+    };
+
+    // Builds the tree over the existing lights.
+    LightTree();
+    ~LightTree();
+
+    LightTree(const LightTree& other) = delete;
+    LightTree& operator=(const LightTree& rhs) = delete;
+
+    // Consumes the scene node and light changes made since the last update and refits or rebuilds the tree.
+    void update();
+
+    inline unsigned int get_light_count() const { return (unsigned int)(m_light_IDs.size() + m_directional_light_IDs.size()); }
+    inline unsigned int get_node_count() const { return (unsigned int)m_nodes.size(); }
+    size_t get_allocated_bytes() const;
+
+    // Samples a light with a probability proportional to its estimated contribution at the position.
+    // A zero normal estimates the contribution to a point in a medium instead of a surface.
+    // Returns an invalid light ID and a PDF of zero if no light contributes.
+    Sample sample(Math::Vector3f position, Math::Vector3f normal, float random) const;
+
+    // The probability of sampling the light at the position, fx for multiple importance sampling.
+    float PDF(LightSources::UID light_ID, Math::Vector3f position, Math::Vector3f normal) const;
+
+private:
+    // The bounds of the emission from one or more lights.
+    struct LightBounds {
+        Math::AABB bounds;
+        float power;
+        Math::Vector3f axis;
+        float cos_theta_o, cos_theta_e;
+    };
+
+    static LightBounds compute_light_bounds(LightSources::UID light_ID);
+    static LightBounds merge(const LightBounds& lhs, const LightBounds& rhs);
+
+    void build();
+    void refit(); // Refits all nodes to the light bounds.
+
+    // The probability of sampling the tree instead of one of the directional lights.
+    inline float get_tree_probability() const {
+        if (m_nodes.empty())
+            return 0.0f;
+        return 1.0f / (1 + m_directional_light_IDs.size());
+    }
+
+    std::vector<LightTreeNode> m_nodes;
+
+    // The lights and their bounds in tree order.
+    std::vector<LightSources::UID> m_light_IDs;
+    std::vector<LightBounds> m_light_bounds;
+    // The node and slot holding each light, encoded as node * 4 + slot and indexed by the light's index.
+    std::vector<unsigned int> m_light_slots;
+    std::vector<LightSources::UID> m_directional_light_IDs;
+
+    SceneNodes::ChangeConsumerID m_scene_node_consumer_ID;
+    LightSources::ChangeConsumerID m_light_consumer_ID;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_LIGHT_TREE_H_
@@ -0,0 +1,134 @@
+// Bifrost memory report.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/MemoryReport.h>
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Scene/SceneRoot.h>
+
+#include <cstdio>
+
+using namespace Bifrost::Assets;
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Memory report.
+// ------------------------------------------------------------------------------------------------
+
+template <typename Manager>
+static inline Core::MemoryUsage get_manager_memory_usage() {
+    return Manager::is_allocated() ? Manager::get_memory_usage() : Core::MemoryUsage();
+}
+
+MemoryReport MemoryReport::create() {
+    MemoryReport report;
+    report.cameras = get_manager_memory_usage<Cameras>();
+    report.images = get_manager_memory_usage<Images>();
+    report.light_sources = get_manager_memory_usage<LightSources>();
+    report.materials = get_manager_memory_usage<Materials>();
+    report.meshes = get_manager_memory_usage<Meshes>();
+    report.mesh_models = get_manager_memory_usage<MeshModels>();
+    report.scene_nodes = get_manager_memory_usage<SceneNodes>();
+    report.scene_roots = get_manager_memory_usage<SceneRoots>();
+    report.textures = get_manager_memory_usage<Textures>();
+    return report;
+}
+
+Core::MemoryUsage MemoryReport::get_total_usage() const {
+    return cameras + images + light_sources + materials + meshes + mesh_models + scene_nodes + scene_roots + textures;
+}
+
+std::string MemoryReport::to_string() const {
+    auto append_row = [](std::string& table, const char* name, const Core::MemoryUsage& usage) {
+        char row[256];
+        int length = snprintf(row, sizeof(row), "%-14s", name);
+        for (size_t bytes : usage.bytes)
+            length += snprintf(row + length, sizeof(row) - length, " %13.2f", bytes / (1024.0 * 1024.0));
+        snprintf(row + length, sizeof(row) - length, " %13.2f\n", usage.get_total_bytes() / (1024.0 * 1024.0));
+        table += row;
+    };
+
+    std::string table = "Memory usage in MB";
+    for (unsigned int c = 0; c < Core::MEMORY_CATEGORY_COUNT; ++c) {
+        char header[32];
+        snprintf(header, sizeof(header), " %13s", Core::to_string(Core::MemoryCategory(c)));
+        table += header;
+    }
+    table += "         total\n";
+
+    append_row(table, "Cameras", cameras);
+    append_row(table, "Images", images);
+    append_row(table, "LightSources", light_sources);
+    append_row(table, "Materials", materials);
+    append_row(table, "Meshes", meshes);
+    append_row(table, "MeshModels", mesh_models);
+    append_row(table, "SceneNodes", scene_nodes);
+    append_row(table, "SceneRoots", scene_roots);
+    append_row(table, "Textures", textures);
+    append_row(table, "Total", get_total_usage());
+    return table;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Memory budgets.
+// ------------------------------------------------------------------------------------------------
+
+MemoryBudgets::WarningCallback MemoryBudgets::m_warning_callback = nullptr;
+size_t MemoryBudgets::m_category_budgets[Core::MEMORY_CATEGORY_COUNT] = {
+    UNLIMITED, UNLIMITED, UNLIMITED, UNLIMITED, UNLIMITED, UNLIMITED, UNLIMITED
+};
+size_t MemoryBudgets::m_total_budget = MemoryBudgets::UNLIMITED;
+bool MemoryBudgets::m_is_exceeded[Core::MEMORY_CATEGORY_COUNT + 1] = {};
+
+static_assert(Core::MEMORY_CATEGORY_COUNT == 7, "Initialize the budgets of all memory categories.");
+
+void MemoryBudgets::set_budget(Core::MemoryCategory category, size_t byte_count) {
+    m_category_budgets[(unsigned int)category] = byte_count;
+    m_is_exceeded[(unsigned int)category] = false;
+}
+
+void MemoryBudgets::set_total_budget(size_t byte_count) {
+    m_total_budget = byte_count;
+    m_is_exceeded[Core::MEMORY_CATEGORY_COUNT] = false;
+}
+
+void MemoryBudgets::reset() {
+    m_warning_callback = nullptr;
+    for (size_t& budget : m_category_budgets)
+        budget = UNLIMITED;
+    m_total_budget = UNLIMITED;
+    for (bool& is_exceeded : m_is_exceeded)
+        is_exceeded = false;
+}
+
+bool MemoryBudgets::check(const MemoryReport& report) {
+    auto check_budget = [](const char* budget_name, size_t used_bytes, size_t budget_bytes, bool& is_exceeded) -> bool {
+        bool was_exceeded = is_exceeded;
+        is_exceeded = used_bytes > budget_bytes;
+        if (is_exceeded && !was_exceeded && m_warning_callback)
+            m_warning_callback(budget_name, used_bytes, budget_bytes);
+        return !is_exceeded;
+    };
+
+    Core::MemoryUsage usage = report.get_total_usage();
+    bool is_within_budget = true;
+    for (unsigned int c = 0; c < Core::MEMORY_CATEGORY_COUNT; ++c)
+        is_within_budget &= check_budget(Core::to_string(Core::MemoryCategory(c)), usage.bytes[c], m_category_budgets[c], m_is_exceeded[c]);
+    is_within_budget &= check_budget("total", usage.get_total_bytes(), m_total_budget, m_is_exceeded[Core::MEMORY_CATEGORY_COUNT]);
+    return is_within_budget;
+}
+
+} // NS Bifrost::Scene
@@ -0,0 +1,83 @@
+// Bifrost memory report.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MEMORY_REPORT_H_
+#define _BIFROST_SCENE_MEMORY_REPORT_H_
+
+#include <Bifrost/Core/MemoryUsage.h>
+
+#include <functional>
+#include <string>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Memory used by the asset and scene managers, pr manager and pr category.
+// Use the managers' get_memory_usage(UID) for the memory used by a single resource.
+// ------------------------------------------------------------------------------------------------
+struct MemoryReport final {
+    Core::MemoryUsage cameras;
+    Core::MemoryUsage images;
+    Core::MemoryUsage light_sources;
+    Core::MemoryUsage materials;
+    Core::MemoryUsage meshes;
+    Core::MemoryUsage mesh_models;
+    Core::MemoryUsage scene_nodes;
+    Core::MemoryUsage scene_roots;
+    Core::MemoryUsage textures;
+
+    // Queries the memory usage of all allocated managers.
+    static MemoryReport create();
+
+    Core::MemoryUsage get_total_usage() const;
+
+    // Human readable table with the usage in MB pr manager and category.
+    std::string to_string() const;
+};
+
+// ------------------------------------------------------------------------------------------------
+// Optional memory budgets pr category and in total.
+// Checking the budgets calls the warning callback once when a budget is exceeded and then not
+// again for that budget until the usage has dropped below it, so the budgets can be checked every
+// tick, fx from an engine callback that reads all managers and writes none.
+// Future work
+// * Budgets pr manager.
+// ------------------------------------------------------------------------------------------------
+class MemoryBudgets final {
+public:
+    static constexpr size_t UNLIMITED = ~size_t(0);
+
+    // Called with the name of the exceeded budget, either a category name or "total".
+    typedef std::function<void(const char* budget_name, size_t used_bytes, size_t budget_bytes)> WarningCallback;
+
+    static void set_warning_callback(WarningCallback callback) { m_warning_callback = callback; }
+
+    static void set_budget(Core::MemoryCategory category, size_t byte_count);
+    static size_t get_budget(Core::MemoryCategory category) { return m_category_budgets[(unsigned int)category]; }
+    static void set_total_budget(size_t byte_count);
+    static size_t get_total_budget() { return m_total_budget; }
+
+    // Removes all budgets and the warning callback.
+    static void reset();
+
+    // Checks the budgets and returns true if all are within budget.
+    static bool check(const MemoryReport& report);
+    static bool check() { return check(MemoryReport::create()); }
+
+private:
+    static WarningCallback m_warning_callback;
+    static size_t m_category_budgets[Core::MEMORY_CATEGORY_COUNT];
+    static size_t m_total_budget;
+
+    // Whether the budget was exceeded at the last check. The total budget is stored last.
+    static bool m_is_exceeded[Core::MEMORY_CATEGORY_COUNT + 1];
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_MEMORY_REPORT_H_
@@ -0,0 +1,206 @@
+// Bifrost bounding volume hierarchy over mesh models.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/MeshModelBVH.h>
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Math/Conversions.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+namespace Bifrost::Scene {
+
+// The world space bounds of the model's mesh. Models without valid mesh bounds are treated as a point at the scene node.
+static inline AABB compute_world_bounds(MeshModels::UID model_ID) {
+    Meshes::UID mesh_ID = MeshModels::get_mesh_ID(model_ID);
+    AABB local_bounds = Meshes::has(mesh_ID) ? Meshes::get_bounds(mesh_ID) : AABB::invalid();
+    bool is_valid = local_bounds.minimum.x <= local_bounds.maximum.x && local_bounds.minimum.y <= local_bounds.maximum.y &&
+                    local_bounds.minimum.z <= local_bounds.maximum.z;
+    if (!is_valid)
+        local_bounds = AABB(Vector3f::zero(), Vector3f::zero());
+
+    Transform transform = SceneNodes::get_global_transform(MeshModels::get_scene_node_ID(model_ID));
+    Matrix3x3f rotation = to_matrix3x3(transform.rotation);
+    Vector3f center = rotation * local_bounds.center() * transform.scale + transform.translation;
+    Vector3f half_size = local_bounds.size() * (0.5f * transform.scale);
+    Vector3f extent = Vector3f(std::abs(rotation(0, 0)) * half_size.x + std::abs(rotation(0, 1)) * half_size.y + std::abs(rotation(0, 2)) * half_size.z,
+                               std::abs(rotation(1, 0)) * half_size.x + std::abs(rotation(1, 1)) * half_size.y + std::abs(rotation(1, 2)) * half_size.z,
+                               std::abs(rotation(2, 0)) * half_size.x + std::abs(rotation(2, 1)) * half_size.y + std::abs(rotation(2, 2)) * half_size.z);
+    return AABB(center - extent, center + extent);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Mesh model BVH.
+// ------------------------------------------------------------------------------------------------
+
+MeshModelBVH::MeshModelBVH() {
+    m_scene_node_consumer_ID = SceneNodes::add_change_consumer();
+    m_model_consumer_ID = MeshModels::add_change_consumer();
+    build();
+}
+
+MeshModelBVH::~MeshModelBVH() {
+    if (SceneNodes::is_allocated())
+        SceneNodes::remove_change_consumer(m_scene_node_consumer_ID);
+    if (MeshModels::is_allocated())
+        MeshModels::remove_change_consumer(m_model_consumer_ID);
+}
+
+size_t MeshModelBVH::get_allocated_bytes() const {
+    return Core::get_allocated_bytes(m_nodes) + Core::get_allocated_bytes(m_model_IDs) + Core::get_allocated_bytes(m_model_bounds) +
+        Core::get_allocated_bytes(m_model_node_indices) + Core::get_allocated_bytes(m_scene_node_model_offsets) +
+        Core::get_allocated_bytes(m_scene_node_models);
+}
+
+void MeshModelBVH::update() {
+    bool rebuild = false;
+    for (auto model_changes : MeshModels::consume_changes(m_model_consumer_ID))
+        rebuild |= model_changes.changes.any_set(MeshModels::Change::Created, MeshModels::Change::Destroyed);
+
+    auto scene_node_changes = SceneNodes::consume_changes(m_scene_node_consumer_ID);
+    if (rebuild) {
+        build();
+        return;
+    }
+
+    std::vector<unsigned int> changed_models;
+    unsigned int scene_node_count = (unsigned int)m_scene_node_model_offsets.size() - 1;
+    for (auto node_changes : scene_node_changes) {
+        unsigned int scene_node_index = node_changes.ID.get_index();
+        if (!node_changes.changes.is_set(SceneNodes::Change::Transform) || scene_node_index >= scene_node_count)
+            continue;
+        for (unsigned int m = m_scene_node_model_offsets[scene_node_index]; m < m_scene_node_model_offsets[scene_node_index + 1]; ++m)
+            changed_models.push_back(m_scene_node_models[m]);
+    }
+
+    if (!changed_models.empty())
+        refit(changed_models);
+}
+
+void MeshModelBVH::build() {
+    std::vector<MeshModels::UID> model_IDs;
+    for (MeshModels::UID model_ID : MeshModels::get_iterable())
+        model_IDs.push_back(model_ID);
+    int model_count = (int)model_IDs.size();
+
+    std::vector<AABB> model_bounds(model_count);
+    Core::Parallel::for_each_chunk(0, model_count, [&](int begin, int end) {
+        for (int m = begin; m < end; ++m)
+            model_bounds[m] = compute_world_bounds(model_IDs[m]);
+    }, 1024);
+
+    std::vector<unsigned int> model_order;
+    build_BVH4(model_bounds.data(), model_count, MAX_LEAF_SIZE, m_nodes, model_order);
+
+    m_model_IDs.resize(model_count);
+    m_model_bounds.resize(model_count);
+    for (int m = 0; m < model_count; ++m) {
+        m_model_IDs[m] = model_IDs[model_order[m]];
+        m_model_bounds[m] = model_bounds[model_order[m]];
+    }
+
+    m_model_node_indices.resize(model_count);
+    for (unsigned int n = 0; n < m_nodes.size(); ++n) {
+        const BVH4Node& node = m_nodes[n];
+        for (int s = 0; s < 4; ++s)
+            if (node.is_leaf(s))
+                for (unsigned int m = node.first_primitives[s]; m < node.first_primitives[s] + node.primitive_counts[s]; ++m)
+                    m_model_node_indices[m] = n;
+    }
+
+    // Group the models by scene node index with a counting sort.
+    unsigned int scene_node_count = SceneNodes::capacity();
+    m_scene_node_model_offsets.assign(scene_node_count + 1, 0u);
+    for (MeshModels::UID model_ID : m_model_IDs)
+        ++m_scene_node_model_offsets[MeshModels::get_scene_node_ID(model_ID).get_index() + 1];
+    for (unsigned int n = 0; n < scene_node_count; ++n)
+        m_scene_node_model_offsets[n + 1] += m_scene_node_model_offsets[n];
+    m_scene_node_models.resize(model_count);
+    std::vector<unsigned int> group_sizes(scene_node_count, 0u);
+    for (int m = 0; m < model_count; ++m) {
+        unsigned int scene_node_index = MeshModels::get_scene_node_ID(m_model_IDs[m]).get_index();
+        m_scene_node_models[m_scene_node_model_offsets[scene_node_index] + group_sizes[scene_node_index]++] = m;
+    }
+}
+
+void MeshModelBVH::refit(std::vector<unsigned int>& changed_models) {
+    Core::Parallel::for_each_chunk(0, (int)changed_models.size(), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            m_model_bounds[changed_models[i]] = compute_world_bounds(m_model_IDs[changed_models[i]]);
+    }, 1024);
+
+    // Refitting every node is cheaper than tracking the dirty nodes when a large part of the scene moved.
+    if (changed_models.size() * 4 > m_model_IDs.size()) {
+        for (int n = (int)m_nodes.size() - 1; n >= 0; --n)
+            refit_BVH4_node(m_nodes, n, m_model_bounds.data());
+        return;
+    }
+
+    // Refit the dirty nodes deepest first, using a max-heap of node indices, and queue their parents.
+    // Children have larger indices than their parents, so all children are refitted before their parent.
+    std::vector<int> dirty_nodes;
+    dirty_nodes.reserve(changed_models.size() * 2);
+    for (unsigned int model_index : changed_models)
+        dirty_nodes.push_back(m_model_node_indices[model_index]);
+    std::make_heap(dirty_nodes.begin(), dirty_nodes.end());
+    while (!dirty_nodes.empty()) {
+        int node_index = dirty_nodes.front();
+        // Equal indices are popped consecutively, so duplicates are skipped here.
+        while (!dirty_nodes.empty() && dirty_nodes.front() == node_index) {
+            std::pop_heap(dirty_nodes.begin(), dirty_nodes.end());
+            dirty_nodes.pop_back();
+        }
+
+        refit_BVH4_node(m_nodes, node_index, m_model_bounds.data());
+        int parent_index = m_nodes[node_index].parent;
+        if (parent_index >= 0) {
+            dirty_nodes.push_back(parent_index);
+            std::push_heap(dirty_nodes.begin(), dirty_nodes.end());
+        }
+    }
+}
+
+void MeshModelBVH::find_models_in_frustum(const Frustum& frustum, std::vector<MeshModels::UID>& model_IDs) const {
+    if (m_nodes.empty())
+        return;
+
+    int node_stack[BVH4_MAX_STACK_SIZE];
+    int stack_size = 0;
+    node_stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const BVH4Node& node = m_nodes[node_stack[--stack_size]];
+
+        int intersected_mask, contained_mask;
+        classify_children(node, frustum, intersected_mask, contained_mask);
+
+        for (int s = 0; s < 4; ++s) {
+            if ((intersected_mask & (1 << s)) == 0)
+                continue;
+
+            unsigned int first_model = node.first_primitives[s];
+            unsigned int model_count = node.primitive_counts[s];
+            if (contained_mask & (1 << s))
+                model_IDs.insert(model_IDs.end(), m_model_IDs.begin() + first_model, m_model_IDs.begin() + first_model + model_count);
+            else if (node.children[s] >= 0) {
+                assert(stack_size < BVH4_MAX_STACK_SIZE);
+                node_stack[stack_size++] = node.children[s];
+            } else
+                for (unsigned int m = first_model; m < first_model + model_count; ++m)
+                    if (frustum.intersects(m_model_bounds[m]))
+                        model_IDs.push_back(m_model_IDs[m]);
+        }
+    }
+}
+
+} // NS Bifrost::Scene
@@ -0,0 +1,95 @@
+// Bifrost bounding volume hierarchy over mesh models.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MESH_MODEL_BVH_H_
+#define _BIFROST_SCENE_MESH_MODEL_BVH_H_
+
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Math/AABB.h>
+#include <Bifrost/Math/BVH4.h>
+#include <Bifrost/Math/Frustum.h>
+#include <Bifrost/Math/Intersect.h>
+
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Four wide bounding volume hierarchy over the world space bounds of all mesh models.
+// The bounds of a model are the bounds of its mesh transformed by the global transform of its
+// scene node. The hierarchy tracks the SceneNodes and MeshModels changes through change consumers.
+// Moving scene nodes refits the bounds of the affected models and their ancestor nodes, while
+// creating or destroying models rebuilds the hierarchy.
+// The hierarchy must be destroyed before the SceneNodes and MeshModels are deallocated.
+// Future work
+// * Insert and remove models without a full rebuild.
+// * Track changes to mesh bounds.
+// * Hierarchies pr scene.
+// ------------------------------------------------------------------------------------------------
+class MeshModelBVH final {
+public:
+    static const unsigned int MAX_LEAF_SIZE = 4;
+
+    // Builds the hierarchy over the existing models.
+    MeshModelBVH();
+    ~MeshModelBVH();
+
+    MeshModelBVH(const MeshModelBVH& other) = delete;
+    MeshModelBVH& operator=(const MeshModelBVH& rhs) = delete;
+
+    // Consumes the scene node and model changes made since the last update and refits or rebuilds the hierarchy.
+    void update();
+
+    inline unsigned int get_model_count() const { return (unsigned int)m_model_IDs.size(); }
+    inline unsigned int get_node_count() const { return (unsigned int)m_nodes.size(); }
+    inline Math::AABB get_bounds() const { return m_nodes.empty() ? Math::AABB::invalid() : m_nodes[0].get_bounds(); }
+    size_t get_allocated_bytes() const;
+
+    // Appends the models whose bounds intersect the frustum. The test is conservative,
+    // so models close to the corners of the frustum can be reported as visible.
+    void find_models_in_frustum(const Math::Frustum& frustum, std::vector<Assets::MeshModels::UID>& model_IDs) const;
+
+    // Calls bool intersect_model(MeshModels::UID model_ID, float& max_distance) for the models whose bounds are
+    // hit by the ray within max_distance, roughly front to back. The callback can shorten max_distance to cull the
+    // models behind a hit, or return true to stop the traversal.
+    template <typename ModelIntersector>
+    void intersect(Math::Ray ray, float& max_distance, ModelIntersector intersect_model) const {
+        if (m_nodes.empty())
+            return;
+        Math::Vector3f inverse_direction = Math::Vector3f(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+        Math::traverse_BVH4(m_nodes.data(), ray, max_distance, [&](unsigned int first_model, unsigned int model_count, float& max_distance) -> bool {
+            for (unsigned int m = first_model; m < first_model + model_count; ++m)
+                if (Math::intersect(ray.origin, inverse_direction, m_model_bounds[m]) < max_distance)
+                    if (intersect_model(m_model_IDs[m], max_distance))
+                        return true;
+            return false;
+        });
+    }
+
+private:
+    void build();
+    void refit(std::vector<unsigned int>& changed_models);
+
+    std::vector<Math::BVH4Node> m_nodes;
+
+    // The models and their bounds in hierarchy order and the node whose slot holds each model.
+    std::vector<Assets::MeshModels::UID> m_model_IDs;
+    std::vector<Math::AABB> m_model_bounds;
+    std::vector<unsigned int> m_model_node_indices;
+
+    // Model positions grouped by the index of their scene node. The group of node n starts at offset n.
+    std::vector<unsigned int> m_scene_node_model_offsets;
+    std::vector<unsigned int> m_scene_node_models;
+
+    SceneNodes::ChangeConsumerID m_scene_node_consumer_ID;
+    Assets::MeshModels::ChangeConsumerID m_model_consumer_ID;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_MESH_MODEL_BVH_H_
@@ -0,0 +1,141 @@
+// Bifrost instance batches of mesh models.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/MeshModelBatches.h>
+
+#include <algorithm>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+namespace Bifrost::Scene {
+
+MeshModelBatches::MeshModelBatches() {
+    m_scene_node_consumer_ID = SceneNodes::add_change_consumer();
+    m_model_consumer_ID = MeshModels::add_change_consumer();
+
+    for (MeshModels::UID model_ID : MeshModels::get_iterable())
+        add_model(model_ID);
+
+    // All batches are new.
+    m_changed_batch_indices.resize(m_batches.size());
+    for (unsigned int b = 0; b < m_batches.size(); ++b)
+        m_changed_batch_indices[b] = b;
+}
+
+MeshModelBatches::~MeshModelBatches() {
+    if (SceneNodes::is_allocated())
+        SceneNodes::remove_change_consumer(m_scene_node_consumer_ID);
+    if (MeshModels::is_allocated())
+        MeshModels::remove_change_consumer(m_model_consumer_ID);
+}
+
+size_t MeshModelBatches::get_allocated_bytes() const {
+    size_t batch_bytes = Core::get_allocated_bytes(m_batches);
+    for (const Batch& batch : m_batches)
+        batch_bytes += Core::get_allocated_bytes(batch.model_IDs) + Core::get_allocated_bytes(batch.transforms);
+    // Estimate the lookup as a bucket array and a node with a next pointer pr batch.
+    size_t lookup_bytes = m_batch_lookup.bucket_count() * sizeof(void*) +
+        m_batch_lookup.size() * (sizeof(void*) + sizeof(std::pair<unsigned long long, unsigned int>));
+    return batch_bytes + lookup_bytes + Core::get_allocated_bytes(m_instances) + Core::get_allocated_bytes(m_changed_batch_indices);
+}
+
+void MeshModelBatches::update() {
+    m_changed_batch_indices.clear();
+
+    // Remove models that have been destroyed or have changed material and batch the new models and materials.
+    // The changes to a model index are merged, so the model can have been replaced by a new model with the same index.
+    for (auto model_changes : MeshModels::consume_changes(m_model_consumer_ID)) {
+        MeshModels::UID model_ID = model_changes.ID;
+        unsigned int model_index = model_ID.get_index();
+        bool is_alive = MeshModels::has(model_ID);
+
+        if (model_index < m_instances.size() && !(m_instances[model_index].model_ID == MeshModels::UID::invalid_UID())) {
+            const Instance& instance = m_instances[model_index];
+            const Batch& batch = m_batches[instance.batch_index];
+            bool is_batched_correctly = is_alive && instance.model_ID == model_ID &&
+                batch.mesh_ID == MeshModels::get_mesh_ID(model_ID) && batch.material_ID == MeshModels::get_material_ID(model_ID);
+            if (!is_batched_correctly)
+                remove_model(model_index);
+        }
+
+        if (is_alive && get_batch_index(model_ID) < 0)
+            add_model(model_ID);
+    }
+
+    // Update the transforms of the models on the moved scene nodes.
+    for (auto node_changes : SceneNodes::consume_changes(m_scene_node_consumer_ID)) {
+        if (!node_changes.changes.is_set(SceneNodes::Change::Transform) || !SceneNodes::has(node_changes.ID))
+            continue;
+
+        Transform transform = SceneNodes::get_global_transform(node_changes.ID);
+        for (MeshModels::UID model_ID : MeshModels::get_models_on_scene_node(node_changes.ID)) {
+            const Instance& instance = m_instances[model_ID.get_index()];
+            m_batches[instance.batch_index].transforms[instance.instance_index] = transform;
+            m_changed_batch_indices.push_back(instance.batch_index);
+        }
+    }
+
+    std::sort(m_changed_batch_indices.begin(), m_changed_batch_indices.end());
+    m_changed_batch_indices.erase(std::unique(m_changed_batch_indices.begin(), m_changed_batch_indices.end()), m_changed_batch_indices.end());
+}
+
+int MeshModelBatches::find_batch(Meshes::UID mesh_ID, Materials::UID material_ID) const {
+    auto batch_itr = m_batch_lookup.find(get_batch_key(mesh_ID, material_ID));
+    if (batch_itr == m_batch_lookup.end())
+        return -1;
+    const Batch& batch = m_batches[batch_itr->second];
+    return batch.mesh_ID == mesh_ID && batch.material_ID == material_ID ? (int)batch_itr->second : -1;
+}
+
+void MeshModelBatches::add_model(MeshModels::UID model_ID) {
+    Meshes::UID mesh_ID = MeshModels::get_mesh_ID(model_ID);
+    Materials::UID material_ID = MeshModels::get_material_ID(model_ID);
+    SceneNodes::UID scene_node_ID = MeshModels::get_scene_node_ID(model_ID);
+
+    // Find the batch or create it. A batch of a destroyed mesh or material whose index has been reused is left to empty
+    // out as its models are destroyed, while the lookup refers to the new batch.
+    int batch_index = find_batch(mesh_ID, material_ID);
+    if (batch_index < 0) {
+        batch_index = (int)m_batches.size();
+        Batch batch = {};
+        batch.mesh_ID = mesh_ID;
+        batch.material_ID = material_ID;
+        m_batches.push_back(batch);
+        m_batch_lookup[get_batch_key(mesh_ID, material_ID)] = batch_index;
+    }
+
+    Batch& batch = m_batches[batch_index];
+    unsigned int instance_index = batch.get_instance_count();
+    batch.model_IDs.push_back(model_ID);
+    batch.transforms.push_back(SceneNodes::get_global_transform(scene_node_ID));
+    m_changed_batch_indices.push_back(batch_index);
+
+    unsigned int model_index = model_ID.get_index();
+    if (model_index >= m_instances.size())
+        m_instances.resize(MeshModels::capacity(), { MeshModels::UID::invalid_UID(), 0u, 0u });
+    m_instances[model_index] = { model_ID, (unsigned int)batch_index, instance_index };
+}
+
+void MeshModelBatches::remove_model(unsigned int model_index) {
+    Instance& instance = m_instances[model_index];
+    Batch& batch = m_batches[instance.batch_index];
+
+    // Move the last instance into the removed instance's place.
+    MeshModels::UID last_model_ID = batch.model_IDs.back();
+    batch.model_IDs[instance.instance_index] = last_model_ID;
+    batch.transforms[instance.instance_index] = batch.transforms.back();
+    batch.model_IDs.pop_back();
+    batch.transforms.pop_back();
+    m_instances[last_model_ID.get_index()].instance_index = instance.instance_index;
+    m_changed_batch_indices.push_back(instance.batch_index);
+
+    instance = { MeshModels::UID::invalid_UID(), 0u, 0u };
+}
+
+} // NS Bifrost::Scene
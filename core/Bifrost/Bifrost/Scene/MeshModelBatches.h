@@ -0,0 +1,104 @@
+// Bifrost instance batches of mesh models.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MESH_MODEL_BATCHES_H_
+#define _BIFROST_SCENE_MESH_MODEL_BATCHES_H_
+
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Math/Transform.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Instance batches of the mesh models, grouped by mesh and material.
+// A batch holds the models sharing a mesh and material and the global transforms of their scene
+// nodes in contiguous arrays, so a renderer can issue a single draw or instance list pr batch.
+// The batches track the SceneNodes and MeshModels changes through change consumers and are
+// updated incrementally. Creating or destroying models and changing their material moves the
+// models between batches, while moving scene nodes updates the transforms of the models found
+// through MeshModels::get_models_on_scene_node.
+// Batches keep their index once created, also when they become empty, so renderers can keep
+// resources pr batch index.
+// The batches must be destroyed before the SceneNodes and MeshModels are deallocated.
+// Future work
+// * Split batches by scene root.
+// * Compact the batches when many of them are empty.
+// ------------------------------------------------------------------------------------------------
+class MeshModelBatches final {
+public:
+    struct Batch final {
+        Assets::Meshes::UID mesh_ID;
+        Assets::Materials::UID material_ID;
+        std::vector<Assets::MeshModels::UID> model_IDs;
+        std::vector<Math::Transform> transforms; // The global transforms of the models' scene nodes.
+
+        inline unsigned int get_instance_count() const { return (unsigned int)model_IDs.size(); }
+        inline bool is_empty() const { return model_IDs.empty(); }
+    };
+
+    // Batches the existing models.
+    MeshModelBatches();
+    ~MeshModelBatches();
+
+    MeshModelBatches(const MeshModelBatches& other) = delete;
+    MeshModelBatches& operator=(const MeshModelBatches& rhs) = delete;
+
+    // Consumes the scene node and model changes made since the last update and updates the batches.
+    void update();
+
+    inline unsigned int get_batch_count() const { return (unsigned int)m_batches.size(); }
+    inline const Batch& get_batch(unsigned int batch_index) const { return m_batches[batch_index]; }
+    inline const std::vector<Batch>& get_batches() const { return m_batches; }
+    size_t get_allocated_bytes() const;
+
+    // The index of the batch holding the models with the mesh and material or -1 if no such batch exists.
+    int find_batch(Assets::Meshes::UID mesh_ID, Assets::Materials::UID material_ID) const;
+
+    // The index of the batch holding the model or -1 if the model isn't batched.
+    inline int get_batch_index(Assets::MeshModels::UID model_ID) const {
+        unsigned int model_index = model_ID.get_index();
+        if (model_index >= m_instances.size() || !(m_instances[model_index].model_ID == model_ID))
+            return -1;
+        return (int)m_instances[model_index].batch_index;
+    }
+
+    // The batches whose instances or transforms changed during the last update, in ascending order.
+    inline const std::vector<unsigned int>& get_changed_batch_indices() const { return m_changed_batch_indices; }
+
+private:
+    // The batch and position in the batch of a model, indexed by the model's index.
+    struct Instance final {
+        Assets::MeshModels::UID model_ID; // Invalid if the model isn't batched.
+        unsigned int batch_index;
+        unsigned int instance_index;
+    };
+
+    static inline unsigned long long get_batch_key(Assets::Meshes::UID mesh_ID, Assets::Materials::UID material_ID) {
+        return ((unsigned long long)mesh_ID.get_index() << 32) | material_ID.get_index();
+    }
+
+    void add_model(Assets::MeshModels::UID model_ID);
+    void remove_model(unsigned int model_index);
+
+    std::vector<Batch> m_batches;
+    std::unordered_map<unsigned long long, unsigned int> m_batch_lookup; // Batch index by mesh and material index.
+
+    std::vector<Instance> m_instances;
+
+    std::vector<unsigned int> m_changed_batch_indices;
+
+    SceneNodes::ChangeConsumerID m_scene_node_consumer_ID;
+    Assets::MeshModels::ChangeConsumerID m_model_consumer_ID;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_MESH_MODEL_BATCHES_H_
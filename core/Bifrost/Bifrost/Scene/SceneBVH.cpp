@@ -0,0 +1,123 @@
+// Bifrost two level bounding volume hierarchy over the mesh models in the scenes.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/SceneBVH.h>
+
+#include <Bifrost/Core/Parallel.h>
+
+#include <algorithm>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+namespace Bifrost::Scene {
+
+// Transforms the ray into the space of the model's mesh. The direction is scaled along with the origin,
+// so distances along the mesh space ray equal distances along the world space ray.
+static inline Ray to_mesh_space(Ray ray, MeshModels::UID model_ID) {
+    Transform inverse_transform = invert(SceneNodes::get_global_transform(MeshModels::get_scene_node_ID(model_ID)));
+    return Ray(inverse_transform * ray.origin, inverse_transform.rotation * ray.direction * inverse_transform.scale);
+}
+
+SceneBVH::SceneBVH() {
+    m_mesh_consumer_ID = Meshes::add_change_consumer();
+    m_model_consumer_ID = MeshModels::add_change_consumer();
+
+    std::vector<Meshes::UID> mesh_IDs;
+    for (MeshModels::UID model_ID : MeshModels::get_iterable())
+        mesh_IDs.push_back(MeshModels::get_mesh_ID(model_ID));
+    build_mesh_BVHs(mesh_IDs);
+}
+
+SceneBVH::~SceneBVH() {
+    if (Meshes::is_allocated())
+        Meshes::remove_change_consumer(m_mesh_consumer_ID);
+    if (MeshModels::is_allocated())
+        MeshModels::remove_change_consumer(m_model_consumer_ID);
+}
+
+size_t SceneBVH::get_allocated_bytes() const {
+    size_t allocated_bytes = m_model_BVH.get_allocated_bytes() + Core::get_allocated_bytes(m_mesh_BVHs);
+    for (const auto& mesh_BVH : m_mesh_BVHs)
+        if (mesh_BVH != nullptr)
+            allocated_bytes += sizeof(MeshBVH) + mesh_BVH->get_allocated_bytes();
+    return allocated_bytes;
+}
+
+void SceneBVH::update() {
+    // Release the hierarchies of destroyed and updated meshes and queue the updated meshes for rebuilding.
+    std::vector<Meshes::UID> mesh_IDs;
+    for (auto mesh_changes : Meshes::consume_changes(m_mesh_consumer_ID)) {
+        unsigned int mesh_index = mesh_changes.ID.get_index();
+        if (mesh_index >= m_mesh_BVHs.size() || m_mesh_BVHs[mesh_index] == nullptr)
+            continue;
+        m_mesh_BVHs[mesh_index].reset();
+        if (Meshes::has(mesh_changes.ID) && !mesh_changes.changes.is_set(Meshes::Change::Created))
+            mesh_IDs.push_back(mesh_changes.ID);
+    }
+
+    // Models can only reference new meshes when they are created.
+    for (auto model_changes : MeshModels::consume_changes(m_model_consumer_ID))
+        if (model_changes.changes.is_set(MeshModels::Change::Created) && MeshModels::has(model_changes.ID))
+            mesh_IDs.push_back(MeshModels::get_mesh_ID(model_changes.ID));
+    build_mesh_BVHs(mesh_IDs);
+
+    m_model_BVH.update();
+}
+
+void SceneBVH::build_mesh_BVHs(std::vector<Meshes::UID>& mesh_IDs) {
+    if (m_mesh_BVHs.size() < Meshes::capacity())
+        m_mesh_BVHs.resize(Meshes::capacity());
+
+    // Queue meshes used by several models once.
+    auto unbuilt_end = std::remove_if(mesh_IDs.begin(), mesh_IDs.end(), [&](Meshes::UID mesh_ID) {
+        return !Meshes::has(mesh_ID) || !Meshes::get_flags(mesh_ID).is_set(MeshFlag::Position) || m_mesh_BVHs[mesh_ID.get_index()] != nullptr;
+    });
+    std::sort(mesh_IDs.begin(), unbuilt_end, [](Meshes::UID lhs, Meshes::UID rhs) { return lhs.get_index() < rhs.get_index(); });
+    unbuilt_end = std::unique(mesh_IDs.begin(), unbuilt_end);
+
+    Core::Parallel::for_each(0, (int)(unbuilt_end - mesh_IDs.begin()), [&](int i) {
+        Meshes::UID mesh_ID = mesh_IDs[i];
+        m_mesh_BVHs[mesh_ID.get_index()] = MeshUtils::build_BVH(mesh_ID);
+    }, 1);
+}
+
+const MeshBVH* SceneBVH::get_mesh_BVH(SceneNodes::UID root_node_ID, MeshModels::UID model_ID) const {
+    Meshes::UID mesh_ID = MeshModels::get_mesh_ID(model_ID);
+    unsigned int mesh_index = mesh_ID.get_index();
+    if (mesh_index >= m_mesh_BVHs.size() || m_mesh_BVHs[mesh_index] == nullptr)
+        return nullptr;
+
+    bool is_in_scene = SceneNodes::is_in_subtree(root_node_ID, MeshModels::get_scene_node_ID(model_ID));
+    return is_in_scene ? m_mesh_BVHs[mesh_index].get() : nullptr;
+}
+
+RayHit SceneBVH::intersect(SceneNodes::UID root_node_ID, Ray ray, float max_distance) const {
+    RayHit hit = { MeshModels::UID::invalid_UID(), 0u, max_distance, Vector2f::zero() };
+    m_model_BVH.intersect(ray, max_distance, [&](MeshModels::UID model_ID, float& max_distance) -> bool {
+        const MeshBVH* mesh_BVH = get_mesh_BVH(root_node_ID, model_ID);
+        if (mesh_BVH != nullptr && mesh_BVH->intersect(to_mesh_space(ray, model_ID), max_distance, hit.primitive_index, hit.barycentric)) {
+            hit.model_ID = model_ID;
+            hit.distance = max_distance;
+        }
+        return false;
+    });
+    return hit;
+}
+
+bool SceneBVH::intersects(SceneNodes::UID root_node_ID, Ray ray, float max_distance) const {
+    bool hit = false;
+    m_model_BVH.intersect(ray, max_distance, [&](MeshModels::UID model_ID, float& max_distance) -> bool {
+        const MeshBVH* mesh_BVH = get_mesh_BVH(root_node_ID, model_ID);
+        hit = mesh_BVH != nullptr && mesh_BVH->intersects(to_mesh_space(ray, model_ID), max_distance);
+        return hit;
+    });
+    return hit;
+}
+
+} // NS Bifrost::Scene
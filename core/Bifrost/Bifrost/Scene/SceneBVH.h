@@ -0,0 +1,72 @@
+// Bifrost two level bounding volume hierarchy over the mesh models in the scenes.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SCENE_BVH_H_
+#define _BIFROST_SCENE_SCENE_BVH_H_
+
+#include <Bifrost/Assets/MeshBVH.h>
+#include <Bifrost/Scene/MeshModelBVH.h>
+#include <Bifrost/Scene/SceneRoot.h>
+
+#include <memory>
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Two level bounding volume hierarchy for ray queries.
+// The top level is a MeshModelBVH over the world space bounds of the models and the bottom level
+// is a MeshBVH pr mesh in mesh space, shared by all models of the mesh. Rays are transformed into
+// mesh space by the inverse transform of the model's scene node.
+// The mesh hierarchies are shared with the Meshes' cache through MeshUtils::build_BVH. They are
+// built on demand, released when their mesh is destroyed and rebuilt when its geometry is updated.
+// The hierarchy must be destroyed before the SceneNodes, Meshes and MeshModels are deallocated.
+// Future work
+// * Top level hierarchies pr scene instead of filtering the hits by scene.
+// ------------------------------------------------------------------------------------------------
+class SceneBVH final {
+public:
+    SceneBVH();
+    ~SceneBVH();
+
+    SceneBVH(const SceneBVH& other) = delete;
+    SceneBVH& operator=(const SceneBVH& rhs) = delete;
+
+    // Consumes the scene node, mesh and model changes made since the last update, refits or rebuilds
+    // the top level hierarchy and builds the missing mesh hierarchies in parallel.
+    // Queries are thread safe between updates.
+    void update();
+
+    size_t get_allocated_bytes() const;
+
+    // Finds the closest hit within max_distance on a model in the scene below the root node.
+    // Returns a hit with an invalid model ID if nothing was hit.
+    RayHit intersect(SceneNodes::UID root_node_ID, Math::Ray ray, float max_distance) const;
+
+    // Returns true if a model in the scene below the root node is hit within max_distance.
+    bool intersects(SceneNodes::UID root_node_ID, Math::Ray ray, float max_distance) const;
+
+private:
+    // Builds the hierarchies of the meshes that don't have one yet.
+    void build_mesh_BVHs(std::vector<Assets::Meshes::UID>& mesh_IDs);
+
+    // Returns the mesh hierarchy of the model if the model is in the scene below the root node.
+    const Assets::MeshBVH* get_mesh_BVH(SceneNodes::UID root_node_ID, Assets::MeshModels::UID model_ID) const;
+
+    MeshModelBVH m_model_BVH;
+
+    // Mesh hierarchies indexed by mesh index.
+    std::vector<std::shared_ptr<const Assets::MeshBVH>> m_mesh_BVHs;
+
+    Assets::Meshes::ChangeConsumerID m_mesh_consumer_ID;
+    Assets::MeshModels::ChangeConsumerID m_model_consumer_ID;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_SCENE_BVH_H_
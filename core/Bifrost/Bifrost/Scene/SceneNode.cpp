@@ -7,7 +7,10 @@
 // ---------------------------------------------------------------------------
 
 #include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/Parallel.h>
 
+#include <algorithm>
 #include <assert.h>
 
 using namespace Bifrost::Math;
@@ -16,13 +19,26 @@ namespace Bifrost {
 namespace Scene {
 
 SceneNodes::UIDGenerator SceneNodes::m_UID_generator = UIDGenerator(0u);
-std::string* SceneNodes::m_names = nullptr;
+Core::ReservedArray<std::string> SceneNodes::m_names;
+std::unordered_multimap<size_t, SceneNodes::UID> SceneNodes::m_name_index;
 
-SceneNodes::UID* SceneNodes::m_parent_IDs = nullptr;
-SceneNodes::UID* SceneNodes::m_sibling_IDs = nullptr;
-SceneNodes::UID* SceneNodes::m_first_child_IDs = nullptr;
+Core::ReservedArray<SceneNodes::UID> SceneNodes::m_parent_IDs;
+Core::ReservedArray<SceneNodes::ChildRange> SceneNodes::m_child_ranges;
+Core::ReservedArray<unsigned int> SceneNodes::m_child_positions;
+std::vector<SceneNodes::UID> SceneNodes::m_child_pool;
+unsigned int SceneNodes::m_child_count = 0u;
+unsigned int SceneNodes::m_abandoned_child_slot_count = 0u;
 
-Transform* SceneNodes::m_global_transforms = nullptr;
+Core::ReservedArray<Transform> SceneNodes::m_local_transforms;
+Core::ReservedArray<Transform> SceneNodes::m_global_transforms;
+
+SceneNodes::TransformPropagation SceneNodes::m_transform_propagation = TransformPropagation::Immediate;
+Core::ReservedArray<bool> SceneNodes::m_dirty_transforms;
+std::vector<SceneNodes::UID> SceneNodes::m_dirty_node_IDs;
+
+std::vector<SceneNodes::UID> SceneNodes::m_propagation_node_IDs;
+std::vector<SceneNodes::UID> SceneNodes::m_propagation_parent_IDs;
+std::vector<unsigned int> SceneNodes::m_propagation_level_offsets;
 
 Core::ChangeSet<SceneNodes::Changes, SceneNodes::UID> SceneNodes::m_changes;
 
@@ -33,20 +49,25 @@ void SceneNodes::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
     
-    m_names = new std::string[capacity];
+    m_names = Core::ReservedArray<std::string>(m_UID_generator.max_capacity(), capacity);
     
-    m_parent_IDs = new SceneNodes::UID[capacity];
-    m_sibling_IDs = new SceneNodes::UID[capacity];
-    m_first_child_IDs = new SceneNodes::UID[capacity];
+    m_parent_IDs = Core::ReservedArray<SceneNodes::UID>(m_UID_generator.max_capacity(), capacity);
+    m_child_ranges = Core::ReservedArray<ChildRange>(m_UID_generator.max_capacity(), capacity);
+    m_child_positions = Core::ReservedArray<unsigned int>(m_UID_generator.max_capacity(), capacity);
 
-    m_global_transforms = new Transform[capacity];
+    m_local_transforms = Core::ReservedArray<Transform>(m_UID_generator.max_capacity(), capacity);
+    m_global_transforms = Core::ReservedArray<Transform>(m_UID_generator.max_capacity(), capacity);
+    m_dirty_transforms = Core::ReservedArray<bool>(m_UID_generator.max_capacity(), capacity);
 
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
     m_names[0] = "Dummy Node";
-    m_parent_IDs[0] = m_first_child_IDs[0] = m_sibling_IDs[0] = UID::invalid_UID();
-    m_global_transforms[0] = Transform::identity();
+    m_parent_IDs[0] = UID::invalid_UID();
+    m_child_ranges[0] = { 0u, 0u, 0u };
+    m_child_positions[0] = 0u;
+    m_local_transforms[0] = m_global_transforms[0] = Transform::identity();
+    m_dirty_transforms[0] = false;
 }
 
 void SceneNodes::deallocate() {
@@ -54,13 +75,24 @@ void SceneNodes::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_names; m_names = nullptr;
+    m_names.release();
+    m_name_index = std::unordered_multimap<size_t, UID>();
+
+    m_parent_IDs.release();
+    m_child_ranges.release();
+    m_child_positions.release();
+    m_child_pool = std::vector<UID>();
+    m_child_count = m_abandoned_child_slot_count = 0u;
 
-    delete[] m_parent_IDs; m_parent_IDs = nullptr;
-    delete[] m_sibling_IDs; m_sibling_IDs = nullptr;
-    delete[] m_first_child_IDs; m_first_child_IDs = nullptr;
+    m_local_transforms.release();
+    m_global_transforms.release();
 
-    delete[] m_global_transforms; m_global_transforms = nullptr;
+    m_transform_propagation = TransformPropagation::Immediate;
+    m_dirty_transforms.release();
+    m_dirty_node_IDs = std::vector<UID>();
+    m_propagation_node_IDs = std::vector<UID>();
+    m_propagation_parent_IDs = std::vector<UID>();
+    m_propagation_level_offsets = std::vector<unsigned int>();
 
     m_changes.resize(0);
 }
@@ -71,40 +103,59 @@ void SceneNodes::reserve(unsigned int new_capacity) {
     reserve_node_data(m_UID_generator.capacity(), old_capacity);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
-}
-
 void SceneNodes::reserve_node_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_first_child_IDs != nullptr);
-    assert(m_global_transforms != nullptr);
-    assert(m_names != nullptr);
-    assert(m_parent_IDs != nullptr);
-    assert(m_sibling_IDs != nullptr);
+    assert(m_child_positions.data() != nullptr);
+    assert(m_child_ranges.data() != nullptr);
+    assert(m_global_transforms.data() != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
+    m_names.resize(new_capacity);
 
-    m_names = resize_and_copy_array(m_names, new_capacity, copyable_elements);
+    m_parent_IDs.resize(new_capacity);
+    m_child_ranges.resize(new_capacity);
+    m_child_positions.resize(new_capacity);
 
-    m_parent_IDs = resize_and_copy_array(m_parent_IDs, new_capacity, copyable_elements);
-    m_sibling_IDs = resize_and_copy_array(m_sibling_IDs, new_capacity, copyable_elements);
-    m_first_child_IDs = resize_and_copy_array(m_first_child_IDs, new_capacity, copyable_elements);
-
-    m_global_transforms = resize_and_copy_array(m_global_transforms, new_capacity, copyable_elements);
+    m_local_transforms.resize(new_capacity);
+    m_global_transforms.resize(new_capacity);
+    m_dirty_transforms.resize(new_capacity);
 
     m_changes.resize(new_capacity);
 }
 
+Core::MemoryUsage SceneNodes::get_memory_usage(SceneNodes::UID node_ID) {
+    Core::MemoryUsage usage;
+    if (!m_UID_generator.has(node_ID))
+        return usage;
+    usage[Core::MemoryCategory::Metadata] = sizeof(std::string) + 2 * sizeof(UID) + sizeof(ChildRange) + sizeof(unsigned int) +
+        2 * sizeof(Transform) + sizeof(bool) + Core::get_allocated_bytes(m_names[node_ID]);
+    usage[Core::MemoryCategory::Metadata] += m_child_ranges[node_ID].capacity * sizeof(UID);
+    return usage;
+}
+
+Core::MemoryUsage SceneNodes::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID node_ID : m_UID_generator)
+        usage[Core::MemoryCategory::Metadata] += Core::get_allocated_bytes(m_names[node_ID]);
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() +
+        Core::get_allocated_bytes(m_names) + Core::get_allocated_bytes(m_parent_IDs) + Core::get_allocated_bytes(m_child_ranges) +
+        Core::get_allocated_bytes(m_child_positions) + Core::get_allocated_bytes(m_child_pool) + Core::get_allocated_bytes(m_local_transforms) +
+        Core::get_allocated_bytes(m_global_transforms) + Core::get_allocated_bytes(m_dirty_transforms) +
+        Core::get_allocated_bytes(m_dirty_node_IDs) + Core::get_allocated_bytes(m_propagation_node_IDs) +
+        Core::get_allocated_bytes(m_propagation_parent_IDs) + Core::get_allocated_bytes(m_propagation_level_offsets);
+    // Estimate the name index as a bucket array and a node with a next pointer pr name.
+    usage[Core::MemoryCategory::Metadata] += m_name_index.bucket_count() * sizeof(void*) +
+        m_name_index.size() * (sizeof(void*) + sizeof(std::pair<size_t, UID>));
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
+}
+
 SceneNodes::UID SceneNodes::create(const std::string& name, Transform transform) {
-    assert(m_first_child_IDs != nullptr);
-    assert(m_global_transforms != nullptr);
-    assert(m_names != nullptr);
-    assert(m_parent_IDs != nullptr);
-    assert(m_sibling_IDs != nullptr);
+    assert(m_child_positions.data() != nullptr);
+    assert(m_child_ranges.data() != nullptr);
+    assert(m_global_transforms.data() != nullptr);
+    assert(m_names.data() != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
 
     unsigned int old_capacity = m_UID_generator.capacity();
     UID id = m_UID_generator.generate();
@@ -113,48 +164,164 @@ SceneNodes::UID SceneNodes::create(const std::string& name, Transform transform)
         reserve_node_data(m_UID_generator.capacity(), old_capacity);
 
     m_names[id] = name;
-    m_parent_IDs[id] = m_first_child_IDs[id] = m_sibling_IDs[id] = UID::invalid_UID();
-    m_global_transforms[id] = transform;
+    add_to_name_index(id);
+    m_parent_IDs[id] = UID::invalid_UID();
+    m_child_ranges[id] = { 0u, 0u, 0u };
+    m_child_positions[id] = 0u;
+    m_local_transforms[id] = m_global_transforms[id] = transform;
+    m_dirty_transforms[id] = false;
     m_changes.set_change(id, Change::Created);
 
     return id;
 }
 
 void SceneNodes::destroy(SceneNodes::UID node_ID) {
-    // We don't actually destroy anything when destroying a node. The properties will get overwritten later when a node is created in same the spot.
-    if (m_UID_generator.erase(node_ID))
-        m_changes.add_change(node_ID, Change::Destroyed);
+    if (!m_UID_generator.has(node_ID))
+        return;
+
+    // Detach the node from the hierarchy, so the node can be reused. The children become roots and keep their global transforms.
+    while (m_child_ranges[node_ID].count > 0) {
+        const ChildRange& children = m_child_ranges[node_ID];
+        set_parent(m_child_pool[children.first + children.count - 1], UID::invalid_UID());
+    }
+    set_parent(node_ID, UID::invalid_UID());
+
+    // The node's child slots are left unused until the pool is compacted.
+    m_abandoned_child_slot_count += m_child_ranges[node_ID].capacity;
+    m_child_ranges[node_ID] = { 0u, 0u, 0u };
+
+    remove_from_name_index(node_ID);
+
+    // The remaining properties will get overwritten later when a node is created in same the spot.
+    m_UID_generator.erase(node_ID);
+    m_changes.add_change(node_ID, Change::Destroyed);
+}
+
+void SceneNodes::set_name(SceneNodes::UID node_ID, const std::string& name) {
+    assert(has(node_ID));
+
+    remove_from_name_index(node_ID);
+    m_names[node_ID] = name;
+    add_to_name_index(node_ID);
+}
+
+SceneNodes::UID SceneNodes::find(const std::string& name) {
+    auto nodes = m_name_index.equal_range(std::hash<std::string>()(name));
+    for (auto node_itr = nodes.first; node_itr != nodes.second; ++node_itr)
+        if (m_names[node_itr->second] == name)
+            return node_itr->second;
+    return UID::invalid_UID();
+}
+
+std::vector<SceneNodes::UID> SceneNodes::find_all(const std::string& name) {
+    std::vector<UID> node_IDs;
+    auto nodes = m_name_index.equal_range(std::hash<std::string>()(name));
+    for (auto node_itr = nodes.first; node_itr != nodes.second; ++node_itr)
+        if (m_names[node_itr->second] == name)
+            node_IDs.push_back(node_itr->second);
+    return node_IDs;
+}
+
+void SceneNodes::add_to_name_index(SceneNodes::UID node_ID) {
+    m_name_index.emplace(std::hash<std::string>()(m_names[node_ID]), node_ID);
+}
+
+void SceneNodes::remove_from_name_index(SceneNodes::UID node_ID) {
+    auto nodes = m_name_index.equal_range(std::hash<std::string>()(m_names[node_ID]));
+    for (auto node_itr = nodes.first; node_itr != nodes.second; ++node_itr)
+        if (node_itr->second == node_ID) {
+            m_name_index.erase(node_itr);
+            return;
+        }
 }
 
 void SceneNodes::set_parent(SceneNodes::UID node_ID, const SceneNodes::UID parent_ID) {
-    assert(m_parent_IDs != nullptr);
-    assert(m_sibling_IDs != nullptr);
-    assert(m_first_child_IDs != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
+    assert(m_child_ranges.data() != nullptr);
+    assert(m_child_positions.data() != nullptr);
 
     SceneNodes::UID old_parent_ID = m_parent_IDs[node_ID];
-    if (node_ID != parent_ID && node_ID != UID::invalid_UID()) {
-        // Detach current node from it's place in the hierarchy
-        if (old_parent_ID != UID::invalid_UID()) {
-            // Find old previous sibling.
-            UID sibling = m_first_child_IDs[old_parent_ID];
-            if (sibling == node_ID) {
-                m_first_child_IDs[old_parent_ID] = m_sibling_IDs[sibling];
-            } else {
-                while (node_ID != m_sibling_IDs[sibling])
-                    sibling = m_sibling_IDs[sibling];
-                m_sibling_IDs[sibling] = m_sibling_IDs[node_ID];
-            }
+    if (node_ID != parent_ID && node_ID != UID::invalid_UID() && old_parent_ID != parent_ID) {
+        // The node keeps its global transform, so its local transform is recomputed relative to the new parent.
+        Transform global_transform = compute_global_transform(node_ID);
+        Transform parent_transform = compute_global_transform(parent_ID);
+
+        // Move the node from its old parent's children to the new parent's. Root nodes are not stored as children.
+        // The node is a root while it is added, as compacting the child pool only visits the subtrees of roots.
+        if (old_parent_ID != UID::invalid_UID())
+            remove_child(old_parent_ID, node_ID);
+        m_parent_IDs[node_ID] = UID::invalid_UID();
+        if (parent_ID != UID::invalid_UID())
+            add_child(parent_ID, node_ID);
+        m_parent_IDs[node_ID] = parent_ID;
+
+        m_local_transforms[node_ID] = Transform::delta(parent_transform, global_transform);
+        // The node's global transform may be pending propagation from its old ancestors.
+        if (m_transform_propagation == TransformPropagation::Deferred)
+            propagate_transform(node_ID);
+    }
+}
+
+void SceneNodes::add_child(SceneNodes::UID parent_ID, SceneNodes::UID child_ID) {
+    if (m_child_ranges[parent_ID].count == m_child_ranges[parent_ID].capacity) {
+        // Compact before growing, as compaction gives every range a capacity equal to its child count.
+        if (m_abandoned_child_slot_count > 1024u && m_abandoned_child_slot_count > m_child_count)
+            compact_child_pool();
+
+        ChildRange& children = m_child_ranges[parent_ID];
+        unsigned int new_capacity = children.capacity < 2u ? 2u : 2u * children.capacity;
+        if (children.first + children.capacity == m_child_pool.size() && children.capacity > 0u) {
+            // The range is last in the pool and can grow in place.
+            m_child_pool.resize(children.first + new_capacity);
+        } else {
+            // Move the range to the end of the pool. Its old slots are left unused until the pool is compacted.
+            unsigned int new_first = (unsigned int)m_child_pool.size();
+            m_child_pool.resize(new_first + new_capacity);
+            std::copy_n(m_child_pool.begin() + children.first, children.count, m_child_pool.begin() + new_first);
+            m_abandoned_child_slot_count += children.capacity;
+            children.first = new_first;
         }
+        children.capacity = new_capacity;
+    }
 
-        // Attach it to the new parent as the first child and link it to the other siblings.
-        m_parent_IDs[node_ID] = parent_ID;
-        m_sibling_IDs[node_ID] = m_first_child_IDs[parent_ID];
-        m_first_child_IDs[parent_ID] = node_ID;
+    ChildRange& children = m_child_ranges[parent_ID];
+    m_child_positions[child_ID] = children.count;
+    m_child_pool[children.first + children.count++] = child_ID;
+    ++m_child_count;
+}
+
+void SceneNodes::remove_child(SceneNodes::UID parent_ID, SceneNodes::UID child_ID) {
+    // Move the last child into the removed child's position.
+    ChildRange& children = m_child_ranges[parent_ID];
+    unsigned int position = m_child_positions[child_ID];
+    UID last_child_ID = m_child_pool[children.first + --children.count];
+    m_child_pool[children.first + position] = last_child_ID;
+    m_child_positions[last_child_ID] = position;
+    --m_child_count;
+}
+
+void SceneNodes::compact_child_pool() {
+    // Gather the nodes in depth first order before moving any ranges, as the traversal reads the ranges.
+    std::vector<UID> depth_first_nodes;
+    depth_first_nodes.reserve(m_child_count + m_UID_generator.size());
+    for (UID node_ID : m_UID_generator)
+        if (m_parent_IDs[node_ID] == UID::invalid_UID())
+            apply_recursively(node_ID, [&](SceneNodes::UID id) { depth_first_nodes.push_back(id); });
+
+    std::vector<UID> child_pool;
+    child_pool.reserve(m_child_count);
+    for (UID node_ID : depth_first_nodes) {
+        ChildRange& children = m_child_ranges[node_ID];
+        unsigned int first = (unsigned int)child_pool.size();
+        child_pool.insert(child_pool.end(), m_child_pool.begin() + children.first, m_child_pool.begin() + children.first + children.count);
+        children = { first, children.count, children.count };
     }
+    m_child_pool.swap(child_pool);
+    m_abandoned_child_slot_count = 0u;
 }
 
 std::vector<SceneNodes::UID> SceneNodes::get_sibling_IDs(SceneNodes::UID node_ID) {
-    assert(m_parent_IDs != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
 
     SceneNodes::UID parent_ID = m_parent_IDs[node_ID];
     
@@ -162,91 +329,179 @@ std::vector<SceneNodes::UID> SceneNodes::get_sibling_IDs(SceneNodes::UID node_ID
 }
 
 std::vector<SceneNodes::UID> SceneNodes::get_children_IDs(SceneNodes::UID node_ID) {
-    assert(m_first_child_IDs != nullptr);
-    assert(m_sibling_IDs != nullptr);
-
-    std::vector<SceneNodes::UID> res(0);
-    SceneNodes::UID child = m_first_child_IDs[node_ID];
-    while (child != UID::invalid_UID()) {
-        res.push_back(child);
-        child = m_sibling_IDs[child];
-    }
-    return res;
+    assert(m_child_ranges.data() != nullptr);
+
+    Core::Iterable<ChildIterator> children = get_children(node_ID);
+    return std::vector<SceneNodes::UID>(children.begin(), children.end());
 }
 
-bool SceneNodes::has_child(SceneNodes::UID node_ID, SceneNodes::UID tested_Child_ID) {
-    assert(m_first_child_IDs != nullptr);
-    assert(m_sibling_IDs != nullptr);
+bool SceneNodes::has_child(SceneNodes::UID node_ID, SceneNodes::UID tested_child_ID) {
+    assert(m_parent_IDs.data() != nullptr);
 
-    SceneNodes::UID child = m_first_child_IDs[node_ID];
-    while (child != UID::invalid_UID()) {
-        if (child == tested_Child_ID)
-            return true;
-        child = m_sibling_IDs[child];
-    }
-    return false;
+    return node_ID != UID::invalid_UID() && m_UID_generator.has(tested_child_ID) && m_parent_IDs[tested_child_ID] == node_ID;
+}
+
+bool SceneNodes::is_in_subtree(SceneNodes::UID root_node_ID, SceneNodes::UID tested_node_ID) {
+    assert(m_parent_IDs.data() != nullptr);
+
+    while (tested_node_ID != root_node_ID && tested_node_ID != UID::invalid_UID())
+        tested_node_ID = m_parent_IDs[tested_node_ID];
+    return tested_node_ID == root_node_ID;
 }
 
 std::vector<SceneNode> SceneNode::get_children() const {
-    std::vector<SceneNodes::UID> children_IDs = SceneNodes::get_children_IDs(m_ID);
-    std::vector<SceneNode> children;
-    children.reserve(children_IDs.size());
-    for (SceneNodes::UID id : children_IDs)
-        children.push_back(SceneNode(id));
-    return children;
+    Core::Iterable<SceneNodes::ChildIterator> children_IDs = SceneNodes::get_children(m_ID);
+    return std::vector<SceneNode>(children_IDs.begin(), children_IDs.end());
 }
 
 Transform SceneNodes::get_local_transform(SceneNodes::UID node_ID) {
-    UID parent_ID = m_parent_IDs[node_ID];
-    const Transform parent_transform = m_global_transforms[parent_ID];
-    const Transform transform = m_global_transforms[node_ID];
-    return Transform::delta(parent_transform, transform);
+    assert(m_local_transforms.data() != nullptr);
+    return m_local_transforms[node_ID];
 }
 
 void SceneNodes::set_local_transform(SceneNodes::UID node_ID, Transform transform) {
-    assert(m_global_transforms != nullptr);
-    assert(m_parent_IDs != nullptr);
+    assert(m_global_transforms.data() != nullptr);
+    assert(m_local_transforms.data() != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
 
     if (node_ID == UID::invalid_UID()) return;
 
-    // Update global transform.
-    UID parent_ID = m_parent_IDs[node_ID];
-    Transform parent_transform = m_global_transforms[parent_ID];
-    Transform new_global_transform = parent_transform * transform;
-    unsafe_set_global_transform(node_ID, new_global_transform);
+    m_local_transforms[node_ID] = transform;
+    if (m_transform_propagation == TransformPropagation::Immediate)
+        m_global_transforms[node_ID] = m_global_transforms[m_parent_IDs[node_ID]] * transform;
+    propagate_transform(node_ID);
 }
 
 void SceneNodes::set_global_transform(SceneNodes::UID node_ID, Transform transform) {
-    assert(m_global_transforms != nullptr);
+    assert(m_global_transforms.data() != nullptr);
+    assert(m_local_transforms.data() != nullptr);
+    assert(m_parent_IDs.data() != nullptr);
 
     if (node_ID == UID::invalid_UID()) return;
 
-    unsafe_set_global_transform(node_ID, transform);
+    Transform parent_transform = compute_global_transform(m_parent_IDs[node_ID]);
+    m_local_transforms[node_ID] = Transform::delta(parent_transform, transform);
+    if (m_transform_propagation == TransformPropagation::Immediate)
+        m_global_transforms[node_ID] = transform;
+    propagate_transform(node_ID);
 }
 
 void SceneNodes::apply_delta_transform(SceneNodes::UID node_ID, Transform delta_transform) {
-    assert(m_global_transforms != nullptr);
+    assert(m_global_transforms.data() != nullptr);
+    assert(m_local_transforms.data() != nullptr);
 
     if (node_ID == UID::invalid_UID()) return;
 
-    Transform new_global_transform = m_global_transforms[node_ID] * delta_transform;
-    unsafe_set_global_transform(node_ID, new_global_transform);
+    // parent * (local * delta) == (parent * local) * delta, so the delta can be applied to the local transform.
+    m_local_transforms[node_ID] = m_local_transforms[node_ID] * delta_transform;
+    if (m_transform_propagation == TransformPropagation::Immediate)
+        m_global_transforms[node_ID] = m_global_transforms[node_ID] * delta_transform;
+    propagate_transform(node_ID);
 }
 
-void SceneNodes::unsafe_set_global_transform(SceneNodes::UID node_ID, Transform new_transform) {
-    Transform old_transform = m_global_transforms[node_ID];
-    Transform delta_transform = Transform::delta(new_transform, old_transform);
-    m_global_transforms[node_ID] = new_transform;
-    m_changes.add_change(node_ID, Change::Transform);
+Transform SceneNodes::compute_global_transform(SceneNodes::UID node_ID) {
+    if (m_transform_propagation == TransformPropagation::Immediate)
+        return m_global_transforms[node_ID];
+
+    // Global transforms can be stale in deferred mode, so concatenate the local transforms up to the root.
+    Transform transform = m_local_transforms[node_ID];
+    for (UID parent_ID = m_parent_IDs[node_ID]; parent_ID != UID::invalid_UID(); parent_ID = m_parent_IDs[parent_ID])
+        transform = m_local_transforms[parent_ID] * transform;
+    return transform;
+}
 
-    // Update global transforms of all children.
-    Transform inverse_old_transform = old_transform.inverse();
-    apply_to_children_recursively(node_ID, [=](SceneNodes::UID child_ID) {
-        Transform delta_transform = inverse_old_transform * m_global_transforms[child_ID]; // Inlined Transform::delta(); to ensure that old_transform isn't inverted on every application.
-        m_global_transforms[child_ID] = new_transform * delta_transform;
+void SceneNodes::propagate_transform(SceneNodes::UID node_ID) {
+    if (m_transform_propagation == TransformPropagation::Deferred) {
+        if (!m_dirty_transforms[node_ID]) {
+            m_dirty_transforms[node_ID] = true;
+            m_dirty_node_IDs.push_back(node_ID);
+        }
+        return;
+    }
+
+    // Update global transforms of all children. The traversal visits parents before their children.
+    m_changes.add_change(node_ID, Change::Transform);
+    apply_to_children_recursively(node_ID, [](SceneNodes::UID child_ID) {
+        m_global_transforms[child_ID] = m_global_transforms[m_parent_IDs[child_ID]] * m_local_transforms[child_ID];
         m_changes.add_change(child_ID, Change::Transform);
     });
 }
 
+// ------------------------------------------------------------------------------------------------
+// Deferred transform propagation.
+// ------------------------------------------------------------------------------------------------
+
+void SceneNodes::set_transform_propagation(TransformPropagation propagation) {
+    if (propagation == TransformPropagation::Immediate)
+        propagate_transforms();
+    m_transform_propagation = propagation;
+}
+
+bool SceneNodes::has_dirty_ancestor(SceneNodes::UID node_ID) {
+    for (UID parent_ID = m_parent_IDs[node_ID]; parent_ID != UID::invalid_UID(); parent_ID = m_parent_IDs[parent_ID])
+        if (m_dirty_transforms[parent_ID])
+            return true;
+    return false;
+}
+
+void SceneNodes::add_transform_propagation_callbacks(Core::Engine& engine) {
+    // The mutating callback propagates the transforms set between ticks and the non-mutating callback the transforms
+    // set by the mutating callbacks. Callbacks added later that access the scene nodes depend on them.
+    typedef Core::Engine::Manager Manager;
+    engine.add_mutating_callback("Propagate transforms", propagate_transforms, Manager::SceneNodes, Manager::SceneNodes);
+    engine.add_non_mutating_callback("Propagate transforms", propagate_transforms, Manager::SceneNodes, Manager::SceneNodes);
+}
+
+void SceneNodes::propagate_transforms() {
+    if (m_dirty_node_IDs.empty())
+        return;
+
+    m_propagation_node_IDs.clear();
+    m_propagation_parent_IDs.clear();
+    m_propagation_level_offsets.clear();
+
+    // The first level holds the dirty nodes without dirty ancestors. The parents of these are up to date
+    // and their subtrees are disjoint, so every dirty node is visited exactly once.
+    for (UID node_ID : m_dirty_node_IDs)
+        if (m_UID_generator.has(node_ID) && !has_dirty_ancestor(node_ID)) {
+            m_propagation_node_IDs.push_back(node_ID);
+            m_propagation_parent_IDs.push_back(m_parent_IDs[node_ID]);
+        }
+    for (UID node_ID : m_dirty_node_IDs)
+        m_dirty_transforms[node_ID] = false;
+    m_dirty_node_IDs.clear();
+
+    // Append the children of every level to form the next level, until a level has no children.
+    unsigned int level_begin = 0;
+    while (level_begin < m_propagation_node_IDs.size()) {
+        m_propagation_level_offsets.push_back(level_begin);
+        unsigned int level_end = (unsigned int)m_propagation_node_IDs.size();
+        for (unsigned int i = level_begin; i < level_end; ++i) {
+            UID node_ID = m_propagation_node_IDs[i];
+            for (UID child_ID : get_children(node_ID)) {
+                m_propagation_node_IDs.push_back(child_ID);
+                m_propagation_parent_IDs.push_back(node_ID);
+            }
+        }
+        level_begin = level_end;
+    }
+    m_propagation_level_offsets.push_back(level_begin);
+
+    for (UID node_ID : m_propagation_node_IDs)
+        m_changes.add_change(node_ID, Change::Transform);
+
+    // The nodes in a level only read the global transforms of the previous level, so they can be updated in parallel.
+    const UID* node_IDs = m_propagation_node_IDs.data();
+    const UID* parent_IDs = m_propagation_parent_IDs.data();
+    for (unsigned int l = 0; l + 1 < m_propagation_level_offsets.size(); ++l) {
+        int level_begin = (int)m_propagation_level_offsets[l];
+        int level_end = (int)m_propagation_level_offsets[l + 1];
+        Core::Parallel::for_each_chunk(level_begin, level_end, [=](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                m_global_transforms[node_IDs[i]] = m_global_transforms[parent_IDs[i]] * m_local_transforms[node_IDs[i]];
+        }, 1024);
+    }
+}
+
 } // NS Scene
 } // NS Bifrost
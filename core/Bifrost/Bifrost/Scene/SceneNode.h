@@ -12,19 +12,39 @@
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/Transform.h>
 
+#include <unordered_map>
+
 namespace Bifrost {
+namespace Core {
+class Engine;
+}
 namespace Scene {
 
 // ---------------------------------------------------------------------------
 // Container class for the bifrost scene node.
+// Transforms are propagated to the children either immediately when a transform
+// is set or deferred until propagate_transforms() is called.
+// In deferred mode setting a transform only writes the local transform and marks
+// the node dirty. propagate_transforms() then updates the global transforms of
+// all dirty subtrees in one pass, level by level in depth sorted order, with the
+// nodes of a level updated in parallel. Global transforms read in deferred mode
+// are the ones computed by the last propagation, while local transforms are
+// always up to date.
+// The children of a node are stored as a contiguous range in a shared child pool
+// and a node knows its position in its parent's range, so children can be
+// iterated without allocating and a node is detached from its parent in constant
+// time by moving the last sibling into its position. The order of siblings is
+// therefore not preserved when a node is reparented.
+// Ranges that outgrow their capacity are moved to the end of the pool and the
+// pool is compacted into depth first order once the slots left behind by moved
+// ranges and destroyed nodes outnumber the children.
 // Future work
 // * A parent changed event: (node_id, old_parent_id). Is this actually needed by anything when transforms are global?
-// * Change the sibling/children layout, so sibling IDs or perhaps siblings are always allocated next too each other?
-//   * Requires an extra indirection though, since node ID's won't match the node positions anymore.
-//   * Could be done (incrementally?) when all mutations in a tick are done.
 // * The change notification count is going to explode when setting up or tearing down a scene. 
 //   We should implement a better solution for these cases.
 //   Perhaps a great big 'a lot has changed, rebuild everything and ignore the notifications' flag?
@@ -35,7 +55,7 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static bool is_allocated() { return m_global_transforms != nullptr; }
+    static bool is_allocated() { return m_global_transforms.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -51,14 +71,29 @@ public:
     static Core::Iterable<ConstUIDIterator> get_iterable() { return Core::Iterable<ConstUIDIterator>(begin(), end()); }
 
     static inline std::string get_name(SceneNodes::UID node_ID) { return m_names[node_ID]; }
-    static inline void set_name(SceneNodes::UID node_ID, const std::string& name) { m_names[node_ID] = name; }
+    static void set_name(SceneNodes::UID node_ID, const std::string& name);
+
+    // Finds the nodes with a name through a hashed index of the names.
+    // Names aren't unique, so find returns any of the nodes with the name or the invalid UID if no node has it.
+    static SceneNodes::UID find(const std::string& name);
+    static std::vector<SceneNodes::UID> find_all(const std::string& name);
 
     static inline SceneNodes::UID get_parent_ID(SceneNodes::UID node_ID) { return m_parent_IDs[node_ID]; }
     static void set_parent(SceneNodes::UID node_ID, const SceneNodes::UID parent_ID);
     static bool has_child(SceneNodes::UID node_ID, SceneNodes::UID tested_child_ID);
+    // Returns true if the tested node is the root node or one of its descendants.
+    static bool is_in_subtree(SceneNodes::UID root_node_ID, SceneNodes::UID tested_node_ID);
     static std::vector<SceneNodes::UID> get_sibling_IDs(SceneNodes::UID node_ID);
     static std::vector<SceneNodes::UID> get_children_IDs(SceneNodes::UID node_ID);
 
+    // Iterates the children of a node without allocating. Invalidated when the hierarchy changes.
+    typedef const UID* ChildIterator;
+    static inline unsigned int get_child_count(SceneNodes::UID node_ID) { return m_child_ranges[node_ID].count; }
+    static inline Core::Iterable<ChildIterator> get_children(SceneNodes::UID node_ID) {
+        const ChildRange& children = m_child_ranges[node_ID];
+        return Core::Iterable<ChildIterator>(m_child_pool.data() + children.first, children.count);
+    }
+
     static Math::Transform get_local_transform(SceneNodes::UID node_ID);
     static void set_local_transform(SceneNodes::UID node_ID, Math::Transform transform);
     static Math::Transform get_global_transform(SceneNodes::UID node_ID) { return m_global_transforms[node_ID];}
@@ -70,6 +105,27 @@ public:
     template<typename F>
     static void apply_to_children_recursively(SceneNodes::UID node_ID, F& function);
 
+    //-------------------------------------------------------------------------
+    // Transform propagation.
+    //-------------------------------------------------------------------------
+    enum class TransformPropagation : unsigned char { Immediate, Deferred };
+    // Switching to immediate propagation propagates all pending transforms.
+    static void set_transform_propagation(TransformPropagation propagation);
+    static TransformPropagation get_transform_propagation() { return m_transform_propagation; }
+
+    // Updates the global transforms of all nodes below a dirty node.
+    static void propagate_transforms();
+    // Adds engine callbacks that propagate the deferred transforms before the mutating and non-mutating callbacks
+    // that access the scene nodes. Must be called before adding those callbacks.
+    static void add_transform_propagation_callbacks(Core::Engine& engine);
+    static bool has_pending_transforms() { return !m_dirty_node_IDs.empty(); }
+
+    //-------------------------------------------------------------------------
+    // Memory usage.
+    //-------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(SceneNodes::UID node_ID);
+    static Core::MemoryUsage get_memory_usage();
+
     //-------------------------------------------------------------------------
     // Changes since last game loop tick.
     //-------------------------------------------------------------------------
@@ -87,21 +143,62 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_nodes() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { return m_changes.reset_change_notifications(); }
 
 private:
     static void reserve_node_data(unsigned int new_capacity, unsigned int old_capacity);
-    static void SceneNodes::unsafe_set_global_transform(SceneNodes::UID node_ID, Math::Transform transform);
 
+    static void add_child(SceneNodes::UID parent_ID, SceneNodes::UID child_ID);
+    static void remove_child(SceneNodes::UID parent_ID, SceneNodes::UID child_ID);
+    // Copies the child ranges into a new pool in depth first order, without unused slots.
+    static void compact_child_pool();
+
+    // Computes the up to date global transform from the local transforms of the node and its ancestors.
+    static Math::Transform compute_global_transform(SceneNodes::UID node_ID);
+    // Propagates the node's global transform to its children or marks it dirty in deferred mode.
+    static void propagate_transform(SceneNodes::UID node_ID);
+    static bool has_dirty_ancestor(SceneNodes::UID node_ID);
+
+
+    static void add_to_name_index(SceneNodes::UID node_ID);
+    static void remove_from_name_index(SceneNodes::UID node_ID);
 
     static UIDGenerator m_UID_generator;
-    static std::string* m_names;
+    static Core::ReservedArray<std::string> m_names;
+    static std::unordered_multimap<size_t, SceneNodes::UID> m_name_index; // Nodes by the hash of their name.
+
+    struct ChildRange final {
+        unsigned int first;
+        unsigned int count;
+        unsigned int capacity;
+    };
+
+    static Core::ReservedArray<SceneNodes::UID> m_parent_IDs;
+    static Core::ReservedArray<ChildRange> m_child_ranges;
+    static Core::ReservedArray<unsigned int> m_child_positions; // Position of the node in its parent's child range.
+    static std::vector<SceneNodes::UID> m_child_pool;
+    static unsigned int m_child_count; // Number of used slots in the child pool.
+    static unsigned int m_abandoned_child_slot_count; // Slots left behind by ranges moved to the end of the pool and by destroyed nodes.
 
-    static SceneNodes::UID* m_parent_IDs;
-    static SceneNodes::UID* m_sibling_IDs;
-    static SceneNodes::UID* m_first_child_IDs;
+    static Core::ReservedArray<Math::Transform> m_local_transforms;
+    static Core::ReservedArray<Math::Transform> m_global_transforms;
 
-    static Math::Transform* m_global_transforms;
+    static TransformPropagation m_transform_propagation;
+    static Core::ReservedArray<bool> m_dirty_transforms;
+    static std::vector<UID> m_dirty_node_IDs;
+
+    // Nodes to propagate in depth sorted order with their parents and the first node of every level.
+    // Kept between propagations to reuse the memory.
+    static std::vector<UID> m_propagation_node_IDs;
+    static std::vector<UID> m_propagation_parent_IDs;
+    static std::vector<unsigned int> m_propagation_level_offsets;
 
     static Core::ChangeSet<Changes, UID> m_changes;
 };
@@ -136,6 +233,7 @@ public:
     inline void set_parent(SceneNode parent) { SceneNodes::set_parent(m_ID, parent.get_ID()); }
     inline bool has_child(SceneNode tested_child) { return SceneNodes::has_child(m_ID, tested_child.get_ID()); }
     std::vector<SceneNode> get_children() const;
+    inline unsigned int get_child_count() const { return SceneNodes::get_child_count(m_ID); }
 
     inline Math::Transform get_local_transform() const { return SceneNodes::get_local_transform(m_ID); }
     inline void set_local_transform(Math::Transform transform) { SceneNodes::set_local_transform(m_ID, transform); }
@@ -163,34 +261,35 @@ private:
 
 template<typename F>
 void SceneNodes::apply_to_children_recursively(SceneNodes::UID node_ID, F& function) {
-    UID node = m_first_child_IDs[node_ID];
-    if (node == UID::invalid_UID())
+    if (m_child_ranges[node_ID].count == 0)
         return;
 
-    do {
+    UID node = m_child_pool[m_child_ranges[node_ID].first];
+    while (true) {
         function(node);
 
-        if (m_first_child_IDs[node] != UID::invalid_UID())
-            // Visit the next child.
-            node = m_first_child_IDs[node];
-        else if (m_sibling_IDs[node] != UID::invalid_UID())
-            // Visit the next sibling.
-            node = m_sibling_IDs[node];
-        else
-        {
-            // search upwards for next node not visited.
-            node = m_parent_IDs[node];
-            while (node != node_ID) {
-                UID parent_sibling = m_sibling_IDs[node];
-                if (parent_sibling == UID::invalid_UID())
-                    node = m_parent_IDs[node];
-                else {
-                    node = parent_sibling;
-                    break;
-                }
-            }
+        const ChildRange& children = m_child_ranges[node];
+        if (children.count > 0) {
+            // Visit the first child.
+            node = m_child_pool[children.first];
+            continue;
         }
-    } while (node != node_ID);
+
+        // Search upwards for the next sibling not visited.
+        do {
+            UID parent_ID = m_parent_IDs[node];
+            const ChildRange& siblings = m_child_ranges[parent_ID];
+            unsigned int next_position = m_child_positions[node] + 1;
+            if (next_position < siblings.count) {
+                node = m_child_pool[siblings.first + next_position];
+                break;
+            }
+            node = parent_ID;
+        } while (node != node_ID);
+
+        if (node == node_ID)
+            return;
+    }
 }
 
 template<typename F>
@@ -8,14 +8,18 @@
 
 #include <Bifrost/Scene/SceneRoot.h>
 
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Scene/SceneBVH.h>
+
 #include <assert.h>
 
 namespace Bifrost {
 namespace Scene {
 
 SceneRoots::UIDGenerator SceneRoots::m_UID_generator = UIDGenerator(0u);
-SceneRoots::Scene* SceneRoots::m_scenes = nullptr;
+Core::ReservedArray<SceneRoots::Scene> SceneRoots::m_scenes;
 Core::ChangeSet<SceneRoots::Changes, SceneRoots::UID> SceneRoots::m_changes;
+std::unique_ptr<SceneBVH> SceneRoots::m_BVH;
 
 void SceneRoots::allocate(unsigned int capacity) {
     if (is_allocated())
@@ -24,7 +28,7 @@ void SceneRoots::allocate(unsigned int capacity) {
     m_UID_generator = UIDGenerator(capacity);
     capacity = m_UID_generator.capacity();
 
-    m_scenes = new Scene[capacity];
+    m_scenes = Core::ReservedArray<Scene>(m_UID_generator.max_capacity(), capacity);
     m_changes = Core::ChangeSet<Changes, UID>(capacity);
 
     // Allocate dummy element at 0.
@@ -38,7 +42,8 @@ void SceneRoots::deallocate() {
         return;
 
     m_UID_generator = UIDGenerator(0u);
-    delete[] m_scenes; m_scenes = nullptr;
+    m_scenes.release();
+    m_BVH.reset();
 
     m_changes.resize(0);
 }
@@ -49,25 +54,40 @@ void SceneRoots::reserve(unsigned int new_capacity) {
     reserve_scene_data(m_UID_generator.capacity(), old_capacity);
 }
 
-template <typename T>
-static inline T* resize_and_copy_array(T* old_array, unsigned int new_capacity, unsigned int copyable_elements) {
-    T* new_array = new T[new_capacity];
-    std::copy(old_array, old_array + copyable_elements, new_array);
-    delete[] old_array;
-    return new_array;
+void SceneRoots::reserve_scene_data(unsigned int new_capacity, unsigned int old_capacity) {
+    assert(m_scenes.data() != nullptr);
+
+    m_scenes.resize(new_capacity);
+    m_changes.resize(new_capacity);
 }
 
-void SceneRoots::reserve_scene_data(unsigned int new_capacity, unsigned int old_capacity) {
-    assert(m_scenes != nullptr);
+static inline void add_environment_light_bytes(Core::MemoryUsage& usage, const Assets::InfiniteAreaLight* environment_light) {
+    if (environment_light != nullptr) {
+        usage[Core::MemoryCategory::Distributions] += environment_light->get_allocated_bytes();
+        usage[Core::MemoryCategory::Metadata] += sizeof(Assets::InfiniteAreaLight);
+    }
+}
 
-    const unsigned int copyable_elements = new_capacity < old_capacity ? new_capacity : old_capacity;
+Core::MemoryUsage SceneRoots::get_memory_usage(SceneRoots::UID scene_ID) {
+    Core::MemoryUsage usage;
+    if (!m_UID_generator.has(scene_ID))
+        return usage;
+    usage[Core::MemoryCategory::Metadata] = sizeof(Scene);
+    add_environment_light_bytes(usage, m_scenes[scene_ID].environment_light);
+    return usage;
+}
 
-    m_scenes = resize_and_copy_array(m_scenes, new_capacity, copyable_elements);
-    m_changes.resize(new_capacity);
+Core::MemoryUsage SceneRoots::get_memory_usage() {
+    Core::MemoryUsage usage;
+    for (UID scene_ID : m_UID_generator)
+        add_environment_light_bytes(usage, m_scenes[scene_ID].environment_light);
+    usage[Core::MemoryCategory::Metadata] += m_UID_generator.get_allocated_bytes() + Core::get_allocated_bytes(m_scenes);
+    usage[Core::MemoryCategory::ChangeSets] = m_changes.get_allocated_bytes();
+    return usage;
 }
 
 SceneRoots::UID SceneRoots::create(const std::string& name, Assets::Textures::UID environment_map, Math::RGB environment_tint) {
-    assert(m_scenes != nullptr);
+    assert(m_scenes.data() != nullptr);
 
     unsigned int old_capacity = m_UID_generator.capacity();
     UID id = m_UID_generator.generate();
@@ -103,5 +123,47 @@ void SceneRoots::set_environment_map(SceneRoots::UID scene_ID, Assets::Textures:
     m_changes.add_change(scene_ID, Change::EnvironmentMap);
 }
 
+void SceneRoots::set_environment_light(SceneRoots::UID scene_ID, Assets::InfiniteAreaLight* environment_light) {
+    delete m_scenes[scene_ID].environment_light;
+    m_scenes[scene_ID].environment_light = environment_light;
+    m_changes.add_change(scene_ID, Change::EnvironmentMap);
+}
+
+static inline RayHit no_hit(float max_distance) {
+    return { Assets::MeshModels::UID::invalid_UID(), 0u, max_distance, Math::Vector2f::zero() };
+}
+
+void SceneRoots::update_BVH() {
+    if (m_BVH == nullptr)
+        m_BVH = std::make_unique<SceneBVH>();
+    else
+        m_BVH->update();
+}
+
+RayHit SceneRoots::intersect(SceneRoots::UID scene_ID, Math::Ray ray, float max_distance) {
+    if (m_BVH == nullptr)
+        return no_hit(max_distance);
+    return m_BVH->intersect(m_scenes[scene_ID].root_node, ray, max_distance);
+}
+
+bool SceneRoots::intersects(SceneRoots::UID scene_ID, Math::Ray ray, float max_distance) {
+    return m_BVH != nullptr && m_BVH->intersects(m_scenes[scene_ID].root_node, ray, max_distance);
+}
+
+void SceneRoots::intersect(SceneRoots::UID scene_ID, const Math::Ray* rays, RayHit* hits, unsigned int ray_count, float max_distance) {
+    if (m_BVH == nullptr) {
+        for (unsigned int r = 0; r < ray_count; ++r)
+            hits[r] = no_hit(max_distance);
+        return;
+    }
+
+    const SceneBVH& bvh = *m_BVH;
+    SceneNodes::UID root_node_ID = m_scenes[scene_ID].root_node;
+    Core::Parallel::for_each_chunk(0, (int)ray_count, [&](int begin, int end) {
+        for (int r = begin; r < end; ++r)
+            hits[r] = bvh.intersect(root_node_ID, rays[r], max_distance);
+    }, 64);
+}
+
 } // NS Scene
 } // NS Bifrost
@@ -10,17 +10,38 @@
 #define _BIFROST_SCENE_SCENE_ROOT_H_
 
 #include <Bifrost/Assets/InfiniteAreaLight.h>
+#include <Bifrost/Assets/MeshModel.h>
 #include <Bifrost/Assets/Texture.h>
 #include <Bifrost/Core/Bitmask.h>
 #include <Bifrost/Core/ChangeSet.h>
 #include <Bifrost/Core/Iterable.h>
+#include <Bifrost/Core/MemoryUsage.h>
+#include <Bifrost/Core/ReservedArray.h>
 #include <Bifrost/Core/UniqueIDGenerator.h>
 #include <Bifrost/Math/Color.h>
+#include <Bifrost/Math/Ray.h>
 #include <Bifrost/Scene/SceneNode.h>
 
+#include <memory>
+
 namespace Bifrost {
 namespace Scene {
 
+class SceneBVH;
+
+// ------------------------------------------------------------------------------------------------
+// The result of a ray query. The model ID is invalid if nothing was hit.
+// The barycentric coordinates are the weights of the second and third vertex of the primitive hit.
+// ------------------------------------------------------------------------------------------------
+struct RayHit final {
+    Assets::MeshModels::UID model_ID;
+    unsigned int primitive_index;
+    float distance;
+    Math::Vector2f barycentric;
+
+    inline bool is_hit() const { return model_ID != Assets::MeshModels::UID::invalid_UID(); }
+};
+
 // ------------------------------------------------------------------------------------------------
 // The scene root contains the root scene node and scene specific properties,
 // such as the environment map and tint.
@@ -39,7 +60,7 @@ public:
     typedef UIDGenerator::UID UID;
     typedef UIDGenerator::ConstIterator ConstUIDIterator;
 
-    static bool is_allocated() { return m_scenes != nullptr; }
+    static bool is_allocated() { return m_scenes.data() != nullptr; }
     static void allocate(unsigned int capacity);
     static void deallocate();
 
@@ -67,6 +88,29 @@ public:
         return environment_light == nullptr ? Assets::Textures::UID::invalid_UID() : environment_light->get_texture_ID();
     }
     static void set_environment_map(SceneRoots::UID scene_ID, Assets::Textures::UID environment_map);
+    // Replaces the environment light, taking ownership of it. Used to set lights whose distribution has been precomputed.
+    static void set_environment_light(SceneRoots::UID scene_ID, Assets::InfiniteAreaLight* environment_light);
+
+    //---------------------------------------------------------------------------------------------
+    // Ray queries.
+    // The queries run against a two level bounding volume hierarchy over the mesh models, which is
+    // brought up to date with the scene node, mesh and model changes by update_BVH. Queries before
+    // the first update miss everything. Queries are thread safe between updates.
+    // Distances are measured in units of the ray direction, which therefore should be normalized.
+    //---------------------------------------------------------------------------------------------
+    // Creates the hierarchy or updates it with the changes since the last update. Requires the SceneNodes,
+    // Meshes and MeshModels to be allocated. Call it once pr tick before querying, fx from a mutating callback.
+    static void update_BVH();
+    static RayHit intersect(SceneRoots::UID scene_ID, Math::Ray ray, float max_distance = 1e30f);
+    static bool intersects(SceneRoots::UID scene_ID, Math::Ray ray, float max_distance = 1e30f);
+    // Intersects the rays in parallel and stores the closest hit of every ray in hits.
+    static void intersect(SceneRoots::UID scene_ID, const Math::Ray* rays, RayHit* hits, unsigned int ray_count, float max_distance = 1e30f);
+
+    //---------------------------------------------------------------------------------------------
+    // Memory usage.
+    //---------------------------------------------------------------------------------------------
+    static Core::MemoryUsage get_memory_usage(SceneRoots::UID scene_ID);
+    static Core::MemoryUsage get_memory_usage();
 
     //---------------------------------------------------------------------------------------------
     // Changes since last game loop tick.
@@ -86,6 +130,13 @@ public:
     typedef std::vector<UID>::iterator ChangedIterator;
     static Core::Iterable<ChangedIterator> get_changed_scenes() { return m_changes.get_changed_resources(); }
 
+    // Changes consumed at the consumer's own rate, independently of reset_change_notifications().
+    typedef Core::ChangeSet<Changes, UID>::ConsumerID ChangeConsumerID;
+    typedef Core::ChangeSet<Changes, UID>::ConsumedIterator ConsumedChangeIterator;
+    static ChangeConsumerID add_change_consumer() { return m_changes.add_consumer(); }
+    static void remove_change_consumer(ChangeConsumerID consumer_ID) { m_changes.remove_consumer(consumer_ID); }
+    static Core::Iterable<ConsumedChangeIterator> consume_changes(ChangeConsumerID consumer_ID) { return m_changes.consume_changes(consumer_ID); }
+
     static void reset_change_notifications() { m_changes.reset_change_notifications(); }
 private:
 
@@ -99,9 +150,12 @@ private:
         Assets::InfiniteAreaLight* environment_light;
     };
 
-    static Scene* m_scenes;
+    static Core::ReservedArray<Scene> m_scenes;
 
     static Core::ChangeSet<Changes, UID> m_changes;
+
+    // Acceleration structure for ray queries. Created by the first query.
+    static std::unique_ptr<SceneBVH> m_BVH;
 };
 
 // ------------------------------------------------------------------------------------------------
@@ -0,0 +1,107 @@
+// Bifrost asynchronous screenshot writer.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/ScreenshotWriter.h>
+
+#include <assert.h>
+
+using namespace Bifrost::Assets;
+
+namespace Bifrost::Scene {
+
+ScreenshotWriter::ScreenshotWriter(Encoder encoder, unsigned int queue_capacity, unsigned int worker_count)
+    : m_encoder(encoder), m_queue_capacity(queue_capacity > 0u ? queue_capacity : 1u)
+    , m_active_job_count(0u), m_stopping(false) {
+    worker_count = worker_count > 0u ? worker_count : 1u;
+    m_workers.reserve(worker_count);
+    for (unsigned int w = 0; w < worker_count; ++w)
+        m_workers.emplace_back([this] { process_jobs(); });
+}
+
+ScreenshotWriter::~ScreenshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_job_queued.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void ScreenshotWriter::push_job(Screenshot& screenshot, const std::string& path, CompletionCallback& on_completion) {
+    m_queue.push_back({ screenshot, path, std::move(on_completion) });
+    screenshot.pixels = nullptr;
+}
+
+void ScreenshotWriter::write(Screenshot screenshot, const std::string& path, CompletionCallback on_completion) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job_dequeued.wait(lock, [this] { return m_queue.size() < m_queue_capacity; });
+        push_job(screenshot, path, on_completion);
+    }
+    m_job_queued.notify_one();
+}
+
+bool ScreenshotWriter::try_write(Screenshot screenshot, const std::string& path, CompletionCallback on_completion) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.size() >= m_queue_capacity)
+            return false;
+        push_job(screenshot, path, on_completion);
+    }
+    m_job_queued.notify_one();
+    return true;
+}
+
+bool ScreenshotWriter::write(Cameras::UID camera_ID, Screenshot::Content content, const std::string& path, CompletionCallback on_completion) {
+    Screenshot screenshot = Cameras::take_screenshot(camera_ID, content);
+    if (screenshot.pixels == nullptr)
+        return false;
+    write(screenshot, path, std::move(on_completion));
+    return true;
+}
+
+unsigned int ScreenshotWriter::get_pending_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (unsigned int)m_queue.size() + m_active_job_count;
+}
+
+void ScreenshotWriter::wait_until_idle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_job_completed.wait(lock, [this] { return m_queue.empty() && m_active_job_count == 0u; });
+}
+
+void ScreenshotWriter::process_jobs() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_queued.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+                return; // Stopping and all screenshots have been written.
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+            ++m_active_job_count;
+        }
+        m_job_dequeued.notify_one();
+
+        bool succeeded = m_encoder(job.screenshot, job.path);
+        Images::deallocate_pixels(job.screenshot.format, job.screenshot.pixels);
+        if (job.on_completion)
+            job.on_completion(job.path, succeeded);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            assert(m_active_job_count > 0u);
+            --m_active_job_count;
+        }
+        m_job_completed.notify_all();
+    }
+}
+
+} // NS Bifrost::Scene
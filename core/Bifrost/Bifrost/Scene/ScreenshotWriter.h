@@ -0,0 +1,97 @@
+// Bifrost asynchronous screenshot writer.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SCREENSHOT_WRITER_H_
+#define _BIFROST_SCENE_SCREENSHOT_WRITER_H_
+
+#include <Bifrost/Scene/Camera.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Encodes and writes screenshots to disk on background threads, so resolving screenshots doesn't
+// stall the tick. Screenshots are moved into a bounded queue together with the ownership of their
+// pixels, and the encoder reads the pixels directly from the screenshot buffer. The writer
+// releases the pixels with Images::deallocate_pixels once they are written.
+// The queue provides backpressure: write blocks while the queue is full and try_write refuses
+// the screenshot instead.
+// The writer uses its own threads instead of the task scheduler, as encoding and file IO would
+// otherwise block the workers used for the parallel algorithms.
+// Completion callbacks are called from the worker threads.
+// Future work
+// * Encode to memory and write the files with asynchronous IO.
+// ------------------------------------------------------------------------------------------------
+class ScreenshotWriter final {
+public:
+    // Encodes the screenshot to the file at path and returns true if it succeeded.
+    // The encoder is called concurrently when the writer has multiple workers.
+    using Encoder = std::function<bool(const Screenshot& screenshot, const std::string& path)>;
+    using CompletionCallback = std::function<void(const std::string& path, bool succeeded)>;
+
+    ScreenshotWriter(Encoder encoder, unsigned int queue_capacity = 8u, unsigned int worker_count = 1u);
+    // Writes the remaining queued screenshots before returning.
+    ~ScreenshotWriter();
+
+    ScreenshotWriter(const ScreenshotWriter& other) = delete;
+    ScreenshotWriter& operator=(const ScreenshotWriter& rhs) = delete;
+
+    inline unsigned int get_queue_capacity() const { return m_queue_capacity; }
+    inline unsigned int get_worker_count() const { return (unsigned int)m_workers.size(); }
+
+    // Queues the screenshot and takes ownership of its pixels. Blocks while the queue is full.
+    void write(Screenshot screenshot, const std::string& path, CompletionCallback on_completion = nullptr);
+
+    // Queues the screenshot and takes ownership of its pixels if the queue isn't full.
+    // Returns false and leaves the pixels with the caller if the queue is full.
+    bool try_write(Screenshot screenshot, const std::string& path, CompletionCallback on_completion = nullptr);
+
+    // Takes the last screenshot with the given content from the camera and queues it.
+    // Returns false if the camera has no pending screenshot with the content.
+    bool write(Cameras::UID camera_ID, Screenshot::Content content, const std::string& path, CompletionCallback on_completion = nullptr);
+
+    // The number of screenshots that are queued or being written.
+    unsigned int get_pending_count() const;
+
+    // Blocks until all queued screenshots have been written.
+    void wait_until_idle();
+
+private:
+    struct Job {
+        Screenshot screenshot;
+        std::string path;
+        CompletionCallback on_completion;
+    };
+
+    void push_job(Screenshot& screenshot, const std::string& path, CompletionCallback& on_completion);
+    void process_jobs();
+
+    Encoder m_encoder;
+    unsigned int m_queue_capacity;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_job_queued;
+    std::condition_variable m_job_dequeued;
+    std::condition_variable m_job_completed;
+    std::deque<Job> m_queue;
+    unsigned int m_active_job_count;
+    bool m_stopping;
+
+    std::vector<std::thread> m_workers;
+};
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_SCREENSHOT_WRITER_H_
@@ -0,0 +1,171 @@
+// Bifrost serialization utilities shared by snapshots and change logs.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/SerializationUtils.h>
+
+#include <cstring>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+
+namespace Bifrost::Scene::SerializationUtils {
+
+Header create_header(const char magic[8], unsigned int version) {
+    Header header;
+    memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = version;
+    header.pointer_size = sizeof(void*);
+    return header;
+}
+
+bool has_magic(const Header& header, const char magic[8]) {
+    return memcmp(header.magic, magic, sizeof(header.magic)) == 0;
+}
+
+size_t get_pixel_bytes(Images::UID image_ID) {
+    size_t pixel_count = 0;
+    for (unsigned int m = 0; m < Images::get_mipmap_count(image_ID); ++m)
+        pixel_count += Images::get_pixel_count(image_ID, m);
+    return pixel_count * size_of(Images::get_pixel_format(image_ID));
+}
+
+// ------------------------------------------------------------------------------------------------
+// Materials.
+// ------------------------------------------------------------------------------------------------
+
+void write_material(Core::BinaryWriter& writer, Materials::UID material_ID) {
+    writer.write_string(Materials::get_name(material_ID));
+    writer.write(Materials::get_flags(material_ID));
+    writer.write(Materials::get_tint(material_ID));
+    writer.write(index_of<Textures>(Materials::get_tint_roughness_texture_ID(material_ID)));
+    writer.write(Materials::get_roughness(material_ID));
+    writer.write(Materials::get_specularity(material_ID));
+    writer.write(Materials::get_metallic(material_ID));
+    writer.write(index_of<Textures>(Materials::get_metallic_texture_ID(material_ID)));
+    writer.write(Materials::get_coat(material_ID));
+    writer.write(Materials::get_coat_roughness(material_ID));
+    writer.write(Materials::get_coverage(material_ID));
+    writer.write(index_of<Textures>(Materials::get_coverage_texture_ID(material_ID)));
+    writer.write(Materials::get_transmission(material_ID));
+}
+
+MaterialState read_material(Core::BinaryReader& reader, const std::vector<Textures::UID>& texture_IDs) {
+    MaterialState material = {};
+    material.name = reader.read_string();
+    Materials::Data& data = material.data;
+    data.flags = reader.read<Materials::Flags>();
+    data.tint = reader.read<RGB>();
+    data.tint_roughness_texture_ID = lookup(texture_IDs, reader.read<unsigned int>());
+    data.roughness = reader.read<float>();
+    data.specularity = reader.read<float>();
+    data.metallic = reader.read<float>();
+    data.metallic_texture_ID = lookup(texture_IDs, reader.read<unsigned int>());
+    data.coat = reader.read<float>();
+    data.coat_roughness = reader.read<float>();
+    data.coverage = reader.read<float>();
+    data.coverage_texture_ID = lookup(texture_IDs, reader.read<unsigned int>());
+    data.transmission = reader.read<float>();
+    return material;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Meshes.
+// ------------------------------------------------------------------------------------------------
+
+void write_mesh(Core::BinaryWriter& writer, Meshes::UID mesh_ID) {
+    writer.write_string(Meshes::get_name(mesh_ID));
+    writer.write(Meshes::get_primitive_count(mesh_ID));
+    writer.write(Meshes::get_vertex_count(mesh_ID));
+    writer.write(Meshes::get_flags(mesh_ID));
+    writer.write(Meshes::get_bounds(mesh_ID));
+    writer.write(Meshes::get_position_quantization(mesh_ID));
+    for_each_mesh_block(mesh_ID, [&](const void* data, size_t byte_count) { writer.write_block(data, byte_count); });
+}
+
+MeshHeader read_mesh_header(Core::BinaryReader& reader) {
+    MeshHeader header = {};
+    header.name = reader.read_string();
+    header.primitive_count = reader.read<unsigned int>();
+    header.vertex_count = reader.read<unsigned int>();
+    header.buffers = reader.read<MeshFlags>();
+    header.bounds = reader.read<AABB>();
+    header.position_quantization = reader.read<Meshes::PositionQuantization>();
+    return header;
+}
+
+Meshes::UID create_mesh(const MeshHeader& header) {
+    Meshes::UID mesh_ID = Meshes::create(header.name, header.primitive_count, header.vertex_count, header.buffers);
+    Meshes::set_bounds(mesh_ID, header.bounds);
+    Meshes::set_position_quantization(mesh_ID, header.position_quantization);
+    return mesh_ID;
+}
+
+void skip_mesh_blocks(Core::BinaryReader& reader, MeshFlags buffers) {
+    reader.skip_block();
+    for (MeshFlag buffer : { MeshFlag::Position, MeshFlag::Normal, MeshFlag::Texcoord })
+        if (buffers.is_set(buffer))
+            reader.skip_block();
+}
+
+// ------------------------------------------------------------------------------------------------
+// Light sources.
+// ------------------------------------------------------------------------------------------------
+
+void write_light(Core::BinaryWriter& writer, LightSources::UID light_ID) {
+    LightSources::Type type = LightSources::get_type(light_ID);
+    writer.write(index_of<SceneNodes>(LightSources::get_node_ID(light_ID)));
+    writer.write(type);
+    switch (type) {
+    case LightSources::Type::Sphere:
+        writer.write(LightSources::get_sphere_light_power(light_ID));
+        writer.write(LightSources::get_sphere_light_radius(light_ID));
+        break;
+    case LightSources::Type::Spot:
+        writer.write(LightSources::get_spot_light_power(light_ID));
+        writer.write(LightSources::get_spot_light_radius(light_ID));
+        writer.write(LightSources::get_spot_light_cos_angle(light_ID));
+        break;
+    case LightSources::Type::Directional:
+        writer.write(LightSources::get_directional_light_radiance(light_ID));
+        break;
+    }
+}
+
+LightState read_light(Core::BinaryReader& reader, const std::vector<SceneNodes::UID>& node_IDs) {
+    LightState light = {};
+    light.node_ID = lookup(node_IDs, reader.read<unsigned int>());
+    light.type = reader.read<LightSources::Type>();
+    light.power = reader.read<RGB>();
+    switch (light.type) {
+    case LightSources::Type::Sphere:
+        light.radius = reader.read<float>();
+        break;
+    case LightSources::Type::Spot:
+        light.radius = reader.read<float>();
+        light.cos_angle = reader.read<float>();
+        break;
+    case LightSources::Type::Directional:
+        break;
+    default:
+        reader.fail();
+    }
+    return light;
+}
+
+LightSources::UID create_light(const LightState& light) {
+    switch (light.type) {
+    case LightSources::Type::Sphere:
+        return LightSources::create_sphere_light(light.node_ID, light.power, light.radius);
+    case LightSources::Type::Spot:
+        return LightSources::create_spot_light(light.node_ID, light.power, light.radius, light.cos_angle);
+    default:
+        return LightSources::create_directional_light(light.node_ID, light.power);
+    }
+}
+
+} // NS Bifrost::Scene::SerializationUtils
@@ -0,0 +1,114 @@
+// Bifrost serialization utilities shared by snapshots and change logs.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SERIALIZATION_UTILS_H_
+#define _BIFROST_SCENE_SERIALIZATION_UTILS_H_
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Core/BinaryStream.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+
+#include <string>
+#include <vector>
+
+namespace Bifrost::Scene::SerializationUtils {
+
+// ------------------------------------------------------------------------------------------------
+// Resources are stored in the native memory layout and references between resources are stored
+// as resource indices, which the reader maps to the resources it created. The resource state
+// shared by snapshots and change logs is written and read by the functions below, so the two
+// formats store it identically.
+// ------------------------------------------------------------------------------------------------
+
+struct Header {
+    char magic[8];
+    unsigned int version;
+    unsigned int pointer_size; // Guards against loading files written by a build for a different architecture.
+};
+
+Header create_header(const char magic[8], unsigned int version);
+bool has_magic(const Header& header, const char magic[8]);
+inline bool is_native(const Header& header, unsigned int version) { return header.version == version && header.pointer_size == sizeof(void*); }
+
+// Returns the index of the resource or the index of the sentinel resource if the resource doesn't exist.
+template <typename Manager, typename UID>
+inline unsigned int index_of(UID resource_ID) {
+    return Manager::has(resource_ID) ? resource_ID.get_index() : 0u;
+}
+
+// Returns the resource created for the stored index or the invalid UID if there is none.
+template <typename UID>
+inline UID lookup(const std::vector<UID>& IDs, unsigned int index) {
+    return index < IDs.size() ? IDs[index] : UID::invalid_UID();
+}
+
+size_t get_pixel_bytes(Assets::Images::UID image_ID);
+
+// ------------------------------------------------------------------------------------------------
+// Materials.
+// ------------------------------------------------------------------------------------------------
+struct MaterialState {
+    std::string name;
+    Assets::Materials::Data data;
+};
+
+void write_material(Core::BinaryWriter& writer, Assets::Materials::UID material_ID);
+MaterialState read_material(Core::BinaryReader& reader, const std::vector<Assets::Textures::UID>& texture_IDs);
+
+// ------------------------------------------------------------------------------------------------
+// Meshes. The buffers are stored in their storage format, given by the buffer flags.
+// ------------------------------------------------------------------------------------------------
+struct MeshHeader {
+    std::string name;
+    unsigned int primitive_count;
+    unsigned int vertex_count;
+    Assets::MeshFlags buffers;
+    Math::AABB bounds;
+    Assets::Meshes::PositionQuantization position_quantization;
+};
+
+void write_mesh(Core::BinaryWriter& writer, Assets::Meshes::UID mesh_ID);
+MeshHeader read_mesh_header(Core::BinaryReader& reader);
+// Creates a mesh with the properties of the header. The geometry is read afterwards with for_each_mesh_block.
+Assets::Meshes::UID create_mesh(const MeshHeader& header);
+void skip_mesh_blocks(Core::BinaryReader& reader, Assets::MeshFlags buffers);
+
+// Calls copy_block(void* destination, size_t byte_count) for each geometry block of the mesh in the stored order.
+template <typename BlockCopier>
+inline void for_each_mesh_block(Assets::Meshes::UID mesh_ID, BlockCopier copy_block) {
+    using namespace Assets;
+    copy_block(Meshes::get_primitives(mesh_ID), Meshes::get_primitive_count(mesh_ID) * sizeof(Math::Vector3ui));
+    MeshFlags buffers = Meshes::get_flags(mesh_ID);
+    for (MeshFlag buffer : { MeshFlag::Position, MeshFlag::Normal, MeshFlag::Texcoord })
+        if (buffers.is_set(buffer))
+            copy_block(Meshes::get_buffer_data(mesh_ID, buffer), Meshes::get_buffer_size(mesh_ID, buffer));
+}
+
+// ------------------------------------------------------------------------------------------------
+// Light sources.
+// ------------------------------------------------------------------------------------------------
+struct LightState {
+    SceneNodes::UID node_ID;
+    LightSources::Type type;
+    Math::RGB power; // Radiance for directional lights.
+    float radius;
+    float cos_angle;
+};
+
+void write_light(Core::BinaryWriter& writer, LightSources::UID light_ID);
+// Reads a light and fails the reader if the light type is unknown.
+LightState read_light(Core::BinaryReader& reader, const std::vector<SceneNodes::UID>& node_IDs);
+LightSources::UID create_light(const LightState& light);
+
+} // NS Bifrost::Scene::SerializationUtils
+
+#endif // _BIFROST_SCENE_SERIALIZATION_UTILS_H_
@@ -0,0 +1,529 @@
+// Bifrost binary snapshot of the datamodel.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#include <Bifrost/Scene/Snapshot.h>
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/InfiniteAreaLight.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Core/BinaryStream.h>
+#include <Bifrost/Core/MemoryMappedFile.h>
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Scene/SceneRoot.h>
+#include <Bifrost/Scene/SerializationUtils.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Math;
+using namespace Bifrost::Scene::SerializationUtils;
+
+namespace Bifrost::Scene::Snapshot {
+
+// ------------------------------------------------------------------------------------------------
+// File layout.
+// The header is followed by a section pr manager in the order below. A section starts with its
+// tag, the number of resources and the capacity of the manager, which bounds the resource indices.
+// Resources are written as their index followed by their properties, with references to other
+// resources stored as indices. Strings are prefixed by their length and blocks by their size and
+// padding to the block alignment.
+// ------------------------------------------------------------------------------------------------
+
+static const char MAGIC[8] = { 'B', 'F', 'S', 'N', 'A', 'P', 'S', 'H' };
+
+enum class Section : unsigned int {
+    Images = 1, Textures, Materials, Meshes, SceneRoots, SceneNodes, MeshModels, LightSources, Cameras, End
+};
+
+struct SectionHeader {
+    Section section;
+    unsigned int resource_count;
+    unsigned int capacity;
+};
+
+static inline void write_section_header(Core::BinaryWriter& writer, Section section, unsigned int resource_count, unsigned int capacity) {
+    writer.write(SectionHeader{ section, resource_count, capacity });
+}
+
+// Reads the section header and fails if the section isn't the expected one.
+static inline SectionHeader read_section_header(Core::BinaryReader& reader, Section expected_section) {
+    SectionHeader header = reader.read<SectionHeader>();
+    if (header.section != expected_section)
+        reader.fail();
+    return header;
+}
+
+// Reads a resource index and fails if it isn't below the capacity of its section.
+static inline unsigned int read_index(Core::BinaryReader& reader, unsigned int capacity) {
+    unsigned int index = reader.read<unsigned int>();
+    if (index >= capacity)
+        reader.fail();
+    return index;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Saving.
+// ------------------------------------------------------------------------------------------------
+
+template <typename Manager>
+static inline unsigned int resource_count() {
+    unsigned int count = 0;
+    for (auto resource_ID : Manager::get_iterable()) {
+        (void)resource_ID;
+        ++count;
+    }
+    return count;
+}
+
+static void save_images(Core::BinaryWriter& writer) {
+    bool is_allocated = Images::is_allocated();
+    write_section_header(writer, Section::Images, is_allocated ? resource_count<Images>() : 0u, is_allocated ? Images::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (Images::UID image_ID : Images::get_iterable()) {
+        writer.write(image_ID.get_index());
+        writer.write_string(Images::get_name(image_ID));
+        writer.write(Images::get_pixel_format(image_ID));
+        writer.write(Images::get_gamma(image_ID));
+        writer.write(Vector3ui(Images::get_width(image_ID), Images::get_height(image_ID), Images::get_depth(image_ID)));
+        writer.write(Images::get_mipmap_count(image_ID));
+        writer.write(Images::is_mipmapable(image_ID));
+        writer.write_block(Images::get_pixels(image_ID), get_pixel_bytes(image_ID));
+    }
+}
+
+static void save_textures(Core::BinaryWriter& writer) {
+    bool is_allocated = Textures::is_allocated();
+    write_section_header(writer, Section::Textures, is_allocated ? resource_count<Textures>() : 0u, is_allocated ? Textures::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (Textures::UID texture_ID : Textures::get_iterable()) {
+        writer.write(texture_ID.get_index());
+        writer.write(index_of<Images>(Textures::get_image_ID(texture_ID)));
+        writer.write(Textures::get_magnification_filter(texture_ID));
+        writer.write(Textures::get_minification_filter(texture_ID));
+        writer.write(Textures::get_wrapmode_U(texture_ID));
+        writer.write(Textures::get_wrapmode_V(texture_ID));
+    }
+}
+
+static void save_materials(Core::BinaryWriter& writer) {
+    bool is_allocated = Materials::is_allocated();
+    write_section_header(writer, Section::Materials, is_allocated ? resource_count<Materials>() : 0u, is_allocated ? Materials::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (Materials::UID material_ID : Materials::get_iterable()) {
+        writer.write(material_ID.get_index());
+        write_material(writer, material_ID);
+    }
+}
+
+static void save_meshes(Core::BinaryWriter& writer) {
+    bool is_allocated = Meshes::is_allocated();
+    write_section_header(writer, Section::Meshes, is_allocated ? resource_count<Meshes>() : 0u, is_allocated ? Meshes::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (Meshes::UID mesh_ID : Meshes::get_iterable()) {
+        writer.write(mesh_ID.get_index());
+        write_mesh(writer, mesh_ID);
+    }
+}
+
+static void save_scene_roots(Core::BinaryWriter& writer) {
+    bool is_allocated = SceneRoots::is_allocated();
+    write_section_header(writer, Section::SceneRoots, is_allocated ? resource_count<SceneRoots>() : 0u, is_allocated ? SceneRoots::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (SceneRoots::UID scene_ID : SceneRoots::get_iterable()) {
+        writer.write(scene_ID.get_index());
+        writer.write(index_of<SceneNodes>(SceneRoots::get_root_node(scene_ID)));
+        writer.write(SceneRoots::get_environment_tint(scene_ID));
+
+        // The environment map is stored with the CDFs of its light, so the distribution isn't recomputed when loading.
+        const InfiniteAreaLight* environment_light = SceneRoots::get_environment_light(scene_ID);
+        writer.write(environment_light != nullptr);
+        if (environment_light != nullptr) {
+            writer.write(index_of<Textures>(environment_light->get_texture_ID()));
+            unsigned int width = environment_light->get_width(), height = environment_light->get_height();
+            writer.write(environment_light->image_integral());
+            writer.write_block(environment_light->get_image_marginal_CDF(), (height + 1) * sizeof(float));
+            writer.write_block(environment_light->get_image_conditional_CDF(), (width + 1) * height * sizeof(float));
+        }
+    }
+}
+
+static void save_scene_nodes(Core::BinaryWriter& writer) {
+    bool is_allocated = SceneNodes::is_allocated();
+    write_section_header(writer, Section::SceneNodes, is_allocated ? resource_count<SceneNodes>() : 0u, is_allocated ? SceneNodes::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (SceneNodes::UID node_ID : SceneNodes::get_iterable()) {
+        writer.write(node_ID.get_index());
+        writer.write_string(SceneNodes::get_name(node_ID));
+        writer.write(index_of<SceneNodes>(SceneNodes::get_parent_ID(node_ID)));
+        writer.write(SceneNodes::get_global_transform(node_ID));
+    }
+}
+
+static void save_mesh_models(Core::BinaryWriter& writer) {
+    bool is_allocated = MeshModels::is_allocated();
+    write_section_header(writer, Section::MeshModels, is_allocated ? resource_count<MeshModels>() : 0u, is_allocated ? MeshModels::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (MeshModels::UID model_ID : MeshModels::get_iterable()) {
+        writer.write(model_ID.get_index());
+        writer.write(index_of<SceneNodes>(MeshModels::get_scene_node_ID(model_ID)));
+        writer.write(index_of<Meshes>(MeshModels::get_mesh_ID(model_ID)));
+        writer.write(index_of<Materials>(MeshModels::get_material_ID(model_ID)));
+    }
+}
+
+static void save_light_sources(Core::BinaryWriter& writer) {
+    bool is_allocated = LightSources::is_allocated();
+    write_section_header(writer, Section::LightSources, is_allocated ? resource_count<LightSources>() : 0u, is_allocated ? LightSources::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (LightSources::UID light_ID : LightSources::get_iterable()) {
+        writer.write(light_ID.get_index());
+        write_light(writer, light_ID);
+    }
+}
+
+static void save_cameras(Core::BinaryWriter& writer) {
+    bool is_allocated = Cameras::is_allocated();
+    write_section_header(writer, Section::Cameras, is_allocated ? resource_count<Cameras>() : 0u, is_allocated ? Cameras::capacity() : 0u);
+    if (!is_allocated)
+        return;
+    for (Cameras::UID camera_ID : Cameras::get_iterable()) {
+        writer.write(camera_ID.get_index());
+        writer.write_string(Cameras::get_name(camera_ID));
+        writer.write(index_of<SceneRoots>(Cameras::get_scene_ID(camera_ID)));
+        writer.write(Cameras::get_transform(camera_ID));
+        writer.write(Cameras::get_projection_matrix(camera_ID));
+        writer.write(Cameras::get_inverse_projection_matrix(camera_ID));
+        writer.write(Cameras::get_z_index(camera_ID));
+        writer.write(Cameras::get_viewport(camera_ID));
+        writer.write(Cameras::get_effects_settings(camera_ID));
+    }
+}
+
+bool save(const std::string& path) {
+    Core::BinaryWriter writer = Core::BinaryWriter(path);
+    if (!writer.succeeded()) {
+        printf("Snapshot::save error: Could not open '%s' for writing.\n", path.c_str());
+        return false;
+    }
+
+    writer.write(create_header(MAGIC, VERSION));
+
+    // The scene nodes are saved with their global transforms, so deferred transforms are propagated first.
+    if (SceneNodes::is_allocated())
+        SceneNodes::propagate_transforms();
+
+    // Resources are saved before the resources referencing them.
+    save_images(writer);
+    save_textures(writer);
+    save_materials(writer);
+    save_meshes(writer);
+    // The scene roots reference their root nodes before the scene node section, so its capacity is stored up front.
+    writer.write(SceneNodes::is_allocated() ? SceneNodes::capacity() : 0u);
+    save_scene_roots(writer);
+    save_scene_nodes(writer);
+    save_mesh_models(writer);
+    save_light_sources(writer);
+    save_cameras(writer);
+    write_section_header(writer, Section::End, 0u, 0u);
+
+    if (!writer.succeeded()) {
+        printf("Snapshot::save error: Failed writing '%s'.\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Loading.
+// ------------------------------------------------------------------------------------------------
+
+// Copies the blocks from the mapped file into the resources. Large blocks are split into chunks,
+// so the page faults and copies of a few large blocks are spread across the threads as well.
+struct BlockCopy {
+    void* destination;
+    const void* source;
+    size_t byte_count;
+};
+
+static void copy_blocks(const std::vector<BlockCopy>& block_copies) {
+    const size_t CHUNK_SIZE = 4u << 20u;
+    std::vector<BlockCopy> chunk_copies;
+    for (const BlockCopy& block_copy : block_copies)
+        for (size_t offset = 0; offset < block_copy.byte_count; offset += CHUNK_SIZE) {
+            size_t byte_count = std::min(CHUNK_SIZE, block_copy.byte_count - offset);
+            chunk_copies.push_back({ (char*)block_copy.destination + offset, (const char*)block_copy.source + offset, byte_count });
+        }
+
+    Core::Parallel::for_each(0, (int)chunk_copies.size(), [&](int c) {
+        const BlockCopy& chunk_copy = chunk_copies[c];
+        memcpy(chunk_copy.destination, chunk_copy.source, chunk_copy.byte_count);
+    }, 1);
+}
+
+// The loaded resources indexed by their index in the snapshot.
+struct LoadedResources {
+    std::vector<Images::UID> image_IDs;
+    std::vector<Textures::UID> texture_IDs;
+    std::vector<Materials::UID> material_IDs;
+    std::vector<Meshes::UID> mesh_IDs;
+    std::vector<SceneRoots::UID> scene_IDs;
+    std::vector<SceneNodes::UID> node_IDs;
+
+    std::vector<BlockCopy> block_copies;
+};
+
+// Reads the section header and prepares the map from snapshot indices to loaded resources.
+// Fails if the section has resources and the manager isn't allocated.
+template <typename UID>
+static inline SectionHeader begin_section(Core::BinaryReader& reader, Section section, bool is_allocated, std::vector<UID>* loaded_IDs) {
+    SectionHeader header = read_section_header(reader, section);
+    if (header.resource_count > 0 && !is_allocated)
+        reader.fail();
+    if (loaded_IDs != nullptr && !reader.failed())
+        loaded_IDs->assign(header.capacity, UID::invalid_UID());
+    return header;
+}
+
+static void load_images(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section(reader, Section::Images, Images::is_allocated(), &resources.image_IDs);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        std::string name = reader.read_string();
+        PixelFormat format = reader.read<PixelFormat>();
+        float gamma = reader.read<float>();
+        Vector3ui size = reader.read<Vector3ui>();
+        unsigned int mipmap_count = reader.read<unsigned int>();
+        bool is_mipmapable = reader.read<bool>();
+        if (reader.failed() || size_of(format) == 0 || mipmap_count == 0)
+            return reader.fail();
+
+        Images::UID image_ID = Images::create3D(name, format, gamma, size, mipmap_count);
+        Images::set_mipmapable(image_ID, is_mipmapable);
+        resources.image_IDs[index] = image_ID;
+
+        size_t byte_count = get_pixel_bytes(image_ID);
+        const void* pixels = reader.read_block(byte_count);
+        if (pixels != nullptr)
+            resources.block_copies.push_back({ Images::get_pixels(image_ID), pixels, byte_count });
+    }
+}
+
+static void load_textures(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section(reader, Section::Textures, Textures::is_allocated(), &resources.texture_IDs);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        Images::UID image_ID = lookup(resources.image_IDs, reader.read<unsigned int>());
+        MagnificationFilter magnification_filter = reader.read<MagnificationFilter>();
+        MinificationFilter minification_filter = reader.read<MinificationFilter>();
+        WrapMode wrapmode_U = reader.read<WrapMode>();
+        WrapMode wrapmode_V = reader.read<WrapMode>();
+        if (!reader.failed())
+            resources.texture_IDs[index] = Textures::create2D(image_ID, magnification_filter, minification_filter, wrapmode_U, wrapmode_V);
+    }
+}
+
+static void load_materials(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section(reader, Section::Materials, Materials::is_allocated(), &resources.material_IDs);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        MaterialState material = read_material(reader, resources.texture_IDs);
+        if (!reader.failed())
+            resources.material_IDs[index] = Materials::create(material.name, material.data);
+    }
+}
+
+static void load_meshes(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section(reader, Section::Meshes, Meshes::is_allocated(), &resources.mesh_IDs);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        MeshHeader mesh_header = read_mesh_header(reader);
+        if (reader.failed())
+            return;
+
+        Meshes::UID mesh_ID = create_mesh(mesh_header);
+        resources.mesh_IDs[index] = mesh_ID;
+        for_each_mesh_block(mesh_ID, [&](void* destination, size_t byte_count) {
+            const void* source = reader.read_block(byte_count);
+            if (source != nullptr)
+                resources.block_copies.push_back({ destination, source, byte_count });
+        });
+    }
+}
+
+// Scene roots create their own root nodes, which are then reused when loading the scene nodes.
+static void load_scene_roots(Core::BinaryReader& reader, LoadedResources& resources, unsigned int scene_node_capacity) {
+    SectionHeader header = begin_section(reader, Section::SceneRoots, SceneRoots::is_allocated() && SceneNodes::is_allocated(), &resources.scene_IDs);
+    resources.node_IDs.assign(scene_node_capacity, SceneNodes::UID::invalid_UID());
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        unsigned int root_node_index = read_index(reader, scene_node_capacity);
+        RGB environment_tint = reader.read<RGB>();
+        bool has_environment_light = reader.read<bool>();
+        if (reader.failed())
+            return;
+
+        // The name of the scene is the name of its root node, which is set when loading the scene nodes.
+        SceneRoots::UID scene_ID = SceneRoots::create("", environment_tint);
+        resources.scene_IDs[index] = scene_ID;
+        resources.node_IDs[root_node_index] = SceneRoots::get_root_node(scene_ID);
+
+        if (has_environment_light) {
+            Textures::UID environment_map_ID = lookup(resources.texture_IDs, reader.read<unsigned int>());
+            if (!Textures::has(environment_map_ID))
+                return reader.fail();
+            Images::UID image_ID = Textures::get_image_ID(environment_map_ID);
+            unsigned int width = Images::get_width(image_ID), height = Images::get_height(image_ID);
+            float integral = reader.read<float>();
+            const float* marginal_CDF = (const float*)reader.read_block((height + 1) * sizeof(float));
+            const float* conditional_CDF = (const float*)reader.read_block((width + 1) * height * sizeof(float));
+            if (!reader.failed())
+                SceneRoots::set_environment_light(scene_ID, new InfiniteAreaLight(environment_map_ID, marginal_CDF, conditional_CDF, integral));
+        }
+    }
+}
+
+static void load_scene_nodes(Core::BinaryReader& reader, LoadedResources& resources) {
+    // The scene node capacity is read ahead of the scene roots, so this only validates the section.
+    SectionHeader header = begin_section<SceneNodes::UID>(reader, Section::SceneNodes, SceneNodes::is_allocated(), nullptr);
+    if (header.capacity != resources.node_IDs.size())
+        reader.fail();
+
+    // Create the nodes with their global transforms and connect them once all nodes exist.
+    std::vector<std::pair<SceneNodes::UID, unsigned int>> node_parent_indices;
+    node_parent_indices.reserve(header.resource_count);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        unsigned int index = read_index(reader, header.capacity);
+        std::string name = reader.read_string();
+        unsigned int parent_index = read_index(reader, header.capacity);
+        Transform global_transform = reader.read<Transform>();
+        if (reader.failed())
+            return;
+
+        SceneNodes::UID node_ID = resources.node_IDs[index];
+        if (node_ID == SceneNodes::UID::invalid_UID()) {
+            node_ID = SceneNodes::create(name, global_transform);
+            resources.node_IDs[index] = node_ID;
+        } else {
+            // Root node created by a scene root.
+            SceneNodes::set_name(node_ID, name);
+            SceneNodes::set_global_transform(node_ID, global_transform);
+        }
+        node_parent_indices.emplace_back(node_ID, parent_index);
+    }
+
+    for (auto [node_ID, parent_index] : node_parent_indices)
+        if (parent_index != 0u)
+            SceneNodes::set_parent(node_ID, resources.node_IDs[parent_index]);
+}
+
+static void load_mesh_models(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section<MeshModels::UID>(reader, Section::MeshModels, MeshModels::is_allocated(), nullptr);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        read_index(reader, header.capacity);
+        SceneNodes::UID node_ID = lookup(resources.node_IDs, reader.read<unsigned int>());
+        Meshes::UID mesh_ID = lookup(resources.mesh_IDs, reader.read<unsigned int>());
+        Materials::UID material_ID = lookup(resources.material_IDs, reader.read<unsigned int>());
+        if (!reader.failed())
+            MeshModels::create(node_ID, mesh_ID, material_ID);
+    }
+}
+
+static void load_light_sources(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section<LightSources::UID>(reader, Section::LightSources, LightSources::is_allocated(), nullptr);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        read_index(reader, header.capacity);
+        LightState light = read_light(reader, resources.node_IDs);
+        if (!reader.failed())
+            create_light(light);
+    }
+}
+
+static void load_cameras(Core::BinaryReader& reader, LoadedResources& resources) {
+    SectionHeader header = begin_section<Cameras::UID>(reader, Section::Cameras, Cameras::is_allocated(), nullptr);
+    for (unsigned int i = 0; i < header.resource_count && !reader.failed(); ++i) {
+        read_index(reader, header.capacity);
+        std::string name = reader.read_string();
+        SceneRoots::UID scene_ID = lookup(resources.scene_IDs, reader.read<unsigned int>());
+        Transform transform = reader.read<Transform>();
+        Matrix4x4f projection_matrix = reader.read<Matrix4x4f>();
+        Matrix4x4f inverse_projection_matrix = reader.read<Matrix4x4f>();
+        int z_index = reader.read<int>();
+        Rectf viewport = reader.read<Rectf>();
+        CameraEffects::Settings effects_settings = reader.read<CameraEffects::Settings>();
+        if (reader.failed())
+            return;
+
+        Cameras::UID camera_ID = Cameras::create(name, scene_ID, projection_matrix, inverse_projection_matrix);
+        if (camera_ID == Cameras::UID::invalid_UID())
+            continue;
+        Cameras::set_transform(camera_ID, transform);
+        Cameras::set_z_index(camera_ID, z_index);
+        Cameras::set_viewport(camera_ID, viewport);
+        Cameras::set_effects_settings(camera_ID, effects_settings);
+    }
+}
+
+bool load(const std::string& path) {
+    Core::MemoryMappedFile file = Core::MemoryMappedFile(path);
+    if (!file.is_open()) {
+        printf("Snapshot::load error: Could not map '%s'.\n", path.c_str());
+        return false;
+    }
+
+    Core::BinaryReader reader = Core::BinaryReader(file.data(), file.size());
+    Header header = reader.read<Header>();
+    if (reader.failed() || !has_magic(header, MAGIC)) {
+        printf("Snapshot::load error: '%s' is not a snapshot.\n", path.c_str());
+        return false;
+    }
+    if (!is_native(header, VERSION)) {
+        printf("Snapshot::load error: '%s' is version %u for %u bit builds. Expected version %u for %u bit builds.\n",
+               path.c_str(), header.version, header.pointer_size * 8, VERSION, unsigned(sizeof(void*) * 8));
+        return false;
+    }
+
+    LoadedResources resources;
+    load_images(reader, resources);
+    load_textures(reader, resources);
+    load_materials(reader, resources);
+    load_meshes(reader, resources);
+    unsigned int scene_node_capacity = reader.read<unsigned int>();
+    load_scene_roots(reader, resources, scene_node_capacity);
+    load_scene_nodes(reader, resources);
+    load_mesh_models(reader, resources);
+    load_light_sources(reader, resources);
+    load_cameras(reader, resources);
+    read_section_header(reader, Section::End);
+
+    copy_blocks(resources.block_copies);
+
+    if (reader.failed()) {
+        printf("Snapshot::load error: '%s' is truncated or references managers that are not allocated.\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // NS Bifrost::Scene::Snapshot
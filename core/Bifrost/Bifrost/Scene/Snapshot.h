@@ -0,0 +1,47 @@
+// Bifrost binary snapshot of the datamodel.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SNAPSHOT_H_
+#define _BIFROST_SCENE_SNAPSHOT_H_
+
+#include <string>
+
+namespace Bifrost::Scene {
+
+// ------------------------------------------------------------------------------------------------
+// Versioned binary snapshot of the resources in all the managers: Images, Textures, Materials,
+// Meshes, SceneRoots, SceneNodes, MeshModels, LightSources and Cameras.
+// Pixels, mesh buffers and the CDFs of environment lights are stored as raw, 64 byte aligned blocks,
+// so loading maps the file into memory and copies the blocks directly into the new resources
+// instead of decoding images and recomputing normals and distributions.
+// The blocks are stored in the native memory layout and snapshots are therefore only intended
+// to be loaded by builds for the same architecture, fx as a cache of a scene loaded from its sources.
+// Loading creates new resources next to the existing ones and remaps the references between them.
+// Future work
+// * Adopt the mapped blocks as resource buffers instead of copying them.
+// * Store renderer specific camera state.
+// ------------------------------------------------------------------------------------------------
+namespace Snapshot {
+
+static const unsigned int VERSION = 2u;
+
+// Writes all resources in the allocated managers to the file. Returns false if the file couldn't be written.
+// Pending scene node transforms are propagated before saving.
+bool save(const std::string& path);
+
+// Loads the resources in the snapshot into the allocated managers.
+// Returns false if the file couldn't be mapped or isn't a snapshot of the current version.
+// A snapshot that is truncated or references managers that are not allocated is loaded up to the
+// first invalid resource.
+bool load(const std::string& path);
+
+} // NS Snapshot
+
+} // NS Bifrost::Scene
+
+#endif // _BIFROST_SCENE_SNAPSHOT_H_
@@ -11,6 +11,7 @@
 #include "Dx11Renderer/Utils.h"
 
 #include "Bifrost/Assets/InfiniteAreaLight.h"
+#include "Bifrost/Core/Parallel.h"
 #include "Bifrost/Math/RNG.h"
 #include "Bifrost/Scene/SceneRoot.h"
 
@@ -202,9 +203,9 @@ void EnvironmentManager::handle_updates(ID3D11Device1& device, ID3D11DeviceConte
                             sample_buffer_desc.StructureByteStride = sizeof(LightSample);
 
                             LightSample* light_samples = new LightSample[light_sample_count];
-                            #pragma omp parallel for schedule(dynamic, 16)
-                            for (int i = 0; i < light_sample_count; ++i)
+                            Bifrost::Core::Parallel::for_each(0, light_sample_count, [&](int i) {
                                 light_samples[i] = light.sample(RNG::sample02(i));
+                            }, 16);
 
                             D3D11_SUBRESOURCE_DATA sample_resource_data = {};
                             sample_resource_data.pSysMem = light_samples;
@@ -234,13 +235,12 @@ void EnvironmentManager::handle_updates(ID3D11Device1& device, ID3D11DeviceConte
                         THROW_DX11_ERROR(device.CreateTexture2D(&tex_desc, nullptr, &env.texture2D));
 
                         R11G11B10_Float* pixels = new R11G11B10_Float[env_width* env_height];
-                        #pragma omp parallel for schedule(dynamic, 16)
-                        for (int i = 0; i < env_width * env_height; ++i) {
+                        Bifrost::Core::Parallel::for_each(0, env_width * env_height, [&](int i) {
                             int x = i % env_width, y = i / env_width;
                             Vector2f uv = Vector2f((x + 0.5f) / env_width, (y + 0.5f) / env_height);
                             RGB c = sample2D(light.get_texture_ID(), uv).rgb();
                             pixels[x + y * env_width] = R11G11B10_Float(c.r, c.g, c.b);
-                        }
+                        }, 16);
 
                         device_context.UpdateSubresource(env.texture2D, 0, nullptr, pixels, sizeof(R11G11B10_Float) * env_width, 0);
                         delete[] pixels;
@@ -18,6 +18,8 @@
 #include <Bifrost/Assets/Mesh.h>
 #include <Bifrost/Assets/MeshModel.h>
 #include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Core/Profiler.h>
 #include <Bifrost/Core/Window.h>
 #include <Bifrost/Math/OctahedralNormal.h>
 #include <Bifrost/Scene/Camera.h>
@@ -743,11 +745,28 @@ public:
     }
 
     void handle_updates() {
-        m_environments->handle_updates(m_device, *m_render_context);
-        m_lights.manager.handle_updates(*m_render_context);
-        m_materials.handle_updates(m_device, *m_render_context);
-        m_textures.handle_updates(m_device, *m_render_context);
-        m_transforms.handle_updates(m_device, *m_render_context);
+        BIFROST_PROFILE_SCOPE("DX11Renderer::handle_updates");
+
+        {
+            BIFROST_PROFILE_SCOPE("DX11Renderer environment updates");
+            m_environments->handle_updates(m_device, *m_render_context);
+        }
+        {
+            BIFROST_PROFILE_SCOPE("DX11Renderer light updates");
+            m_lights.manager.handle_updates(*m_render_context);
+        }
+        {
+            BIFROST_PROFILE_SCOPE("DX11Renderer material updates");
+            m_materials.handle_updates(m_device, *m_render_context);
+        }
+        {
+            BIFROST_PROFILE_SCOPE("DX11Renderer texture updates");
+            m_textures.handle_updates(m_device, *m_render_context);
+        }
+        {
+            BIFROST_PROFILE_SCOPE("DX11Renderer transform updates");
+            m_transforms.handle_updates(m_device, *m_render_context);
+        }
 
         { // Camera updates.
             for (Cameras::UID cam_ID : Cameras::get_changed_cameras())
@@ -780,7 +799,8 @@ public:
                     // Expand the indexed buffers if an index buffer is used, but no normals are given.
                     // In that case we need to compute hard normals per triangle and we can only store that for non-indexed buffers.
                     // NOTE Alternatively look into storing the hard normals in a buffer and index into it based on the triangle ID?
-                    bool expand_indexed_buffers = mesh.get_primitive_count() != 0 && mesh.get_normals() == nullptr;
+                    MeshFlags mesh_flags = mesh.get_flags();
+                    bool expand_indexed_buffers = mesh.get_primitive_count() != 0 && !mesh_flags.is_set(MeshFlag::Normal);
 
                     if (!expand_indexed_buffers) { // Upload indices.
                         dx_mesh.index_count = mesh.get_index_count();
@@ -792,18 +812,26 @@ public:
                     }
 
                     dx_mesh.vertex_count = mesh.get_vertex_count();
-                    Vector3f* positions = mesh.get_positions();
+
+                    // Compressed vertex buffers are decoded before upload.
+                    std::vector<Vector3f> decoded_positions;
+                    Vector3f* vertex_positions = mesh.get_positions();
+                    if (vertex_positions == nullptr) {
+                        decoded_positions.resize(mesh.get_vertex_count());
+                        Meshes::decode_positions(mesh_ID, 0, mesh.get_vertex_count(), decoded_positions.data());
+                        vertex_positions = decoded_positions.data();
+                    }
+                    Vector3f* positions = vertex_positions;
 
                     if (expand_indexed_buffers) {
                         // Expand the positions.
                         dx_mesh.vertex_count = mesh.get_index_count();
-                        positions = MeshUtils::expand_indexed_buffer(mesh.get_primitives(), mesh.get_primitive_count(), mesh.get_positions());
+                        positions = MeshUtils::expand_indexed_buffer(mesh.get_primitives(), mesh.get_primitive_count(), vertex_positions);
                     }
 
                     { // Upload geometry.
-                        auto create_vertex_geometry = [](Vector3f p, Vector3f n) -> Dx11VertexGeometry {
+                        auto create_vertex_geometry = [](Vector3f p, OctahedralNormal encoded_normal) -> Dx11VertexGeometry {
                             float3 dx_p = { p.x, p.y, p.z };
-                            OctahedralNormal encoded_normal = OctahedralNormal::encode_precise(n);
                             int2 dx_normal = { encoded_normal.encoding.x, encoded_normal.encoding.y };
                             int packed_dx_normal = (dx_normal.x - SHRT_MIN) | (dx_normal.y << 16);
                             Dx11VertexGeometry geometry = { dx_p, packed_dx_normal };
@@ -811,23 +839,29 @@ public:
                         };
 
                         Vector3f* normals = mesh.get_normals();
+                        OctahedralNormal* octahedral_normals = mesh.get_octahedral_normals();
 
                         Dx11VertexGeometry* geometry = new Dx11VertexGeometry[dx_mesh.vertex_count];
-                        if (normals == nullptr) {
+                        if (normals == nullptr && octahedral_normals == nullptr) {
                             // Compute hard normals. Positions have already been expanded if there is an index buffer.
-                            #pragma omp parallel for
-                            for (int i = 0; i < int(dx_mesh.vertex_count); i += 3) {
+                            Parallel::for_each(0, int(dx_mesh.vertex_count) / 3, [&](int t) {
+                                int i = t * 3;
                                 Vector3f p0 = positions[i], p1 = positions[i + 1], p2 = positions[i+2];
-                                Vector3f normal = normalize(cross(p1 - p0, p2 - p0));
+                                OctahedralNormal normal = OctahedralNormal::encode_precise(normalize(cross(p1 - p0, p2 - p0)));
                                 geometry[i] = create_vertex_geometry(p0, normal);
                                 geometry[i+1] = create_vertex_geometry(p1, normal);
                                 geometry[i+2] = create_vertex_geometry(p2, normal);
-                            }
+                            });
+                        } else if (octahedral_normals != nullptr) {
+                            // Octahedral encoded normals are used as is.
+                            Parallel::for_each(0, int(dx_mesh.vertex_count), [&](int i) {
+                                geometry[i] = create_vertex_geometry(positions[i], octahedral_normals[i]);
+                            });
                         } else {
                             // Copy position and normal.
-                            #pragma omp parallel for
-                            for (int i = 0; i < int(dx_mesh.vertex_count); ++i)
-                                geometry[i] = create_vertex_geometry(positions[i], normals[i]);
+                            Parallel::for_each(0, int(dx_mesh.vertex_count), [&](int i) {
+                                geometry[i] = create_vertex_geometry(positions[i], OctahedralNormal::encode_precise(normals[i]));
+                            });
                         }
 
                         HRESULT hr = upload_default_buffer(geometry, dx_mesh.vertex_count, D3D11_BIND_VERTEX_BUFFER,
@@ -839,28 +873,35 @@ public:
                     }
 
                     // Delete temporary expanded positions.
-                    if (positions != mesh.get_positions())
+                    if (positions != vertex_positions)
                         delete[] positions;
 
+                    bool has_texcoords = mesh_flags.is_set(MeshFlag::Texcoord);
                     { // Upload texcoords if present, otherwise upload 'null buffer'.
-                        Vector2f* texcoords = mesh.get_texcoords();
-                        if (texcoords != nullptr) {
+                        if (has_texcoords) {
+                            std::vector<Vector2f> decoded_texcoords;
+                            Vector2f* vertex_texcoords = mesh.get_texcoords();
+                            if (vertex_texcoords == nullptr) {
+                                decoded_texcoords.resize(mesh.get_vertex_count());
+                                Meshes::decode_texcoords(mesh_ID, 0, mesh.get_vertex_count(), decoded_texcoords.data());
+                                vertex_texcoords = decoded_texcoords.data();
+                            }
 
+                            Vector2f* texcoords = vertex_texcoords;
                             if (expand_indexed_buffers)
-                                texcoords = MeshUtils::expand_indexed_buffer(mesh.get_primitives(), mesh.get_primitive_count(), texcoords);
+                                texcoords = MeshUtils::expand_indexed_buffer(mesh.get_primitives(), mesh.get_primitive_count(), vertex_texcoords);
 
                             HRESULT hr = upload_default_buffer(texcoords, dx_mesh.vertex_count, D3D11_BIND_VERTEX_BUFFER,
                                                                dx_mesh.texcoords_address());
                             if (FAILED(hr))
                                 printf("Could not upload %s's texcoord buffer.\n", mesh.get_name().c_str());
 
-                            if (texcoords != mesh.get_texcoords())
+                            if (texcoords != vertex_texcoords)
                                 delete[] texcoords;
                         } else
                             *dx_mesh.texcoords_address() = m_vertex_shading.null_buffer;
                     }
 
-                    bool has_texcoords = mesh.get_texcoords() != nullptr;
                     dx_mesh.buffer_count = has_texcoords ? 2 : 1;
 
                     m_meshes[mesh_ID] = dx_mesh;
@@ -925,8 +966,8 @@ public:
                         int sorted_models_end = m_cutout.first_model_index = m_transparent.first_model_index =
                             (int)m_sorted_models.size();
 
-                        #pragma omp parallel for
-                        for (int i = 1; i < m_sorted_models.size(); ++i) {
+                        // Each bucket transition occurs at most once in the sorted list, so the bucket indices are written by at most one iteration each.
+                        Parallel::for_each(1, (int)m_sorted_models.size(), [&](int i) {
                             Dx11Model& model = m_sorted_models[i];
                             m_model_indices[model.model_ID] = i;
 
@@ -939,7 +980,7 @@ public:
                                 if (!prevModel.is_destroyed() && model.is_destroyed())
                                     sorted_models_end = i;
                             }
-                        }
+                        });
 
                         // Correct indices in case no bucket transition was found.
                         if (m_transparent.first_model_index > sorted_models_end)
@@ -0,0 +1,237 @@
+// Bifrost headless main.
+// ----------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ----------------------------------------------------------------------------
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#undef RGB
+#endif // _WIN32
+
+#include <HeadlessDriver.h>
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Scene/SceneRoot.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace Bifrost::Assets;
+using namespace Bifrost::Scene;
+using Bifrost::Core::Engine;
+
+static volatile std::sig_atomic_t g_received_signal = 0;
+
+static void signal_handler(int signal) {
+    g_received_signal = signal;
+}
+
+// The data directory is placed next to the directory containing the executable, same as for the other drivers.
+static std::filesystem::path get_data_path() {
+#if defined(_WIN32)
+    char exepath[512];
+    GetModuleFileName(nullptr, exepath, 512);
+    std::filesystem::path executable_path = exepath;
+#else
+    std::error_code error;
+    std::filesystem::path executable_path = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error)
+        return "Data";
+#endif
+    return executable_path.parent_path().parent_path() / "Data";
+}
+
+static bool has_changes(Engine& engine) {
+    return engine.get_window().has_changes() ||
+        !Cameras::get_changed_cameras().is_empty() ||
+        !Images::get_changed_images().is_empty() ||
+        !LightSources::get_changed_lights().is_empty() ||
+        !Materials::get_changed_materials().is_empty() ||
+        !Meshes::get_changed_meshes().is_empty() ||
+        !MeshModels::get_changed_models().is_empty() ||
+        !SceneNodes::get_changed_nodes().is_empty() ||
+        !SceneRoots::get_changed_scenes().is_empty() ||
+        !Textures::get_changed_textures().is_empty();
+}
+
+namespace HeadlessDriver {
+
+// ----------------------------------------------------------------------------
+// Argument parsing.
+// ----------------------------------------------------------------------------
+
+static const char* get_argument_value(const char* arg, const char* name) {
+    size_t name_length = strlen(name);
+    if (strncmp(arg, name, name_length) == 0 && arg[name_length] == '=')
+        return arg + name_length + 1;
+    return nullptr;
+}
+
+static bool parse_unsigned_int(const char* str, unsigned int& value) {
+    char* end;
+    unsigned long parsed_value = strtoul(str, &end, 10);
+    if (end == str || *end != 0 || str[0] == '-')
+        return false;
+    value = (unsigned int)parsed_value;
+    return true;
+}
+
+static bool parse_non_negative_double(const char* str, double& value) {
+    char* end;
+    double parsed_value = strtod(str, &end);
+    if (end == str || *end != 0 || !(parsed_value >= 0.0))
+        return false;
+    value = parsed_value;
+    return true;
+}
+
+static bool parse_argument(const char* arg, Options& options, bool& is_driver_argument) {
+    is_driver_argument = true;
+    const char* value;
+    if ((value = get_argument_value(arg, "--ticks-per-second")))
+        return parse_non_negative_double(value, options.ticks_per_second);
+    else if ((value = get_argument_value(arg, "--fixed-delta-time")))
+        return parse_non_negative_double(value, options.fixed_delta_time);
+    else if ((value = get_argument_value(arg, "--max-ticks")))
+        return parse_unsigned_int(value, options.max_tick_count);
+    else if ((value = get_argument_value(arg, "--quit-on-idle")))
+        return parse_unsigned_int(value, options.quit_on_idle_tick_count);
+    else if ((value = get_argument_value(arg, "--resolution"))) {
+        int width, height;
+        char trailing;
+        if (sscanf(value, "%dx%d%c", &width, &height, &trailing) != 2 || width <= 0 || height <= 0)
+            return false;
+        options.window_width = width;
+        options.window_height = height;
+        return true;
+    } else if ((value = get_argument_value(arg, "--data-directory"))) {
+        options.data_directory = value;
+        return true;
+    }
+
+    is_driver_argument = false;
+    return true;
+}
+
+bool parse_arguments(int& argc, char** argv, Options& options) {
+    int remaining_argc = argc > 0 ? 1 : 0; // Keep the executable name.
+    for (int i = remaining_argc; i < argc; ++i) {
+        bool is_driver_argument;
+        if (!parse_argument(argv[i], options, is_driver_argument)) {
+            fprintf(stderr, "HeadlessDriver: Invalid argument '%s'.\n", argv[i]);
+            return false;
+        }
+        if (!is_driver_argument)
+            argv[remaining_argc++] = argv[i];
+    }
+
+    if (remaining_argc < argc)
+        argv[remaining_argc] = nullptr;
+    argc = remaining_argc;
+    return true;
+}
+
+void print_usage() {
+    const char* usage =
+        "Headless driver options:\n"
+        "  --ticks-per-second=<ticks>: Tick rate. 0 ticks as fast as possible. Default 0.\n"
+        "  --fixed-delta-time=<seconds>: Advance time by a fixed delta every tick. 0 uses wall clock time. Default 0.\n"
+        "  --max-ticks=<count>: Quit after the given number of ticks. 0 disables the limit. Default 0.\n"
+        "  --quit-on-idle=<count>: Quit after the given number of consecutive ticks without changes. 0 disables it. Default 0.\n"
+        "  --resolution=<width>x<height>: Size of the engine window.\n"
+        "  --data-directory=<path>: Data directory passed to the engine.\n";
+    printf("%s", usage);
+}
+
+// ----------------------------------------------------------------------------
+// Engine loop.
+// ----------------------------------------------------------------------------
+
+int run(OnLaunchCallback on_launch, OnQuitCallback on_quit, const Options& options) {
+    using namespace std::chrono;
+
+    std::filesystem::path data_path = options.data_directory.empty() ? get_data_path() : options.data_directory;
+    Engine engine(data_path);
+    if (options.window_width > 0 && options.window_height > 0)
+        engine.get_window().resize(options.window_width, options.window_height);
+
+    if (on_launch != nullptr) {
+        int error_code = on_launch(engine);
+        if (error_code != 0)
+            return error_code;
+    }
+
+    // Registered after the application's callbacks and reading all managers,
+    // so it observes all changes made during the tick before they are reset in tick cleanup.
+    bool tick_had_changes = false;
+    if (options.quit_on_idle_tick_count > 0)
+        engine.add_non_mutating_callback("Idle detection", [&]() { tick_had_changes = has_changes(engine); }, Engine::Manager::All, Engine::Manager::None);
+
+    g_received_signal = 0;
+    auto previous_sigint_handler = std::signal(SIGINT, signal_handler);
+    auto previous_sigterm_handler = std::signal(SIGTERM, signal_handler);
+
+    bool is_rate_limited = options.ticks_per_second > 0.0;
+    auto tick_duration = is_rate_limited ? duration_cast<steady_clock::duration>(duration<double>(1.0 / options.ticks_per_second)) : steady_clock::duration::zero();
+    auto previous_time = steady_clock::now();
+    auto next_tick_time = previous_time;
+    unsigned int tick_count = 0;
+    unsigned int idle_tick_count = 0;
+
+    while (!engine.is_quit_requested() && g_received_signal == 0) {
+        if (is_rate_limited) {
+            std::this_thread::sleep_until(next_tick_time);
+            // Schedule from the previous deadline to avoid drift, unless we fell more than a tick behind.
+            auto now = steady_clock::now();
+            next_tick_time = next_tick_time + tick_duration < now ? now + tick_duration : next_tick_time + tick_duration;
+        }
+
+        auto current_time = steady_clock::now();
+        double delta_time = options.fixed_delta_time > 0.0 ? options.fixed_delta_time : duration<double>(current_time - previous_time).count();
+        previous_time = current_time;
+
+        engine.do_tick(delta_time);
+        ++tick_count;
+
+        if (options.max_tick_count > 0 && tick_count >= options.max_tick_count)
+            break;
+
+        if (options.quit_on_idle_tick_count > 0) {
+            idle_tick_count = tick_had_changes ? 0 : idle_tick_count + 1;
+            if (idle_tick_count >= options.quit_on_idle_tick_count)
+                break;
+        }
+    }
+
+    std::signal(SIGINT, previous_sigint_handler);
+    std::signal(SIGTERM, previous_sigterm_handler);
+
+    int exit_code = EXIT_SUCCESS;
+    if (on_quit != nullptr)
+        exit_code = on_quit(engine);
+
+    // Report interrupted runs as failed, using the shell convention for termination by a signal.
+    if (g_received_signal != 0)
+        exit_code = 128 + g_received_signal;
+
+    return exit_code;
+}
+
+} // NS HeadlessDriver
@@ -0,0 +1,65 @@
+// Bifrost headless main.
+// ----------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ----------------------------------------------------------------------------
+
+#ifndef _BIFROST_HEADLESS_DRIVER_H_
+#define _BIFROST_HEADLESS_DRIVER_H_
+
+#include <filesystem>
+
+//----------------------------------------------------------------------------
+// Forward declerations
+//----------------------------------------------------------------------------
+namespace Bifrost {
+namespace Core {
+class Engine;
+}
+}
+
+// ----------------------------------------------------------------------------
+// Drives the engine without a window, keyboard or mouse, e.g. for batch jobs,
+// benchmarks and dataset generation on machines without a display.
+// The engine window is never shown, but its size is still used by renderers
+// as the output resolution.
+// The loop stops when the engine requests a quit, when the max tick count is
+// reached, when the scene has been idle for the given number of ticks or when
+// the process receives SIGINT or SIGTERM.
+// ----------------------------------------------------------------------------
+namespace HeadlessDriver {
+
+typedef int (*OnLaunchCallback)(Bifrost::Core::Engine&);
+// Called after the last tick. The returned value is used as the exit code.
+typedef int (*OnQuitCallback)(Bifrost::Core::Engine&);
+
+struct Options {
+    // Ticks pr second. Zero ticks as fast as possible.
+    double ticks_per_second = 0.0;
+    // If positive, every tick advances time by this delta instead of the elapsed wall clock time,
+    // making runs deterministic.
+    double fixed_delta_time = 0.0;
+    // Quit after this many ticks. Zero never quits due to the tick count.
+    unsigned int max_tick_count = 0;
+    // Quit after this many consecutive ticks without any changes to the scene, assets or window.
+    // Zero disables quitting on idle.
+    unsigned int quit_on_idle_tick_count = 0;
+    // Size of the engine window. Zero keeps the engine's default size.
+    int window_width = 0;
+    int window_height = 0;
+    // Data directory passed to the engine. Empty uses the Data directory next to the executable's directory.
+    std::filesystem::path data_directory;
+};
+
+// Parses and removes the driver's arguments from argv, leaving the remaining arguments for the application.
+// Returns false and prints an error if a driver argument is malformed.
+bool parse_arguments(int& argc, char** argv, Options& options);
+void print_usage();
+
+int run(OnLaunchCallback on_launch, OnQuitCallback on_quit, const Options& options);
+
+} // NS HeadlessDriver
+
+#endif // _BIFROST_HEADLESS_DRIVER_H_
@@ -10,6 +10,7 @@
 #define _IMAGE_OPERATIONS_BLUR_H_
 
 #include <Bifrost/Assets/Image.h>
+#include <Bifrost/Core/Parallel.h>
 
 namespace ImageOperations {
 namespace Blur {
@@ -19,6 +20,7 @@ namespace Blur {
 // ------------------------------------------------------------------------------------------------
 
 inline void gaussian(Bifrost::Assets::Images::UID image_ID, float std_dev, Bifrost::Assets::Images::UID result_ID) {
+    using namespace Bifrost;
     using namespace Bifrost::Assets;
     using namespace Bifrost::Math;
 
@@ -53,30 +55,28 @@ inline void gaussian(Bifrost::Assets::Images::UID image_ID, float std_dev, Bifro
     
     // Filter x
     if (size.x > 1) {
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int i = 0; i < pixel_count; ++i) {
+        Core::Parallel::for_each(0, pixel_count, [&](int i) {
             int min_index = (i / size.x) * size.x;
             pong[i] = filter(ping, i, 1, min_index, min_index + size.x);
-        }
+        });
         std::swap(ping, pong);
     }
 
     // Filter y
     if (size.y > 1) {
         int range = size.x * size.y;
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int i = 0; i < pixel_count; ++i) {
+        Core::Parallel::for_each(0, pixel_count, [&](int i) {
             int min_index = (i / range) * range;
             pong[i] = filter(ping, i, size.x, min_index, min_index + range);
-        }
+        });
         std::swap(ping, pong);
     }
     
     // Filter z TODO Optimize by storing directly in result.
     if (size.z > 1) {
-        #pragma omp parallel for schedule(dynamic, 16)
-        for (int i = 0; i < pixel_count; ++i)
+        Core::Parallel::for_each(0, pixel_count, [&](int i) {
             pong[i] = filter(ping, i, size.x * size.y, 0, pixel_count);
+        });
         std::swap(ping, pong);
     }
 
@@ -14,6 +14,7 @@
 #include <Bifrost/Assets/Mesh.h>
 #include <Bifrost/Assets/MeshModel.h>
 #include <Bifrost/Core/Array.h>
+#include <Bifrost/Core/Profiler.h>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <ObjLoader/tiny_obj_loader.h>
@@ -48,7 +49,9 @@ void split_path(std::string& directory, std::string& filename, const std::string
     }
 }
 
-SceneNodes::UID load(const std::string& path, ImageLoader image_loader) {
+SceneNodes::UID load(const std::string& path, ImageLoader image_loader, bool optimize_meshes) {
+    BIFROST_PROFILE_SCOPE("ObjLoader::load");
+
     std::string directory, filename;
     split_path(directory, filename, path);
 
@@ -58,7 +61,11 @@ SceneNodes::UID load(const std::string& path, ImageLoader image_loader) {
     std::string warning;
     std::string error;
 
-    bool obj_loaded = tinyobj::LoadObj(&attributes, &shapes, &tiny_materials, &warning, &error, path.c_str(), directory.c_str());
+    bool obj_loaded;
+    {
+        BIFROST_PROFILE_SCOPE("ObjLoader::load parse");
+        obj_loaded = tinyobj::LoadObj(&attributes, &shapes, &tiny_materials, &warning, &error, path.c_str(), directory.c_str());
+    }
 
     if (!warning.empty())
         printf("ObjLoader::load warning: '%s'.\n", warning.c_str());
@@ -230,6 +237,10 @@ SceneNodes::UID load(const std::string& path, ImageLoader image_loader) {
         }
 
         bifrost_mesh.compute_bounds();
+        if (optimize_meshes) {
+            MeshUtils::optimize_vertex_cache(bifrost_mesh.get_ID());
+            MeshUtils::optimize_vertex_fetch(bifrost_mesh.get_ID());
+        }
 
         SceneNodes::UID node_ID = SceneNodes::create(shape.name);
         if (root_ID != SceneNodes::UID::invalid_UID())
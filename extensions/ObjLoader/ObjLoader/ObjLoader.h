@@ -19,11 +19,13 @@ typedef Bifrost::Assets::Images::UID (*ImageLoader)(const std::string& filename)
 
 // -----------------------------------------------------------------------
 // Loads an obj file.
+// If optimize_meshes is set, the meshes' triangles and vertices are reordered for vertex cache and
+// vertex fetch efficiency with MeshUtils::optimize_vertex_cache and MeshUtils::optimize_vertex_fetch.
 // Future work:
 // * Return an (optional) list of created mesh model IDs?
 // * Reserve capacity for Mesh, MeshModels and SceneNodes before creating them.
 // -----------------------------------------------------------------------
-Bifrost::Scene::SceneNodes::UID load(const std::string& filename, ImageLoader image_loader);
+Bifrost::Scene::SceneNodes::UID load(const std::string& filename, ImageLoader image_loader, bool optimize_meshes = false);
 
 bool file_supported(const std::string& filename);
 
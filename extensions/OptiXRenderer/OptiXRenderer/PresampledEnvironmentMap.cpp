@@ -9,6 +9,7 @@
 #include <OptiXRenderer/PresampledEnvironmentMap.h>
 
 #include <Bifrost/Assets/InfiniteAreaLight.h>
+#include <Bifrost/Core/Parallel.h>
 #include <Bifrost/Math/RNG.h>
 
 using namespace Bifrost;
@@ -67,8 +68,7 @@ PresampledEnvironmentMap::PresampledEnvironmentMap(Context& context, const Asset
         if (disable_importance_sampling) {
             samples_data[0] = LightSample::none();
         } else {
-            #pragma omp parallel for schedule(dynamic, 16)
-            for (int i = 0; i < sample_count; ++i) {
+            Core::Parallel::for_each(0, sample_count, [&](int i) {
                 // RNG::sample02 is correlated with the seeding strategy in the path tracer (hash ^ brev(accumulation).
                 // To avoid this, and keep the drawing the nicely distributed samples that sample02 gives us,
                 // we change the order in which the samples are drawn by reversing the bit pattern.
@@ -78,7 +78,7 @@ PresampledEnvironmentMap::PresampledEnvironmentMap(Context& context, const Asset
                 samples_data[i].PDF = sample.PDF;
                 samples_data[i].direction_to_light = { sample.direction_to_light.x, sample.direction_to_light.y, sample.direction_to_light.z };
                 samples_data[i].distance = sample.distance;
-            }
+            }, 16);
         }
         m_samples->unmap();
         OPTIX_VALIDATE(m_samples);
@@ -21,6 +21,7 @@
 #include <Bifrost/Assets/Texture.h>
 #include <Bifrost/Core/Array.h>
 #include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/Profiler.h>
 #include <Bifrost/Math/OctahedralNormal.h>
 #include <Bifrost/Scene/Camera.h>
 #include <Bifrost/Scene/LightSource.h>
@@ -94,20 +95,31 @@ static inline optix::GeometryTriangles load_mesh(optix::Context& context, Meshes
     optix::Buffer geometry_buffer = context->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, vertex_count);
     geometry_buffer->setElementSize(sizeof(VertexGeometry));
     VertexGeometry* mapped_geometry = (VertexGeometry*)geometry_buffer->map();
+    bool has_normals = mesh.get_flags().is_set(MeshFlag::Normal);
+    Math::OctahedralNormal* octahedral_normals = mesh.get_octahedral_normals();
     for (unsigned int i = 0; i < vertex_count; ++i) {
-        Vector3f position = mesh.get_positions()[i];
+        Vector3f position = mesh.get_position(i);
         mapped_geometry[i].position = optix::make_float3(position.x, position.y, position.z);
-        if (mesh.get_normals() != nullptr) {
-            Vector3f normal = mesh.get_normals()[i];
-            Math::OctahedralNormal encoded_normal = Math::OctahedralNormal::encode_precise(normal.x, normal.y, normal.z);
+        if (has_normals) {
+            // Octahedral encoded normals are used as is.
+            Math::OctahedralNormal encoded_normal = octahedral_normals != nullptr ? octahedral_normals[i] : Math::OctahedralNormal::encode_precise(mesh.get_normals()[i]);
             mapped_geometry[i].normal = { optix::make_short2(encoded_normal.encoding.x, encoded_normal.encoding.y) };
         }
     }
     geometry_buffer->unmap();
 
-    optix::Buffer texcoord_buffer = mesh.get_texcoords() != nullptr ?
-        create_buffer(context, RT_BUFFER_INPUT, RT_FORMAT_FLOAT2, vertex_count, mesh.get_texcoords()) :
-        context->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_FLOAT2, 0); // TODO Use shared default buffer or bind default to context.
+    optix::Buffer texcoord_buffer;
+    if (mesh.get_flags().is_set(MeshFlag::Texcoord)) {
+        std::vector<Vector2f> decoded_texcoords;
+        Vector2f* texcoords = mesh.get_texcoords();
+        if (texcoords == nullptr) {
+            decoded_texcoords.resize(vertex_count);
+            Meshes::decode_texcoords(mesh_ID, 0, vertex_count, decoded_texcoords.data());
+            texcoords = decoded_texcoords.data();
+        }
+        texcoord_buffer = create_buffer(context, RT_BUFFER_INPUT, RT_FORMAT_FLOAT2, vertex_count, texcoords);
+    } else
+        texcoord_buffer = context->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_FLOAT2, 0); // TODO Use shared default buffer or bind default to context.
 
     { // Setup triangle geometry representation.
         optix::GeometryTriangles triangle_mesh = context->createGeometryTriangles();
@@ -137,8 +149,8 @@ static inline optix::Transform load_model(optix::Context& context, MeshModel mod
 
     optix::GeometryInstance optix_model = context->createGeometryInstance(optix_mesh, optix_material);
     optix_model["material_index"]->setInt(model.get_material().get_ID());
-    unsigned char mesh_flags = mesh.get_normals() != nullptr ? MeshFlags::Normals : MeshFlags::None;
-    mesh_flags |= mesh.get_texcoords() != nullptr ? MeshFlags::Texcoords : MeshFlags::None;
+    unsigned char mesh_flags = mesh.get_flags().is_set(MeshFlag::Normal) ? MeshFlags::Normals : MeshFlags::None;
+    mesh_flags |= mesh.get_flags().is_set(MeshFlag::Texcoord) ? MeshFlags::Texcoords : MeshFlags::None;
     optix_model["mesh_flags"]->setInt(mesh_flags);
     OPTIX_VALIDATE(optix_model);
 
@@ -516,6 +528,8 @@ struct Renderer::Implementation {
     inline bool is_valid() const { return device_IDs.optix >= 0; }
 
     void handle_updates() {
+        BIFROST_PROFILE_SCOPE("OptiXRenderer::handle_updates");
+
         bool should_reset_accumulations = false;
 
         { // Camera updates.
@@ -10,6 +10,8 @@
 
 #include <StbImageLoader/StbImageLoader.h>
 
+#include <Bifrost/Core/Profiler.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <StbImageLoader/stb_image.h>
 
@@ -97,6 +99,8 @@ inline Images::UID convert_image(const std::string& name, void* loaded_pixels, i
 }
 
 Images::UID load(const std::string& path) {
+    BIFROST_PROFILE_SCOPE("StbImageLoader::load");
+
     stbi_set_flip_vertically_on_load(true);
 
     void* loaded_pixels = nullptr;
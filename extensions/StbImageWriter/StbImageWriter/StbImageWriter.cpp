@@ -61,22 +61,26 @@ bool save_image(const std::string& path, FileType file_type, unsigned int width,
     return false;
 }
 
-bool write(Image image, const std::string& path) {
-
-    if (image.get_depth() != 1)
-        return false;
+bool write(PixelFormat format, float gamma, Vector2ui size, const Images::PixelData pixels, const std::string& path) {
 
     FileType file_type = get_file_type(path);
     if (file_type == FileType::Unknown) {
         printf("StbImageWriter found unsupported file type. Path: '%s'\n", path.c_str());
         return false;
     }
-    unsigned int width = image.get_width(), height = image.get_height();
-    int channel_count = Bifrost::Assets::channel_count(image.get_pixel_format());
+    unsigned int width = size.x, height = size.y;
+    int channel_count = Bifrost::Assets::channel_count(format);
+
+    // Gamma encoded 8 bit pixels can be written to png as they are, by passing the last row and a negative stride
+    // to flip the image vertically, as stb_image_writer uses the upper left corner as origo.
+    bool is_color8 = format == PixelFormat::Intensity8 || format == PixelFormat::RGB24 || format == PixelFormat::RGBA32;
+    if (file_type == FileType::PNG && is_color8 && gamma == 2.2f) {
+        int row_size = width * channel_count;
+        const unsigned char* last_row = (const unsigned char*)pixels + (height - 1) * row_size;
+        return stbi_write_png(path.c_str(), width, height, channel_count, last_row, -row_size) != 0;
+    }
 
-    // Flip texture vertically, as stb_image_writer uses the upper left corner as origo,
-    // and ensure that the image format is correct.
-    // NOTE This could be optimized if the image already has the correct format and gamma.
+    // Flip texture vertically and ensure that the image format is correct.
     bool did_succeed = false;
     if (file_type == FileType::HDR) {
         float* data = new float[width * height * channel_count];
@@ -84,7 +88,7 @@ bool write(Image image, const std::string& path) {
             for (unsigned int x = 0; x < width; ++x) {
                 int data_index = x + (height - 1 - y) * width;
                 float* pixel_data = data + data_index * channel_count;
-                RGBA pixel = image.get_pixel(Vector2ui(x, y));
+                RGBA pixel = Images::decode_pixel(pixels, format, gamma, x + y * width);
                 memcpy(pixel_data, pixel.begin(), sizeof(float) * channel_count);
             }
 
@@ -92,14 +96,14 @@ bool write(Image image, const std::string& path) {
         delete[] data;
     } else {
         unsigned char* data = new unsigned char[width * height * channel_count];
-        float gamma = 1.0f / 2.2f;
+        float encoding_gamma = 1.0f / 2.2f;
         for (unsigned int y = 0; y < height; ++y)
             for (unsigned int x = 0; x < width; ++x) {
                 int data_index = x + (height - 1 - y) * width;
                 unsigned char* pixel_data = data + data_index * channel_count;
-                RGBA pixel = image.get_pixel(Vector2ui(x, y));
+                RGBA pixel = Images::decode_pixel(pixels, format, gamma, x + y * width);
                 for (int c = 0; c < channel_count; ++c) {
-                    float channel_intensity = c != 3 ? pow(pixel[c], gamma) : pixel[c]; // Gamma correct colors but leave alpha as linear.
+                    float channel_intensity = c != 3 ? pow(pixel[c], encoding_gamma) : pixel[c]; // Gamma correct colors but leave alpha as linear.
                     pixel_data[c] = unsigned char(clamp(channel_intensity, 0.0f, 1.0f) * 255 + 0.5f);
                 }
             }
@@ -111,4 +115,12 @@ bool write(Image image, const std::string& path) {
     return did_succeed;
 }
 
+bool write(Image image, const std::string& path) {
+    if (image.get_depth() != 1)
+        return false;
+
+    Vector2ui size = Vector2ui(image.get_width(), image.get_height());
+    return write(image.get_pixel_format(), image.get_gamma(), size, image.get_pixels(), path);
+}
+
 } // NS StbImageWriter
@@ -10,6 +10,7 @@
 #define _BIFROST_ASSETS_STB_IMAGE_WRITER_H_
 
 #include <Bifrost/Assets/Image.h>
+#include <Bifrost/Scene/Camera.h>
 #include <string>
 
 namespace StbImageWriter {
@@ -17,11 +18,22 @@ namespace StbImageWriter {
 // -----------------------------------------------------------------------
 // Writes an image file.
 // Basic support for png, hdr, bmp and tga file formats.
+// Pixels are read directly from their buffer, which is indexed from the
+// lower left corner, and gamma encoded 8 bit pixels are written to png
+// without being converted.
 // Future work
 // * Return an actual error about why a file could not be written.
 // -----------------------------------------------------------------------
+bool write(Bifrost::Assets::PixelFormat format, float gamma, Bifrost::Math::Vector2ui size,
+           const Bifrost::Assets::Images::PixelData pixels, const std::string& filename);
+
 bool write(Bifrost::Assets::Image image, const std::string& filename);
 
+inline bool write(const Bifrost::Scene::Screenshot& screenshot, const std::string& filename) {
+    Bifrost::Math::Vector2ui size = Bifrost::Math::Vector2ui(screenshot.width, screenshot.height);
+    return write(screenshot.format, screenshot.get_gamma(), size, screenshot.pixels, filename);
+}
+
 inline bool write(Bifrost::Assets::Images::UID imageID, const std::string& filename) {
     return write(Bifrost::Assets::Image(imageID), filename);
 }
@@ -13,6 +13,7 @@
 #include <Bifrost/Assets/Material.h>
 #include <Bifrost/Assets/Mesh.h>
 #include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Core/Profiler.h>
 #include <Bifrost/Math/Conversions.h>
 
 #include <StbImageLoader/StbImageLoader.h>
@@ -353,7 +354,8 @@ void copy_indices(unsigned int* bifrost_indices, const T* glTF_indices, size_t c
 // ------------------------------------------------------------------------------------------------
 // Loads a glTF file.
 // ------------------------------------------------------------------------------------------------
-SceneNodes::UID load(const std::string& filename) {
+SceneNodes::UID load(const std::string& filename, bool optimize_meshes) {
+    BIFROST_PROFILE_SCOPE("glTFLoader::load");
 
     // See https://github.com/syoyo/tinygltf/blob/master/loader_example.cc
 
@@ -397,7 +399,7 @@ SceneNodes::UID load(const std::string& filename) {
         glTF_image->height = image.get_height();
         glTF_image->component = channel_count(image.get_pixel_format());
         // HACK Store image ID in pixels instead of pixel data.
-        glTF_image->image.resize(4);
+        glTF_image->image.resize(sizeof(Images::UID));
         memcpy(glTF_image->image.data(), &image.get_ID(), sizeof(Images::UID));
 
         return true;
@@ -406,13 +408,16 @@ SceneNodes::UID load(const std::string& filename) {
     glTF_ctx.SetImageLoader(image_loader, nullptr);
 
     bool ret = false;
-    if (string_ends_with(filename, "glb"))
-        ret = glTF_ctx.LoadBinaryFromFile(&model, &errors, &warnings, filename.c_str());
-    else if (string_ends_with(filename, "gltf"))
-        ret = glTF_ctx.LoadASCIIFromFile(&model, &errors, &warnings, filename.c_str());
-    else {
-        printf("glTFLoader::load error: '%s' not a glTF file\n", filename.c_str());
-        return SceneNodes::UID::invalid_UID();
+    {
+        BIFROST_PROFILE_SCOPE("glTFLoader::load parse");
+        if (string_ends_with(filename, "glb"))
+            ret = glTF_ctx.LoadBinaryFromFile(&model, &errors, &warnings, filename.c_str());
+        else if (string_ends_with(filename, "gltf"))
+            ret = glTF_ctx.LoadASCIIFromFile(&model, &errors, &warnings, filename.c_str());
+        else {
+            printf("glTFLoader::load error: '%s' not a glTF file\n", filename.c_str());
+            return SceneNodes::UID::invalid_UID();
+        }
     }
 
     if (!warnings.empty())
@@ -639,6 +644,10 @@ SceneNodes::UID load(const std::string& filename) {
             }
 
             mesh.set_bounds(AABB(min_position, max_position));
+            if (optimize_meshes) {
+                MeshUtils::optimize_vertex_cache(mesh.get_ID());
+                MeshUtils::optimize_vertex_fetch(mesh.get_ID());
+            }
 
             loaded_meshes.push_back({ mesh.get_ID(), false });
         }
@@ -17,13 +17,15 @@ namespace glTFLoader {
 // ------------------------------------------------------------------------------------------------
 // Loads a glTF file.
 // See the glTF spec at https://github.com/KhronosGroup/glTF/tree/master/specification
+// If optimize_meshes is set, the meshes' triangles and vertices are reordered for vertex cache and
+// vertex fetch efficiency with MeshUtils::optimize_vertex_cache and MeshUtils::optimize_vertex_fetch.
 // Future work:
 // * Support doubleSided/thinwalled on meshes. Requires mesh support first.
 // * Reserve capacity for Mesh, MeshModels and SceneNodes before creating them.
 // * Import cameras. Perhaps as viewpoints, since there is no way to enable/disable cameras.
 // * Support triangle fan and triangle strip as well.
 // ------------------------------------------------------------------------------------------------
-Bifrost::Scene::SceneNodes::UID load(const std::string& filename);
+Bifrost::Scene::SceneNodes::UID load(const std::string& filename, bool optimize_meshes = false);
 
 bool file_supported(const std::string& filename);
 
@@ -242,6 +242,16 @@ TEST_F(Assets_Images, mipmapable_events) {
     }
 }
 
+TEST_F(Assets_Images, memory_usage) {
+    Images::UID image_ID = Images::create2D("Test image", PixelFormat::RGBA32, 2.2f, Math::Vector2ui(4, 4), 3);
+    size_t pixel_bytes = (16 + 4 + 1) * 4;
+    EXPECT_EQ(pixel_bytes, Images::get_memory_usage(image_ID)[Core::MemoryCategory::Pixels]);
+    EXPECT_EQ(pixel_bytes, Images::get_memory_usage()[Core::MemoryCategory::Pixels]);
+
+    Images::destroy(image_ID);
+    EXPECT_EQ(0u, Images::get_memory_usage()[Core::MemoryCategory::Pixels]);
+}
+
 // ------------------------------------------------------------------------------------------------
 // Image utils tests.
 // ------------------------------------------------------------------------------------------------
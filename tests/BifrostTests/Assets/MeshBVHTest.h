@@ -0,0 +1,245 @@
+// Test Bifrost mesh BVH.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_ASSETS_MESH_BVH_TEST_H_
+#define _BIFROST_ASSETS_MESH_BVH_TEST_H_
+
+#include <Bifrost/Assets/MeshBVH.h>
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Math/Intersect.h>
+#include <Bifrost/Math/RNG.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Bifrost {
+namespace Assets {
+
+class Assets_MeshBVH : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        Meshes::allocate(2u);
+    }
+    virtual void TearDown() {
+        Meshes::deallocate();
+    }
+
+    // Rays from random points around the mesh towards random points inside its bounds.
+    static std::vector<Math::Ray> create_random_rays(Meshes::UID mesh_ID, unsigned int ray_count) {
+        Math::AABB bounds = Meshes::compute_bounds(mesh_ID);
+        Math::Vector3f size = bounds.size();
+        Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(ray_count);
+        std::vector<Math::Ray> rays(ray_count);
+        for (Math::Ray& ray : rays) {
+            Math::Vector3f origin = bounds.minimum - size + rng.sample3f() * size * 3.0f;
+            Math::Vector3f target = bounds.minimum + rng.sample3f() * size;
+            ray = Math::Ray(origin, Math::normalize(target - origin));
+        }
+        return rays;
+    }
+
+    // Brute force reference, intersecting every triangle of the mesh.
+    static float brute_force_intersect(Meshes::UID mesh_ID, Math::Ray ray, unsigned int& primitive_index) {
+        const Math::Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+        const Math::Vector3f* positions = Meshes::get_positions(mesh_ID);
+        float closest_distance = 1e30f;
+        for (unsigned int p = 0; p < Meshes::get_primitive_count(mesh_ID); ++p) {
+            Math::Vector3f vertex0 = positions[primitives[p].x];
+            Math::Vector2f barycentric;
+            float distance = Math::intersect_triangle(ray, vertex0, positions[primitives[p].y] - vertex0, positions[primitives[p].z] - vertex0, barycentric);
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                primitive_index = p;
+            }
+        }
+        return closest_distance;
+    }
+
+    static void test_against_brute_force(Meshes::UID mesh_ID, unsigned int ray_count) {
+        MeshBVH bvh = MeshBVH(mesh_ID);
+        EXPECT_EQ(Meshes::get_primitive_count(mesh_ID), bvh.get_primitive_count());
+
+        for (Math::Ray ray : create_random_rays(mesh_ID, ray_count)) {
+            unsigned int expected_primitive_index = 0;
+            float expected_distance = brute_force_intersect(mesh_ID, ray, expected_primitive_index);
+            bool expected_hit = expected_distance < 1e30f;
+
+            float distance = 1e30f;
+            unsigned int primitive_index = 0;
+            Math::Vector2f barycentric;
+            EXPECT_EQ(expected_hit, bvh.intersect(ray, distance, primitive_index, barycentric));
+            EXPECT_EQ(expected_hit, bvh.intersects(ray, 1e30f));
+            if (expected_hit) {
+                EXPECT_FLOAT_EQ(expected_distance, distance);
+                // Triangles sharing the hit point are equally valid hits, so only compare the hit positions.
+                EXPECT_LT(Math::magnitude(ray.position_at(distance) - ray.position_at(expected_distance)), 1e-4f);
+                EXPECT_FALSE(bvh.intersects(ray, expected_distance * 0.999f));
+            }
+        }
+    }
+};
+
+TEST_F(Assets_MeshBVH, SAH_hierarchy_layout) {
+    Meshes::UID mesh_ID = MeshCreation::torus(64, 32, 0.3f);
+    unsigned int primitive_count = Meshes::get_primitive_count(mesh_ID);
+    const Math::Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+    const Math::Vector3f* positions = Meshes::get_positions(mesh_ID);
+    std::vector<Math::AABB> primitive_bounds(primitive_count);
+    for (unsigned int p = 0; p < primitive_count; ++p) {
+        primitive_bounds[p] = Math::AABB(positions[primitives[p].x], positions[primitives[p].x]);
+        primitive_bounds[p].grow_to_contain(positions[primitives[p].y]);
+        primitive_bounds[p].grow_to_contain(positions[primitives[p].z]);
+    }
+
+    std::vector<Math::BVH4Node> nodes;
+    std::vector<unsigned int> primitive_order;
+    Math::build_BVH4_SAH(primitive_bounds.data(), primitive_count, 4, nodes, primitive_order);
+
+    // Every primitive is in the order exactly once.
+    std::vector<unsigned int> sorted_order = primitive_order;
+    std::sort(sorted_order.begin(), sorted_order.end());
+    for (unsigned int p = 0; p < primitive_count; ++p)
+        ASSERT_EQ(p, sorted_order[p]);
+
+    // Children come after their parents, leaves are small and the child bounds contain their primitives.
+    EXPECT_EQ(-1, nodes[0].parent);
+    unsigned int leaf_primitive_count = 0;
+    for (int n = 0; n < (int)nodes.size(); ++n) {
+        const Math::BVH4Node& node = nodes[n];
+        for (int s = 0; s < 4; ++s) {
+            if (node.is_empty(s))
+                continue;
+            if (node.children[s] >= 0) {
+                EXPECT_GT(node.children[s], n);
+                EXPECT_EQ(n, nodes[node.children[s]].parent);
+                EXPECT_EQ(node.get_child_bounds(s), nodes[node.children[s]].get_bounds());
+            } else {
+                EXPECT_LE(node.primitive_counts[s], 4u);
+                leaf_primitive_count += node.primitive_counts[s];
+                Math::AABB child_bounds = node.get_child_bounds(s);
+                for (unsigned int p = node.first_primitives[s]; p < node.first_primitives[s] + node.primitive_counts[s]; ++p) {
+                    Math::AABB bounds = child_bounds;
+                    bounds.grow_to_contain(primitive_bounds[primitive_order[p]]);
+                    EXPECT_EQ(child_bounds, bounds);
+                }
+            }
+        }
+    }
+    EXPECT_EQ(primitive_count, leaf_primitive_count);
+}
+
+TEST_F(Assets_MeshBVH, SAH_hierarchy_depth_is_bounded) {
+    // Exponentially spaced primitives make every binned split peel off the few primitives in the last bins.
+    const unsigned int primitive_count = 240;
+    std::vector<Math::AABB> primitive_bounds(primitive_count);
+    for (unsigned int p = 0; p < primitive_count; ++p) {
+        float x = std::ldexp(1.0f, int(p) - 120);
+        primitive_bounds[p] = Math::AABB(Math::Vector3f(x, 0, 0), Math::Vector3f(x * 1.1f, 1, 1));
+    }
+
+    std::vector<Math::BVH4Node> nodes;
+    std::vector<unsigned int> primitive_order;
+    Math::build_BVH4_SAH(primitive_bounds.data(), primitive_count, 1, nodes, primitive_order);
+
+    int max_depth = 0;
+    for (int n = 0; n < (int)nodes.size(); ++n) {
+        int depth = 1;
+        for (int parent = nodes[n].parent; parent >= 0; parent = nodes[parent].parent)
+            ++depth;
+        max_depth = std::max(max_depth, depth);
+    }
+    EXPECT_LE(max_depth, Math::BVH4_MAX_DEPTH);
+
+    // A ray along the primitives visits every leaf.
+    Math::Ray ray = Math::Ray(Math::Vector3f(0.0f, 0.5f, 0.5f), Math::Vector3f(1, 0, 0));
+    float max_distance = std::numeric_limits<float>::infinity();
+    unsigned int visited_primitive_count = 0;
+    Math::traverse_BVH4(nodes.data(), ray, max_distance, [&](unsigned int first_primitive, unsigned int primitive_count, float& max_distance) -> bool {
+        visited_primitive_count += primitive_count;
+        return false;
+    });
+    EXPECT_EQ(primitive_count, visited_primitive_count);
+}
+
+TEST_F(Assets_MeshBVH, intersect_matches_brute_force) {
+    test_against_brute_force(MeshCreation::cube(1), 64);
+    test_against_brute_force(MeshCreation::torus(32, 16, 0.3f), 256);
+    // A plane has no extent along one axis and only coplanar triangle centers.
+    test_against_brute_force(MeshCreation::plane(16), 256);
+    // Large enough to bin and build subtrees in parallel.
+    test_against_brute_force(MeshCreation::torus(256, 160, 0.3f), 32);
+}
+
+TEST_F(Assets_MeshBVH, packets_match_single_rays) {
+    Meshes::UID mesh_ID = MeshCreation::torus(64, 32, 0.3f);
+    MeshBVH bvh = MeshBVH(mesh_ID);
+    std::vector<Math::Ray> rays = create_random_rays(mesh_ID, 256);
+
+    for (unsigned int r = 0; r < rays.size(); r += 4) {
+        Math::RayPacket4 packet = Math::RayPacket4(rays.data() + r);
+        // Leave one ray inactive and give the rays different max distances.
+        int ray_mask = 0xF & ~(1 << (r / 4 % 4));
+        float max_distances[4] = { 1e30f, 2.0f, 1e30f, 3.0f };
+        float packet_distances[4] = { max_distances[0], max_distances[1], max_distances[2], max_distances[3] };
+        unsigned int primitive_indices[4];
+        Math::Vector2f barycentrics[4];
+        int hit_mask = bvh.intersect(packet, ray_mask, packet_distances, primitive_indices, barycentrics);
+        int occluded_mask = bvh.intersects(packet, ray_mask, max_distances);
+        EXPECT_EQ(hit_mask, occluded_mask);
+
+        for (int i = 0; i < 4; ++i) {
+            float distance = max_distances[i];
+            unsigned int primitive_index;
+            Math::Vector2f barycentric;
+            bool is_active = (ray_mask & (1 << i)) != 0;
+            bool hit = is_active && bvh.intersect(rays[r + i], distance, primitive_index, barycentric);
+            EXPECT_EQ(hit, (hit_mask & (1 << i)) != 0);
+            if (hit) {
+                EXPECT_FLOAT_EQ(distance, packet_distances[i]);
+                EXPECT_EQ(primitive_index, primitive_indices[i]);
+                EXPECT_FLOAT_EQ(barycentric.x, barycentrics[i].x);
+                EXPECT_FLOAT_EQ(barycentric.y, barycentrics[i].y);
+            } else
+                EXPECT_EQ(max_distances[i], packet_distances[i]);
+        }
+    }
+}
+
+TEST_F(Assets_MeshBVH, cached_hierarchy) {
+    Meshes::UID mesh_ID = MeshCreation::cube(2);
+    EXPECT_EQ(nullptr, Meshes::get_cached_BVH(mesh_ID));
+
+    std::shared_ptr<const MeshBVH> bvh = MeshUtils::build_BVH(mesh_ID);
+    ASSERT_NE(nullptr, bvh);
+    EXPECT_EQ(bvh, Meshes::get_cached_BVH(mesh_ID));
+    EXPECT_EQ(bvh, MeshUtils::build_BVH(mesh_ID));
+
+    // Updating the geometry releases the cached hierarchy and the rebuilt hierarchy sees the new positions.
+    Meshes::reset_change_notifications();
+    MeshUtils::transform_mesh(mesh_ID, Math::Transform(Math::Vector3f(10, 0, 0)));
+    EXPECT_TRUE(Meshes::get_changes(mesh_ID).is_set(Meshes::Change::GeometryUpdated));
+    EXPECT_EQ(nullptr, Meshes::get_cached_BVH(mesh_ID));
+    std::shared_ptr<const MeshBVH> updated_bvh = MeshUtils::build_BVH(mesh_ID);
+    EXPECT_NE(bvh, updated_bvh);
+    EXPECT_LT(9.0f, updated_bvh->get_bounds().minimum.x);
+    // The released hierarchy stays valid for its holders.
+    EXPECT_GT(1.0f, bvh->get_bounds().maximum.x);
+
+    Meshes::destroy(mesh_ID);
+    EXPECT_EQ(nullptr, Meshes::get_cached_BVH(mesh_ID));
+    EXPECT_LT(9.0f, updated_bvh->get_bounds().minimum.x);
+}
+
+} // NS Assets
+} // NS Bifrost
+
+#endif // _BIFROST_ASSETS_MESH_BVH_TEST_H_
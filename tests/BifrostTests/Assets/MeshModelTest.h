@@ -13,6 +13,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 namespace Bifrost {
 namespace Assets {
 
@@ -157,6 +159,52 @@ TEST_F(Assets_MeshModels, create_and_destroy_notifications) {
     }
 }
 
+TEST_F(Assets_MeshModels, reverse_lookup) {
+    Scene::SceneNodes::UID node_ID0 = Scene::SceneNodes::create("Node0");
+    Scene::SceneNodes::UID node_ID1 = Scene::SceneNodes::create("Node1");
+    Meshes::UID mesh_ID0 = Meshes::create("Mesh0", 2u, 4u);
+    Meshes::UID mesh_ID1 = Meshes::create("Mesh1", 2u, 4u);
+    Materials::UID material_ID0 = Materials::create("Material0", {});
+    Materials::UID material_ID1 = Materials::create("Material1", {});
+
+    MeshModels::UID model_ID0 = MeshModels::create(node_ID0, mesh_ID0, material_ID0);
+    MeshModels::UID model_ID1 = MeshModels::create(node_ID0, mesh_ID1, material_ID0);
+    MeshModels::UID model_ID2 = MeshModels::create(node_ID1, mesh_ID0, material_ID1);
+
+    auto to_vector = [](auto models) {
+        std::vector<MeshModels::UID> model_IDs;
+        for (MeshModels::UID model_ID : models)
+            model_IDs.push_back(model_ID);
+        std::sort(model_IDs.begin(), model_IDs.end(), [](MeshModels::UID lhs, MeshModels::UID rhs) { return lhs.get_index() < rhs.get_index(); });
+        return model_IDs;
+    };
+    typedef std::vector<MeshModels::UID> ModelIDs;
+
+    EXPECT_EQ(ModelIDs({ model_ID0, model_ID2 }), to_vector(MeshModels::get_models_with_mesh(mesh_ID0)));
+    EXPECT_EQ(ModelIDs({ model_ID1 }), to_vector(MeshModels::get_models_with_mesh(mesh_ID1)));
+    EXPECT_EQ(ModelIDs({ model_ID0, model_ID1 }), to_vector(MeshModels::get_models_with_material(material_ID0)));
+    EXPECT_EQ(ModelIDs({ model_ID0, model_ID1 }), to_vector(MeshModels::get_models_on_scene_node(node_ID0)));
+    EXPECT_EQ(ModelIDs({ model_ID2 }), to_vector(MeshModels::get_models_on_scene_node(node_ID1)));
+
+    // Changing material and destroying models updates the lookups.
+    MeshModels::set_material_ID(model_ID0, material_ID1);
+    EXPECT_EQ(ModelIDs({ model_ID1 }), to_vector(MeshModels::get_models_with_material(material_ID0)));
+    EXPECT_EQ(ModelIDs({ model_ID0, model_ID2 }), to_vector(MeshModels::get_models_with_material(material_ID1)));
+    MeshModels::destroy(model_ID0);
+    EXPECT_EQ(ModelIDs({ model_ID2 }), to_vector(MeshModels::get_models_with_mesh(mesh_ID0)));
+    EXPECT_EQ(ModelIDs({ model_ID1 }), to_vector(MeshModels::get_models_on_scene_node(node_ID0)));
+
+    // Models referencing a destroyed mesh aren't returned for a new mesh in the same slot.
+    Meshes::destroy(mesh_ID1);
+    Meshes::UID mesh_ID2 = Meshes::create("Mesh2", 2u, 4u);
+    for (int m = 0; m < 16 && mesh_ID2.get_index() != mesh_ID1.get_index(); ++m)
+        mesh_ID2 = Meshes::create("Mesh2", 2u, 4u);
+    ASSERT_EQ(mesh_ID1.get_index(), mesh_ID2.get_index());
+    EXPECT_TRUE(MeshModels::get_models_with_mesh(mesh_ID2).is_empty());
+    MeshModels::UID model_ID3 = MeshModels::create(node_ID1, mesh_ID2, material_ID1);
+    EXPECT_EQ(ModelIDs({ model_ID3 }), to_vector(MeshModels::get_models_with_mesh(mesh_ID2)));
+}
+
 } // NS Assets
 } // NS Bifrost
 
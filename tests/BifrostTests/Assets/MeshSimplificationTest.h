@@ -0,0 +1,176 @@
+// Test Bifrost mesh simplification.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_ASSETS_MESH_SIMPLIFICATION_TEST_H_
+#define _BIFROST_ASSETS_MESH_SIMPLIFICATION_TEST_H_
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Assets/MeshSimplification.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace Bifrost {
+namespace Assets {
+
+class Assets_MeshSimplification : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        Meshes::allocate(8u);
+    }
+    virtual void TearDown() {
+        Meshes::deallocate();
+    }
+
+    // Tests that every vertex of the simplified mesh is a vertex of the source mesh.
+    static void test_vertices_are_kept(Meshes::UID mesh_ID, Meshes::UID simplified_mesh_ID) {
+        Mesh mesh = mesh_ID, simplified_mesh = simplified_mesh_ID;
+        for (unsigned int sv = 0; sv < simplified_mesh.get_vertex_count(); ++sv) {
+            bool found_vertex = false;
+            for (unsigned int v = 0; v < mesh.get_vertex_count() && !found_vertex; ++v)
+                found_vertex = mesh.get_position(v) == simplified_mesh.get_position(sv) &&
+                               mesh.get_normal(v) == simplified_mesh.get_normal(sv) &&
+                               mesh.get_texcoord(v) == simplified_mesh.get_texcoord(sv);
+            EXPECT_TRUE(found_vertex);
+        }
+    }
+};
+
+TEST_F(Assets_MeshSimplification, simplify_to_triangle_count) {
+    Mesh mesh = MeshCreation::torus(64, 32, 0.3f);
+    unsigned int target_triangle_count = mesh.get_primitive_count() / 4;
+
+    float error;
+    Mesh simplified_mesh = MeshUtils::simplify(mesh.get_ID(), target_triangle_count, std::numeric_limits<float>::infinity(), &error);
+    EXPECT_LE(simplified_mesh.get_primitive_count(), target_triangle_count);
+    EXPECT_GT(simplified_mesh.get_primitive_count(), target_triangle_count * 9 / 10);
+    EXPECT_LT(simplified_mesh.get_vertex_count(), mesh.get_vertex_count() / 2);
+    EXPECT_EQ(mesh.get_flags(), simplified_mesh.get_flags());
+    EXPECT_FALSE(MeshTests::has_invalid_indices(simplified_mesh.get_ID()));
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(simplified_mesh.get_ID()));
+    test_vertices_are_kept(mesh.get_ID(), simplified_mesh.get_ID());
+
+    // The error is small compared to the torus, but not zero as the curvature is reduced.
+    EXPECT_LT(0.0f, error);
+    EXPECT_GT(0.05f, error);
+}
+
+TEST_F(Assets_MeshSimplification, simplify_to_error) {
+    Mesh mesh = MeshCreation::torus(64, 32, 0.3f);
+
+    float small_error, large_error;
+    Mesh precise_mesh = MeshUtils::simplify(mesh.get_ID(), 0, 0.001f, &small_error);
+    Mesh coarse_mesh = MeshUtils::simplify(mesh.get_ID(), 0, 0.01f, &large_error);
+    EXPECT_LE(small_error, 0.001f);
+    EXPECT_LE(large_error, 0.01f);
+    EXPECT_LT(small_error, large_error);
+    EXPECT_LT(coarse_mesh.get_primitive_count(), precise_mesh.get_primitive_count());
+    EXPECT_LT(precise_mesh.get_primitive_count(), mesh.get_primitive_count());
+
+    // Flat surfaces are simplified without error and the borders are kept in place.
+    Mesh plane = MeshCreation::plane(16);
+    float plane_error;
+    Mesh simplified_plane = MeshUtils::simplify(plane.get_ID(), 0, 0.0001f, &plane_error);
+    EXPECT_GE(8u, simplified_plane.get_primitive_count());
+    EXPECT_GT(0.0001f, plane_error);
+    EXPECT_EQ(plane.get_bounds().minimum.x, simplified_plane.get_bounds().minimum.x);
+    EXPECT_EQ(plane.get_bounds().minimum.z, simplified_plane.get_bounds().minimum.z);
+    EXPECT_EQ(plane.get_bounds().maximum.x, simplified_plane.get_bounds().maximum.x);
+    EXPECT_EQ(plane.get_bounds().maximum.z, simplified_plane.get_bounds().maximum.z);
+}
+
+TEST_F(Assets_MeshSimplification, seams_are_preserved) {
+    // The faces of the cube are split by normal seams along its edges.
+    Mesh cube = MeshCreation::cube(4);
+    Mesh simplified_cube = MeshUtils::simplify(cube.get_ID(), 0);
+
+    // Every face is reduced to two triangles between its corners.
+    EXPECT_EQ(12u, simplified_cube.get_primitive_count());
+    EXPECT_EQ(24u, simplified_cube.get_vertex_count());
+    EXPECT_EQ(cube.get_bounds(), simplified_cube.get_bounds());
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(simplified_cube.get_ID()));
+    test_vertices_are_kept(cube.get_ID(), simplified_cube.get_ID());
+}
+
+TEST_F(Assets_MeshSimplification, compressed_mesh) {
+    Mesh mesh = MeshCreation::torus(32, 16, 0.3f);
+    mesh.set_compression(MeshFlag::Compressed);
+
+    Mesh simplified_mesh = MeshUtils::simplify(mesh.get_ID(), mesh.get_primitive_count() / 2);
+    EXPECT_EQ(mesh.get_flags(), simplified_mesh.get_flags());
+    EXPECT_LE(simplified_mesh.get_primitive_count(), mesh.get_primitive_count() / 2);
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(simplified_mesh.get_ID()));
+}
+
+TEST_F(Assets_MeshSimplification, LOD_chain) {
+    Mesh mesh = MeshCreation::torus(64, 32, 0.3f);
+    size_t metadata_bytes = Meshes::get_memory_usage(mesh.get_ID())[Core::MemoryCategory::Metadata];
+    MeshUtils::build_LOD_chain(mesh.get_ID(), 3, 0.5f);
+    // The chain is reported as metadata of the mesh, while the levels are reported as meshes.
+    EXPECT_LE(metadata_bytes + 3 * sizeof(Meshes::LOD), Meshes::get_memory_usage(mesh.get_ID())[Core::MemoryCategory::Metadata]);
+
+    const std::vector<Meshes::LOD>& LOD_chain = mesh.get_LOD_chain();
+    ASSERT_EQ(3u, LOD_chain.size());
+    unsigned int previous_triangle_count = mesh.get_primitive_count();
+    float previous_error = 0.0f;
+    for (Meshes::LOD level : LOD_chain) {
+        Mesh level_mesh = level.mesh_ID;
+        EXPECT_LE(level_mesh.get_primitive_count(), previous_triangle_count / 2);
+        EXPECT_LE(previous_error, level.error);
+        EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(level.mesh_ID));
+        previous_triangle_count = level_mesh.get_primitive_count();
+        previous_error = level.error;
+    }
+
+    // Distant meshes use coarser levels and nearby meshes use the mesh itself.
+    float projection_scale = 1000.0f;
+    EXPECT_EQ(mesh.get_ID(), MeshUtils::select_LOD(mesh.get_ID(), 0.0f, projection_scale));
+    EXPECT_EQ(LOD_chain[2].mesh_ID, MeshUtils::select_LOD(mesh.get_ID(), 1e6f, projection_scale));
+    float distance = LOD_chain[1].error * projection_scale;
+    EXPECT_EQ(LOD_chain[1].mesh_ID, MeshUtils::select_LOD(mesh.get_ID(), distance * 1.01f, projection_scale));
+    EXPECT_EQ(1.0f, MeshUtils::compute_screen_space_error(LOD_chain[1].error, distance, projection_scale));
+
+    // Rebuilding the chain replaces the levels and destroying the mesh destroys its levels.
+    std::vector<Meshes::LOD> old_LOD_chain = LOD_chain;
+    MeshUtils::build_LOD_chain(mesh.get_ID(), 2, 0.25f);
+    EXPECT_EQ(2u, mesh.get_LOD_chain().size());
+    for (Meshes::LOD level : old_LOD_chain)
+        EXPECT_FALSE(Meshes::has(level.mesh_ID));
+    std::vector<Meshes::LOD> new_LOD_chain = mesh.get_LOD_chain();
+    Meshes::destroy(mesh.get_ID());
+    for (Meshes::LOD level : new_LOD_chain)
+        EXPECT_FALSE(Meshes::has(level.mesh_ID));
+}
+
+TEST_F(Assets_MeshSimplification, parallel_LOD_chains) {
+    Meshes::UID mesh_IDs[] = { MeshCreation::torus(64, 32, 0.3f), MeshCreation::cube(8), MeshCreation::plane(32), MeshCreation::torus(48, 24, 0.2f) };
+    Meshes::UID serial_mesh_IDs[4];
+    for (int m = 0; m < 4; ++m) {
+        serial_mesh_IDs[m] = MeshUtils::deep_clone(mesh_IDs[m]);
+        MeshUtils::build_LOD_chain(serial_mesh_IDs[m]);
+    }
+    MeshUtils::build_LOD_chains(mesh_IDs, mesh_IDs + 4);
+
+    for (int m = 0; m < 4; ++m) {
+        const std::vector<Meshes::LOD>& LOD_chain = Meshes::get_LOD_chain(mesh_IDs[m]);
+        const std::vector<Meshes::LOD>& serial_LOD_chain = Meshes::get_LOD_chain(serial_mesh_IDs[m]);
+        EXPECT_FALSE(LOD_chain.empty());
+        ASSERT_EQ(serial_LOD_chain.size(), LOD_chain.size());
+        for (unsigned int l = 0; l < LOD_chain.size(); ++l) {
+            EXPECT_EQ(Meshes::get_primitive_count(serial_LOD_chain[l].mesh_ID), Meshes::get_primitive_count(LOD_chain[l].mesh_ID));
+            EXPECT_EQ(serial_LOD_chain[l].error, LOD_chain[l].error);
+        }
+    }
+}
+
+} // NS Assets
+} // NS Bifrost
+
+#endif // _BIFROST_ASSETS_MESH_SIMPLIFICATION_TEST_H_
@@ -10,10 +10,16 @@
 #define _BIFROST_ASSETS_MESH_TEST_H_
 
 #include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshBVH.h>
 #include <Bifrost/Assets/MeshCreation.h>
 
+#include <Bifrost/Math/RNG.h>
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace Bifrost {
 namespace Assets {
 
@@ -26,6 +32,23 @@ protected:
     virtual void TearDown() {
         Meshes::deallocate();
     }
+
+    // Shuffles the triangles of the mesh, which leaves little vertex reuse between consecutive triangles.
+    static void shuffle_triangles(Meshes::UID mesh_ID) {
+        Math::Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+        Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(19);
+        for (unsigned int p = Meshes::get_primitive_count(mesh_ID) - 1; p > 0; --p)
+            std::swap(primitives[p], primitives[rng.sample1ui() % (p + 1)]);
+    }
+
+    static std::vector<Math::Vector3ui> get_sorted_triangles(Meshes::UID mesh_ID) {
+        const Math::Vector3ui* primitives = Meshes::get_primitives(mesh_ID);
+        std::vector<Math::Vector3ui> triangles(primitives, primitives + Meshes::get_primitive_count(mesh_ID));
+        std::sort(triangles.begin(), triangles.end(), [](Math::Vector3ui lhs, Math::Vector3ui rhs) {
+            return lhs.x != rhs.x ? lhs.x < rhs.x : (lhs.y != rhs.y ? lhs.y < rhs.y : lhs.z < rhs.z);
+        });
+        return triangles;
+    }
 };
 
 TEST_F(Assets_Mesh, resizing) {
@@ -224,6 +247,279 @@ TEST_F(Assets_Mesh, hard_normal_computation) {
     }
 }
 
+TEST_F(Assets_Mesh, memory_usage) {
+    Core::MemoryUsage empty_usage = Meshes::get_memory_usage();
+    EXPECT_EQ(0u, empty_usage[Core::MemoryCategory::Vertices]);
+    EXPECT_EQ(0u, empty_usage[Core::MemoryCategory::Indices]);
+    EXPECT_LT(0u, empty_usage[Core::MemoryCategory::Metadata]);
+
+    Meshes::UID mesh_ID = Meshes::create("TestMesh", 32u, 16u, { MeshFlag::Position, MeshFlag::Texcoord });
+    Core::MemoryUsage mesh_usage = Meshes::get_memory_usage(mesh_ID);
+    EXPECT_EQ(16u * (sizeof(Math::Vector3f) + sizeof(Math::Vector2f)), mesh_usage[Core::MemoryCategory::Vertices]);
+    EXPECT_EQ(32u * sizeof(Math::Vector3ui), mesh_usage[Core::MemoryCategory::Indices]);
+
+    EXPECT_EQ(0u, mesh_usage[Core::MemoryCategory::BVHs]);
+
+    Core::MemoryUsage usage = Meshes::get_memory_usage();
+    EXPECT_EQ(mesh_usage[Core::MemoryCategory::Vertices], usage[Core::MemoryCategory::Vertices]);
+    EXPECT_EQ(mesh_usage[Core::MemoryCategory::Indices], usage[Core::MemoryCategory::Indices]);
+    EXPECT_EQ(0u, usage[Core::MemoryCategory::BVHs]);
+
+    // The cached hierarchy is reported with its mesh and released with the geometry.
+    Meshes::UID plane_ID = MeshCreation::plane(4);
+    std::shared_ptr<const MeshBVH> BVH = MeshUtils::build_BVH(plane_ID);
+    size_t BVH_bytes = Meshes::get_memory_usage(plane_ID)[Core::MemoryCategory::BVHs];
+    EXPECT_LT(BVH->get_allocated_bytes(), BVH_bytes);
+    EXPECT_EQ(BVH_bytes, Meshes::get_memory_usage()[Core::MemoryCategory::BVHs]);
+    Meshes::flag_geometry_updated(plane_ID);
+    EXPECT_EQ(0u, Meshes::get_memory_usage()[Core::MemoryCategory::BVHs]);
+
+    Meshes::destroy(mesh_ID);
+    Meshes::destroy(plane_ID);
+    EXPECT_EQ(0u, Meshes::get_memory_usage(mesh_ID).get_total_bytes());
+    EXPECT_EQ(0u, Meshes::get_memory_usage()[Core::MemoryCategory::Vertices]);
+}
+
+TEST_F(Assets_Mesh, vertex_cache_optimization) {
+    Meshes::UID mesh_ID = MeshCreation::plane(32);
+    shuffle_triangles(mesh_ID);
+    std::vector<Math::Vector3ui> shuffled_triangles = get_sorted_triangles(mesh_ID);
+    MeshUtils::VertexCacheStatistics shuffled_statistics = MeshUtils::compute_vertex_cache_statistics(mesh_ID);
+    EXPECT_GT(shuffled_statistics.ACMR, 1.5f);
+
+    Meshes::reset_change_notifications();
+    MeshUtils::optimize_vertex_cache(mesh_ID);
+    EXPECT_TRUE(Meshes::get_changes(mesh_ID).is_set(Meshes::Change::GeometryUpdated));
+
+    // The same triangles with the same winding are reordered for cache reuse.
+    EXPECT_EQ(shuffled_triangles, get_sorted_triangles(mesh_ID));
+    MeshUtils::VertexCacheStatistics optimized_statistics = MeshUtils::compute_vertex_cache_statistics(mesh_ID);
+    EXPECT_LT(optimized_statistics.ACMR, 0.8f);
+    EXPECT_LT(optimized_statistics.ATVR, 1.6f);
+    EXPECT_EQ(optimized_statistics.transformed_vertex_count, unsigned int(optimized_statistics.ATVR * Meshes::get_vertex_count(mesh_ID) + 0.5f));
+}
+
+TEST_F(Assets_Mesh, vertex_fetch_optimization) {
+    Meshes::UID mesh_ID = MeshCreation::torus(16, 8, 0.3f);
+    shuffle_triangles(mesh_ID);
+    MeshUtils::optimize_vertex_cache(mesh_ID);
+    Mesh mesh = mesh_ID;
+
+    // Store the triangles' positions and texcoords to verify that the remapping preserves them.
+    std::vector<Math::Vector3f> triangle_positions;
+    std::vector<Math::Vector2f> triangle_texcoords;
+    for (unsigned int index : Core::Iterable<unsigned int*>(mesh.get_indices(), mesh.get_index_count())) {
+        triangle_positions.push_back(mesh.get_positions()[index]);
+        triangle_texcoords.push_back(mesh.get_texcoords()[index]);
+    }
+
+    MeshUtils::optimize_vertex_fetch(mesh_ID);
+
+    // The vertices are referenced in order of first use.
+    unsigned int next_vertex_index = 0;
+    for (unsigned int i = 0; i < mesh.get_index_count(); ++i) {
+        unsigned int index = mesh.get_indices()[i];
+        EXPECT_LE(index, next_vertex_index);
+        if (index == next_vertex_index)
+            ++next_vertex_index;
+        EXPECT_EQ(triangle_positions[i], mesh.get_positions()[index]);
+        EXPECT_EQ(triangle_texcoords[i], mesh.get_texcoords()[index]);
+    }
+    EXPECT_EQ(mesh.get_vertex_count(), next_vertex_index);
+}
+
+TEST_F(Assets_Mesh, compressed_storage) {
+    Mesh mesh = MeshCreation::torus(16, 8, 0.3f);
+    Mesh compressed_mesh = MeshUtils::deep_clone(mesh.get_ID());
+    unsigned int vertex_count = mesh.get_vertex_count();
+
+    Meshes::reset_change_notifications();
+    compressed_mesh.set_compression(MeshFlag::Compressed);
+    EXPECT_EQ(MeshFlags(MeshFlag::AllBuffers) | MeshFlag::Compressed, compressed_mesh.get_flags());
+    EXPECT_TRUE(compressed_mesh.get_changes().is_set(Meshes::Change::GeometryUpdated));
+    EXPECT_EQ(nullptr, compressed_mesh.get_positions());
+    EXPECT_EQ(nullptr, compressed_mesh.get_normals());
+    EXPECT_EQ(nullptr, compressed_mesh.get_texcoords());
+
+    // 14 bytes pr vertex instead of 32.
+    EXPECT_EQ(32u * vertex_count, Meshes::get_memory_usage(mesh.get_ID())[Core::MemoryCategory::Vertices]);
+    EXPECT_EQ(14u * vertex_count, Meshes::get_memory_usage(compressed_mesh.get_ID())[Core::MemoryCategory::Vertices]);
+
+    // The decoded attributes are within the precision of their storage.
+    Math::Vector3f quantization_step = mesh.compute_bounds().size() / 65535.0f;
+    for (unsigned int v = 0; v < vertex_count; ++v) {
+        Math::Vector3f position = mesh.get_positions()[v], compressed_position = compressed_mesh.get_position(v);
+        for (int a = 0; a < 3; ++a)
+            EXPECT_NEAR(position[a], compressed_position[a], quantization_step[a] * 0.51f);
+        EXPECT_LT(Math::magnitude(mesh.get_normals()[v] - compressed_mesh.get_normal(v)), 0.0001f);
+        Math::Vector2f texcoord = mesh.get_texcoords()[v], compressed_texcoord = compressed_mesh.get_texcoord(v);
+        EXPECT_NEAR(texcoord.x, compressed_texcoord.x, 0.0005f);
+        EXPECT_NEAR(texcoord.y, compressed_texcoord.y, 0.0005f);
+    }
+
+    // Bulk decoding matches decoding a vertex at a time, also for ranges that aren't multiples of four.
+    unsigned int first_vertex = 3, decoded_vertex_count = vertex_count - 8;
+    std::vector<Math::Vector3f> positions(decoded_vertex_count), normals(decoded_vertex_count);
+    std::vector<Math::Vector2f> texcoords(decoded_vertex_count);
+    compressed_mesh.decode_positions(first_vertex, decoded_vertex_count, positions.data());
+    compressed_mesh.decode_normals(first_vertex, decoded_vertex_count, normals.data());
+    compressed_mesh.decode_texcoords(first_vertex, decoded_vertex_count, texcoords.data());
+    for (unsigned int v = 0; v < decoded_vertex_count; ++v) {
+        EXPECT_EQ(compressed_mesh.get_position(first_vertex + v), positions[v]);
+        EXPECT_EQ(compressed_mesh.get_normal(first_vertex + v), normals[v]);
+        EXPECT_EQ(compressed_mesh.get_texcoord(first_vertex + v), texcoords[v]);
+    }
+
+    // Decompression restores float buffers with the decoded attributes.
+    compressed_mesh.set_compression(MeshFlag::None);
+    EXPECT_EQ(MeshFlags(MeshFlag::AllBuffers), compressed_mesh.get_flags());
+    ASSERT_NE(nullptr, compressed_mesh.get_positions());
+    for (unsigned int v = 0; v < decoded_vertex_count; ++v) {
+        EXPECT_EQ(positions[v], compressed_mesh.get_positions()[first_vertex + v]);
+        EXPECT_EQ(normals[v], compressed_mesh.get_normals()[first_vertex + v]);
+        EXPECT_EQ(texcoords[v], compressed_mesh.get_texcoords()[first_vertex + v]);
+    }
+}
+
+TEST_F(Assets_Mesh, utilities_on_compressed_meshes) {
+    Mesh mesh = MeshCreation::cube(2);
+    Mesh compressed_mesh = MeshUtils::deep_clone(mesh.get_ID());
+    compressed_mesh.set_compression(MeshFlag::Compressed);
+
+    // Cloning preserves the storage.
+    Mesh cloned_mesh = MeshUtils::deep_clone(compressed_mesh.get_ID());
+    EXPECT_EQ(compressed_mesh.get_flags(), cloned_mesh.get_flags());
+    for (unsigned int v = 0; v < cloned_mesh.get_vertex_count(); ++v)
+        EXPECT_EQ(compressed_mesh.get_position(v), cloned_mesh.get_position(v));
+
+    // Transforming keeps the mesh compressed.
+    MeshUtils::transform_mesh(compressed_mesh.get_ID(), Math::Transform(Math::Vector3f(10, 0, 0)));
+    EXPECT_EQ(compressed_mesh.get_flags(), cloned_mesh.get_flags());
+    Math::AABB bounds = compressed_mesh.compute_bounds();
+    EXPECT_FLOAT_EQ(9.5f, bounds.minimum.x);
+    EXPECT_FLOAT_EQ(10.5f, bounds.maximum.x);
+
+    // Combining compressed and uncompressed meshes.
+    Mesh combined_mesh = MeshUtils::combine("Combined", mesh.get_ID(), Math::Transform::identity(), compressed_mesh.get_ID(), Math::Transform::identity());
+    EXPECT_EQ(MeshFlags(MeshFlag::AllBuffers), combined_mesh.get_flags());
+    EXPECT_EQ(mesh.get_vertex_count() * 2, combined_mesh.get_vertex_count());
+    EXPECT_FLOAT_EQ(-0.5f, combined_mesh.get_bounds().minimum.x);
+    EXPECT_FLOAT_EQ(10.5f, combined_mesh.get_bounds().maximum.x);
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(combined_mesh.get_ID()));
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(compressed_mesh.get_ID()));
+}
+
+TEST_F(Assets_Mesh, vertex_welding) {
+    // The cube's faces are separated by normal seams, so there is nothing to weld.
+    Mesh cube = MeshCreation::cube(2);
+    unsigned int cube_vertex_count = cube.get_vertex_count();
+    EXPECT_EQ(0u, MeshUtils::weld_vertices(cube.get_ID()));
+    EXPECT_EQ(cube_vertex_count, cube.get_vertex_count());
+
+    // Combining the cube with itself duplicates every vertex.
+    Mesh combined_mesh = MeshUtils::combine("Combined", cube.get_ID(), Math::Transform::identity(), cube.get_ID(), Math::Transform::identity());
+    std::vector<Math::Vector3f> triangle_positions;
+    std::vector<Math::Vector3f> triangle_normals;
+    for (unsigned int index : Core::Iterable<unsigned int*>(combined_mesh.get_indices(), combined_mesh.get_index_count())) {
+        triangle_positions.push_back(combined_mesh.get_positions()[index]);
+        triangle_normals.push_back(combined_mesh.get_normals()[index]);
+    }
+
+    Meshes::reset_change_notifications();
+    EXPECT_EQ(cube_vertex_count, MeshUtils::weld_vertices(combined_mesh.get_ID()));
+    EXPECT_TRUE(combined_mesh.get_changes().is_set(Meshes::Change::GeometryUpdated));
+    EXPECT_EQ(cube_vertex_count, combined_mesh.get_vertex_count());
+    EXPECT_EQ(32u * cube_vertex_count, Meshes::get_memory_usage(combined_mesh.get_ID())[Core::MemoryCategory::Vertices]);
+    EXPECT_FALSE(MeshTests::has_invalid_indices(combined_mesh.get_ID()));
+    EXPECT_EQ(cube.get_bounds(), combined_mesh.get_bounds());
+    for (unsigned int i = 0; i < combined_mesh.get_index_count(); ++i) {
+        unsigned int index = combined_mesh.get_indices()[i];
+        EXPECT_EQ(triangle_positions[i], combined_mesh.get_positions()[index]);
+        EXPECT_EQ(triangle_normals[i], combined_mesh.get_normals()[index]);
+    }
+}
+
+TEST_F(Assets_Mesh, vertex_welding_with_epsilon) {
+    // Expand the torus to three vertices pr triangle and offset the vertices slightly.
+    Mesh torus = MeshCreation::torus(16, 8, 0.3f);
+    MeshUtils::weld_vertices(torus.get_ID());
+    unsigned int torus_vertex_count = torus.get_vertex_count();
+    Mesh expanded_torus = Meshes::create("Expanded torus", torus.get_primitive_count(), torus.get_index_count(), { MeshFlag::Position, MeshFlag::Texcoord });
+    MeshUtils::expand_indexed_buffer(torus.get_primitives(), torus.get_primitive_count(), torus.get_positions(), expanded_torus.get_positions());
+    MeshUtils::expand_indexed_buffer(torus.get_primitives(), torus.get_primitive_count(), torus.get_texcoords(), expanded_torus.get_texcoords());
+    for (unsigned int i = 0; i < expanded_torus.get_index_count(); ++i) {
+        expanded_torus.get_indices()[i] = i;
+        expanded_torus.get_positions()[i].x += (i % 3) * 0.00001f;
+    }
+    Mesh offset_torus = MeshUtils::deep_clone(expanded_torus.get_ID());
+
+    // Without an epsilon only vertices at the same offset are welded.
+    MeshUtils::weld_vertices(expanded_torus.get_ID());
+    EXPECT_LT(torus_vertex_count, expanded_torus.get_vertex_count());
+    EXPECT_GT(expanded_torus.get_index_count(), expanded_torus.get_vertex_count());
+
+    // With an epsilon larger than the offsets the torus' vertices are recovered.
+    unsigned int removed_vertex_count = MeshUtils::weld_vertices(offset_torus.get_ID(), 0.0001f);
+    EXPECT_EQ(torus_vertex_count, offset_torus.get_vertex_count());
+    EXPECT_EQ(offset_torus.get_index_count() - torus_vertex_count, removed_vertex_count);
+    EXPECT_FALSE(MeshTests::has_invalid_indices(offset_torus.get_ID()));
+    for (Math::Vector3ui primitive : offset_torus.get_primitive_iterable())
+        EXPECT_TRUE(primitive.x != primitive.y && primitive.x != primitive.z && primitive.y != primitive.z);
+}
+
+TEST_F(Assets_Mesh, vertex_welding_is_not_transitive) {
+    // A row of vertices where neighbours are within epsilon, but their neighbours' neighbours are not.
+    float epsilon = 0.1f;
+    Mesh mesh = Meshes::create("Row", 4, 6, { MeshFlag::Position });
+    Math::Vector3f* positions = mesh.get_positions();
+    for (int v = 0; v < 4; ++v)
+        positions[v] = Math::Vector3f(v * 0.6f * epsilon, 0, 0);
+    positions[4] = Math::Vector3f(0, 1, 0);
+    positions[5] = Math::Vector3f(0, 0, 1);
+    for (unsigned int p = 0; p < 4; ++p)
+        mesh.get_primitives()[p] = Math::Vector3ui(p, 4, 5);
+    std::vector<Math::Vector3f> triangle_positions;
+    for (unsigned int index : Core::Iterable<unsigned int*>(mesh.get_indices(), mesh.get_index_count()))
+        triangle_positions.push_back(positions[index]);
+
+    EXPECT_EQ(2u, MeshUtils::weld_vertices(mesh.get_ID(), epsilon));
+    EXPECT_EQ(4u, mesh.get_vertex_count());
+    ASSERT_EQ(4u, mesh.get_primitive_count());
+    for (unsigned int i = 0; i < mesh.get_index_count(); ++i)
+        EXPECT_LE(magnitude(triangle_positions[i] - mesh.get_positions()[mesh.get_indices()[i]]), epsilon);
+}
+
+TEST_F(Assets_Mesh, vertex_welding_removes_degenerate_triangles) {
+    float epsilon = 0.1f;
+    Mesh mesh = Meshes::create("Sliver", 2, 4, { MeshFlag::Position });
+    mesh.get_positions()[0] = Math::Vector3f(0, 0, 0);
+    mesh.get_positions()[1] = Math::Vector3f(0.5f * epsilon, 0, 0);
+    mesh.get_positions()[2] = Math::Vector3f(0, 1, 0);
+    mesh.get_positions()[3] = Math::Vector3f(1, 0, 0);
+    mesh.get_primitives()[0] = Math::Vector3ui(0, 1, 2);
+    mesh.get_primitives()[1] = Math::Vector3ui(0, 3, 2);
+
+    EXPECT_EQ(1u, MeshUtils::weld_vertices(mesh.get_ID(), epsilon));
+    ASSERT_EQ(1u, mesh.get_primitive_count());
+    EXPECT_EQ(Math::Vector3ui(0, 2, 1), mesh.get_primitives()[0]);
+    EXPECT_FALSE(MeshTests::has_invalid_indices(mesh.get_ID()));
+    EXPECT_EQ(sizeof(Math::Vector3ui), Meshes::get_memory_usage(mesh.get_ID())[Core::MemoryCategory::Indices]);
+}
+
+TEST_F(Assets_Mesh, vertex_welding_on_compressed_mesh) {
+    Mesh cube = MeshCreation::cube(2);
+    Mesh combined_mesh = MeshUtils::combine("Combined", cube.get_ID(), Math::Transform::identity(), cube.get_ID(), Math::Transform::identity());
+    combined_mesh.set_compression(MeshFlag::Compressed);
+    MeshFlags compressed_flags = combined_mesh.get_flags();
+
+    EXPECT_EQ(cube.get_vertex_count(), MeshUtils::weld_vertices(combined_mesh.get_ID()));
+    EXPECT_EQ(cube.get_vertex_count(), combined_mesh.get_vertex_count());
+    EXPECT_EQ(compressed_flags, combined_mesh.get_flags());
+    EXPECT_EQ(14u * cube.get_vertex_count(), Meshes::get_memory_usage(combined_mesh.get_ID())[Core::MemoryCategory::Vertices]);
+    EXPECT_FALSE(MeshTests::has_invalid_indices(combined_mesh.get_ID()));
+    EXPECT_EQ(0u, MeshTests::normals_correspond_to_winding_order(combined_mesh.get_ID()));
+}
+
 } // NS Assets
 } // NS Bifrost
 
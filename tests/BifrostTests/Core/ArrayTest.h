@@ -13,6 +13,8 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+
 namespace Bifrost {
 namespace Core {
 
@@ -78,6 +80,114 @@ GTEST_TEST(Core_Array, push_back) {
         EXPECT_EQ(i, array[i]);
 }
 
+GTEST_TEST(Core_Array, geometric_growth) {
+    Array<unsigned int> array;
+    unsigned int reallocation_count = 0;
+    const unsigned int* previous_data = array.data();
+    for (unsigned int i = 0; i < 10000; ++i) {
+        array.push_back(i);
+        if (array.data() != previous_data) {
+            ++reallocation_count;
+            previous_data = array.data();
+        }
+    }
+
+    EXPECT_EQ(10000u, array.size());
+    EXPECT_GE(array.capacity(), array.size());
+    EXPECT_LT(reallocation_count, 30u);
+    for (unsigned int i = 0; i != array.size(); ++i)
+        EXPECT_EQ(i, array[i]);
+
+    array.shrink_to_fit();
+    EXPECT_EQ(array.size(), array.capacity());
+}
+
+GTEST_TEST(Core_Array, copy_assignment) {
+    Array<unsigned int> array0 = { 0u, 1u, 2u };
+    Array<unsigned int> array1 = { 3u, 4u };
+    array1 = array0;
+    array1 = array1;
+
+    EXPECT_EQ(3u, array1.size());
+    EXPECT_NE(array0.data(), array1.data());
+    for (unsigned int i = 0; i != array1.size(); ++i)
+        EXPECT_EQ(i, array1[i]);
+}
+
+GTEST_TEST(Core_Array, push_back_own_element) {
+    Array<unsigned int> array = { 7u };
+    for (int i = 0; i < 10; ++i)
+        array.push_back(array[0]);
+    array.push_back(array.begin(), array.end());
+
+    EXPECT_EQ(22u, array.size());
+    for (unsigned int i = 0; i != array.size(); ++i)
+        EXPECT_EQ(7u, array[i]);
+}
+
+GTEST_TEST(Core_Array, aligned_elements) {
+    AlignedArray<float, 64> array = AlignedArray<float, 64>(3u);
+    EXPECT_EQ(0u, size_t(array.data()) % 64);
+
+    for (int i = 0; i < 100; ++i)
+        array.push_back(float(i));
+    EXPECT_EQ(0u, size_t(array.data()) % 64);
+}
+
+GTEST_TEST(Core_Array, move_only_and_non_default_constructible_elements) {
+    struct Element {
+        std::unique_ptr<int> value;
+        explicit Element(int v) : value(new int(v)) { }
+    };
+
+    Array<Element> array;
+    for (int i = 0; i < 100; ++i)
+        array.emplace_back(i);
+    array.push_back(Element(100));
+
+    EXPECT_EQ(101u, array.size());
+    for (unsigned int i = 0; i != array.size(); ++i)
+        EXPECT_EQ(int(i), *array[i].value);
+
+    array.pop_back();
+    EXPECT_EQ(100u, array.size());
+    EXPECT_EQ(99, *array.back().value);
+
+    Array<Element> moved_array = std::move(array);
+    EXPECT_EQ(100u, moved_array.size());
+    EXPECT_EQ(0u, array.size());
+}
+
+// Bump allocator that never frees, as used for per frame scratch memory.
+struct ArenaAllocator {
+    static constexpr size_t alignment = 16;
+    unsigned char* memory;
+    size_t* used_byte_count;
+
+    void* allocate(size_t byte_count) {
+        void* pointer = memory + *used_byte_count;
+        *used_byte_count += (byte_count + alignment - 1) & ~(alignment - 1);
+        return pointer;
+    }
+    void deallocate(void* pointer, size_t byte_count) { }
+};
+
+GTEST_TEST(Core_Array, arena_allocator) {
+    alignas(16) unsigned char memory[4096];
+    size_t used_byte_count = 0;
+    ArenaAllocator allocator = { memory, &used_byte_count };
+
+    Array<unsigned int, unsigned int, ArenaAllocator> array = Array<unsigned int, unsigned int, ArenaAllocator>(allocator);
+    for (unsigned int i = 0; i < 100; ++i)
+        array.push_back(i);
+
+    EXPECT_GE(array.data(), (unsigned int*)memory);
+    EXPECT_LT(array.data(), (unsigned int*)(memory + 4096));
+    EXPECT_LE(used_byte_count, 4096u);
+    for (unsigned int i = 0; i != array.size(); ++i)
+        EXPECT_EQ(i, array[i]);
+}
+
 } // NS Core
 } // NS Bifrost
 
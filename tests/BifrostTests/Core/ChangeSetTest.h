@@ -0,0 +1,219 @@
+// Test Bifrost change set.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_CHANGE_SET_TEST_H_
+#define _BIFROST_CORE_CHANGE_SET_TEST_H_
+
+#include <Bifrost/Core/Bitmask.h>
+#include <Bifrost/Core/ChangeSet.h>
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/TaskScheduler.h>
+#include <Bifrost/Core/UniqueIDGenerator.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Bifrost {
+namespace Core {
+
+class Core_ChangeSet : public ::testing::Test {
+protected:
+    enum class Change : unsigned char {
+        None = 0u,
+        Created = 1u << 0u,
+        Destroyed = 1u << 1u,
+        Updated = 1u << 2u,
+    };
+    typedef Bitmask<Change> Changes;
+    typedef ChangeSet<Changes, UID> TestChangeSet;
+    typedef TestChangeSet::ResourceChanges ResourceChanges;
+
+    static std::vector<ResourceChanges> to_vector(Iterable<TestChangeSet::ConsumedIterator> changes) {
+        return std::vector<ResourceChanges>(changes.begin(), changes.end());
+    }
+};
+
+TEST_F(Core_ChangeSet, reset_only_clears_changed_resources) {
+    UIDGenerator UID_generator = UIDGenerator(8u);
+    TestChangeSet changes = TestChangeSet(8u);
+    UID id0 = UID_generator.generate();
+    UID id1 = UID_generator.generate();
+
+    changes.set_change(id0, Change::Created);
+    changes.add_change(id0, Change::Updated);
+    changes.add_change(id1, Change::Updated);
+
+    EXPECT_EQ(Changes({ Change::Created, Change::Updated }), changes.get_changes(id0));
+    EXPECT_EQ(Changes(Change::Updated), changes.get_changes(id1));
+    EXPECT_EQ(2, changes.get_changed_resources().end() - changes.get_changed_resources().begin());
+
+    changes.reset_change_notifications();
+    EXPECT_TRUE(changes.get_changes(id0).none_set());
+    EXPECT_TRUE(changes.get_changes(id1).none_set());
+    EXPECT_TRUE(changes.get_changed_resources().is_empty());
+}
+
+TEST_F(Core_ChangeSet, resize_preserves_changes) {
+    UIDGenerator UID_generator = UIDGenerator(4u);
+    TestChangeSet changes = TestChangeSet(4u);
+    UID id = UID_generator.generate();
+    changes.set_change(id, Change::Created);
+
+    for (int size = 5; size < 64; ++size) {
+        changes.resize(size);
+        EXPECT_EQ(Changes(Change::Created), changes.get_changes(id));
+    }
+
+    changes.resize(0);
+    EXPECT_TRUE(changes.get_changed_resources().is_empty());
+}
+
+TEST_F(Core_ChangeSet, consumers_at_different_rates) {
+    UIDGenerator UID_generator = UIDGenerator(8u);
+    TestChangeSet changes = TestChangeSet(8u);
+    auto fast_consumer = changes.add_consumer();
+    auto slow_consumer = changes.add_consumer();
+
+    // Tick 0.
+    UID id0 = UID_generator.generate();
+    changes.set_change(id0, Change::Created);
+    auto fast_changes = to_vector(changes.consume_changes(fast_consumer));
+    ASSERT_EQ(1u, fast_changes.size());
+    EXPECT_EQ(id0, fast_changes[0].ID);
+    EXPECT_EQ(Changes(Change::Created), fast_changes[0].changes);
+    changes.reset_change_notifications();
+
+    // Tick 1.
+    UID id1 = UID_generator.generate();
+    changes.set_change(id1, Change::Created);
+    changes.add_change(id0, Change::Updated);
+    fast_changes = to_vector(changes.consume_changes(fast_consumer));
+    ASSERT_EQ(2u, fast_changes.size());
+    EXPECT_EQ(id1, fast_changes[0].ID);
+    EXPECT_EQ(id0, fast_changes[1].ID);
+    EXPECT_EQ(Changes(Change::Updated), fast_changes[1].changes);
+    changes.reset_change_notifications();
+
+    // The slow consumer sees the changes of both ticks, merged pr resource.
+    auto slow_changes = to_vector(changes.consume_changes(slow_consumer));
+    ASSERT_EQ(2u, slow_changes.size());
+    EXPECT_EQ(id0, slow_changes[0].ID);
+    EXPECT_EQ(Changes({ Change::Created, Change::Updated }), slow_changes[0].changes);
+    EXPECT_EQ(id1, slow_changes[1].ID);
+    EXPECT_EQ(Changes(Change::Created), slow_changes[1].changes);
+
+    // Nothing left to consume.
+    EXPECT_TRUE(changes.consume_changes(fast_consumer).is_empty());
+    EXPECT_TRUE(changes.consume_changes(slow_consumer).is_empty());
+
+    changes.remove_consumer(fast_consumer);
+    changes.remove_consumer(slow_consumer);
+}
+
+TEST_F(Core_ChangeSet, consumer_sees_reused_slot_as_separate_resources) {
+    UIDGenerator UID_generator = UIDGenerator(8u);
+    TestChangeSet changes = TestChangeSet(8u);
+    auto consumer = changes.add_consumer();
+
+    // Create and destroy a resource and reuse its slot, until the slot of the first resource is reused.
+    UID first_ID = UID_generator.generate();
+    changes.set_change(first_ID, Change::Created);
+    UID_generator.erase(first_ID);
+    changes.add_change(first_ID, Change::Destroyed);
+    UID reused_ID = UID_generator.generate();
+    while (reused_ID.get_index() != first_ID.get_index()) {
+        UID_generator.erase(reused_ID);
+        reused_ID = UID_generator.generate();
+    }
+    changes.reset_change_notifications();
+    changes.set_change(reused_ID, Change::Created);
+
+    auto consumed_changes = to_vector(changes.consume_changes(consumer));
+    ASSERT_EQ(2u, consumed_changes.size());
+    EXPECT_EQ(first_ID, consumed_changes[0].ID);
+    EXPECT_EQ(Changes({ Change::Created, Change::Destroyed }), consumed_changes[0].changes);
+    EXPECT_EQ(reused_ID, consumed_changes[1].ID);
+    EXPECT_EQ(Changes(Change::Created), consumed_changes[1].changes);
+}
+
+TEST_F(Core_ChangeSet, consumer_only_sees_changes_after_it_was_added) {
+    UIDGenerator UID_generator = UIDGenerator(8u);
+    TestChangeSet changes = TestChangeSet(8u);
+    UID id0 = UID_generator.generate();
+    changes.set_change(id0, Change::Created);
+
+    auto consumer = changes.add_consumer();
+    EXPECT_TRUE(changes.consume_changes(consumer).is_empty());
+
+    UID id1 = UID_generator.generate();
+    changes.set_change(id1, Change::Created);
+    auto consumed_changes = to_vector(changes.consume_changes(consumer));
+    ASSERT_EQ(1u, consumed_changes.size());
+    EXPECT_EQ(id1, consumed_changes[0].ID);
+}
+
+TEST_F(Core_ChangeSet, consumers_in_concurrent_non_mutating_callbacks) {
+    typedef Engine::Manager Manager;
+    const int resource_count = 1 << 16;
+    UIDGenerator UID_generator = UIDGenerator(resource_count);
+    std::vector<UID> IDs(resource_count);
+    for (UID& id : IDs)
+        id = UID_generator.generate();
+    TestChangeSet changes = TestChangeSet(UID_generator.capacity());
+
+    Engine engine = Engine("");
+    engine.add_mutating_callback("Change resources", [&]() {
+        for (int r = 0; r < 4; ++r)
+            for (UID id : IDs)
+                changes.add_change(id, Change::Updated);
+    }, Manager::None, Manager::SceneNodes);
+
+    // The consumers wait for each other to start, so they consume at the same time when the scheduler has workers.
+    bool has_workers = TaskScheduler::get_global().get_worker_count() > 0;
+    std::atomic<int> started_count = 0;
+    auto consume = [&](TestChangeSet::ConsumerID consumer, size_t& consumed_count, bool& all_updated) {
+        ++started_count;
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (has_workers && started_count.load() < 2 && std::chrono::steady_clock::now() < timeout)
+            std::this_thread::yield();
+
+        auto consumed_changes = changes.consume_changes(consumer);
+        consumed_count = consumed_changes.end() - consumed_changes.begin();
+        for (ResourceChanges resource_changes : consumed_changes)
+            all_updated &= resource_changes.changes == Change::Updated;
+    };
+
+    auto consumer0 = changes.add_consumer();
+    auto consumer1 = changes.add_consumer();
+    size_t consumed_count0, consumed_count1;
+    bool all_updated0 = true, all_updated1 = true;
+    engine.add_non_mutating_callback("Consume 0", [&]() { consume(consumer0, consumed_count0, all_updated0); }, Manager::SceneNodes, Manager::None);
+    engine.add_non_mutating_callback("Consume 1", [&]() { consume(consumer1, consumed_count1, all_updated1); }, Manager::SceneNodes, Manager::None);
+    engine.add_tick_cleanup_callback("Reset changes", [&]() { changes.reset_change_notifications(); }, Manager::None, Manager::SceneNodes);
+
+    for (int tick = 0; tick < 8; ++tick) {
+        started_count = 0;
+        engine.do_tick(0.1);
+        EXPECT_EQ(resource_count, consumed_count0);
+        EXPECT_EQ(resource_count, consumed_count1);
+    }
+    EXPECT_TRUE(all_updated0);
+    EXPECT_TRUE(all_updated1);
+
+    changes.remove_consumer(consumer0);
+    changes.remove_consumer(consumer1);
+}
+
+} // NS Core
+} // NS Bifrost
+
+#endif // _BIFROST_CORE_CHANGE_SET_TEST_H_
@@ -0,0 +1,178 @@
+// Test Bifrost engine.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_ENGINE_TEST_H_
+#define _BIFROST_CORE_ENGINE_TEST_H_
+
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Core/Profiler.h>
+#include <Bifrost/Core/TaskScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Bifrost {
+namespace Core {
+
+GTEST_TEST(Core_Engine, callback_stages_are_ordered) {
+    Engine engine = Engine("");
+    std::vector<int> order;
+
+    engine.add_tick_cleanup_callback("Tick cleanup", [&]() { order.push_back(2); });
+    engine.add_non_mutating_callback("Non-mutating", [&]() { order.push_back(1); });
+    engine.add_mutating_callback("Mutating", [&]() { order.push_back(0); });
+
+    engine.do_tick(0.1);
+
+    ASSERT_EQ(3u, order.size());
+    EXPECT_EQ(0, order[0]);
+    EXPECT_EQ(1, order[1]);
+    EXPECT_EQ(2, order[2]);
+}
+
+GTEST_TEST(Core_Engine, undeclared_callbacks_run_in_order_on_ticking_thread) {
+    Engine engine = Engine("");
+    std::vector<int> order;
+    std::thread::id ticking_thread = std::this_thread::get_id();
+    bool all_on_ticking_thread = true;
+
+    for (int i = 0; i < 8; ++i)
+        engine.add_mutating_callback("Undeclared", [&, i]() {
+            order.push_back(i);
+            all_on_ticking_thread &= std::this_thread::get_id() == ticking_thread;
+        });
+
+    engine.do_tick(0.1);
+
+    ASSERT_EQ(8u, order.size());
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(i, order[i]);
+    EXPECT_TRUE(all_on_ticking_thread);
+}
+
+GTEST_TEST(Core_Engine, conflicting_callbacks_are_ordered) {
+    typedef Engine::Manager Manager;
+    Engine engine = Engine("");
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(id);
+    };
+
+    // Writer of scene nodes, followed by two readers and a final writer.
+    engine.add_mutating_callback("Write scene nodes", [&]() { record(0); }, Manager::None, Manager::SceneNodes);
+    engine.add_mutating_callback("Read scene nodes, write meshes", [&]() { record(1); }, Manager::SceneNodes, Manager::Meshes);
+    engine.add_mutating_callback("Read scene nodes, write images", [&]() { record(2); }, Manager::SceneNodes, Manager::Images);
+    engine.add_mutating_callback("Write scene nodes again", [&]() { record(3); }, { Manager::Meshes, Manager::Images }, Manager::SceneNodes);
+
+    for (int t = 0; t < 16; ++t) {
+        order.clear();
+        engine.do_tick(0.1);
+
+        ASSERT_EQ(4u, order.size());
+        EXPECT_EQ(0, order[0]);
+        EXPECT_TRUE((order[1] == 1 && order[2] == 2) || (order[1] == 2 && order[2] == 1));
+        EXPECT_EQ(3, order[3]);
+    }
+}
+
+GTEST_TEST(Core_Engine, independent_callbacks_all_run) {
+    typedef Engine::Manager Manager;
+    Engine engine = Engine("");
+
+    std::atomic<int> call_count = 0;
+    for (int i = 0; i < 32; ++i)
+        engine.add_non_mutating_callback("Count", [&]() { ++call_count; }, Manager::SceneNodes, Manager::None);
+
+    engine.do_tick(0.1);
+    EXPECT_EQ(32, call_count.load());
+
+    engine.do_tick(0.1);
+    EXPECT_EQ(64, call_count.load());
+}
+
+GTEST_TEST(Core_Engine, independent_callbacks_run_concurrently) {
+    typedef Engine::Manager Manager;
+    if (TaskScheduler::get_global().get_worker_count() == 0)
+        GTEST_SKIP();
+
+    Engine engine = Engine("");
+
+    // Each callback waits for the other to start, which only happens if they run at the same time.
+    std::atomic<int> started_count = 0;
+    std::atomic<int> overlapping_count = 0;
+    auto wait_for_other = [&]() {
+        ++started_count;
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (started_count.load() < 2 && std::chrono::steady_clock::now() < timeout)
+            std::this_thread::yield();
+        if (started_count.load() == 2)
+            ++overlapping_count;
+    };
+    engine.add_mutating_callback("Write cameras", wait_for_other, Manager::Input, Manager::Cameras);
+    engine.add_mutating_callback("Write scene nodes", wait_for_other, Manager::Input, Manager::SceneNodes);
+
+    engine.do_tick(0.1);
+    EXPECT_EQ(2, overlapping_count.load());
+}
+
+GTEST_TEST(Core_Engine, window_writers_run_on_ticking_thread) {
+    typedef Engine::Manager Manager;
+    Engine engine = Engine("");
+    std::thread::id ticking_thread = std::this_thread::get_id();
+
+    std::atomic<int> window_writer_count = 0;
+    std::atomic<bool> all_on_ticking_thread = true;
+    for (int i = 0; i < 8; ++i) {
+        engine.add_non_mutating_callback("Read scene nodes", []() {}, Manager::SceneNodes, Manager::None);
+        engine.add_non_mutating_callback("Write window", [&]() {
+            ++window_writer_count;
+            if (std::this_thread::get_id() != ticking_thread)
+                all_on_ticking_thread = false;
+        }, Manager::All, Manager::Window);
+    }
+
+    engine.do_tick(0.1);
+    EXPECT_EQ(8, window_writer_count.load());
+    EXPECT_TRUE(all_on_ticking_thread.load());
+}
+
+GTEST_TEST(Core_Engine, callbacks_are_profiled_by_name) {
+    Engine engine = Engine("");
+    engine.add_mutating_callback("Mutating", []() {});
+    engine.add_non_mutating_callback("Non-mutating", []() {});
+
+    Profiler::reset();
+    Profiler::set_enabled(true);
+    engine.do_tick(0.1);
+    Profiler::set_enabled(false);
+
+    auto summary = Profiler::get_frame_summary(Profiler::get_frame());
+    Profiler::reset();
+    auto has_scope = [&](const char* name) -> bool {
+        for (const Profiler::ScopeSummary& scope : summary)
+            if (strcmp(scope.name, name) == 0)
+                return true;
+        return false;
+    };
+    EXPECT_TRUE(has_scope("Mutating"));
+    EXPECT_TRUE(has_scope("Non-mutating"));
+}
+
+} // NS Core
+} // NS Bifrost
+
+#endif // _BIFROST_CORE_ENGINE_TEST_H_
@@ -0,0 +1,111 @@
+// Test Bifrost profiler.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_PROFILER_TEST_H_
+#define _BIFROST_CORE_PROFILER_TEST_H_
+
+#include <Bifrost/Core/Profiler.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+namespace Bifrost {
+namespace Core {
+
+class Core_Profiler : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Profiler::reset();
+        Profiler::set_enabled(true);
+    }
+
+    void TearDown() override {
+        Profiler::set_enabled(false);
+        Profiler::reset();
+    }
+};
+
+TEST_F(Core_Profiler, disabled_profiler_records_nothing) {
+    Profiler::set_enabled(false);
+    { BIFROST_PROFILE_SCOPE("Disabled"); }
+
+    for (auto& thread : Profiler::collect_events())
+        EXPECT_TRUE(thread.events.empty());
+}
+
+TEST_F(Core_Profiler, nested_scopes_in_frame_summary) {
+    Profiler::begin_frame();
+    unsigned int frame = Profiler::get_frame();
+    {
+        BIFROST_PROFILE_SCOPE("Parent");
+        for (int i = 0; i < 3; ++i) {
+            BIFROST_PROFILE_SCOPE("Child");
+        }
+    }
+
+    auto summary = Profiler::get_frame_summary(frame);
+    ASSERT_EQ(2u, summary.size());
+
+    EXPECT_STREQ("Parent", summary[0].name);
+    EXPECT_EQ(0u, summary[0].depth);
+    EXPECT_EQ(1u, summary[0].call_count);
+
+    EXPECT_STREQ("Child", summary[1].name);
+    EXPECT_EQ(1u, summary[1].depth);
+    EXPECT_EQ(3u, summary[1].call_count);
+    EXPECT_LE(summary[1].total_ms, summary[0].total_ms);
+
+    // Scopes from other frames are not part of the summary.
+    Profiler::begin_frame();
+    { BIFROST_PROFILE_SCOPE("Next frame"); }
+    EXPECT_EQ(2u, Profiler::get_frame_summary(frame).size());
+}
+
+TEST_F(Core_Profiler, events_from_multiple_threads) {
+    { BIFROST_PROFILE_SCOPE("Main thread"); }
+    std::thread worker([]() { BIFROST_PROFILE_SCOPE("Worker thread"); });
+    worker.join();
+
+    int thread_with_events_count = 0;
+    for (auto& thread : Profiler::collect_events())
+        if (!thread.events.empty())
+            ++thread_with_events_count;
+    EXPECT_EQ(2, thread_with_events_count);
+}
+
+TEST_F(Core_Profiler, ring_buffer_keeps_newest_events) {
+    for (unsigned int i = 0; i < Profiler::EVENTS_PR_THREAD + 10; ++i) {
+        BIFROST_PROFILE_SCOPE("Overflow");
+    }
+
+    size_t event_count = 0;
+    for (auto& thread : Profiler::collect_events())
+        event_count += thread.events.size();
+    // The slot next in line to be overwritten may be in flight, so it is conservatively dropped.
+    EXPECT_LE(Profiler::EVENTS_PR_THREAD - 1, event_count);
+    EXPECT_GE(Profiler::EVENTS_PR_THREAD, event_count);
+}
+
+TEST_F(Core_Profiler, chrome_trace) {
+    { BIFROST_PROFILE_SCOPE("Quoted \"scope\""); }
+
+    std::ostringstream trace;
+    Profiler::write_chrome_trace(trace);
+    std::string json = trace.str();
+
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"Quoted \\\"scope\\\"\""));
+    EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\""));
+}
+
+} // NS Core
+} // NS Bifrost
+
+#endif // _BIFROST_CORE_PROFILER_TEST_H_
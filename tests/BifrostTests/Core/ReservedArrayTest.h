@@ -0,0 +1,115 @@
+// Test Bifrost reserved array.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_RESERVED_ARRAY_TEST_H_
+#define _BIFROST_CORE_RESERVED_ARRAY_TEST_H_
+
+#include <Bifrost/Core/ReservedArray.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace Bifrost {
+namespace Core {
+
+GTEST_TEST(Core_ReservedArray, growing_keeps_elements_in_place) {
+    ReservedArray<unsigned int> array = ReservedArray<unsigned int>(1u << 20, 8u);
+    EXPECT_EQ(8u, array.size());
+    for (unsigned int i = 0; i < 8u; ++i)
+        array[i] = i;
+
+    unsigned int* data = array.data();
+    array.resize(1u << 19);
+    EXPECT_EQ(1u << 19, array.size());
+    EXPECT_EQ(data, array.data());
+    for (unsigned int i = 0; i < 8u; ++i)
+        EXPECT_EQ(i, array[i]);
+
+    // Committed pages are zero initialized.
+    EXPECT_EQ(0u, array[(1u << 19) - 1]);
+}
+
+GTEST_TEST(Core_ReservedArray, commits_pages_on_demand) {
+    ReservedArray<unsigned char> array = ReservedArray<unsigned char>(1u << 24);
+    EXPECT_EQ(0u, array.committed_bytes());
+
+    array.resize(1u);
+    size_t page_size = VirtualMemory::page_size();
+    EXPECT_EQ(page_size, array.committed_bytes());
+
+    array.resize(page_size + 1);
+    EXPECT_EQ(2 * page_size, array.committed_bytes());
+
+    array.resize(1u);
+    EXPECT_EQ(page_size, array.committed_bytes());
+}
+
+GTEST_TEST(Core_ReservedArray, non_trivial_elements) {
+    ReservedArray<std::string> array = ReservedArray<std::string>(1024u, 2u);
+    EXPECT_TRUE(array[0].empty());
+    array[0] = "Sleipnir";
+    array[1] = "A name long enough to not fit in the small string buffer";
+
+    array.resize(512u);
+    EXPECT_EQ("Sleipnir", array[0]);
+    EXPECT_EQ("A name long enough to not fit in the small string buffer", array[1]);
+    EXPECT_TRUE(array[511].empty());
+
+    array.resize(1u);
+    array.resize(2u);
+    EXPECT_EQ("Sleipnir", array[0]);
+    EXPECT_TRUE(array[1].empty());
+}
+
+GTEST_TEST(Core_ReservedArray, growing_beyond_max_size_moves_elements) {
+    ReservedArray<std::string> array = ReservedArray<std::string>(4u, 4u);
+    array[3] = "Last";
+
+    array.resize(5u);
+    EXPECT_LE(5u, array.max_size());
+    EXPECT_EQ("Last", array[3]);
+    EXPECT_TRUE(array[4].empty());
+}
+
+GTEST_TEST(Core_ReservedArray, release) {
+    ReservedArray<int> array = ReservedArray<int>(1024u, 16u);
+    array.release();
+    EXPECT_EQ(nullptr, array.data());
+    EXPECT_EQ(0u, array.size());
+    EXPECT_EQ(0u, array.committed_bytes());
+}
+
+GTEST_TEST(Core_ReservedArray, read_while_growing) {
+    ReservedArray<int> array = ReservedArray<int>(1u << 22, 1u);
+    array[0] = 42;
+    const int* first_element = &array[0];
+
+    std::atomic<bool> done = false;
+    std::atomic<bool> values_valid = true;
+    std::thread reader = std::thread([&]() {
+        while (!done)
+            if (*first_element != 42)
+                values_valid = false;
+    });
+
+    for (unsigned int size = 2; size <= (1u << 22); size *= 2)
+        array.resize(size);
+    done = true;
+    reader.join();
+
+    EXPECT_TRUE(values_valid);
+    EXPECT_EQ(first_element, array.data());
+}
+
+} // NS Core
+} // NS Bifrost
+
+#endif // _BIFROST_CORE_RESERVED_ARRAY_TEST_H_
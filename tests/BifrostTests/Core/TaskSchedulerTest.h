@@ -0,0 +1,123 @@
+// Test Bifrost task scheduler.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_CORE_TASK_SCHEDULER_TEST_H_
+#define _BIFROST_CORE_TASK_SCHEDULER_TEST_H_
+
+#include <Bifrost/Core/Parallel.h>
+#include <Bifrost/Core/TaskScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace Bifrost {
+namespace Core {
+
+GTEST_TEST(Core_TaskScheduler, task_group_runs_all_tasks) {
+    TaskScheduler scheduler = TaskScheduler(3);
+    std::atomic<int> counter = 0;
+
+    TaskGroup group(scheduler);
+    for (int i = 0; i < 100; ++i)
+        group.run([&]() { ++counter; });
+    group.wait();
+
+    EXPECT_EQ(100, counter.load());
+    EXPECT_TRUE(group.is_done());
+}
+
+GTEST_TEST(Core_TaskScheduler, scheduler_without_workers) {
+    TaskScheduler scheduler = TaskScheduler(0);
+    EXPECT_EQ(1u, scheduler.get_thread_count());
+
+    std::vector<int> values(1000, 0);
+    scheduler.parallel_for(0, 1000, 0, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            values[i] = i;
+    });
+
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, values[i]);
+}
+
+GTEST_TEST(Core_TaskScheduler, parallel_for_visits_every_index_once) {
+    TaskScheduler scheduler = TaskScheduler(3);
+    std::vector<std::atomic<int>> visits(10007);
+    for (auto& visit : visits)
+        visit = 0;
+
+    scheduler.parallel_for(0, 10007, 16, [&](int begin, int end) {
+        EXPECT_LE(begin, end);
+        for (int i = begin; i < end; ++i)
+            ++visits[i];
+    });
+
+    for (auto& visit : visits)
+        EXPECT_EQ(1, visit.load());
+}
+
+GTEST_TEST(Core_TaskScheduler, nested_parallelism) {
+    TaskScheduler scheduler = TaskScheduler(3);
+    const int outer_count = 16, inner_count = 1000;
+    std::vector<int> values(outer_count * inner_count, 0);
+
+    scheduler.parallel_for(0, outer_count, 1, [&](int outer_begin, int outer_end) {
+        for (int o = outer_begin; o < outer_end; ++o)
+            scheduler.parallel_for(0, inner_count, 10, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i)
+                    values[o * inner_count + i] = o + i;
+            });
+    });
+
+    for (int o = 0; o < outer_count; ++o)
+        for (int i = 0; i < inner_count; ++i)
+            EXPECT_EQ(o + i, values[o * inner_count + i]);
+}
+
+GTEST_TEST(Core_TaskScheduler, parallel_reduce) {
+    TaskScheduler scheduler = TaskScheduler(3);
+    long long sum = scheduler.parallel_reduce(0, 100000, 64, 0ll,
+        [](int begin, int end, long long partial_sum) -> long long {
+            for (int i = begin; i < end; ++i)
+                partial_sum += i;
+            return partial_sum;
+        }, [](long long lhs, long long rhs) { return lhs + rhs; });
+
+    EXPECT_EQ(100000ll * 99999ll / 2, sum);
+
+    // Empty ranges return the identity.
+    int empty_sum = scheduler.parallel_reduce(5, 5, 0, 42, [](int, int, int v) { return v + 1; }, [](int lhs, int rhs) { return lhs + rhs; });
+    EXPECT_EQ(42, empty_sum);
+}
+
+GTEST_TEST(Core_TaskScheduler, async) {
+    TaskScheduler scheduler = TaskScheduler(2);
+    std::future<int> answer = scheduler.async([]() { return 42; });
+    EXPECT_EQ(42, answer.get());
+}
+
+GTEST_TEST(Core_Parallel, reduce_and_for_range) {
+    int sum = Parallel::reduce(0, 1000, 0, [](int i) { return i; }, [](int lhs, int rhs) { return lhs + rhs; });
+    EXPECT_EQ(999 * 1000 / 2, sum);
+
+    int range_sum = 0;
+    int chunk_count = 0;
+    Parallel::for_range(0, 1000,
+        []() -> int { return 0; },
+        [](int i, int& local_sum) { local_sum += i; },
+        [&](int local_sum) { range_sum += local_sum; ++chunk_count; });
+    EXPECT_EQ(999 * 1000 / 2, range_sum);
+    EXPECT_GE(chunk_count, 1);
+}
+
+} // NS Core
+} // NS Bifrost
+
+#endif // _BIFROST_CORE_TASK_SCHEDULER_TEST_H_
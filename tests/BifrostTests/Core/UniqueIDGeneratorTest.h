@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 
 #include <set>
+#include <vector>
 
 namespace Bifrost {
 namespace Core {
@@ -263,6 +264,118 @@ GTEST_TEST(Core_UniqueIDGenerator, iterator) {
     }
 }
 
+GTEST_TEST(Core_UniqueIDGenerator, iteration_after_churn) {
+    UIDGenerator gen = UIDGenerator(8u);
+
+    std::vector<UID> IDs;
+    for (int i = 0; i < 1000; ++i)
+        IDs.push_back(gen.generate());
+
+    // Erase all but every 10th ID and reuse some of the freed IDs.
+    std::set<UID> live_IDs;
+    for (int i = 0; i < 1000; ++i)
+        if (i % 10 == 0)
+            live_IDs.insert(IDs[i]);
+        else
+            gen.erase(IDs[i]);
+    for (int i = 0; i < 50; ++i)
+        live_IDs.insert(gen.generate());
+
+    EXPECT_EQ(live_IDs.size(), gen.size());
+
+    std::set<UID> iterated_IDs;
+    for (UID id : gen) {
+        EXPECT_TRUE(gen.has(id));
+        iterated_IDs.insert(id);
+    }
+    EXPECT_EQ(live_IDs, iterated_IDs);
+}
+
+GTEST_TEST(Core_UniqueIDGenerator, erase_while_iterating) {
+    UIDGenerator gen = UIDGenerator(8u);
+    for (int i = 0; i < 20; ++i)
+        gen.generate();
+
+    // Erase every other ID encountered.
+    int visited_count = 0;
+    for (UID id : gen)
+        if (visited_count++ % 2 == 0)
+            gen.erase(id);
+
+    EXPECT_EQ(20, visited_count);
+    EXPECT_EQ(10u, gen.size());
+}
+
+GTEST_TEST(Core_UniqueIDGenerator, iteration_order) {
+    UIDGenerator gen = UIDGenerator(8u);
+    UID IDs[5];
+    for (UID& id : IDs)
+        id = gen.generate();
+
+    // The UIDs are iterated in the order they were generated.
+    int i = 0;
+    for (UID id : gen)
+        EXPECT_TRUE(id == IDs[i++]);
+    EXPECT_EQ(5, i);
+    EXPECT_TRUE(*gen.begin() == IDs[0]);
+
+    // Erasing moves the last UID into the erased UID's position.
+    gen.erase(IDs[1]);
+    UID expected_IDs[4] = { IDs[0], IDs[4], IDs[2], IDs[3] };
+    i = 0;
+    for (UID id : gen)
+        EXPECT_TRUE(id == expected_IDs[i++]);
+    EXPECT_EQ(4, i);
+}
+
+GTEST_TEST(Core_UniqueIDGenerator, get_iterator) {
+    UIDGenerator gen = UIDGenerator(8u);
+    UID id0 = gen.generate();
+    UID id1 = gen.generate();
+    gen.erase(id0);
+
+    EXPECT_TRUE(gen.get_iterator(id0) == gen.end());
+    EXPECT_TRUE(*gen.get_iterator(id1) == id1);
+}
+
+GTEST_TEST(Core_UniqueIDGenerator, wide_UIDs) {
+    typedef TypedUIDGenerator<void, WideUIDLayout> WideUIDGenerator;
+    typedef WideUIDGenerator::UID WideUID;
+    EXPECT_EQ(8u, sizeof(WideUID));
+    EXPECT_EQ(0xFFFFFFFFu, WideUID::MAX_IDS);
+
+    WideUIDGenerator gen = WideUIDGenerator(8u);
+    WideUID id0 = gen.generate();
+    WideUID id1 = gen.generate();
+    EXPECT_TRUE(gen.has(id0));
+    EXPECT_TRUE(gen.has(id1));
+
+    gen.erase(id0);
+    EXPECT_FALSE(gen.has(id0));
+    EXPECT_EQ(1u, gen.size());
+    EXPECT_TRUE(*gen.begin() == id1);
+}
+
+GTEST_TEST(Core_UniqueIDGenerator, incarnation_wraparound) {
+    // Reuse the same few slots thousands of times. The 8 bit incarnation count of narrow UIDs wraps around,
+    // making the stale UID valid again, while the 32 bit incarnation count of wide UIDs does not.
+    auto count_stale_aliases = [](auto gen) -> int {
+        auto stale_ID = gen.generate();
+        auto current_ID = stale_ID;
+        int alias_count = 0;
+        for (int i = 0; i < 4096; ++i) {
+            gen.erase(current_ID);
+            current_ID = gen.generate();
+            if (gen.has(stale_ID))
+                ++alias_count;
+        }
+        return alias_count;
+    };
+
+    EXPECT_LT(0, count_stale_aliases(TypedUIDGenerator<void, NarrowUIDLayout>(8u)));
+    EXPECT_EQ(0, count_stale_aliases(TypedUIDGenerator<void, WideUIDLayout>(8u)));
+}
+
 } // NS Core
 } // NS Bifrost
 
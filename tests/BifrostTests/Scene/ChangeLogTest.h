@@ -0,0 +1,200 @@
+// Test Bifrost recording and replay of datamodel changes.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_CHANGE_LOG_TEST_H_
+#define _BIFROST_SCENE_CHANGE_LOG_TEST_H_
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Core/Engine.h>
+#include <Bifrost/Scene/ChangeLog.h>
+
+#include <Scene/DatamodelFixture.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_ChangeLog : public DatamodelFixture {
+protected:
+    Scene_ChangeLog() : DatamodelFixture("Scene_ChangeLog.bfchanges") {}
+
+    static void reset_change_notifications() {
+        Assets::Images::reset_change_notifications();
+        Assets::Textures::reset_change_notifications();
+        Assets::Materials::reset_change_notifications();
+        Assets::Meshes::reset_change_notifications();
+        Assets::MeshModels::reset_change_notifications();
+        SceneNodes::reset_change_notifications();
+        SceneRoots::reset_change_notifications();
+        LightSources::reset_change_notifications();
+        Cameras::reset_change_notifications();
+    }
+
+    // Records three ticks of changes: Creating a scene, moving and editing it and destroying parts of it.
+    void record_session() {
+        using namespace Assets;
+
+        ChangeRecorder recorder = ChangeRecorder(m_path);
+        EXPECT_TRUE(recorder.succeeded());
+
+        { // Tick 0: Create the scene.
+            SceneRoots::UID scene_ID = SceneRoots::create("Scene", Math::RGB(0.5f));
+            Image image = Images::create2D("Tint", PixelFormat::Intensity8, 1.0f, Math::Vector2ui(2, 2));
+            unsigned char* pixels = image.get_pixels<unsigned char>();
+            pixels[0] = 1; pixels[1] = 2; pixels[2] = 3; pixels[3] = 4;
+            Textures::UID texture_ID = Textures::create2D(image.get_ID());
+            Materials::Data material_data = Materials::Data::create_dielectric(Math::RGB(0.2f), 0.3f, 0.04f);
+            material_data.tint_roughness_texture_ID = texture_ID;
+            Materials::UID material_ID = Materials::create("Material", material_data);
+            Meshes::UID mesh_ID = MeshCreation::cube(1);
+
+            SceneNodes::UID parent_ID = SceneNodes::create("Parent", Math::Transform(Math::Vector3f(1, 0, 0)));
+            SceneNodes::set_parent(parent_ID, SceneRoots::get_root_node(scene_ID));
+            SceneNodes::UID child_ID = SceneNodes::create("Child");
+            SceneNodes::set_parent(child_ID, parent_ID);
+            SceneNodes::set_local_transform(child_ID, Math::Transform(Math::Vector3f(0, 2, 0)));
+            MeshModels::create(parent_ID, mesh_ID, material_ID);
+            MeshModels::create(child_ID, mesh_ID, material_ID);
+            LightSources::create_sphere_light(child_ID, Math::RGB(10.0f), 0.5f);
+            Cameras::create("Camera", scene_ID, Math::Matrix4x4f::identity(), Math::Matrix4x4f::identity());
+
+            recorder.record_tick(1.0 / 60.0);
+            reset_change_notifications();
+        }
+
+        { // Tick 1: Move the parent, update the material and the light, and replace a model.
+            SceneNodes::UID parent_ID = find_node("Parent");
+            SceneNodes::set_local_transform(parent_ID, Math::Transform(Math::Vector3f(3, 0, 0)));
+            Materials::UID material_ID = *Materials::get_iterable().begin();
+            Materials::set_tint(material_ID, Math::RGB(0.8f));
+            LightSources::set_sphere_light_radius(*LightSources::get_iterable().begin(), 0.25f);
+            for (MeshModels::UID model_ID : MeshModels::get_iterable())
+                if (MeshModels::get_scene_node_ID(model_ID) == parent_ID) {
+                    MeshModels::destroy(model_ID);
+                    break;
+                }
+            MeshModels::create(parent_ID, MeshCreation::revolved_sphere(4, 4), material_ID);
+            Cameras::set_transform(*Cameras::get_iterable().begin(), Math::Transform(Math::Vector3f(0, 0, -5)));
+
+            recorder.record_tick(1.0 / 30.0);
+            reset_change_notifications();
+        }
+
+        { // Tick 2: Destroy the light and a node created and destroyed within the tick.
+            LightSources::destroy(*LightSources::get_iterable().begin());
+            SceneNodes::destroy(SceneNodes::create("Transient"));
+
+            recorder.record_tick(1.0 / 60.0);
+            reset_change_notifications();
+        }
+
+        EXPECT_EQ(3u, recorder.get_tick_count());
+    }
+};
+
+TEST_F(Scene_ChangeLog, replay_session) {
+    using namespace Assets;
+
+    record_session();
+    Math::Transform child_transform = SceneNodes::get_global_transform(find_node("Child"));
+
+    deallocate_managers();
+    allocate_managers();
+
+    ChangeReplayer replayer = ChangeReplayer(m_path);
+    EXPECT_TRUE(replayer.is_valid());
+    EXPECT_DOUBLE_EQ(1.0 / 60.0, replayer.get_next_delta_time());
+
+    { // Tick 0.
+        EXPECT_TRUE(replayer.replay_tick());
+        EXPECT_EQ(1u, count<SceneRoots>());
+        EXPECT_EQ(3u, count<SceneNodes>());
+        EXPECT_EQ(2u, count<MeshModels>());
+        EXPECT_EQ(1u, count<LightSources>());
+        EXPECT_EQ(1u, count<Cameras>());
+        EXPECT_EQ("Scene", SceneRoots::get_name(*SceneRoots::get_iterable().begin()));
+
+        // The replayed resources are reported as created.
+        for (MeshModels::UID model_ID : MeshModels::get_iterable())
+            EXPECT_TRUE(MeshModels::get_changes(model_ID).is_set(MeshModels::Change::Created));
+
+        Material material = *Materials::get_iterable().begin();
+        Image image = material.get_tint_roughness_texture().get_image();
+        EXPECT_EQ(4, image.get_pixels<unsigned char>()[3]);
+        reset_change_notifications();
+    }
+
+    { // Tick 1.
+        EXPECT_DOUBLE_EQ(1.0 / 30.0, replayer.get_next_delta_time());
+        EXPECT_TRUE(replayer.replay_tick());
+        EXPECT_EQ(2u, count<Meshes>());
+        EXPECT_EQ(2u, count<MeshModels>());
+        EXPECT_EQ(Math::RGB(0.8f), Materials::get_tint(*Materials::get_iterable().begin()));
+        EXPECT_TRUE(Materials::get_changes(*Materials::get_iterable().begin()).is_set(Materials::Change::Updated));
+        EXPECT_EQ(0.25f, LightSources::get_sphere_light_radius(*LightSources::get_iterable().begin()));
+        EXPECT_EQ(Math::Transform(Math::Vector3f(0, 0, -5)), Cameras::get_transform(*Cameras::get_iterable().begin()));
+        EXPECT_EQ(child_transform, SceneNodes::get_global_transform(find_node("Child")));
+        reset_change_notifications();
+    }
+
+    { // Tick 2.
+        EXPECT_TRUE(replayer.replay_tick());
+        EXPECT_EQ(0u, count<LightSources>());
+        EXPECT_EQ(3u, count<SceneNodes>());
+        EXPECT_EQ(SceneNodes::UID::invalid_UID(), find_node("Transient"));
+    }
+
+    EXPECT_TRUE(replayer.is_at_end());
+    EXPECT_FALSE(replayer.replay_tick());
+    EXPECT_EQ(3u, replayer.get_tick_count());
+}
+
+TEST_F(Scene_ChangeLog, replay_under_headless_engine) {
+    record_session();
+    deallocate_managers();
+    allocate_managers();
+
+    ChangeReplayer replayer = ChangeReplayer(m_path);
+    Core::Engine engine = Core::Engine("");
+    engine.add_mutating_callback("Replay changes", [&] { replayer.replay_tick(); });
+    engine.add_tick_cleanup_callback("Reset change notifications", [] { reset_change_notifications(); });
+
+    double total_time = 0.0;
+    while (!replayer.is_at_end()) {
+        total_time += replayer.get_next_delta_time();
+        engine.do_tick(replayer.get_next_delta_time());
+    }
+
+    EXPECT_EQ(3u, replayer.get_tick_count());
+    EXPECT_DOUBLE_EQ(total_time, engine.get_time().get_total_time());
+    EXPECT_EQ(2u, count<Assets::MeshModels>());
+    EXPECT_EQ(0u, count<LightSources>());
+}
+
+TEST_F(Scene_ChangeLog, reject_invalid_logs) {
+    ChangeReplayer missing_replayer = ChangeReplayer("Scene_ChangeLog_missing.bfchanges");
+    EXPECT_FALSE(missing_replayer.is_valid());
+    EXPECT_FALSE(missing_replayer.replay_tick());
+
+    { // Snapshot header instead of a change log.
+        FILE* file = fopen(m_path.c_str(), "wb");
+        fputs("BFSNAPSH and some bytes that look like a header", file);
+        fclose(file);
+    }
+    ChangeReplayer replayer = ChangeReplayer(m_path);
+    EXPECT_FALSE(replayer.is_valid());
+    EXPECT_FALSE(replayer.replay_tick());
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_CHANGE_LOG_TEST_H_
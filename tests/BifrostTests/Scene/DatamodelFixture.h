@@ -0,0 +1,91 @@
+// Test fixture for tests that write the Bifrost datamodel to a file.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_DATAMODEL_FIXTURE_H_
+#define _BIFROST_SCENE_DATAMODEL_FIXTURE_H_
+
+#include <Bifrost/Assets/Image.h>
+#include <Bifrost/Assets/Material.h>
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Assets/MeshModel.h>
+#include <Bifrost/Assets/Texture.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/SceneNode.h>
+#include <Bifrost/Scene/SceneRoot.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+namespace Bifrost {
+namespace Scene {
+
+// Allocates all datamodel managers and removes the file at the given path after each test.
+class DatamodelFixture : public ::testing::Test {
+protected:
+    DatamodelFixture(const std::string& path) : m_path(path) {}
+
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        allocate_managers();
+    }
+    virtual void TearDown() {
+        deallocate_managers();
+        std::remove(m_path.c_str());
+    }
+
+    static void allocate_managers() {
+        Assets::Images::allocate(1u);
+        Assets::Textures::allocate(1u);
+        Assets::Materials::allocate(1u);
+        Assets::Meshes::allocate(1u);
+        Assets::MeshModels::allocate(1u);
+        SceneNodes::allocate(1u);
+        SceneRoots::allocate(1u);
+        LightSources::allocate(1u);
+        Cameras::allocate(1u);
+    }
+
+    static void deallocate_managers() {
+        Cameras::deallocate();
+        LightSources::deallocate();
+        SceneRoots::deallocate();
+        Assets::MeshModels::deallocate();
+        SceneNodes::deallocate();
+        Assets::Meshes::deallocate();
+        Assets::Materials::deallocate();
+        Assets::Textures::deallocate();
+        Assets::Images::deallocate();
+    }
+
+    template <typename Manager>
+    static unsigned int count() {
+        unsigned int count = 0;
+        for (auto ID : Manager::get_iterable()) {
+            (void)ID;
+            ++count;
+        }
+        return count;
+    }
+
+    static SceneNodes::UID find_node(const std::string& name) {
+        for (SceneNodes::UID node_ID : SceneNodes::get_iterable())
+            if (SceneNodes::get_name(node_ID) == name)
+                return node_ID;
+        return SceneNodes::UID::invalid_UID();
+    }
+
+    const std::string m_path;
+};
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_DATAMODEL_FIXTURE_H_
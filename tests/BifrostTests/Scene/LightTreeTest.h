@@ -0,0 +1,139 @@
+// Test Bifrost light tree.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_LIGHT_TREE_TEST_H_
+#define _BIFROST_SCENE_LIGHT_TREE_TEST_H_
+
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/LightTree.h>
+
+#include <gtest/gtest.h>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_LightTree : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        SceneNodes::allocate(8u);
+        LightSources::allocate(8u);
+    }
+    virtual void TearDown() {
+        LightSources::deallocate();
+        SceneNodes::deallocate();
+    }
+
+    static LightSources::UID create_sphere_light(Math::Vector3f position, float power, float radius = 0.1f) {
+        SceneNodes::UID node_ID = SceneNodes::create("Light", Math::Transform(position));
+        return LightSources::create_sphere_light(node_ID, Math::RGB(power), radius);
+    }
+
+    // Sums the PDFs of all lights.
+    static float total_PDF(const LightTree& light_tree, Math::Vector3f position, Math::Vector3f normal) {
+        float total = 0.0f;
+        for (LightSources::UID light_ID : LightSources::get_iterable())
+            total += light_tree.PDF(light_ID, position, normal);
+        return total;
+    }
+};
+
+TEST_F(Scene_LightTree, empty_tree) {
+    LightTree light_tree;
+    EXPECT_EQ(0u, light_tree.get_light_count());
+
+    LightTree::Sample sample = light_tree.sample(Math::Vector3f::zero(), Math::Vector3f::up(), 0.5f);
+    EXPECT_EQ(LightSources::UID::invalid_UID(), sample.light_ID);
+    EXPECT_EQ(0.0f, sample.PDF);
+}
+
+TEST_F(Scene_LightTree, sample_PDFs_match) {
+    Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(7);
+    for (int i = 0; i < 40; ++i)
+        create_sphere_light((rng.sample3f() - 0.5f) * 20.0f, 1.0f + 10.0f * rng.sample1f());
+    SceneNodes::UID spot_node_ID = SceneNodes::create("Spot", Math::Transform(Math::Vector3f(0, 5, 0), Math::Quaternionf::look_in(-Math::Vector3f::up(), Math::Vector3f::forward())));
+    LightSources::create_spot_light(spot_node_ID, Math::RGB(100.0f), 0.5f, 0.7f);
+    SceneNodes::UID sun_node_ID = SceneNodes::create("Sun");
+    LightSources::UID sun_ID = LightSources::create_directional_light(sun_node_ID, Math::RGB(2.0f));
+
+    LightTree light_tree;
+    EXPECT_EQ(42u, light_tree.get_light_count());
+
+    Math::Vector3f position = Math::Vector3f(1, 0, 2);
+    Math::Vector3f normal = Math::Vector3f::up();
+    EXPECT_FLOAT_EQ(0.5f, light_tree.PDF(sun_ID, position, normal));
+    EXPECT_NEAR(1.0f, total_PDF(light_tree, position, normal), 0.0001f);
+
+    // The PDF of the sampled light matches the PDF reported for the light.
+    for (int s = 0; s < 64; ++s) {
+        LightTree::Sample sample = light_tree.sample(position, normal, (s + 0.5f) / 64);
+        ASSERT_TRUE(LightSources::has(sample.light_ID));
+        EXPECT_FLOAT_EQ(light_tree.PDF(sample.light_ID, position, normal), sample.PDF);
+    }
+}
+
+TEST_F(Scene_LightTree, sampling_follows_contribution) {
+    LightSources::UID near_light_ID = create_sphere_light(Math::Vector3f(0, 1, 0), 1.0f);
+    LightSources::UID far_light_ID = create_sphere_light(Math::Vector3f(0, 10, 0), 1.0f);
+    LightSources::UID behind_light_ID = create_sphere_light(Math::Vector3f(0, -2, 0), 1.0f, 0.0f);
+
+    LightTree light_tree;
+    Math::Vector3f position = Math::Vector3f::zero();
+    Math::Vector3f normal = Math::Vector3f::up();
+    float near_PDF = light_tree.PDF(near_light_ID, position, normal);
+    float far_PDF = light_tree.PDF(far_light_ID, position, normal);
+    EXPECT_GT(near_PDF, 10.0f * far_PDF);
+    EXPECT_NEAR(1.0f, near_PDF + far_PDF + light_tree.PDF(behind_light_ID, position, normal), 0.0001f);
+
+    // Without a normal the light behind the position contributes as well.
+    EXPECT_GT(light_tree.PDF(behind_light_ID, position, Math::Vector3f::zero()), far_PDF);
+}
+
+TEST_F(Scene_LightTree, spot_lights_facing_away_are_not_sampled) {
+    SceneNodes::UID node_ID = SceneNodes::create("Spot", Math::Transform(Math::Vector3f(0, 5, 0), Math::Quaternionf::look_in(Math::Vector3f::up(), Math::Vector3f::forward())));
+    LightSources::UID spot_light_ID = LightSources::create_spot_light(node_ID, Math::RGB(100.0f), 0.1f, 0.9f);
+
+    LightTree light_tree;
+    EXPECT_EQ(0.0f, light_tree.PDF(spot_light_ID, Math::Vector3f::zero(), Math::Vector3f::zero()));
+    EXPECT_EQ(LightSources::UID::invalid_UID(), light_tree.sample(Math::Vector3f::zero(), Math::Vector3f::zero(), 0.5f).light_ID);
+    EXPECT_FLOAT_EQ(1.0f, light_tree.PDF(spot_light_ID, Math::Vector3f(0, 10, 0), Math::Vector3f::zero()));
+}
+
+TEST_F(Scene_LightTree, refit_and_rebuild_on_changes) {
+    LightSources::UID light_ID0 = create_sphere_light(Math::Vector3f(0, 1, 0), 1.0f);
+    LightSources::UID light_ID1 = create_sphere_light(Math::Vector3f(0, 10, 0), 1.0f);
+
+    LightTree light_tree;
+    Math::Vector3f position = Math::Vector3f::zero();
+    Math::Vector3f normal = Math::Vector3f::up();
+    EXPECT_GT(light_tree.PDF(light_ID0, position, normal), light_tree.PDF(light_ID1, position, normal));
+
+    // Moving the far light closer than the near light refits the tree.
+    SceneNodes::set_global_transform(LightSources::get_node_ID(light_ID1), Math::Transform(Math::Vector3f(0, 0.5f, 0)));
+    light_tree.update();
+    EXPECT_LT(light_tree.PDF(light_ID0, position, normal), light_tree.PDF(light_ID1, position, normal));
+
+    // Turning off a light refits the tree.
+    LightSources::set_sphere_light_power(light_ID1, Math::RGB::black());
+    light_tree.update();
+    EXPECT_FLOAT_EQ(1.0f, light_tree.PDF(light_ID0, position, normal));
+    EXPECT_EQ(0.0f, light_tree.PDF(light_ID1, position, normal));
+
+    // Creating and destroying lights rebuilds the tree.
+    LightSources::UID light_ID2 = create_sphere_light(Math::Vector3f(1, 1, 0), 1.0f);
+    LightSources::destroy(light_ID0);
+    light_tree.update();
+    EXPECT_EQ(2u, light_tree.get_light_count());
+    EXPECT_EQ(0.0f, light_tree.PDF(light_ID0, position, normal));
+    EXPECT_FLOAT_EQ(1.0f, light_tree.PDF(light_ID2, position, normal));
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_LIGHT_TREE_TEST_H_
@@ -0,0 +1,79 @@
+// Test Bifrost memory report and budgets.
+// ---------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ---------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MEMORY_REPORT_TEST_H_
+#define _BIFROST_SCENE_MEMORY_REPORT_TEST_H_
+
+#include <Bifrost/Assets/Mesh.h>
+#include <Bifrost/Scene/MemoryReport.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_MemoryReport : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        Assets::Meshes::allocate(8u);
+    }
+    virtual void TearDown() {
+        Assets::Meshes::deallocate();
+        MemoryBudgets::reset();
+    }
+};
+
+TEST_F(Scene_MemoryReport, report_includes_allocated_managers) {
+    Assets::Meshes::UID mesh_ID = Assets::Meshes::create("TestMesh", 32u, 16u);
+
+    MemoryReport report = MemoryReport::create();
+    EXPECT_EQ(Assets::Meshes::get_memory_usage().get_total_bytes(), report.meshes.get_total_bytes());
+    EXPECT_EQ(0u, report.images.get_total_bytes()); // Not allocated.
+
+    Core::MemoryUsage total_usage = report.get_total_usage();
+    EXPECT_EQ(Assets::Meshes::get_memory_usage(mesh_ID)[Core::MemoryCategory::Vertices], total_usage[Core::MemoryCategory::Vertices]);
+    EXPECT_NE(std::string::npos, report.to_string().find("Meshes"));
+}
+
+TEST_F(Scene_MemoryReport, budget_warnings) {
+    std::vector<std::string> exceeded_budgets;
+    MemoryBudgets::set_warning_callback([&](const char* budget_name, size_t used_bytes, size_t budget_bytes) {
+        EXPECT_GT(used_bytes, budget_bytes);
+        exceeded_budgets.push_back(budget_name);
+    });
+    MemoryBudgets::set_budget(Core::MemoryCategory::Vertices, 1024u);
+    EXPECT_TRUE(MemoryBudgets::check());
+
+    // Exceeding the budget warns once.
+    Assets::Meshes::UID mesh_ID = Assets::Meshes::create("TestMesh", 32u, 64u);
+    EXPECT_FALSE(MemoryBudgets::check());
+    EXPECT_FALSE(MemoryBudgets::check());
+    ASSERT_EQ(1u, exceeded_budgets.size());
+    EXPECT_EQ("vertices", exceeded_budgets[0]);
+
+    // Dropping below the budget rearms the warning.
+    Assets::Meshes::destroy(mesh_ID);
+    EXPECT_TRUE(MemoryBudgets::check());
+    Assets::Meshes::create("TestMesh", 32u, 64u);
+    EXPECT_FALSE(MemoryBudgets::check());
+    EXPECT_EQ(2u, exceeded_budgets.size());
+
+    // Total budget.
+    MemoryBudgets::set_total_budget(1u);
+    MemoryBudgets::check();
+    EXPECT_EQ("total", exceeded_budgets.back());
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_MEMORY_REPORT_TEST_H_
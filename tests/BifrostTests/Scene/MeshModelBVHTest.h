@@ -0,0 +1,240 @@
+// Test Bifrost mesh model BVH.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MESH_MODEL_BVH_TEST_H_
+#define _BIFROST_SCENE_MESH_MODEL_BVH_TEST_H_
+
+#include <Bifrost/Math/Constants.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/MeshModelBVH.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_MeshModelBVH : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        SceneNodes::allocate(1u);
+        SceneRoots::allocate(1u);
+        Cameras::allocate(1u);
+        Assets::Meshes::allocate(1u);
+        Assets::Materials::allocate(1u);
+        Assets::MeshModels::allocate(1u);
+
+        m_mesh_ID = Assets::Meshes::create("Cube", 12u, 8u);
+        Assets::Meshes::set_bounds(m_mesh_ID, Math::AABB(Math::Vector3f(-0.5f), Math::Vector3f(0.5f)));
+        m_material_ID = Assets::Materials::create("Material", {});
+    }
+    virtual void TearDown() {
+        Cameras::deallocate();
+        Assets::MeshModels::deallocate();
+        Assets::Materials::deallocate();
+        Assets::Meshes::deallocate();
+        SceneRoots::deallocate();
+        SceneNodes::deallocate();
+    }
+
+    Assets::MeshModels::UID create_model(Math::Transform transform) {
+        SceneNodes::UID node_ID = SceneNodes::create("Node", transform);
+        return Assets::MeshModels::create(node_ID, m_mesh_ID, m_material_ID);
+    }
+
+    // Scatters the models in a 40 units wide box in front of and behind the origin.
+    std::vector<Assets::MeshModels::UID> create_random_models(unsigned int model_count) {
+        Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(model_count);
+        std::vector<Assets::MeshModels::UID> model_IDs;
+        for (unsigned int m = 0; m < model_count; ++m) {
+            Math::Vector3f position = rng.sample3f() * 40.0f - 20.0f;
+            Math::Quaternionf rotation = Math::Quaternionf::from_angle_axis(rng.sample1f() * 6.0f, Math::Vector3f::up());
+            model_IDs.push_back(create_model(Math::Transform(position, rotation, 0.5f + rng.sample1f())));
+        }
+        return model_IDs;
+    }
+
+    // Brute force reference, testing the world space bounds of every model against the frustum.
+    static std::vector<Assets::MeshModels::UID> find_models_in_frustum(const Math::Frustum& frustum) {
+        std::vector<Assets::MeshModels::UID> model_IDs;
+        for (Assets::MeshModels::UID model_ID : Assets::MeshModels::get_iterable()) {
+            Math::Transform transform = SceneNodes::get_global_transform(Assets::MeshModels::get_scene_node_ID(model_ID));
+            // Bounds of the rotated and scaled unit cube.
+            Math::AABB bounds = Math::AABB::invalid();
+            for (int c = 0; c < 8; ++c)
+                bounds.grow_to_contain(transform * Math::Vector3f((c & 1) - 0.5f, ((c >> 1) & 1) - 0.5f, ((c >> 2) & 1) - 0.5f));
+            if (frustum.intersects(bounds))
+                model_IDs.push_back(model_ID);
+        }
+        return model_IDs;
+    }
+
+    static void sort(std::vector<Assets::MeshModels::UID>& model_IDs) {
+        std::sort(model_IDs.begin(), model_IDs.end(), [](auto lhs, auto rhs) { return lhs.get_index() < rhs.get_index(); });
+    }
+
+    static Math::Frustum create_frustum(Math::Transform camera_transform) {
+        Math::Matrix4x4f projection_matrix, inverse_projection_matrix;
+        CameraUtils::compute_perspective_projection(1, 30, Math::PI<float>() / 4.0f, 1.0f, projection_matrix, inverse_projection_matrix);
+        Math::Matrix4x4f view_projection_matrix = projection_matrix * to_matrix4x4(Math::invert(camera_transform));
+        return Math::Frustum::from_view_projection_matrix(view_projection_matrix);
+    }
+
+    Assets::Meshes::UID m_mesh_ID;
+    Assets::Materials::UID m_material_ID;
+};
+
+TEST_F(Scene_MeshModelBVH, frustum_planes) {
+    Math::Frustum frustum = create_frustum(Math::Transform::identity());
+
+    // The camera looks along +Z with the near and far planes at 1 and 30.
+    EXPECT_TRUE(frustum.intersects(Math::AABB(Math::Vector3f(-0.1f, -0.1f, 5.0f), Math::Vector3f(0.1f, 0.1f, 5.2f))));
+    EXPECT_TRUE(frustum.contains(Math::AABB(Math::Vector3f(-0.1f, -0.1f, 5.0f), Math::Vector3f(0.1f, 0.1f, 5.2f))));
+    EXPECT_FALSE(frustum.intersects(Math::AABB(Math::Vector3f(-0.1f, -0.1f, -5.2f), Math::Vector3f(0.1f, 0.1f, -5.0f))));
+    EXPECT_FALSE(frustum.intersects(Math::AABB(Math::Vector3f(-0.1f, -0.1f, 0.2f), Math::Vector3f(0.1f, 0.1f, 0.5f))));
+    EXPECT_FALSE(frustum.intersects(Math::AABB(Math::Vector3f(-0.1f, -0.1f, 31.0f), Math::Vector3f(0.1f, 0.1f, 32.0f))));
+    EXPECT_FALSE(frustum.intersects(Math::AABB(Math::Vector3f(4.0f, -0.1f, 5.0f), Math::Vector3f(5.0f, 0.1f, 5.2f))));
+
+    // Straddling the left plane.
+    Math::AABB straddling_bounds = Math::AABB(Math::Vector3f(-3.0f, -0.1f, 5.0f), Math::Vector3f(-1.0f, 0.1f, 5.2f));
+    EXPECT_TRUE(frustum.intersects(straddling_bounds));
+    EXPECT_FALSE(frustum.contains(straddling_bounds));
+}
+
+TEST_F(Scene_MeshModelBVH, frustum_culling) {
+    create_random_models(2000);
+    MeshModelBVH bvh;
+    EXPECT_EQ(bvh.get_model_count(), 2000u);
+
+    Math::Transform camera_transforms[] = { Math::Transform::identity(),
+                                            Math::Transform(Math::Vector3f(5, 0, -20), Math::Quaternionf::from_angle_axis(0.5f, Math::Vector3f::up())),
+                                            Math::Transform(Math::Vector3f(0, 30, 0), Math::Quaternionf::look_in(-Math::Vector3f::up(), Math::Vector3f::forward())) };
+    for (Math::Transform camera_transform : camera_transforms) {
+        Math::Frustum frustum = create_frustum(camera_transform);
+        std::vector<Assets::MeshModels::UID> expected_model_IDs = find_models_in_frustum(frustum);
+        EXPECT_GT(expected_model_IDs.size(), 0u);
+
+        std::vector<Assets::MeshModels::UID> model_IDs;
+        bvh.find_models_in_frustum(frustum, model_IDs);
+        sort(expected_model_IDs);
+        sort(model_IDs);
+        EXPECT_EQ(expected_model_IDs, model_IDs);
+    }
+}
+
+TEST_F(Scene_MeshModelBVH, refit_moved_models) {
+    std::vector<Assets::MeshModels::UID> model_IDs = create_random_models(1000);
+    MeshModelBVH bvh;
+    unsigned int node_count = bvh.get_node_count();
+
+    // Move a few models far behind the camera and a few far into the view.
+    Math::Frustum frustum = create_frustum(Math::Transform::identity());
+    for (unsigned int m = 0; m < 20; ++m) {
+        SceneNodes::UID node_ID = Assets::MeshModels::get_scene_node_ID(model_IDs[m]);
+        Math::Vector3f position = Math::Vector3f(0, 0, m % 2 == 0 ? -100.0f : 25.0f);
+        SceneNodes::set_global_transform(node_ID, Math::Transform(position));
+    }
+    bvh.update();
+    EXPECT_EQ(node_count, bvh.get_node_count());
+
+    std::vector<Assets::MeshModels::UID> visible_model_IDs;
+    bvh.find_models_in_frustum(frustum, visible_model_IDs);
+    std::vector<Assets::MeshModels::UID> expected_model_IDs = find_models_in_frustum(frustum);
+    sort(expected_model_IDs);
+    sort(visible_model_IDs);
+    EXPECT_EQ(expected_model_IDs, visible_model_IDs);
+    for (unsigned int m = 0; m < 20; ++m) {
+        bool is_visible = std::binary_search(visible_model_IDs.begin(), visible_model_IDs.end(), model_IDs[m],
+                                             [](auto lhs, auto rhs) { return lhs.get_index() < rhs.get_index(); });
+        EXPECT_EQ(m % 2 == 1, is_visible);
+    }
+
+    // Move every model, which refits all nodes.
+    for (Assets::MeshModels::UID model_ID : model_IDs) {
+        SceneNodes::UID node_ID = Assets::MeshModels::get_scene_node_ID(model_ID);
+        Math::Transform transform = SceneNodes::get_global_transform(node_ID);
+        transform.translation.x += 10.0f;
+        SceneNodes::set_global_transform(node_ID, transform);
+    }
+    bvh.update();
+
+    visible_model_IDs.clear();
+    bvh.find_models_in_frustum(frustum, visible_model_IDs);
+    expected_model_IDs = find_models_in_frustum(frustum);
+    sort(expected_model_IDs);
+    sort(visible_model_IDs);
+    EXPECT_EQ(expected_model_IDs, visible_model_IDs);
+}
+
+TEST_F(Scene_MeshModelBVH, rebuild_on_created_and_destroyed_models) {
+    MeshModelBVH bvh;
+    EXPECT_EQ(bvh.get_model_count(), 0u);
+    std::vector<Assets::MeshModels::UID> model_IDs;
+    bvh.find_models_in_frustum(create_frustum(Math::Transform::identity()), model_IDs);
+    EXPECT_TRUE(model_IDs.empty());
+
+    Assets::MeshModels::UID visible_model_ID = create_model(Math::Transform(Math::Vector3f(0, 0, 10)));
+    Assets::MeshModels::UID hidden_model_ID = create_model(Math::Transform(Math::Vector3f(0, 0, -10)));
+    bvh.update();
+    EXPECT_EQ(bvh.get_model_count(), 2u);
+    EXPECT_EQ(bvh.get_bounds(), Math::AABB(Math::Vector3f(-0.5f, -0.5f, -10.5f), Math::Vector3f(0.5f, 0.5f, 10.5f)));
+
+    bvh.find_models_in_frustum(create_frustum(Math::Transform::identity()), model_IDs);
+    EXPECT_EQ(model_IDs.size(), 1u);
+    EXPECT_EQ(model_IDs[0], visible_model_ID);
+
+    Assets::MeshModels::destroy(visible_model_ID);
+    bvh.update();
+    EXPECT_EQ(bvh.get_model_count(), 1u);
+
+    model_IDs.clear();
+    bvh.find_models_in_frustum(create_frustum(Math::Transform(Math::Vector3f::zero(), Math::Quaternionf::from_angle_axis(Math::PI<float>(), Math::Vector3f::up()))), model_IDs);
+    EXPECT_EQ(model_IDs.size(), 1u);
+    EXPECT_EQ(model_IDs[0], hidden_model_ID);
+}
+
+TEST_F(Scene_MeshModelBVH, camera_visible_models) {
+    SceneRoots::UID scene_ID = SceneRoots::create("Root", Math::RGB::white());
+    SceneRoots::UID other_scene_ID = SceneRoots::create("Other root", Math::RGB::white());
+    Math::Matrix4x4f projection_matrix, inverse_projection_matrix;
+    CameraUtils::compute_perspective_projection(1, 30, Math::PI<float>() / 4.0f, 1.0f, projection_matrix, inverse_projection_matrix);
+    Cameras::UID camera_ID = Cameras::create("Camera", scene_ID, projection_matrix, inverse_projection_matrix);
+
+    // No models are visible before the hierarchy is created.
+    Assets::MeshModels::UID model_ID = create_model(Math::Transform(Math::Vector3f(0, 0, 10)));
+    SceneNodes::set_parent(Assets::MeshModels::get_scene_node_ID(model_ID), SceneRoots::get_root_node(scene_ID));
+    EXPECT_TRUE(Cameras::get_visible_models(camera_ID).empty());
+
+    // Models in other scenes are not visible.
+    Assets::MeshModels::UID other_scene_model_ID = create_model(Math::Transform(Math::Vector3f(0, 0, 10)));
+    SceneNodes::set_parent(Assets::MeshModels::get_scene_node_ID(other_scene_model_ID), SceneRoots::get_root_node(other_scene_ID));
+    Cameras::update_model_BVH();
+    std::vector<Assets::MeshModels::UID> visible_model_IDs = Cameras::get_visible_models(camera_ID);
+    EXPECT_EQ(visible_model_IDs.size(), 1u);
+    EXPECT_EQ(visible_model_IDs[0], model_ID);
+
+    // Turn the camera around.
+    Cameras::set_transform(camera_ID, Math::Transform(Math::Vector3f::zero(), Math::Quaternionf::from_angle_axis(Math::PI<float>(), Math::Vector3f::up())));
+    EXPECT_TRUE(Cameras::get_visible_models(camera_ID).empty());
+
+    // Move the model behind the camera. The query sees the move after the hierarchy is updated.
+    SceneNodes::set_global_transform(Assets::MeshModels::get_scene_node_ID(model_ID), Math::Transform(Math::Vector3f(0, 0, -10)));
+    EXPECT_TRUE(Cameras::get_visible_models(camera_ID).empty());
+    Cameras::update_model_BVH();
+    visible_model_IDs = Cameras::get_visible_models(camera_ID);
+    EXPECT_EQ(visible_model_IDs.size(), 1u);
+    EXPECT_EQ(visible_model_IDs[0], model_ID);
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_MESH_MODEL_BVH_TEST_H_
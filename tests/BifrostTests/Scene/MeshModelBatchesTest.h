@@ -0,0 +1,207 @@
+// Test Bifrost mesh model instance batches.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_MESH_MODEL_BATCHES_TEST_H_
+#define _BIFROST_SCENE_MESH_MODEL_BATCHES_TEST_H_
+
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/MeshModelBatches.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_MeshModelBatches : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        SceneNodes::allocate(1u);
+        Assets::Meshes::allocate(2u);
+        Assets::Materials::allocate(2u);
+        Assets::MeshModels::allocate(1u);
+
+        m_mesh_IDs[0] = Assets::Meshes::create("Cube", 12u, 8u);
+        m_mesh_IDs[1] = Assets::Meshes::create("Plane", 2u, 4u);
+        m_material_IDs[0] = Assets::Materials::create("Red", {});
+        m_material_IDs[1] = Assets::Materials::create("Blue", {});
+    }
+    virtual void TearDown() {
+        Assets::MeshModels::deallocate();
+        Assets::Materials::deallocate();
+        Assets::Meshes::deallocate();
+        SceneNodes::deallocate();
+    }
+
+    static Assets::MeshModels::UID create_model(Math::Vector3f position, Assets::Meshes::UID mesh_ID, Assets::Materials::UID material_ID) {
+        SceneNodes::UID node_ID = SceneNodes::create("Node", Math::Transform(position));
+        return Assets::MeshModels::create(node_ID, mesh_ID, material_ID);
+    }
+
+    // Verifies that every model is batched exactly once by its mesh and material with its current global transform.
+    static void verify_batches(const MeshModelBatches& batches) {
+        unsigned int instance_count = 0;
+        for (unsigned int b = 0; b < batches.get_batch_count(); ++b) {
+            const MeshModelBatches::Batch& batch = batches.get_batch(b);
+            ASSERT_EQ(batch.model_IDs.size(), batch.transforms.size());
+            for (unsigned int i = 0; i < batch.get_instance_count(); ++i) {
+                Assets::MeshModels::UID model_ID = batch.model_IDs[i];
+                ASSERT_TRUE(Assets::MeshModels::has(model_ID));
+                EXPECT_EQ((int)b, batches.get_batch_index(model_ID));
+                EXPECT_EQ(batch.mesh_ID, Assets::MeshModels::get_mesh_ID(model_ID));
+                EXPECT_EQ(batch.material_ID, Assets::MeshModels::get_material_ID(model_ID));
+                Math::Transform transform = SceneNodes::get_global_transform(Assets::MeshModels::get_scene_node_ID(model_ID));
+                EXPECT_EQ(transform.translation, batch.transforms[i].translation);
+            }
+            instance_count += batch.get_instance_count();
+        }
+
+        unsigned int model_count = 0;
+        for (Assets::MeshModels::UID model_ID : Assets::MeshModels::get_iterable()) {
+            EXPECT_GE(batches.get_batch_index(model_ID), 0);
+            ++model_count;
+        }
+        EXPECT_EQ(model_count, instance_count);
+    }
+
+    Assets::Meshes::UID m_mesh_IDs[2];
+    Assets::Materials::UID m_material_IDs[2];
+};
+
+TEST_F(Scene_MeshModelBatches, group_by_mesh_and_material) {
+    create_model(Math::Vector3f(0, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    create_model(Math::Vector3f(1, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    create_model(Math::Vector3f(2, 0, 0), m_mesh_IDs[0], m_material_IDs[1]);
+    create_model(Math::Vector3f(3, 0, 0), m_mesh_IDs[1], m_material_IDs[0]);
+
+    MeshModelBatches batches;
+    EXPECT_EQ(3u, batches.get_batch_count());
+    EXPECT_EQ(3u, batches.get_changed_batch_indices().size());
+    verify_batches(batches);
+
+    int batch_index = batches.find_batch(m_mesh_IDs[0], m_material_IDs[0]);
+    ASSERT_GE(batch_index, 0);
+    EXPECT_EQ(2u, batches.get_batch(batch_index).get_instance_count());
+    EXPECT_LT(batches.find_batch(m_mesh_IDs[1], m_material_IDs[1]), 0);
+}
+
+TEST_F(Scene_MeshModelBatches, create_and_destroy_models) {
+    Assets::MeshModels::UID model_ID0 = create_model(Math::Vector3f(0, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    Assets::MeshModels::UID model_ID1 = create_model(Math::Vector3f(1, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+
+    MeshModelBatches batches;
+    Assets::MeshModels::UID model_ID2 = create_model(Math::Vector3f(2, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    Assets::MeshModels::UID model_ID3 = create_model(Math::Vector3f(3, 0, 0), m_mesh_IDs[1], m_material_IDs[1]);
+    Assets::MeshModels::destroy(model_ID0);
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(2u, batches.get_batch_count());
+    EXPECT_EQ(2u, batches.get_changed_batch_indices().size());
+    EXPECT_LT(batches.get_batch_index(model_ID0), 0);
+    EXPECT_EQ(batches.get_batch_index(model_ID1), batches.get_batch_index(model_ID2));
+
+    // Destroying the last model in a batch keeps the empty batch.
+    Assets::MeshModels::destroy(model_ID3);
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(2u, batches.get_batch_count());
+    int batch_index = batches.find_batch(m_mesh_IDs[1], m_material_IDs[1]);
+    ASSERT_GE(batch_index, 0);
+    EXPECT_TRUE(batches.get_batch(batch_index).is_empty());
+    EXPECT_EQ(std::vector<unsigned int>(1, batch_index), batches.get_changed_batch_indices());
+
+    // A model created in the destroyed model's slot is batched.
+    Assets::MeshModels::destroy(model_ID1);
+    Assets::MeshModels::UID model_ID4 = create_model(Math::Vector3f(4, 0, 0), m_mesh_IDs[1], m_material_IDs[1]);
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(batch_index, batches.get_batch_index(model_ID4));
+    EXPECT_LT(batches.get_batch_index(model_ID1), 0);
+}
+
+TEST_F(Scene_MeshModelBatches, material_changes_move_models) {
+    Assets::MeshModels::UID model_ID0 = create_model(Math::Vector3f(0, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    Assets::MeshModels::UID model_ID1 = create_model(Math::Vector3f(1, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+
+    MeshModelBatches batches;
+    Assets::MeshModels::set_material_ID(model_ID0, m_material_IDs[1]);
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(2u, batches.get_batch_count());
+    EXPECT_NE(batches.get_batch_index(model_ID0), batches.get_batch_index(model_ID1));
+    EXPECT_EQ(2u, batches.get_changed_batch_indices().size());
+
+    Assets::MeshModels::set_material_ID(model_ID0, m_material_IDs[0]);
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(batches.get_batch_index(model_ID0), batches.get_batch_index(model_ID1));
+}
+
+TEST_F(Scene_MeshModelBatches, transforms_follow_scene_nodes) {
+    SceneNodes::UID parent_ID = SceneNodes::create("Parent");
+    Assets::MeshModels::UID model_ID0 = create_model(Math::Vector3f(1, 0, 0), m_mesh_IDs[0], m_material_IDs[0]);
+    Assets::MeshModels::UID model_ID1 = create_model(Math::Vector3f(2, 0, 0), m_mesh_IDs[1], m_material_IDs[0]);
+    SceneNodes::UID node_ID0 = Assets::MeshModels::get_scene_node_ID(model_ID0);
+    SceneNodes::set_parent(node_ID0, parent_ID);
+    // A second model on the same scene node.
+    Assets::MeshModels::UID model_ID2 = Assets::MeshModels::create(node_ID0, m_mesh_IDs[0], m_material_IDs[1]);
+
+    MeshModelBatches batches;
+    SceneNodes::set_global_transform(parent_ID, Math::Transform(Math::Vector3f(0, 5, 0)));
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(Math::Vector3f(1, 5, 0), batches.get_batch(batches.get_batch_index(model_ID0)).transforms[0].translation);
+    EXPECT_EQ(Math::Vector3f(1, 5, 0), batches.get_batch(batches.get_batch_index(model_ID2)).transforms[0].translation);
+
+    // Only the batches of the moved models are changed.
+    std::vector<unsigned int> expected_changed_batches = { (unsigned int)batches.get_batch_index(model_ID0), (unsigned int)batches.get_batch_index(model_ID2) };
+    std::sort(expected_changed_batches.begin(), expected_changed_batches.end());
+    EXPECT_EQ(expected_changed_batches, batches.get_changed_batch_indices());
+    EXPECT_FALSE(std::binary_search(expected_changed_batches.begin(), expected_changed_batches.end(), (unsigned int)batches.get_batch_index(model_ID1)));
+
+    // Destroying one model leaves the other model on the scene node tracking it.
+    Assets::MeshModels::destroy(model_ID0);
+    batches.update();
+    SceneNodes::set_global_transform(node_ID0, Math::Transform(Math::Vector3f(3, 3, 3)));
+    batches.update();
+    verify_batches(batches);
+    EXPECT_EQ(Math::Vector3f(3, 3, 3), batches.get_batch(batches.get_batch_index(model_ID2)).transforms[0].translation);
+}
+
+TEST_F(Scene_MeshModelBatches, random_changes) {
+    Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(17);
+    std::vector<Assets::MeshModels::UID> model_IDs;
+    for (int m = 0; m < 64; ++m)
+        model_IDs.push_back(create_model(rng.sample3f(), m_mesh_IDs[m % 2], m_material_IDs[(m / 2) % 2]));
+
+    MeshModelBatches batches;
+    for (int round = 0; round < 8; ++round) {
+        for (int i = 0; i < 16; ++i) {
+            unsigned int m = rng.sample1ui() % model_IDs.size();
+            float action = rng.sample1f();
+            if (!Assets::MeshModels::has(model_IDs[m]))
+                model_IDs[m] = create_model(rng.sample3f(), m_mesh_IDs[rng.sample1ui() % 2], m_material_IDs[rng.sample1ui() % 2]);
+            else if (action < 0.3f)
+                Assets::MeshModels::destroy(model_IDs[m]);
+            else if (action < 0.6f)
+                Assets::MeshModels::set_material_ID(model_IDs[m], m_material_IDs[rng.sample1ui() % 2]);
+            else
+                SceneNodes::set_global_transform(Assets::MeshModels::get_scene_node_ID(model_IDs[m]), Math::Transform(rng.sample3f()));
+        }
+        batches.update();
+        verify_batches(batches);
+    }
+    EXPECT_EQ(4u, batches.get_batch_count());
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_MESH_MODEL_BATCHES_TEST_H_
@@ -0,0 +1,239 @@
+// Test Bifrost scene BVH and ray queries.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SCENE_BVH_TEST_H_
+#define _BIFROST_SCENE_SCENE_BVH_TEST_H_
+
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Math/Intersect.h>
+#include <Bifrost/Math/RNG.h>
+#include <Bifrost/Scene/SceneBVH.h>
+
+#include <gtest/gtest.h>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_SceneBVH : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        SceneNodes::allocate(1u);
+        SceneRoots::allocate(1u);
+        Assets::Meshes::allocate(1u);
+        Assets::Materials::allocate(1u);
+        Assets::MeshModels::allocate(1u);
+
+        m_material_ID = Assets::Materials::create("Material", {});
+    }
+    virtual void TearDown() {
+        SceneRoots::deallocate();
+        Assets::MeshModels::deallocate();
+        Assets::Materials::deallocate();
+        Assets::Meshes::deallocate();
+        SceneNodes::deallocate();
+    }
+
+    Assets::MeshModels::UID create_model(SceneNodes::UID parent_ID, Assets::Meshes::UID mesh_ID, Math::Transform transform) {
+        SceneNodes::UID node_ID = SceneNodes::create("Node", transform);
+        SceneNodes::set_parent(node_ID, parent_ID);
+        return Assets::MeshModels::create(node_ID, mesh_ID, m_material_ID);
+    }
+
+    // Scatters spheres and tori with random transforms in a 20 units wide box around the origin.
+    void create_random_models(SceneNodes::UID parent_ID, unsigned int model_count) {
+        Assets::Meshes::UID sphere_ID = Assets::MeshCreation::revolved_sphere(8, 6);
+        Assets::Meshes::UID torus_ID = Assets::MeshCreation::torus(8, 6, 0.2f);
+        Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(model_count);
+        for (unsigned int m = 0; m < model_count; ++m) {
+            Math::Vector3f position = rng.sample3f() * 20.0f - 10.0f;
+            Math::Quaternionf rotation = Math::Quaternionf::from_angle_axis(rng.sample1f() * 6.0f, Math::normalize(rng.sample3f() - 0.5f));
+            create_model(parent_ID, (m % 2) ? sphere_ID : torus_ID, Math::Transform(position, rotation, 0.5f + rng.sample1f()));
+        }
+    }
+
+    // Brute force reference, intersecting every triangle of every model in the scene.
+    static RayHit brute_force_intersect(SceneRoots::UID scene_ID, Math::Ray ray) {
+        RayHit hit = { Assets::MeshModels::UID::invalid_UID(), 0u, 1e30f, Math::Vector2f::zero() };
+        for (Assets::MeshModels::UID model_ID : Assets::MeshModels::get_iterable()) {
+            SceneNodes::UID node_ID = Assets::MeshModels::get_scene_node_ID(model_ID);
+            if (!SceneNodes::has_child(SceneRoots::get_root_node(scene_ID), node_ID))
+                continue;
+            Math::Transform transform = SceneNodes::get_global_transform(node_ID);
+            Assets::Meshes::UID mesh_ID = Assets::MeshModels::get_mesh_ID(model_ID);
+            const Math::Vector3ui* primitives = Assets::Meshes::get_primitives(mesh_ID);
+            const Math::Vector3f* positions = Assets::Meshes::get_positions(mesh_ID);
+            for (unsigned int p = 0; p < Assets::Meshes::get_primitive_count(mesh_ID); ++p) {
+                Math::Vector3f vertex0 = transform * positions[primitives[p].x];
+                Math::Vector3f edge1 = transform * positions[primitives[p].y] - vertex0;
+                Math::Vector3f edge2 = transform * positions[primitives[p].z] - vertex0;
+                Math::Vector2f barycentric;
+                float distance = Math::intersect_triangle(ray, vertex0, edge1, edge2, barycentric);
+                if (distance < hit.distance)
+                    hit = { model_ID, p, distance, barycentric };
+            }
+        }
+        return hit;
+    }
+
+    static std::vector<Math::Ray> create_random_rays(unsigned int ray_count) {
+        Math::RNG::LinearCongruential rng = Math::RNG::LinearCongruential(ray_count + 17);
+        std::vector<Math::Ray> rays(ray_count);
+        for (Math::Ray& ray : rays)
+            ray = Math::Ray(rng.sample3f() * 24.0f - 12.0f, Math::normalize(rng.sample3f() - 0.5f));
+        return rays;
+    }
+
+    Assets::Materials::UID m_material_ID;
+};
+
+TEST_F(Scene_SceneBVH, intersect_triangle) {
+    Math::Vector3f vertex0 = Math::Vector3f(0, 0, 2);
+    Math::Vector3f edge1 = Math::Vector3f(1, 0, 0);
+    Math::Vector3f edge2 = Math::Vector3f(0, 1, 0);
+    Math::Vector2f barycentric;
+
+    float distance = Math::intersect_triangle(Math::Ray(Math::Vector3f(0.25f, 0.5f, 0), Math::Vector3f::forward()), vertex0, edge1, edge2, barycentric);
+    EXPECT_FLOAT_EQ(2.0f, distance);
+    EXPECT_FLOAT_EQ(0.25f, barycentric.x);
+    EXPECT_FLOAT_EQ(0.5f, barycentric.y);
+
+    // Hit from behind.
+    distance = Math::intersect_triangle(Math::Ray(Math::Vector3f(0.25f, 0.5f, 4), -Math::Vector3f::forward()), vertex0, edge1, edge2, barycentric);
+    EXPECT_FLOAT_EQ(2.0f, distance);
+
+    // Miss outside the triangle and behind the ray.
+    distance = Math::intersect_triangle(Math::Ray(Math::Vector3f(0.75f, 0.5f, 0), Math::Vector3f::forward()), vertex0, edge1, edge2, barycentric);
+    EXPECT_EQ(std::numeric_limits<float>::infinity(), distance);
+    distance = Math::intersect_triangle(Math::Ray(Math::Vector3f(0.25f, 0.5f, 4), Math::Vector3f::forward()), vertex0, edge1, edge2, barycentric);
+    EXPECT_EQ(std::numeric_limits<float>::infinity(), distance);
+}
+
+TEST_F(Scene_SceneBVH, mesh_BVH_matches_brute_force) {
+    Assets::Meshes::UID mesh_ID = Assets::MeshCreation::torus(32, 16, 0.3f);
+    Assets::MeshBVH mesh_BVH = Assets::MeshBVH(mesh_ID);
+    EXPECT_EQ(Assets::Meshes::get_primitive_count(mesh_ID), mesh_BVH.get_primitive_count());
+
+    const Math::Vector3ui* primitives = Assets::Meshes::get_primitives(mesh_ID);
+    const Math::Vector3f* positions = Assets::Meshes::get_positions(mesh_ID);
+    unsigned int hit_count = 0;
+    for (Math::Ray ray : create_random_rays(500)) {
+        // Aim the rays at the torus.
+        ray.origin *= 0.2f;
+        ray.direction = Math::normalize(ray.direction - ray.origin);
+        float expected_distance = 1e30f;
+        unsigned int expected_primitive_index = 0;
+        for (unsigned int p = 0; p < Assets::Meshes::get_primitive_count(mesh_ID); ++p) {
+            Math::Vector3f vertex0 = positions[primitives[p].x];
+            Math::Vector2f barycentric;
+            float distance = Math::intersect_triangle(ray, vertex0, positions[primitives[p].y] - vertex0, positions[primitives[p].z] - vertex0, barycentric);
+            if (distance < expected_distance) {
+                expected_distance = distance;
+                expected_primitive_index = p;
+            }
+        }
+
+        float distance = 1e30f;
+        unsigned int primitive_index;
+        Math::Vector2f barycentric;
+        bool hit = mesh_BVH.intersect(ray, distance, primitive_index, barycentric);
+        EXPECT_EQ(expected_distance < 1e30f, hit);
+        EXPECT_EQ(hit, mesh_BVH.intersects(ray, 1e30f));
+        if (hit) {
+            ++hit_count;
+            EXPECT_FLOAT_EQ(expected_distance, distance);
+            EXPECT_EQ(expected_primitive_index, primitive_index);
+            EXPECT_FALSE(mesh_BVH.intersects(ray, distance * 0.99f));
+        }
+    }
+    EXPECT_GT(hit_count, 50u);
+}
+
+TEST_F(Scene_SceneBVH, ray_queries_match_brute_force) {
+    SceneRoots::UID scene_ID = SceneRoots::create("Scene", Math::RGB::black());
+    create_random_models(SceneRoots::get_root_node(scene_ID), 200);
+    SceneRoots::update_BVH();
+
+    std::vector<Math::Ray> rays = create_random_rays(300);
+    std::vector<RayHit> hits(rays.size());
+    SceneRoots::intersect(scene_ID, rays.data(), hits.data(), (unsigned int)rays.size());
+
+    unsigned int hit_count = 0;
+    for (unsigned int r = 0; r < rays.size(); ++r) {
+        RayHit expected_hit = brute_force_intersect(scene_ID, rays[r]);
+        RayHit hit = SceneRoots::intersect(scene_ID, rays[r]);
+        EXPECT_EQ(expected_hit.model_ID, hit.model_ID);
+        EXPECT_EQ(expected_hit.is_hit(), SceneRoots::intersects(scene_ID, rays[r]));
+        EXPECT_EQ(hit.model_ID, hits[r].model_ID);
+        if (expected_hit.is_hit()) {
+            ++hit_count;
+            EXPECT_EQ(expected_hit.primitive_index, hit.primitive_index);
+            EXPECT_NEAR(expected_hit.distance, hit.distance, 0.0001f);
+            EXPECT_NEAR(expected_hit.barycentric.x, hit.barycentric.x, 0.001f);
+            EXPECT_NEAR(expected_hit.barycentric.y, hit.barycentric.y, 0.001f);
+            EXPECT_FALSE(SceneRoots::intersects(scene_ID, rays[r], hit.distance * 0.99f));
+        }
+    }
+    EXPECT_GT(hit_count, 30u);
+}
+
+TEST_F(Scene_SceneBVH, hits_are_filtered_by_scene) {
+    SceneRoots::UID scene_ID0 = SceneRoots::create("Scene0", Math::RGB::black());
+    SceneRoots::UID scene_ID1 = SceneRoots::create("Scene1", Math::RGB::black());
+    Assets::Meshes::UID mesh_ID = Assets::MeshCreation::cube(1);
+    Assets::MeshModels::UID near_model_ID = create_model(SceneRoots::get_root_node(scene_ID0), mesh_ID, Math::Transform(Math::Vector3f(0, 0, 2)));
+    Assets::MeshModels::UID far_model_ID = create_model(SceneRoots::get_root_node(scene_ID1), mesh_ID, Math::Transform(Math::Vector3f(0, 0, 4)));
+    SceneRoots::update_BVH();
+
+    Math::Ray ray = Math::Ray(Math::Vector3f::zero(), Math::Vector3f::forward());
+    RayHit hit0 = SceneRoots::intersect(scene_ID0, ray);
+    EXPECT_EQ(near_model_ID, hit0.model_ID);
+    EXPECT_FLOAT_EQ(1.5f, hit0.distance);
+
+    RayHit hit1 = SceneRoots::intersect(scene_ID1, ray);
+    EXPECT_EQ(far_model_ID, hit1.model_ID);
+    EXPECT_FLOAT_EQ(3.5f, hit1.distance);
+}
+
+TEST_F(Scene_SceneBVH, queries_track_scene_changes) {
+    SceneRoots::UID scene_ID = SceneRoots::create("Scene", Math::RGB::black());
+    SceneNodes::UID root_ID = SceneRoots::get_root_node(scene_ID);
+    Assets::Meshes::UID cube_ID = Assets::MeshCreation::cube(1);
+    Assets::MeshModels::UID model_ID = create_model(root_ID, cube_ID, Math::Transform(Math::Vector3f(0, 0, 2)));
+
+    // Nothing is hit before the hierarchy is created.
+    Math::Ray ray = Math::Ray(Math::Vector3f::zero(), Math::Vector3f::forward());
+    EXPECT_FALSE(SceneRoots::intersects(scene_ID, ray));
+    SceneRoots::update_BVH();
+    EXPECT_FLOAT_EQ(1.5f, SceneRoots::intersect(scene_ID, ray).distance);
+
+    // Moving and scaling the model refits the hierarchy.
+    SceneNodes::UID node_ID = Assets::MeshModels::get_scene_node_ID(model_ID);
+    SceneNodes::set_global_transform(node_ID, Math::Transform(Math::Vector3f(0, 0, 5), Math::Quaternionf::identity(), 2.0f));
+    SceneRoots::update_BVH();
+    EXPECT_FLOAT_EQ(4.0f, SceneRoots::intersect(scene_ID, ray).distance);
+    SceneNodes::set_global_transform(node_ID, Math::Transform(Math::Vector3f(5, 0, 5)));
+    SceneRoots::update_BVH();
+    EXPECT_FALSE(SceneRoots::intersects(scene_ID, ray));
+
+    // Replacing the model's mesh rebuilds the mesh hierarchy.
+    SceneNodes::set_global_transform(node_ID, Math::Transform(Math::Vector3f(0, 0, 5)));
+    Assets::MeshModels::destroy(model_ID);
+    Assets::Meshes::destroy(cube_ID);
+    Assets::Meshes::UID wide_cube_ID = Assets::MeshCreation::cube(1, Math::Vector3f(4.0f));
+    model_ID = Assets::MeshModels::create(node_ID, wide_cube_ID, m_material_ID);
+    SceneRoots::update_BVH();
+    RayHit hit = SceneRoots::intersect(scene_ID, ray);
+    EXPECT_EQ(model_ID, hit.model_ID);
+    EXPECT_FLOAT_EQ(3.0f, hit.distance);
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_SCENE_BVH_TEST_H_
@@ -313,6 +313,153 @@ GTEST_TEST(Scene_SceneNode, graph_traversal) {
     SceneNodes::deallocate();
 }
 
+GTEST_TEST(Scene_SceneNode, child_iteration) {
+    SceneNodes::allocate(8u);
+    SceneNode parent = SceneNodes::create("parent");
+    SceneNode c0 = SceneNodes::create("c0");
+    SceneNode c1 = SceneNodes::create("c1");
+    SceneNode c2 = SceneNodes::create("c2");
+    c0.set_parent(parent);
+    c1.set_parent(parent);
+    c2.set_parent(parent);
+
+    EXPECT_EQ(3u, parent.get_child_count());
+    Core::Iterable<SceneNodes::ChildIterator> children = SceneNodes::get_children(parent.get_ID());
+    EXPECT_EQ(3, children.end() - children.begin());
+    unsigned int child_mask = 0u;
+    for (SceneNodes::UID child_ID : children)
+        child_mask |= (child_ID == c0.get_ID() ? 1u : 0u) | (child_ID == c1.get_ID() ? 2u : 0u) | (child_ID == c2.get_ID() ? 4u : 0u);
+    EXPECT_EQ(7u, child_mask);
+
+    // Detaching a child keeps the remaining children contiguous.
+    c0.set_parent(SceneNodes::UID::invalid_UID());
+    EXPECT_EQ(2u, parent.get_child_count());
+    EXPECT_FALSE(parent.has_child(c0));
+    EXPECT_TRUE(parent.has_child(c1));
+    EXPECT_TRUE(parent.has_child(c2));
+    EXPECT_TRUE(SceneNodes::get_children(c0.get_ID()).is_empty());
+
+    SceneNodes::deallocate();
+}
+
+GTEST_TEST(Scene_SceneNode, reparenting_many_children) {
+    // Moves children back and forth between parents, which moves child ranges and compacts the child pool.
+    const unsigned int parent_count = 8u;
+    const unsigned int child_count = 4096u;
+    SceneNodes::allocate(parent_count + child_count + 1);
+
+    std::vector<SceneNode> parents;
+    for (unsigned int p = 0; p < parent_count; ++p) {
+        parents.push_back(SceneNodes::create("parent"));
+        if (p > 0)
+            parents[p].set_parent(parents[p - 1]);
+    }
+    std::vector<SceneNode> children;
+    for (unsigned int c = 0; c < child_count; ++c)
+        children.push_back(SceneNodes::create("child"));
+
+    for (unsigned int round = 0; round < 4u; ++round)
+        for (unsigned int c = 0; c < child_count; ++c)
+            children[c].set_parent(parents[(c * 7u + round) % parent_count]);
+
+    for (unsigned int c = 0; c < child_count; ++c) {
+        SceneNode expected_parent = parents[(c * 7u + 3u) % parent_count];
+        EXPECT_EQ(expected_parent, children[c].get_parent());
+        EXPECT_TRUE(expected_parent.has_child(children[c]));
+    }
+
+    // The parents are still chained and every node below the first parent is visited once.
+    unsigned int visit_count = 0u;
+    parents[0].apply_to_children_recursively([&](SceneNodes::UID) { ++visit_count; });
+    EXPECT_EQ(parent_count - 1 + child_count, visit_count);
+    for (unsigned int p = 1; p < parent_count; ++p)
+        EXPECT_EQ(parents[p - 1], parents[p].get_parent());
+
+    SceneNodes::deallocate();
+}
+
+GTEST_TEST(Scene_SceneNode, child_pool_is_bounded_under_churn) {
+    SceneNodes::allocate(8u);
+    SceneNode root = SceneNodes::create("root");
+
+    // Creates a parent with children and destroys them again, which abandons the parent's child slots.
+    auto churn = [&](unsigned int iteration_count) {
+        for (unsigned int i = 0; i < iteration_count; ++i) {
+            SceneNode parent = SceneNodes::create("parent");
+            parent.set_parent(root);
+            SceneNode child0 = SceneNodes::create("child0");
+            SceneNode child1 = SceneNodes::create("child1");
+            child0.set_parent(parent);
+            child1.set_parent(parent);
+            SceneNodes::destroy(child0.get_ID());
+            SceneNodes::destroy(child1.get_ID());
+            SceneNodes::destroy(parent.get_ID());
+        }
+    };
+
+    churn(4096u);
+    size_t metadata_bytes = SceneNodes::get_memory_usage()[Core::MemoryCategory::Metadata];
+    churn(65536u);
+    EXPECT_LE(SceneNodes::get_memory_usage()[Core::MemoryCategory::Metadata], metadata_bytes + 32 * 1024);
+    EXPECT_EQ(0u, root.get_child_count());
+
+    // Destroyed nodes have no memory usage.
+    SceneNode node = SceneNodes::create("node");
+    SceneNodes::destroy(node.get_ID());
+    EXPECT_EQ(0u, SceneNodes::get_memory_usage(node.get_ID()).get_total_bytes());
+
+    SceneNodes::deallocate();
+}
+
+GTEST_TEST(Scene_SceneNode, destroy_detaches_node) {
+    SceneNodes::allocate(4u);
+    SceneNode n0 = SceneNodes::create("n0");
+    SceneNode n1 = SceneNodes::create("n1");
+    SceneNode n2 = SceneNodes::create("n2");
+    n1.set_parent(n0);
+    n2.set_parent(n1);
+
+    SceneNodes::destroy(n1.get_ID());
+    EXPECT_EQ(0u, n0.get_child_count());
+    EXPECT_FALSE(n2.get_parent().exists());
+
+    // A node created in the destroyed node's slot has no relatives.
+    SceneNode n3 = SceneNodes::create("n3");
+    EXPECT_EQ(0u, n3.get_child_count());
+    EXPECT_FALSE(n3.get_parent().exists());
+
+    SceneNodes::deallocate();
+}
+
+GTEST_TEST(Scene_SceneNode, find_by_name) {
+    SceneNodes::allocate(4u);
+    SceneNodes::UID n0 = SceneNodes::create("Foo");
+    SceneNodes::UID n1 = SceneNodes::create("Bar");
+    SceneNodes::UID n2 = SceneNodes::create("Foo");
+
+    EXPECT_EQ(n1, SceneNodes::find("Bar"));
+    EXPECT_EQ(SceneNodes::UID::invalid_UID(), SceneNodes::find("Baz"));
+    std::vector<SceneNodes::UID> foo_IDs = SceneNodes::find_all("Foo");
+    ASSERT_EQ(2u, foo_IDs.size());
+    EXPECT_TRUE(foo_IDs[0] == n0 || foo_IDs[1] == n0);
+    EXPECT_TRUE(foo_IDs[0] == n2 || foo_IDs[1] == n2);
+
+    // Renaming and destroying nodes updates the index.
+    SceneNodes::set_name(n0, "Baz");
+    EXPECT_EQ(n0, SceneNodes::find("Baz"));
+    EXPECT_EQ(n2, SceneNodes::find("Foo"));
+    SceneNodes::destroy(n2);
+    EXPECT_EQ(SceneNodes::UID::invalid_UID(), SceneNodes::find("Foo"));
+    EXPECT_TRUE(SceneNodes::find_all("Foo").empty());
+
+    // A node created in the destroyed node's slot is found by its own name.
+    SceneNodes::UID n3 = SceneNodes::create("Qux");
+    EXPECT_EQ(n3, SceneNodes::find("Qux"));
+    EXPECT_EQ(SceneNodes::UID::invalid_UID(), SceneNodes::find("Foo"));
+
+    SceneNodes::deallocate();
+}
+
 } // NS Scene
 } // NS Bifrost
 
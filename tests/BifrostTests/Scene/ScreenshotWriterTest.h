@@ -0,0 +1,149 @@
+// Test Bifrost asynchronous screenshot writer.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SCREENSHOT_WRITER_TEST_H_
+#define _BIFROST_SCENE_SCREENSHOT_WRITER_TEST_H_
+
+#include <Bifrost/Scene/ScreenshotWriter.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_ScreenshotWriter : public ::testing::Test {
+protected:
+    // Per-test set-up and tear-down logic.
+    virtual void SetUp() {
+        SceneNodes::allocate(1u);
+        SceneRoots::allocate(1u);
+        Cameras::allocate(1u);
+    }
+    virtual void TearDown() {
+        Cameras::deallocate();
+        SceneRoots::deallocate();
+        SceneNodes::deallocate();
+    }
+
+    static Screenshot create_screenshot(Screenshot::Content content, unsigned char value) {
+        unsigned char* pixels = new unsigned char[4 * 4];
+        for (int i = 0; i < 4 * 4; ++i)
+            pixels[i] = value;
+        return Screenshot(2, 2, content, Assets::PixelFormat::RGBA32, pixels);
+    }
+};
+
+TEST_F(Scene_ScreenshotWriter, write_screenshots) {
+    std::atomic_int encoded_pixel_sum = 0;
+    auto encoder = [&](const Screenshot& screenshot, const std::string& path) {
+        encoded_pixel_sum += ((unsigned char*)screenshot.pixels)[0];
+        return path != "fail";
+    };
+
+    std::atomic_int success_count = 0, failure_count = 0;
+    auto on_completion = [&](const std::string& path, bool succeeded) {
+        if (succeeded)
+            ++success_count;
+        else
+            ++failure_count;
+    };
+
+    {
+        ScreenshotWriter writer = ScreenshotWriter(encoder, 2, 2);
+        EXPECT_EQ(2u, writer.get_queue_capacity());
+        EXPECT_EQ(2u, writer.get_worker_count());
+
+        for (int i = 1; i <= 8; ++i)
+            writer.write(create_screenshot(Screenshot::Content::ColorLDR, (unsigned char)i), "screenshot", on_completion);
+        writer.write(create_screenshot(Screenshot::Content::ColorLDR, 1), "fail", on_completion);
+        writer.wait_until_idle();
+
+        EXPECT_EQ(0u, writer.get_pending_count());
+        EXPECT_EQ(8, success_count);
+        EXPECT_EQ(1, failure_count);
+        EXPECT_EQ(37, encoded_pixel_sum);
+
+        // Screenshots still queued when the writer is destroyed are written.
+        writer.write(create_screenshot(Screenshot::Content::ColorLDR, 1), "screenshot", on_completion);
+    }
+    EXPECT_EQ(9, success_count);
+}
+
+TEST_F(Scene_ScreenshotWriter, backpressure) {
+    std::promise<void> encoding_allowed;
+    std::shared_future<void> allow_encoding = encoding_allowed.get_future().share();
+    std::promise<void> first_screenshot_dequeued;
+    std::atomic_int encoded_count = 0;
+    auto encoder = [&](const Screenshot& screenshot, const std::string& path) {
+        if (encoded_count++ == 0)
+            first_screenshot_dequeued.set_value();
+        allow_encoding.wait();
+        return true;
+    };
+
+    ScreenshotWriter writer = ScreenshotWriter(encoder, 1, 1);
+
+    // The first screenshot is being encoded and the second fills the queue.
+    EXPECT_TRUE(writer.try_write(create_screenshot(Screenshot::Content::ColorLDR, 1), "screenshot"));
+    first_screenshot_dequeued.get_future().wait();
+    EXPECT_TRUE(writer.try_write(create_screenshot(Screenshot::Content::ColorLDR, 2), "screenshot"));
+    EXPECT_EQ(2u, writer.get_pending_count());
+
+    // The full queue refuses the screenshot and leaves the pixels with the caller.
+    Screenshot refused_screenshot = create_screenshot(Screenshot::Content::ColorLDR, 3);
+    EXPECT_FALSE(writer.try_write(refused_screenshot, "screenshot"));
+    EXPECT_EQ(2u, writer.get_pending_count());
+    Assets::Images::deallocate_pixels(refused_screenshot.format, refused_screenshot.pixels);
+
+    encoding_allowed.set_value();
+    writer.wait_until_idle();
+    EXPECT_EQ(2, encoded_count);
+    EXPECT_EQ(0u, writer.get_pending_count());
+}
+
+TEST_F(Scene_ScreenshotWriter, write_camera_screenshots) {
+    SceneRoots::UID scene_ID = SceneRoots::create("Root", Math::RGB::black());
+    Cameras::UID camera_ID = Cameras::create("Camera", scene_ID, Math::Matrix4x4f::identity(), Math::Matrix4x4f::identity());
+
+    Cameras::request_screenshot(camera_ID, { Screenshot::Content::ColorLDR, Screenshot::Content::Depth });
+    Assets::Images::PixelData color_pixels = nullptr;
+    Cameras::fill_screenshot(camera_ID, [&](Cameras::ScreenshotContent content, unsigned int minimum_iteration_count) {
+        std::vector<Screenshot> screenshots;
+        screenshots.push_back(create_screenshot(Screenshot::Content::ColorLDR, 1));
+        color_pixels = screenshots[0].pixels;
+        screenshots.push_back(create_screenshot(Screenshot::Content::Depth, 2));
+        return screenshots;
+    });
+    EXPECT_EQ(Cameras::ScreenshotContent({ Screenshot::Content::ColorLDR, Screenshot::Content::Depth }), Cameras::pending_screenshots(camera_ID));
+
+    // The encoder reads the pixels written by the renderer.
+    std::atomic<Assets::Images::PixelData> encoded_color_pixels = nullptr;
+    auto encoder = [&](const Screenshot& screenshot, const std::string& path) {
+        if (screenshot.content == Screenshot::Content::ColorLDR)
+            encoded_color_pixels = screenshot.pixels;
+        return true;
+    };
+
+    ScreenshotWriter writer = ScreenshotWriter(encoder);
+    EXPECT_TRUE(writer.write(camera_ID, Screenshot::Content::ColorLDR, "color.png"));
+    EXPECT_FALSE(writer.write(camera_ID, Screenshot::Content::ColorHDR, "color.hdr"));
+    EXPECT_EQ(Cameras::ScreenshotContent(Screenshot::Content::Depth), Cameras::pending_screenshots(camera_ID));
+    EXPECT_TRUE(writer.write(camera_ID, Screenshot::Content::Depth, "depth.png"));
+    EXPECT_EQ(Cameras::ScreenshotContent(Screenshot::Content::None), Cameras::pending_screenshots(camera_ID));
+
+    writer.wait_until_idle();
+    EXPECT_EQ(color_pixels, encoded_color_pixels);
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_SCREENSHOT_WRITER_TEST_H_
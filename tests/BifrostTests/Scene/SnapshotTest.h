@@ -0,0 +1,270 @@
+// Test Bifrost datamodel snapshots.
+// ------------------------------------------------------------------------------------------------
+// Copyright (C) Bifrost. See AUTHORS.txt for authors.
+//
+// This program is open source and distributed under the New BSD License.
+// See LICENSE.txt for more detail.
+// ------------------------------------------------------------------------------------------------
+
+#ifndef _BIFROST_SCENE_SNAPSHOT_TEST_H_
+#define _BIFROST_SCENE_SNAPSHOT_TEST_H_
+
+#include <Bifrost/Assets/InfiniteAreaLight.h>
+#include <Bifrost/Assets/MeshCreation.h>
+#include <Bifrost/Scene/Camera.h>
+#include <Bifrost/Scene/LightSource.h>
+#include <Bifrost/Scene/Snapshot.h>
+
+#include <Scene/DatamodelFixture.h>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <vector>
+
+namespace Bifrost {
+namespace Scene {
+
+class Scene_Snapshot : public DatamodelFixture {
+protected:
+    Scene_Snapshot() : DatamodelFixture("Scene_Snapshot.bfsnap") {}
+
+    // Creates a scene with an environment map, a textured material, a model with a child model, a light and a camera.
+    static SceneRoots::UID create_scene() {
+        using namespace Assets;
+
+        Image environment = Images::create2D("Environment", PixelFormat::RGBA_Float, 1.0f, Math::Vector2ui(8, 4));
+        for (unsigned int y = 0; y < 4; ++y)
+            for (unsigned int x = 0; x < 8; ++x)
+                environment.set_pixel(Math::RGBA(x * 0.1f, y * 0.2f, 0.5f, 1.0f), Math::Vector2ui(x, y));
+        Textures::UID environment_map_ID = Textures::create2D(environment.get_ID(), MagnificationFilter::Linear, MinificationFilter::Linear, WrapMode::Repeat, WrapMode::Clamp);
+        SceneRoots::UID scene_ID = SceneRoots::create("Scene", environment_map_ID, Math::RGB(0.5f, 0.75f, 1.0f));
+
+        Image tint = Images::create2D("Tint", PixelFormat::Intensity8, 2.2f, Math::Vector2ui(4, 4), 3);
+        unsigned char* tint_pixels = tint.get_pixels<unsigned char>();
+        for (unsigned int i = 0; i < 16 + 4 + 1; ++i)
+            tint_pixels[i] = (unsigned char)(i * 7);
+        Textures::UID tint_texture_ID = Textures::create2D(tint.get_ID(), MagnificationFilter::None, MinificationFilter::Trilinear, WrapMode::Clamp, WrapMode::Repeat);
+
+        Materials::Data material_data = Materials::Data::create_dielectric(Math::RGB(0.2f, 0.4f, 0.6f), 0.3f, 0.04f);
+        material_data.tint_roughness_texture_ID = tint_texture_ID;
+        material_data.coat = 0.5f;
+        material_data.flags = MaterialFlag::Cutout;
+        Materials::UID material_ID = Materials::create("Material", material_data);
+
+        Meshes::UID mesh_ID = MeshCreation::torus(8, 6, 0.2f);
+
+        SceneNodes::UID parent_ID = SceneNodes::create("Parent", Math::Transform(Math::Vector3f(1, 2, 3), Math::Quaternionf::from_angle_axis(0.5f, Math::Vector3f::up()), 2.0f));
+        SceneNodes::set_parent(parent_ID, SceneRoots::get_root_node(scene_ID));
+        SceneNodes::UID child_ID = SceneNodes::create("Child", Math::Transform(Math::Vector3f(-1, 0, 0)));
+        SceneNodes::set_parent(child_ID, parent_ID);
+        MeshModels::create(parent_ID, mesh_ID, material_ID);
+        MeshModels::create(child_ID, mesh_ID, material_ID);
+
+        LightSources::create_spot_light(child_ID, Math::RGB(10, 20, 30), 0.25f, 0.5f);
+
+        Cameras::UID camera_ID = Cameras::create("Camera", scene_ID, Math::Matrix4x4f::identity(), Math::Matrix4x4f::identity());
+        Cameras::set_transform(camera_ID, Math::Transform(Math::Vector3f(0, 1, -5)));
+        Cameras::set_z_index(camera_ID, 3);
+        Cameras::set_viewport(camera_ID, Math::Rectf(0.25f, 0.0f, 0.5f, 1.0f));
+
+        return scene_ID;
+    }
+};
+
+TEST_F(Scene_Snapshot, save_and_load_datamodel) {
+    using namespace Assets;
+
+    SceneRoots::UID scene_ID = create_scene();
+    const InfiniteAreaLight* environment_light = SceneRoots::get_environment_light(scene_ID);
+    std::vector<float> marginal_CDF(environment_light->get_image_marginal_CDF(), environment_light->get_image_marginal_CDF() + 5);
+    std::vector<float> conditional_CDF(environment_light->get_image_conditional_CDF(), environment_light->get_image_conditional_CDF() + 9 * 4);
+    float integral = environment_light->image_integral();
+    Meshes::UID original_mesh_ID = *Meshes::get_iterable().begin();
+    Mesh original_mesh = original_mesh_ID;
+    std::vector<Math::Vector3ui> primitives(original_mesh.get_primitives(), original_mesh.get_primitives() + original_mesh.get_primitive_count());
+    std::vector<Math::Vector3f> normals(original_mesh.get_normals(), original_mesh.get_normals() + original_mesh.get_vertex_count());
+    Math::Transform child_transform = SceneNodes::get_global_transform(find_node("Child"));
+
+    EXPECT_TRUE(Snapshot::save(m_path));
+
+    deallocate_managers();
+    allocate_managers();
+    EXPECT_TRUE(Snapshot::load(m_path));
+
+    EXPECT_EQ(2u, count<Images>());
+    EXPECT_EQ(2u, count<Textures>());
+    EXPECT_EQ(1u, count<Materials>());
+    EXPECT_EQ(1u, count<Meshes>());
+    EXPECT_EQ(2u, count<MeshModels>());
+    EXPECT_EQ(3u, count<SceneNodes>());
+    EXPECT_EQ(1u, count<SceneRoots>());
+    EXPECT_EQ(1u, count<LightSources>());
+    EXPECT_EQ(1u, count<Cameras>());
+
+    // Scene and environment.
+    SceneRoots::UID loaded_scene_ID = *SceneRoots::get_iterable().begin();
+    EXPECT_EQ("Scene", SceneRoots::get_name(loaded_scene_ID));
+    EXPECT_EQ(Math::RGB(0.5f, 0.75f, 1.0f), SceneRoots::get_environment_tint(loaded_scene_ID));
+    const InfiniteAreaLight* loaded_environment_light = SceneRoots::get_environment_light(loaded_scene_ID);
+    ASSERT_NE(nullptr, loaded_environment_light);
+    EXPECT_EQ(integral, loaded_environment_light->image_integral());
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(marginal_CDF[i], loaded_environment_light->get_image_marginal_CDF()[i]);
+    for (int i = 0; i < 9 * 4; ++i)
+        EXPECT_EQ(conditional_CDF[i], loaded_environment_light->get_image_conditional_CDF()[i]);
+    Image environment = Textures::get_image_ID(loaded_environment_light->get_texture_ID());
+    EXPECT_EQ("Environment", environment.get_name());
+    EXPECT_EQ(Math::RGBA(3 * 0.1f, 2 * 0.2f, 0.5f, 1.0f), environment.get_pixel(Math::Vector2ui(3, 2)));
+
+    // Hierarchy.
+    SceneNodes::UID parent_ID = find_node("Parent");
+    SceneNodes::UID child_ID = find_node("Child");
+    EXPECT_EQ(SceneRoots::get_root_node(loaded_scene_ID), SceneNodes::get_parent_ID(parent_ID));
+    EXPECT_EQ(parent_ID, SceneNodes::get_parent_ID(child_ID));
+    EXPECT_EQ(child_transform, SceneNodes::get_global_transform(child_ID));
+
+    // Material and its mipmapped texture.
+    Material material = *Materials::get_iterable().begin();
+    EXPECT_EQ("Material", material.get_name());
+    EXPECT_EQ(Math::RGB(0.2f, 0.4f, 0.6f), material.get_tint());
+    EXPECT_EQ(0.3f, material.get_roughness());
+    EXPECT_EQ(0.5f, material.get_coat());
+    EXPECT_TRUE(material.get_flags().is_set(MaterialFlag::Cutout));
+    Texture tint_texture = material.get_tint_roughness_texture();
+    EXPECT_EQ(MinificationFilter::Trilinear, tint_texture.get_minification_filter());
+    EXPECT_EQ(WrapMode::Repeat, tint_texture.get_wrapmode_V());
+    Image tint = tint_texture.get_image();
+    EXPECT_EQ(3u, tint.get_mipmap_count());
+    EXPECT_FLOAT_EQ(2.2f, tint.get_gamma());
+    unsigned char* tint_pixels = tint.get_pixels<unsigned char>();
+    for (unsigned int i = 0; i < 16 + 4 + 1; ++i)
+        EXPECT_EQ((unsigned char)(i * 7), tint_pixels[i]);
+
+    // Mesh and models.
+    Mesh mesh = *Meshes::get_iterable().begin();
+    ASSERT_EQ(primitives.size(), mesh.get_primitive_count());
+    ASSERT_EQ(normals.size(), mesh.get_vertex_count());
+    for (unsigned int p = 0; p < primitives.size(); ++p)
+        EXPECT_EQ(primitives[p], mesh.get_primitives()[p]);
+    for (unsigned int v = 0; v < normals.size(); ++v)
+        EXPECT_EQ(normals[v], mesh.get_normals()[v]);
+    for (MeshModel model : MeshModels::get_iterable()) {
+        EXPECT_EQ(mesh.get_ID(), model.get_mesh().get_ID());
+        EXPECT_EQ(material.get_ID(), model.get_material().get_ID());
+        EXPECT_TRUE(model.get_scene_node().get_ID() == parent_ID || model.get_scene_node().get_ID() == child_ID);
+    }
+
+    // Light and camera.
+    LightSources::UID light_ID = *LightSources::get_iterable().begin();
+    EXPECT_EQ(LightSources::Type::Spot, LightSources::get_type(light_ID));
+    EXPECT_EQ(child_ID, LightSources::get_node_ID(light_ID));
+    EXPECT_EQ(Math::RGB(10, 20, 30), LightSources::get_spot_light_power(light_ID));
+    EXPECT_EQ(0.25f, LightSources::get_spot_light_radius(light_ID));
+    EXPECT_NEAR(0.5f, LightSources::get_spot_light_cos_angle(light_ID), 0.0001f);
+
+    Cameras::UID camera_ID = *Cameras::get_iterable().begin();
+    EXPECT_EQ("Camera", Cameras::get_name(camera_ID));
+    EXPECT_EQ(loaded_scene_ID, Cameras::get_scene_ID(camera_ID));
+    EXPECT_EQ(Math::Transform(Math::Vector3f(0, 1, -5)), Cameras::get_transform(camera_ID));
+    EXPECT_EQ(3, Cameras::get_z_index(camera_ID));
+    EXPECT_EQ(Math::Rectf(0.25f, 0.0f, 0.5f, 1.0f), Cameras::get_viewport(camera_ID));
+}
+
+TEST_F(Scene_Snapshot, load_next_to_existing_resources) {
+    using namespace Assets;
+
+    create_scene();
+    EXPECT_TRUE(Snapshot::save(m_path));
+    EXPECT_TRUE(Snapshot::load(m_path));
+
+    EXPECT_EQ(2u, count<SceneRoots>());
+    EXPECT_EQ(6u, count<SceneNodes>());
+    EXPECT_EQ(4u, count<MeshModels>());
+    EXPECT_EQ(2u, count<Cameras>());
+
+    // The loaded resources reference each other and not the original resources.
+    for (Cameras::UID camera_ID : Cameras::get_iterable()) {
+        SceneRoots::UID scene_ID = Cameras::get_scene_ID(camera_ID);
+        EXPECT_TRUE(SceneRoots::has(scene_ID));
+        for (LightSources::UID light_ID : LightSources::get_iterable()) {
+            SceneNodes::UID light_node_ID = LightSources::get_node_ID(light_ID);
+            EXPECT_EQ("Child", SceneNodes::get_name(light_node_ID));
+        }
+    }
+    for (MeshModels::UID model_ID : MeshModels::get_iterable()) {
+        SceneNodes::UID node_ID = MeshModels::get_scene_node_ID(model_ID);
+        unsigned int scenes_containing_model = 0;
+        for (SceneRoots::UID scene_ID : SceneRoots::get_iterable())
+            scenes_containing_model += SceneNodes::has_child(SceneRoots::get_root_node(scene_ID), node_ID) ||
+                                       SceneNodes::has_child(SceneRoots::get_root_node(scene_ID), SceneNodes::get_parent_ID(node_ID));
+        EXPECT_EQ(1u, scenes_containing_model);
+    }
+}
+
+TEST_F(Scene_Snapshot, save_propagates_pending_transforms) {
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    create_scene();
+    // The parent is a child of the scene root, whose global transform is the identity.
+    Math::Transform parent_transform = Math::Transform(Math::Vector3f(0, 0, 5));
+    SceneNodes::set_local_transform(find_node("Parent"), parent_transform);
+    EXPECT_TRUE(SceneNodes::has_pending_transforms());
+    Math::Transform child_transform = parent_transform * SceneNodes::get_local_transform(find_node("Child"));
+
+    EXPECT_TRUE(Snapshot::save(m_path));
+    EXPECT_FALSE(SceneNodes::has_pending_transforms());
+    deallocate_managers();
+    allocate_managers();
+    EXPECT_TRUE(Snapshot::load(m_path));
+
+    EXPECT_EQ(child_transform, SceneNodes::get_global_transform(find_node("Child")));
+}
+
+TEST_F(Scene_Snapshot, compressed_meshes_keep_their_storage) {
+    using namespace Assets;
+
+    Mesh mesh = MeshCreation::torus(8, 6, 0.2f);
+    mesh.set_compression(MeshFlags(MeshFlag::QuantizedPosition) | MeshFlag::OctahedralNormal);
+    std::vector<Math::Vector3f> positions(mesh.get_vertex_count()), normals(mesh.get_vertex_count());
+    mesh.decode_positions(0, mesh.get_vertex_count(), positions.data());
+    mesh.decode_normals(0, mesh.get_vertex_count(), normals.data());
+    EXPECT_TRUE(Snapshot::save(m_path));
+    deallocate_managers();
+    allocate_managers();
+    EXPECT_TRUE(Snapshot::load(m_path));
+
+    // The loaded buffers are decoded to the same values, which also requires the same position quantization.
+    Mesh loaded_mesh = *Meshes::get_iterable().begin();
+    EXPECT_EQ(MeshFlags(MeshFlag::AllBuffers) | MeshFlag::QuantizedPosition | MeshFlag::OctahedralNormal, loaded_mesh.get_flags());
+    ASSERT_EQ(positions.size(), loaded_mesh.get_vertex_count());
+    for (unsigned int v = 0; v < loaded_mesh.get_vertex_count(); ++v) {
+        EXPECT_EQ(positions[v], loaded_mesh.get_position(v));
+        EXPECT_EQ(normals[v], loaded_mesh.get_normal(v));
+    }
+}
+
+TEST_F(Scene_Snapshot, reject_invalid_files) {
+    EXPECT_FALSE(Snapshot::load("Scene_Snapshot_missing.bfsnap"));
+
+    { // Not a snapshot.
+        std::ofstream file(m_path, std::ios::binary);
+        file << "Not a snapshot, but long enough to contain a snapshot header.";
+    }
+    EXPECT_FALSE(Snapshot::load(m_path));
+
+    { // Truncated snapshot.
+        create_scene();
+        EXPECT_TRUE(Snapshot::save(m_path));
+        std::ifstream file(m_path, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        std::ofstream truncated_file(m_path, std::ios::binary | std::ios::trunc);
+        truncated_file.write(contents.data(), contents.size() / 2);
+    }
+    EXPECT_FALSE(Snapshot::load(m_path));
+}
+
+} // NS Scene
+} // NS Bifrost
+
+#endif // _BIFROST_SCENE_SNAPSHOT_TEST_H_
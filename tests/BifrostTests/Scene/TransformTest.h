@@ -9,6 +9,7 @@
 #ifndef _BIFROST_SCENE_TRANSFORM_TEST_H_
 #define _BIFROST_SCENE_TRANSFORM_TEST_H_
 
+#include <Bifrost/Core/Engine.h>
 #include <Bifrost/Scene/SceneNode.h>
 
 #include <gtest/gtest.h>
@@ -314,6 +315,132 @@ TEST_F(Scene_Transform, Transform_changed_notification) {
     }
 }
 
+TEST_F(Scene_Transform, deferred_propagation) {
+    // Tests the following hierachy
+    //    n0
+    //   /  \
+    // n1    n2
+    //       |
+    //       n3
+    SceneNode n0 = SceneNodes::create("n0");
+    SceneNode n1 = SceneNodes::create("n1");
+    SceneNode n2 = SceneNodes::create("n2");
+    SceneNode n3 = SceneNodes::create("n3");
+    n1.set_parent(n0);
+    n2.set_parent(n0);
+    n3.set_parent(n2);
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    SceneNodes::reset_change_notifications();
+
+    Transform n0_local = Transform(Vector3f(1, 2, 3), Quaternionf::from_angle_axis(degrees_to_radians(45.0f), Vector3f::up()), 2.0f);
+    Transform n2_local = Transform(Vector3f(0, 1, 0), Quaternionf::from_angle_axis(degrees_to_radians(-30.0f), Vector3f::right()));
+    Transform n3_local = Transform(Vector3f(4, 0, 0));
+    n0.set_local_transform(n0_local);
+    n3.set_local_transform(n3_local);
+    n2.set_local_transform(n2_local);
+
+    // Local transforms are updated immediately, while global transforms and notifications wait for the propagation.
+    EXPECT_TRUE(SceneNodes::has_pending_transforms());
+    EXPECT_PRED2(compare_transforms, n2_local, n2.get_local_transform());
+    EXPECT_EQ(Transform::identity(), n3.get_global_transform());
+    EXPECT_TRUE(SceneNodes::get_changed_nodes().is_empty());
+
+    SceneNodes::propagate_transforms();
+    EXPECT_FALSE(SceneNodes::has_pending_transforms());
+
+    EXPECT_PRED2(compare_transforms, n0_local, n0.get_global_transform());
+    EXPECT_PRED2(compare_transforms, n0_local, n1.get_global_transform());
+    EXPECT_PRED2(compare_transforms, n0_local * n2_local, n2.get_global_transform());
+    EXPECT_PRED2(compare_transforms, n0_local * n2_local * n3_local, n3.get_global_transform());
+
+    Core::Iterable<SceneNodes::ChangedIterator> changed_nodes = SceneNodes::get_changed_nodes();
+    EXPECT_EQ(4, changed_nodes.end() - changed_nodes.begin());
+    for (SceneNodes::UID node_ID : changed_nodes)
+        EXPECT_EQ(SceneNodes::Change::Transform, SceneNodes::get_changes(node_ID));
+}
+
+TEST_F(Scene_Transform, deferred_propagation_matches_immediate) {
+    auto create_hierarchy = []() -> std::vector<SceneNode> {
+        std::vector<SceneNode> nodes;
+        nodes.push_back(SceneNodes::create("root"));
+        for (int i = 1; i < 16; ++i) {
+            nodes.push_back(SceneNodes::create("node"));
+            nodes[i].set_parent(nodes[(i - 1) / 2]);
+        }
+        return nodes;
+    };
+    auto animate = [](std::vector<SceneNode>& nodes) {
+        for (int i = 0; i < int(nodes.size()); ++i) {
+            Quaternionf rotation = Quaternionf::from_angle_axis(0.1f * i, Vector3f::up());
+            nodes[i].set_local_transform(Transform(Vector3f(float(i), 1, 0), rotation));
+        }
+        nodes[5].apply_delta_transform(Transform(Vector3f(0, 0, 2)));
+        nodes[2].set_global_transform(Transform(Vector3f(3, 3, 3)));
+    };
+
+    std::vector<SceneNode> immediate_nodes = create_hierarchy();
+    animate(immediate_nodes);
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    std::vector<SceneNode> deferred_nodes = create_hierarchy();
+    animate(deferred_nodes);
+    // Switching back to immediate propagation propagates the pending transforms.
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Immediate);
+    EXPECT_FALSE(SceneNodes::has_pending_transforms());
+
+    for (int i = 0; i < int(immediate_nodes.size()); ++i) {
+        EXPECT_PRED2(compare_transforms, immediate_nodes[i].get_global_transform(), deferred_nodes[i].get_global_transform());
+        EXPECT_PRED2(compare_transforms, immediate_nodes[i].get_local_transform(), deferred_nodes[i].get_local_transform());
+    }
+}
+
+TEST_F(Scene_Transform, deferred_reparenting_preserves_global_transform) {
+    SceneNode n0 = SceneNodes::create("n0");
+    SceneNode n1 = SceneNodes::create("n1");
+    SceneNode n2 = SceneNodes::create("n2");
+    n2.set_parent(n0);
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    n0.set_global_transform(Transform(Vector3f(1, 0, 0)));
+    n1.set_global_transform(Transform(Vector3f(0, 5, 0)));
+
+    // n2's global transform is pending propagation from n0 when it is moved below n1.
+    n2.set_parent(n1);
+    SceneNodes::propagate_transforms();
+
+    EXPECT_PRED2(compare_transforms, Transform(Vector3f(1, 0, 0)), n2.get_global_transform());
+    EXPECT_PRED2(compare_transforms, Transform(Vector3f(1, -5, 0)), n2.get_local_transform());
+}
+
+TEST_F(Scene_Transform, engine_tick_propagates_deferred_transforms) {
+    Core::Engine engine = Core::Engine("");
+    SceneNodes::add_transform_propagation_callbacks(engine);
+    SceneNode parent = SceneNodes::create("parent");
+    SceneNode child = SceneNodes::create("child");
+    child.set_parent(parent);
+
+    SceneNodes::set_transform_propagation(SceneNodes::TransformPropagation::Deferred);
+    parent.set_local_transform(Transform(Vector3f(1, 0, 0)));
+
+    // Transforms set between ticks are propagated before the mutating callbacks
+    // and transforms set by mutating callbacks before the non-mutating callbacks.
+    typedef Core::Engine::Manager Manager;
+    Transform mutating_child_transform, non_mutating_child_transform;
+    engine.add_mutating_callback("Move parent", [&]() {
+        mutating_child_transform = child.get_global_transform();
+        parent.set_local_transform(Transform(Vector3f(0, 2, 0)));
+    }, Manager::SceneNodes, Manager::SceneNodes);
+    engine.add_non_mutating_callback("Read child transform", [&]() { non_mutating_child_transform = child.get_global_transform(); },
+                                     Manager::SceneNodes, Manager::None);
+
+    engine.do_tick(0.1);
+
+    EXPECT_PRED2(compare_transforms, Transform(Vector3f(1, 0, 0)), mutating_child_transform);
+    EXPECT_PRED2(compare_transforms, Transform(Vector3f(0, 2, 0)), non_mutating_child_transform);
+    EXPECT_FALSE(SceneNodes::has_pending_transforms());
+}
+
 } // NS Core
 } // NS Bifrost
 
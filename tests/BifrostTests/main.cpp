@@ -11,12 +11,19 @@
 #include <Assets/ImageTest.h>
 #include <Assets/InfiniteAreaLightTest.h>
 #include <Assets/MaterialTest.h>
+#include <Assets/MeshBVHTest.h>
 #include <Assets/MeshTest.h>
 #include <Assets/MeshModelTest.h>
+#include <Assets/MeshSimplificationTest.h>
 #include <Assets/TextureTest.h>
 
 #include <Core/ArrayTest.h>
 #include <Core/BitmaskTest.h>
+#include <Core/ChangeSetTest.h>
+#include <Core/EngineTest.h>
+#include <Core/ProfilerTest.h>
+#include <Core/ReservedArrayTest.h>
+#include <Core/TaskSchedulerTest.h>
 #include <Core/UniqueIDGeneratorTest.h>
 
 #include <Input/KeyboardTest.h>
@@ -32,9 +39,17 @@
 #include <Math/UtilsTest.h>
 
 #include <Scene/CameraTest.h>
+#include <Scene/ChangeLogTest.h>
 #include <Scene/LightSourceTest.h>
+#include <Scene/LightTreeTest.h>
+#include <Scene/MemoryReportTest.h>
+#include <Scene/MeshModelBatchesTest.h>
+#include <Scene/MeshModelBVHTest.h>
+#include <Scene/SceneBVHTest.h>
 #include <Scene/SceneNodeTest.h>
 #include <Scene/SceneRootTest.h>
+#include <Scene/ScreenshotWriterTest.h>
+#include <Scene/SnapshotTest.h>
 #include <Scene/TransformTest.h>
 
 // NOTE